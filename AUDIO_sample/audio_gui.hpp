@@ -148,7 +148,27 @@ namespace app {
 		typedef img::scaling<RENDER> SCALING;
 		SCALING		scaling_;
 
-		typedef img::img_in<SCALING> IMG_IN;
+		// ジャケット画像の縮小（ソースの最大幅 640、出力は LCD_Y 以下）
+		typedef img::resampler<SCALING, 640, LCD_Y> RESAMPLER;
+		RESAMPLER	resampler_;
+
+		// リサンプラーで扱えない画像（幅が広い等）は、scaling で間引く
+		struct art_plot {
+			RESAMPLER&	resampler_;
+			SCALING&	scaling_;
+			bool		resample_;
+
+			art_plot(RESAMPLER& rs, SCALING& sc) noexcept : resampler_(rs), scaling_(sc), resample_(false) { }
+
+			void operator() (int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) noexcept
+			{
+				if(resample_) resampler_(x, y, r, g, b, a);
+				else scaling_(x, y, r, g, b, a);
+			}
+		};
+		art_plot	art_plot_;
+
+		typedef img::img_in<art_plot> IMG_IN;
 		IMG_IN		img_in_;
 
 		uint32_t	ctrl_;
@@ -196,6 +216,7 @@ namespace app {
 			render_.sync_frame(false);
 
 			scaling_.set_offset(vtx::spos(LCD_X - LCD_Y, 0));
+			art_plot_.resample_ = false;
 			if(tag.get_apic().len_ > 0) {
 				if(!img_in_.select_decoder(tag.get_apic().ext_)) {
 					scaling_.set_scale();
@@ -217,9 +238,20 @@ namespace app {
 						render_.swap_color();
 					} else {
 						auto n = std::max(ifo.width, ifo.height);
-						scaling_.set_scale(LCD_Y, n);
+						vtx::spos dst(std::max<int32_t>(ifo.width * LCD_Y / n, 1),
+							std::max<int32_t>(ifo.height * LCD_Y / n, 1));
+						scaling_.set_scale();
+						art_plot_.resample_ = resampler_.start(vtx::spos(ifo.width, ifo.height), dst,
+							RESAMPLER::FILTER::BILINEAR);
+						if(!art_plot_.resample_) {
+							scaling_.set_scale(LCD_Y, n);
+						}
 						render_.flush();
 						img_in_.load(fin);
+						if(art_plot_.resample_) {
+							resampler_.flush();
+							art_plot_.resample_ = false;
+						}
 					}
 					fin.seek(utils::file_io::SEEK::SET, pos);
 				}
@@ -330,7 +362,7 @@ namespace app {
 			ff_(    vtx::srect(70*2, 272-64, 64, 64), ">>"),
 			level_l_(vtx::srect(70*1, 272-64*2+26*0, 134, 20)),
 			level_r_(vtx::srect(70*1, 272-64*2+26*1, 134, 20)),
-			scaling_(render_), img_in_(scaling_),
+			scaling_(render_), resampler_(scaling_), art_plot_(resampler_, scaling_), img_in_(art_plot_),
 			ctrl_(0), path_{ 0 },
 			fin_artist_(), year_str_(), info_str_(), time_str_(),
 			play_stop_(), play_rew_(), play_pause_(), play_ff_(),
@@ -11,6 +11,7 @@
 #include <cmath>
 #include <cstring>
 #include "common/command.hpp"
+#include "common/command_map.hpp"
 
 #include "common/format.hpp"
 #include "common/fixed_string.hpp"
@@ -50,6 +51,22 @@ namespace app {
 
 		typedef utils::fixed_string<256> STR;
 
+		enum class CALC_CMD : uint8_t {
+			HELP,
+			RAD,
+			GRAD,
+			DEG,
+		};
+
+		static constexpr auto calc_map_ = utils::make_command_map<CALC_CMD>({
+			{ "help", CALC_CMD::HELP },
+			{ "?",    CALC_CMD::HELP },
+			{ "Rad",  CALC_CMD::RAD },
+			{ "Grad", CALC_CMD::GRAD },
+			{ "Deg",  CALC_CMD::DEG },
+		});
+		static_assert(calc_map_.unique(), "calc: command name duplicated");
+
 	public:
 		//-------------------------------------------------------------//
 		/*!
@@ -85,28 +102,44 @@ namespace app {
 			const auto* cmd =  cmd_.get_command();
 			if(cmd[0] == 0) return;
 
-			if(strcmp(cmd, "help") == 0 || strcmp(cmd, "?") == 0) {
-				utils::format("  PI\n");
-				utils::format("  LOG2\n");
-				utils::format("  EULER\n");
-				utils::format("  ANS\n");
-				utils::format("  V[0-9]     Memory symbol 0..9\n");
-				utils::format("  Min[0-9]   Memory In 0..9\n");
-				utils::format("  Rad        0 to 2*PI\n");
-				utils::format("  Grad       0 to 400\n");
-				utils::format("  Deg        0 to 360\n");
-				utils::format("  sin(x)\n");
-				utils::format("  cos(x)\n");
-				utils::format("  tan(x)\n");
-				utils::format("  asin(x)\n");
-				utils::format("  acos(x)\n");
-				utils::format("  atan(x)\n");
-				utils::format("  sqrt(x)\n");
-				utils::format("  log(x)\n");
-				utils::format("  ln(x)\n");
-				utils::format("  exp10(x)\n");
+			CALC_CMD id;
+			if(calc_map_.find(cmd, id)) {
+				switch(id) {
+				case CALC_CMD::HELP:
+					utils::format("  PI\n");
+					utils::format("  LOG2\n");
+					utils::format("  EULER\n");
+					utils::format("  ANS\n");
+					utils::format("  V[0-9]     Memory symbol 0..9\n");
+					utils::format("  Min[0-9]   Memory In 0..9\n");
+					utils::format("  Rad        0 to 2*PI\n");
+					utils::format("  Grad       0 to 400\n");
+					utils::format("  Deg        0 to 360\n");
+					utils::format("  sin(x)\n");
+					utils::format("  cos(x)\n");
+					utils::format("  tan(x)\n");
+					utils::format("  asin(x)\n");
+					utils::format("  acos(x)\n");
+					utils::format("  atan(x)\n");
+					utils::format("  sqrt(x)\n");
+					utils::format("  log(x)\n");
+					utils::format("  ln(x)\n");
+					utils::format("  exp10(x)\n");
+					break;
+				case CALC_CMD::RAD:
+					func_.set_atype(FUNC::ATYPE::Rad);
+					break;
+				case CALC_CMD::GRAD:
+					func_.set_atype(FUNC::ATYPE::Grad);
+					break;
+				case CALC_CMD::DEG:
+					func_.set_atype(FUNC::ATYPE::Deg);
+					break;
+				}
 				return;
-			} else if(strncmp(cmd, "Min", 3) == 0) {
+			}
+
+			if(strncmp(cmd, "Min", 3) == 0) {
 				if(cmd[3] >= '0' && cmd[3] <= '9') {
 					NVAL val;
 					symbol_(SYMBOL::NAME::ANS, val);
@@ -117,15 +150,6 @@ namespace app {
 					utils::format("Min number fail.\n");
 				}
 				return;
-			} else if(strcmp(cmd, "Rad") == 0) {
-				func_.set_atype(FUNC::ATYPE::Rad);
-				return;
-			} else if(strcmp(cmd, "Grad") == 0) {
-				func_.set_atype(FUNC::ATYPE::Grad);
-				return;
-			} else if(strcmp(cmd, "Deg") == 0) {
-				func_.set_atype(FUNC::ATYPE::Deg);
-				return;
 			}
 
 			if(arith_.analize(cmd)) {
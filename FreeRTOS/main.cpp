@@ -1,6 +1,8 @@
 //=====================================================================//
 /*! @file
     @brief  FreeRTOS sample（Flash LED, Output SCI） @n
+			各タスクは、自分の出力ファンクタ（line_chaout）で書式変換を行い、@n
+			１行をまとめて SCI に送るので、変換中に他のタスクを止めない。@n
 			RX64M, RX71M, RX72M: @n
 					12MHz のベースクロックを使用する @n
 			　　　　P07 ピンにLEDを接続する @n
@@ -103,6 +105,21 @@ namespace {
 //	StaticSemaphore_t	getch_semaphore_;
 	SemaphoreHandle_t	getch_sync_;
 
+	SemaphoreHandle_t	line_sync_;
+
+	// タスク毎の行出力：１行の送信だけを排他する（書式変換は排他しない）
+	class sci_term {
+	public:
+		void operator() (const char* s, uint16_t l) noexcept {
+			xSemaphoreTake(line_sync_, portMAX_DELAY);
+			for(uint16_t i = 0; i < l; ++i) {
+				sci_.putch(s[i]);
+			}
+			xSemaphoreGive(line_sync_);
+		}
+	};
+	typedef utils::line_chaout<80, sci_term> LINE_OUT;
+	typedef utils::basic_format<LINE_OUT> task_format;
 }
 
 extern "C" {
@@ -222,6 +239,7 @@ namespace {
 
 	void vTask1(void *pvParameters)
 	{
+		LINE_OUT out;
 		uint32_t loop = 0;
 		uint32_t cnt = 0;
 		while(1) {
@@ -232,7 +250,7 @@ namespace {
 			++loop;
 			if(loop >= 10) {
 				loop = 0;
-				utils::format("Task1: %u\n") % cnt;
+				task_format(out, "Task1: %u\n") % cnt;
 				++cnt;
 			}
 		}
@@ -241,6 +259,7 @@ namespace {
 
 	void vTask2(void *pvParameters)
 	{
+		LINE_OUT out;
 		uint32_t loop = 0;
 		uint32_t cnt = 0;
 		while(1) {
@@ -255,7 +274,7 @@ namespace {
 			++loop;
 			if(loop >= 12) {
 				loop = 0;
-				utils::format("Task2: %u\n") % cnt;
+				task_format(out, "Task2: %u\n") % cnt;
 				++cnt;
 			}
 		}
@@ -264,9 +283,10 @@ namespace {
 
 	void vTask3(void *pvParameters)
 	{
+		LINE_OUT out;
 		uint32_t cnt = 0;
 		while(1) {
-			utils::format("Task3: %u\n") % cnt;
+			task_format(out, "Task3: %u\n") % cnt;
 			++cnt;
 			vTaskDelay(1000 / portTICK_PERIOD_MS);
 		}
@@ -291,6 +311,7 @@ int main(int argc, char** argv)
 		putch_sync_ = xSemaphoreCreateBinary();	// putch 排他制御のリソースを作成
 		puts_sync_  = xSemaphoreCreateBinary();	// puts  排他制御のリソースを作成
 		getch_sync_ = xSemaphoreCreateBinary();	// getch 排他制御のリソースを作成
+		line_sync_  = xSemaphoreCreateMutex();	// 行出力 排他制御のリソースを作成
 		uint8_t intr = 2;        // 割り込みレベル
 		uint32_t baud = 115200;  // ボーレート
 		sci_.start(baud, intr);
@@ -203,6 +203,29 @@ namespace {
 	uint8_t		fami_pad_data_;
 	bool		monitor_ = false;
 
+	enum class NES_CMD : uint8_t {
+		NES,
+		RESET,
+		PAUSE,
+		SAVE,
+		LOAD,
+		INFO,
+		MONITOR,
+		HELP,
+	};
+
+	static constexpr auto nes_map_ = utils::make_command_map<NES_CMD>({
+		{ "nes",      NES_CMD::NES },
+		{ "reset",    NES_CMD::RESET },
+		{ "pause",    NES_CMD::PAUSE },
+		{ "save",     NES_CMD::SAVE },
+		{ "load",     NES_CMD::LOAD },
+		{ "info",     NES_CMD::INFO },
+		{ "call-151", NES_CMD::MONITOR },
+		{ "help",     NES_CMD::HELP },
+	});
+	static_assert(nes_map_.unique(), "NESEMU: command name duplicated");
+
 	void command_()
 	{
 		if(!cmd_.service()) {
@@ -228,7 +251,14 @@ namespace {
 		auto cmdn = cmd_.get_words();
 		if(cmdn == 0) return;
 
-		if(cmd_.cmp_word(0, "nes")) {
+		NES_CMD id;
+		if(!cmd_.find_word(0, nes_map_, id)) {
+			utils::format("Command error: '%s'\n") % cmd_.get_command();
+			return;
+		}
+
+		switch(id) {
+		case NES_CMD::NES:
 			if(cmdn >= 2) {
 				char tmp[FF_MAX_LFN + 1];
 				cmd_.get_word(1, tmp, sizeof(tmp));
@@ -236,41 +266,54 @@ namespace {
 					utils::format("Open error: '%s'\n") % tmp;
 				}
 			}
-		} else if(cmd_.cmp_word(0, "reset")) {
+			break;
+		case NES_CMD::RESET:
 			nesemu_.reset();
-		} else if(cmd_.cmp_word(0, "pause")) {
+			break;
+		case NES_CMD::PAUSE:
 			nesemu_.enable_pause(!nesemu_.get_pause());
-		} else if(cmd_.cmp_word(0, "save")) {
-			int slot = 0;
-			if(cmdn >= 2) {
-				char tmp[32];
-				cmd_.get_word(1, tmp, sizeof(tmp));
-				utils::input("%d", tmp) % slot;
-			}
-			if(!nesemu_.save_state(slot)) {
-				utils::format("Save state error: slot = %d\n") % slot;
+			break;
+		case NES_CMD::SAVE:
+			{
+				int slot = 0;
+				if(cmdn >= 2) {
+					char tmp[32];
+					cmd_.get_word(1, tmp, sizeof(tmp));
+					utils::input("%d", tmp) % slot;
+				}
+				if(!nesemu_.save_state(slot)) {
+					utils::format("Save state error: slot = %d\n") % slot;
+				}
 			}
-		} else if(cmd_.cmp_word(0, "load")) {
-			int slot = 0;
-			if(cmdn >= 2) {
-				char tmp[32];
-				cmd_.get_word(1, tmp, sizeof(tmp));
-				utils::input("%d", tmp) % slot;
+			break;
+		case NES_CMD::LOAD:
+			{
+				int slot = 0;
+				if(cmdn >= 2) {
+					char tmp[32];
+					cmd_.get_word(1, tmp, sizeof(tmp));
+					utils::input("%d", tmp) % slot;
+				}
+				if(!nesemu_.load_state(slot)) {
+					utils::format("Load state error: slot = %d\n") % slot;
+				}
 			}
-			if(!nesemu_.load_state(slot)) {
-				utils::format("Load state error: slot = %d\n") % slot;
+			break;
+		case NES_CMD::INFO:
+			{
+				const char* str = nesemu_.get_info();
+				utils::format("%s\n") % str;
 			}
-		} else if(cmd_.cmp_word(0, "info")) {
-			const char* str = nesemu_.get_info();
-			utils::format("%s\n") % str;
-		} else if(cmd_.cmp_word(0, "call-151")) {
+			break;
+		case NES_CMD::MONITOR:
 			if(nesemu_.probe()) {
 				cmd_.set_prompt("$");
 				monitor_ = true;
 			} else {
 				utils::format("Not Ready To Cartridge (NESEMU)\n");
 			}
-		} else if(cmd_.cmp_word(0, "help")) {
+			break;
+		case NES_CMD::HELP:
 			shell_.help();
 			utils::format("    nes filename    Emulations for NES\n");
 			utils::format("    pause           Pause Emulation (toggle)\n");
@@ -279,8 +322,7 @@ namespace {
 			utils::format("    load [slot-no]  Load NES State (slot-no:0 to 9)\n");
 			utils::format("    info            Cartrige Infomations\n");
 			utils::format("    call-151        Goto Monitor\n");
-		} else {
-			utils::format("Command error: '%s'\n") % cmd_.get_command();
+			break;
 		}
 	}
 
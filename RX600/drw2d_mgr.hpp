@@ -41,6 +41,8 @@ namespace device {
 		typedef GLC glc_type;
 		typedef FONT font_type;
 
+		static constexpr uint32_t TEXTURE_RGBA8888 = d2_mode_rgba8888;	///< set_texture のフォーマット
+
 	private:
 		typedef device::DRW2D DRW;
 
@@ -1,7 +1,9 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	コマンド入力クラス
+	@brief	コマンド入力クラス @n
+			※「Enter」キーで行が確定した時に、単語の位置と長さを一度だけ求める @n
+			※get_words、get_word、cmp_word は、行を先頭から探し直さない
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2016, 2017 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -10,6 +12,7 @@
 //=====================================================================//
 #include "common/string_utils.hpp"
 #include "common/input.hpp"
+#include "common/command_map.hpp"
 
 // SCI（文字入出力）コンテキストとして、以下の API を定義する必要がある。
 extern "C" {
@@ -25,11 +28,15 @@ namespace utils {
     /*!
         @brief  command class
 		@param[in]	BUFN	バッファサイズ（最小でも９）
+		@param[in]	WORDN	位置を記録する単語数（それ以降は、行を探して求める）
     */
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <uint16_t BUFN>
+	template <uint16_t BUFN, uint16_t WORDN = 16>
 	class command {
 		char		buff_[BUFN];
+		uint16_t	word_pos_[WORDN];
+		uint16_t	word_len_[WORDN];
+		uint16_t	words_;
 		int16_t		bpos_;
 		int16_t		pos_;
 		uint16_t	len_;
@@ -64,13 +71,47 @@ namespace utils {
 			sci_putch('\n');	///< LF
 		}
 
+		// 単語の位置と長さを記録（str::get_word と同じ規則、バックスラッシュは次の文字を示す）
+		void scan_words_() noexcept
+		{
+			words_ = 0;
+			char bc = ' ';
+			bool bsc = false;
+			uint16_t i = 0;
+			while(1) {
+				char ch = buff_[i];
+				if(ch == '\\') {
+					bsc = true;
+				} else if(bsc) {
+					bsc = false;
+					if(ch == 0) {  // 行末のバックスラッシュ（連続も）は、単語に含めない
+						while(i > 0 && buff_[i - 1] == '\\') --i;
+						break;
+					}
+				} else {
+					if(bc == ' ' && ch != ' ' && ch != 0) {
+						if(words_ < WORDN) word_pos_[words_] = i;
+						++words_;
+					} else if(bc != ' ' && ch == ' ') {
+						if(words_ <= WORDN) word_len_[words_ - 1] = i - word_pos_[words_ - 1];
+					}
+					if(ch == 0) break;
+					bc = ch;
+				}
+				++i;
+			}
+			if(bc != ' ' && words_ > 0 && words_ <= WORDN) {  // 行末で終わる単語
+				word_len_[words_ - 1] = i - word_pos_[words_ - 1];
+			}
+		}
+
 	public:
         //-----------------------------------------------------------------//
         /*!
             @brief  コンストラクター
         */
         //-----------------------------------------------------------------//
-		command() : bpos_(-1), pos_(0), len_(0), tab_top_(-1),
+		command() : words_(0), bpos_(-1), pos_(0), len_(0), tab_top_(-1),
 			prompt_(nullptr), tab_(false), esc_(false), esc_step_(false)
 		{ buff_[0] = 0; }
 
@@ -115,6 +156,7 @@ namespace utils {
 				case '\r':	// Enter キー
 					buff_[pos_] = 0;
 					len_ = pos_;
+					scan_words_();
 					clear_line_();
 					crlf_();
 					pos_ = 0;
@@ -201,13 +243,17 @@ namespace utils {
         */
         //-----------------------------------------------------------------//
 		uint32_t get_words(char sch = ' ') const {
-			return str::get_words(buff_, sch);
+			if(sch != ' ') return str::get_words(buff_, sch);
+			return words_;
 		}
 
 
         //-----------------------------------------------------------------//
         /*!
-            @brief  ワードを取得
+            @brief  ワードを取得 @n
+					※行末が空白の場合（エスケープされた文字は数えない、空の行も同じ）、@n
+					　str::get_word は argc == get_words() でも空の文字列で「true」を返すが、@n
+					　ここでは「false」を返す
 			@param[in]	argc	ワード位置
 			@param[out]	dst		ワード文字列格納ポインター
 			@param[in]	dstlen	ワード文字列リミット数
@@ -216,13 +262,32 @@ namespace utils {
         */
         //-----------------------------------------------------------------//
 		bool get_word(uint32_t argc, char* dst, uint32_t dstlen, char sch = ' ') const {
-			return str::get_word(buff_, argc, dst, dstlen);
+			if(sch != ' ') return str::get_word(buff_, argc, dst, dstlen, sch);
+			if(dst == nullptr || dstlen == 0) return false;
+			if(argc >= words_) {
+				*dst = 0;
+				return false;
+			}
+			if(argc >= WORDN) return str::get_word(buff_, argc, dst, dstlen);
+			const char* src = &buff_[word_pos_[argc]];
+			uint32_t len = word_len_[argc];
+			uint32_t i = 0;
+			while(i < len && dstlen > 1) {
+				char ch = src[i++];
+				while(ch == '\\' && i < len) ch = src[i++];
+				*dst++ = ch;
+				--dstlen;
+			}
+			*dst = 0;
+			return true;
 		}
 
 
         //-----------------------------------------------------------------//
         /*!
-            @brief  ワードを比較
+            @brief  ワードを比較 @n
+					※str::cmp_word は、ワードが無い（argc >= get_words()）時、@n
+					　空のキーで「true」を返すが、ここでは「false」を返す
 			@param[in]	argc	ワード位置
 			@param[in]	key		比較文字列
 			@param[in]	sch		単語分離キャラクタ
@@ -230,7 +295,60 @@ namespace utils {
         */
         //-----------------------------------------------------------------//
 		bool cmp_word(uint32_t argc, const char* key, char sch = ' ') const {
-			return str::cmp_word(buff_, argc, key, sch);
+			if(sch != ' ') return str::cmp_word(buff_, argc, key, sch);
+			if(key == nullptr || argc >= words_) return false;
+			if(argc >= WORDN) return str::cmp_word(buff_, argc, key);
+			const char* src = &buff_[word_pos_[argc]];
+			uint32_t len = word_len_[argc];
+			uint32_t i = 0;
+			while(i < len) {
+				char ch = src[i++];
+				while(ch == '\\' && i < len) ch = src[i++];
+				if(ch != *key) return false;
+				++key;
+			}
+			return *key == 0;
+		}
+
+
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  ワードの先頭と長さを取得（バックスラッシュを含む、NUL 終端されない）
+			@param[in]	argc	ワード位置
+			@param[out]	len		ワードの長さ
+			@return ワードの先頭（無い場合「nullptr」）
+        */
+        //-----------------------------------------------------------------//
+		const char* get_word_top(uint32_t argc, uint32_t& len) const {
+			if(argc >= words_ || argc >= WORDN) {
+				len = 0;
+				return nullptr;
+			}
+			len = word_len_[argc];
+			return &buff_[word_pos_[argc]];
+		}
+
+
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  ワードをコマンド・ディスパッチ表から探す
+			@param[in]	argc	ワード位置
+			@param[in]	map		コマンド・ディスパッチ表
+			@param[out]	id		見つかった ID
+			@return 見つかれば「true」
+        */
+        //-----------------------------------------------------------------//
+		template <class ID, uint32_t N>
+		bool find_word(uint32_t argc, const command_map<ID, N>& map, ID& id) const {
+			if(argc >= WORDN) {  // 位置を記録していない単語
+				char tmp[BUFN];
+				if(!get_word(argc, tmp, sizeof(tmp))) return false;
+				return map.find(tmp, id);
+			}
+			uint32_t len;
+			auto top = get_word_top(argc, len);
+			if(top == nullptr) return false;
+			return map.find(top, len, id);
 		}
 
 
@@ -0,0 +1,188 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	コマンド・ディスパッチ表 @n
+			・コマンド名と ID の表を、コンパイル時に整列する @n
+			・検索は２分探索（コマンド数 N に対して log2(N) 回の比較）@n
+			・キーは NUL 終端されていない単語（command の単語位置）で引ける @n
+			Ex: @n
+			enum class CMD_ID { LS, PWD, CD }; @n
+			static constexpr auto map = utils::make_command_map<CMD_ID>({ @n
+				{ "ls", CMD_ID::LS }, { "pwd", CMD_ID::PWD }, { "cd", CMD_ID::CD } }); @n
+			static_assert(map.unique(), "command name duplicated"); @n
+			CMD_ID id; @n
+			if(cmd.find_word(0, map, id)) { switch(id) { ... } }
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  コマンド名と ID
+		@param[in]	ID	ID の型（enum class など）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class ID>
+	struct command_key {
+		const char*	key;	///< コマンド名
+		ID			id;		///< ID
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  コマンド・ディスパッチ表
+		@param[in]	ID	ID の型
+		@param[in]	N	コマンド数
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class ID, uint32_t N>
+	class command_map {
+
+		command_key<ID>	tbl_[N];
+
+		static constexpr int cmp_(const char* a, const char* b) noexcept
+		{
+			while(*a != 0 && *a == *b) {
+				++a;
+				++b;
+			}
+			return static_cast<int>(static_cast<uint8_t>(*a)) - static_cast<int>(static_cast<uint8_t>(*b));
+		}
+
+		// key と、単語（len 文字、バックスラッシュは除く）の比較
+		static int cmp_word_(const char* key, const char* src, uint32_t len) noexcept
+		{
+			uint32_t i = 0;
+			while(1) {
+				uint8_t s = 0;
+				if(i < len) {
+					s = src[i++];
+					while(s == '\\' && i < len) s = src[i++];
+				}
+				uint8_t k = *key++;
+				if(k != s) return static_cast<int>(k) - static_cast<int>(s);
+				if(k == 0) return 0;
+			}
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクタ（挿入ソートで整列する）
+			@param[in]	src	コマンド名と ID の配列
+		*/
+		//-----------------------------------------------------------------//
+		constexpr command_map(const command_key<ID> (&src)[N]) noexcept : tbl_{ }
+		{
+			for(uint32_t i = 0; i < N; ++i) {
+				auto t = src[i];
+				uint32_t j = i;
+				while(j > 0 && cmp_(t.key, tbl_[j - 1].key) < 0) {
+					tbl_[j] = tbl_[j - 1];
+					--j;
+				}
+				tbl_[j] = t;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コマンド数を返す
+			@return コマンド数
+		*/
+		//-----------------------------------------------------------------//
+		constexpr uint32_t size() const noexcept { return N; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コマンド名の重複が無いか検査（static_assert 用）
+			@return 重複が無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		constexpr bool unique() const noexcept
+		{
+			for(uint32_t i = 1; i < N; ++i) {
+				if(cmp_(tbl_[i - 1].key, tbl_[i].key) == 0) return false;
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  整列後の参照
+			@param[in]	idx	位置
+			@return コマンド名と ID
+		*/
+		//-----------------------------------------------------------------//
+		constexpr const command_key<ID>& operator [] (uint32_t idx) const noexcept { return tbl_[idx]; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  単語を探す
+			@param[in]	src	単語の先頭
+			@param[in]	len	単語の長さ
+			@param[out]	id	見つかった ID
+			@return 見つかれば「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool find(const char* src, uint32_t len, ID& id) const noexcept
+		{
+			uint32_t lo = 0;
+			uint32_t hi = N;
+			while(lo < hi) {
+				uint32_t mid = (lo + hi) / 2;
+				auto r = cmp_word_(tbl_[mid].key, src, len);
+				if(r == 0) {
+					id = tbl_[mid].id;
+					return true;
+				} else if(r < 0) {
+					lo = mid + 1;
+				} else {
+					hi = mid;
+				}
+			}
+			return false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  文字列を探す
+			@param[in]	key	文字列
+			@param[out]	id	見つかった ID
+			@return 見つかれば「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool find(const char* key, ID& id) const noexcept
+		{
+			uint32_t len = 0;
+			while(key[len] != 0) ++len;
+			return find(key, len, id);
+		}
+	};
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  コマンド・ディスパッチ表を作る
+		@param[in]	src	コマンド名と ID の配列
+		@return コマンド・ディスパッチ表
+	*/
+	//-----------------------------------------------------------------//
+	template <class ID, uint32_t N>
+	constexpr command_map<ID, N> make_command_map(const command_key<ID> (&src)[N]) noexcept
+	{
+		return command_map<ID, N>(src);
+	}
+}
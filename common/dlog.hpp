@@ -0,0 +1,397 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	遅延バイナリ・ログ @n
+			マイコン側では文字列変換を行わず、フォーマット文字列のアドレス（ID）、@n
+			タイムスタンプ、引数の生データをリングバッファに積むだけにする。@n
+			文字列化は、ホスト側のデコーダー（rxprog/dlogdec）が、ELF ファイル @n
+			から書式を取り出して、utils::format と同じ規則で行う。@n
+			レコード形式（リトル・エンディアン）： @n
+			SYNC(0xA5) LEN ID(4) TICK(4) 引数... SUM @n
+			引数は、型タグ（１バイト）とデータ： @n
+			'i'/'u' 整数(4)、'f' float(4)、'd' double(8)、'p' ポインター(4)、@n
+			's' 文字列（長さ(1) + 文字）@n
+			LEN は ID から引数の最後までのバイト数、SUM は LEN から引数の最後までの和 @n
+			Ex: @n
+				typedef utils::dlog_buffer<2048> DLOG; @n
+				DLOG dlog_; @n
+				utils::dlog_format<DLOG>(dlog_, "ADC: %d, %d\n") % ch0 % ch1; @n
+				// メインループで、dlog_.read() したバイト列を SCI に送る
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <atomic>
+#include "common/format.hpp"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	遅延ログ、共通定義
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct dlog_base {
+
+		static constexpr uint8_t SYNC = 0xA5;		///< レコード先頭
+		static constexpr uint32_t RECORD_MAX = 64;	///< レコード最大長（SYNC、LEN、SUM を含む）
+		static constexpr uint32_t STR_MAX = 24;		///< 文字列引数の最大長
+
+		//=================================================================//
+		/*!
+			@brief	引数の型タグ
+		*/
+		//=================================================================//
+		enum class tag : uint8_t {
+			INT    = 'i',	///< 符号付き整数（３２ビット）
+			UINT   = 'u',	///< 符号無し整数（３２ビット）
+			FLOAT  = 'f',	///< float
+			DOUBLE = 'd',	///< double
+			PTR    = 'p',	///< ポインター（３２ビット）
+			STR    = 's',	///< 文字列（長さ + 文字）
+		};
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	タイムスタンプ無し（常に０）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct dlog_null_tick {
+		uint32_t operator() () const noexcept { return 0; }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	遅延ログ・バッファ・クラス @n
+				書き込み（レコード単位）と、読み出しが、それぞれ１つのコンテキスト @n
+				なら、割り込みを禁止せずに使える。@n
+				書き込むコンテキストが複数ある場合は、バッファを分ける。
+		@param[in]	SIZE	バッファ・サイズ（２のべき乗）
+		@param[in]	TICK	タイムスタンプ・ファンクタ（uint32_t operator() ()）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t SIZE, class TICK = dlog_null_tick>
+	class dlog_buffer : public dlog_base {
+
+		static_assert(SIZE >= RECORD_MAX && (SIZE & (SIZE - 1)) == 0, "SIZE must be a power of two");
+
+		volatile uint32_t	put_;
+		volatile uint32_t	get_;
+		volatile uint32_t	lost_;
+		TICK				tick_;
+		uint8_t				buff_[SIZE];
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+			@param[in]	tick	タイムスタンプ・ファンクタ
+		*/
+		//-----------------------------------------------------------------//
+		dlog_buffer(const TICK& tick = TICK()) noexcept : put_(0), get_(0), lost_(0), tick_(tick) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  タイムスタンプを取得
+			@return タイムスタンプ
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_tick() const noexcept { return tick_(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  レコードを追加 @n
+					全てコピーしてから、書き込み位置を一度だけ更新する
+			@param[in]	src	レコード
+			@param[in]	len	長さ
+			@return 空きが無い場合「false」（捨てた数を記録する）
+		*/
+		//-----------------------------------------------------------------//
+		bool commit(const uint8_t* src, uint32_t len) noexcept
+		{
+			uint32_t p = put_;
+			if((SIZE - (p - get_)) < len) {
+				lost_ = lost_ + 1;
+				return false;
+			}
+			for(uint32_t i = 0; i < len; ++i) {
+				buff_[(p + i) & (SIZE - 1)] = src[i];
+			}
+			std::atomic_signal_fence(std::memory_order_release);
+			put_ = p + len;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  読み出し可能なバイト数
+			@return バイト数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t length() const noexcept { return put_ - get_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  バイト列を読み出す（レコードの区切りとは無関係）
+			@param[out]	dst	出力先
+			@param[in]	len	最大長
+			@return 読み出したバイト数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t read(uint8_t* dst, uint32_t len) noexcept
+		{
+			uint32_t g = get_;
+			uint32_t n = put_ - g;
+			std::atomic_signal_fence(std::memory_order_acquire);
+			if(n > len) n = len;
+			for(uint32_t i = 0; i < n; ++i) {
+				dst[i] = buff_[(g + i) & (SIZE - 1)];
+			}
+			std::atomic_signal_fence(std::memory_order_release);
+			get_ = g + n;
+			return n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  空きが無くて捨てたレコード数
+			@return レコード数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_lost() const noexcept { return lost_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  クリア（書き込み、読み出しが止まっている事）
+		*/
+		//-----------------------------------------------------------------//
+		void clear() noexcept
+		{
+			put_ = 0;
+			get_ = 0;
+			lost_ = 0;
+		}
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	遅延ログ・フォーマット・クラス @n
+				basic_format と同じ「%」演算子で引数を積み、@n
+				デストラクター（式の終わり）でレコードをバッファに追加する。@n
+				書式の解釈はホスト側で行うので、変換の種類は検査しない。
+		@param[in]	BUFF	dlog_buffer 型
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class BUFF>
+	class dlog_format : public base_format {
+
+		BUFF&		buff_;
+		uint32_t	pos_;
+		error		error_;
+		uint8_t		rec_[dlog_base::RECORD_MAX];
+
+		void put32_(uint32_t v) noexcept {
+			rec_[pos_ + 0] = v;
+			rec_[pos_ + 1] = v >> 8;
+			rec_[pos_ + 2] = v >> 16;
+			rec_[pos_ + 3] = v >> 24;
+			pos_ += 4;
+		}
+
+		bool space_(uint32_t len) noexcept {
+			if(error_ != error::none) return false;
+			// SUM の１バイトを残す
+			if((pos_ + len + 1) > dlog_base::RECORD_MAX) {
+				error_ = error::over;
+				return false;
+			}
+			return true;
+		}
+
+		void value_(dlog_base::tag t, uint32_t v) noexcept {
+			if(!space_(5)) return;
+			rec_[pos_++] = static_cast<uint8_t>(t);
+			put32_(v);
+		}
+
+		void str_(const char* str) noexcept {
+			if(str == nullptr) {
+				error_ = error::null;
+				return;
+			}
+			uint32_t len = 0;
+			while(len < dlog_base::STR_MAX && str[len] != 0) ++len;
+			if(!space_(2 + len)) return;
+			rec_[pos_++] = static_cast<uint8_t>(dlog_base::tag::STR);
+			rec_[pos_++] = len;
+			std::memcpy(&rec_[pos_], str, len);
+			pos_ += len;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+			@param[in]	buff	ログ・バッファ
+			@param[in]	form	フォーマット式（ROM 上の文字列リテラルである事）
+		*/
+		//-----------------------------------------------------------------//
+		dlog_format(BUFF& buff, const char* form) noexcept :
+			buff_(buff), pos_(0), error_(error::none)
+		{
+			if(form == nullptr) {
+				error_ = error::null;
+				return;
+			}
+			rec_[pos_++] = dlog_base::SYNC;
+			rec_[pos_++] = 0;
+			put32_(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(form)));
+			put32_(buff_.get_tick());
+		}
+
+
+		dlog_format(const dlog_format& th) = delete;
+		dlog_format& operator = (const dlog_format& th) = delete;
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  デストラクター（レコードをバッファに追加）
+		*/
+		//-----------------------------------------------------------------//
+		~dlog_format() noexcept
+		{
+			if(pos_ == 0) return;
+
+			rec_[1] = pos_ - 2;
+			uint8_t sum = 0;
+			for(uint32_t i = 1; i < pos_; ++i) sum += rec_[i];
+			rec_[pos_++] = sum;
+			buff_.commit(rec_, pos_);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  エラー種別を返す
+			@return エラー
+		*/
+		//-----------------------------------------------------------------//
+		error get_error() const noexcept { return error_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  変換ステータスを返す
+			@return 引数が全て積めたら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool status() const noexcept { return error_ == error::none; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  オペレーター「%」(const char*)
+			@param[in]	val	文字列（STR_MAX で切り詰める）
+			@return	自分の参照
+		*/
+		//-----------------------------------------------------------------//
+		dlog_format& operator % (const char* val) noexcept
+		{
+			str_(val);
+			return *this;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  オペレーター「%」(char*)
+			@param[in]	val	文字列（STR_MAX で切り詰める）
+			@return	自分の参照
+		*/
+		//-----------------------------------------------------------------//
+		dlog_format& operator % (char* val) noexcept
+		{
+			str_(val);
+			return *this;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  オペレーター「%」(const std::string&)
+			@param[in]	val	文字列（STR_MAX で切り詰める）
+			@return	自分の参照
+		*/
+		//-----------------------------------------------------------------//
+		dlog_format& operator % (const std::string& val) noexcept
+		{
+			str_(val.c_str());
+			return *this;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  オペレーター「%」（ポインター）
+			@param[in]	ptr	ポインター
+			@return	自分の参照
+		*/
+		//-----------------------------------------------------------------//
+		template <typename T>
+		dlog_format& operator % (T* ptr) noexcept
+		{
+			value_(dlog_base::tag::PTR, static_cast<uint32_t>(reinterpret_cast<uintptr_t>(ptr)));
+			return *this;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  オペレーター「%」（整数、浮動小数点）@n
+					それ以外の型（enum class、構造体など）はコンパイル・エラー
+			@param[in]	val	値（整数は３２ビットとして積む）
+			@return	自分の参照
+		*/
+		//-----------------------------------------------------------------//
+		template <typename T>
+		dlog_format& operator % (T val) noexcept
+		{
+			static_assert(std::is_integral<T>::value || std::is_floating_point<T>::value,
+				"dlog_format: argument must be an integer, floating point, pointer or string "
+				"(cast enum class values to an integer type)");
+			if constexpr (std::is_integral<T>::value) {
+				value_(std::is_signed<T>::value ? dlog_base::tag::INT : dlog_base::tag::UINT,
+					static_cast<uint32_t>(val));
+			} else if constexpr (std::is_floating_point<T>::value) {
+				// -m64bit-doubles が無い場合、double も４バイト
+				if(sizeof(T) == 4 || sizeof(double) == 4) {
+					if(!space_(5)) return *this;
+					float v = val;
+					rec_[pos_++] = static_cast<uint8_t>(dlog_base::tag::FLOAT);
+					std::memcpy(&rec_[pos_], &v, 4);
+					pos_ += 4;
+				} else {
+					if(!space_(9)) return *this;
+					double v = val;
+					rec_[pos_++] = static_cast<uint8_t>(dlog_base::tag::DOUBLE);
+					std::memcpy(&rec_[pos_], &v, sizeof(double));
+					pos_ += 8;
+				}
+			}
+			return *this;
+		}
+	};
+}
@@ -2,41 +2,92 @@
 //=====================================================================//
 /*!	@file
 	@brief	固定サイズ・ブロック管理・クラス @n
-			※最大３２個までのブロックを管理 @n
+			※ブロックの状態は、３２ビット単位のビットマップで管理 @n
+			※空きの検索は、ワード単位（最下位ビットを clz で求める）@n
+			※利用中のブロックだけを辿る next_alloc()、next_active() がある @n
 			※排他制御用ロック・ビットを含んでいる
     @author 平松邦仁 (hira@rvf-rc45.net)
-	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+	@copyright	Copyright (C) 2017, 2020 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/RX/blob/master/LICENSE
 */
 //=====================================================================//
+#include <cstdint>
 
 namespace utils {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
-		@brief  固定サイズ・ブロック管理・クラス
+		@brief  固定サイズ・ブロック管理・クラス @n
+				Ex: 利用中（ロックされていない）ブロックを辿る @n
+					for(auto i = blk.next_active(0); i < SIZE; i = blk.next_active(i + 1)) { }
 		@param[in]	UNIT	格納形
-		@param[in]	SIZE	サイズ（最大３２個）
+		@param[in]	SIZE	サイズ
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	template <class UNIT, uint32_t SIZE>
 	class fixed_block {
 
-		volatile uint32_t	flags_;
-		volatile uint32_t	lock_;
+		static constexpr uint32_t WORDS = (SIZE + 31) / 32;
+
+		volatile uint32_t	flags_[WORDS];
+		volatile uint32_t	lock_[WORDS];
+		volatile uint32_t	count_;
 
 		uint32_t	idx_;
 
 		UNIT		unit_[SIZE];
 
+		// 最下位の１のビット位置
+		static uint32_t lsb_(uint32_t bits) noexcept
+		{
+			return 31 - __builtin_clz(bits & (~bits + 1));
+		}
+
+		static uint32_t bit_(uint32_t idx) noexcept
+		{
+			return static_cast<uint32_t>(1) << (idx & 31);
+		}
+
+		// 最後のワードで、範囲外のビットを除くマスク
+		static uint32_t valid_(uint32_t w) noexcept
+		{
+			if(w == (WORDS - 1) && (SIZE & 31) != 0) return (1u << (SIZE & 31)) - 1;
+			else return 0xffffffff;
+		}
+
+		uint32_t find_free_(uint32_t org) const noexcept
+		{
+			uint32_t m = 0xffffffff << (org & 31);
+			for(uint32_t w = org >> 5; w < WORDS; ++w) {
+				uint32_t bits = ~flags_[w] & m & valid_(w);
+				if(bits != 0) return (w << 5) + lsb_(bits);
+				m = 0xffffffff;
+			}
+			return SIZE;
+		}
+
+		uint32_t find_alloc_(uint32_t org, bool active) const noexcept
+		{
+			if(org >= SIZE) return SIZE;
+			uint32_t m = 0xffffffff << (org & 31);
+			for(uint32_t w = org >> 5; w < WORDS; ++w) {
+				uint32_t bits = flags_[w];
+				if(active) bits &= ~lock_[w];
+				bits &= m;
+				if(bits != 0) return (w << 5) + lsb_(bits);
+				m = 0xffffffff;
+			}
+			return SIZE;
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  コンストラクタ
 		*/
 		//-----------------------------------------------------------------//
-		fixed_block() noexcept : flags_(0), lock_(-1), idx_(0) { }
+		fixed_block() noexcept : count_(0), idx_(0) { clear(); }
 
 
 		//-----------------------------------------------------------------//
@@ -54,7 +105,7 @@ namespace utils {
 			@return 空の場合「true」
 		*/
 		//-----------------------------------------------------------------//
-		bool empty() const noexcept { return flags_ == 0; }
+		bool empty() const noexcept { return count_ == 0; }
 
 
 		//-----------------------------------------------------------------//
@@ -62,7 +113,14 @@ namespace utils {
 			@brief  全体クリア
 		*/
 		//-----------------------------------------------------------------//
-		void clear() { flags_ = 0; lock_ = -1; }
+		void clear() noexcept
+		{
+			for(uint32_t i = 0; i < WORDS; ++i) {
+				flags_[i] = 0;
+				lock_[i] = 0xffffffff;
+			}
+			count_ = 0;
+		}
 
 
 		//-----------------------------------------------------------------//
@@ -71,42 +129,30 @@ namespace utils {
 			@return 利用サイズ
 		*/
 		//-----------------------------------------------------------------//
-		uint32_t size() const noexcept
-		{
-			uint32_t n = 0;
-			uint32_t tmp = 1;
-			for(uint32_t i = 0; i < SIZE; ++i) {
-				if(tmp & flags_) {
-					++n;
-				}
-				tmp <<= 1;
-			}
-			return n;
-		}
+		uint32_t size() const noexcept { return count_; }
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  領域を確保して、インデックスを返す
+			@brief  領域を確保して、インデックスを返す @n
+					前回確保した位置の次から探す（直前に解放した番号をすぐには使わない）
 			@return 空きが無い場合、「SIZE」となる。
 		*/
 		//-----------------------------------------------------------------//
 		uint32_t alloc() noexcept
 		{
-			uint32_t idx = idx_;
-			for(uint32_t i = 0; i < SIZE; ++i) {
-				uint32_t mask = 1 << idx;
-				if(!(mask & flags_)) {
-					lock_  |= mask;  // ロックした状態にする
-					flags_ |= mask;
-					++idx_;
-					if(idx_ >= SIZE) idx_ = 0;
-					return idx;
-				}
-				++idx;
-				if(idx >= SIZE) idx = 0;
-			}
-			return SIZE;
+			uint32_t idx = find_free_(idx_);
+			if(idx >= SIZE) idx = find_free_(0);
+			if(idx >= SIZE) return SIZE;
+
+			uint32_t w = idx >> 5;
+			uint32_t mask = bit_(idx);
+			lock_[w]  |= mask;  // ロックした状態にする
+			flags_[w] |= mask;
+			count_ = count_ + 1;
+			idx_ = idx + 1;
+			if(idx_ >= SIZE) idx_ = 0;
+			return idx;
 		}
 
 
@@ -122,7 +168,7 @@ namespace utils {
 			if(idx >= SIZE) {
 				return false;
 			}
-			return (flags_ & (1 << idx)) != 0;
+			return (flags_[idx >> 5] & bit_(idx)) != 0;
 		}
 
 
@@ -138,8 +184,8 @@ namespace utils {
 			if(idx >= SIZE) {
 				return false;
 			}
-			if(!is_alloc(idx)) return false; 
-			return (lock_ & (1 << idx)) != 0;
+			if(!is_alloc(idx)) return false;
+			return (lock_[idx >> 5] & bit_(idx)) != 0;
 		}
 
 
@@ -155,11 +201,12 @@ namespace utils {
 			if(idx >= SIZE) {
 				return false;
 			}
-			if(!is_alloc(idx)) return false; 
+			if(!is_alloc(idx)) return false;
+			uint32_t w = idx >> 5;
 			if(lock) {
-				lock_ |=  (1 << idx);
+				lock_[w] |=  bit_(idx);
 			} else {
-				lock_ &= ~(1 << idx);
+				lock_[w] &= ~bit_(idx);
 			}
 			return true;
 		}
@@ -188,15 +235,37 @@ namespace utils {
 			if(idx >= SIZE) {
 				return false;
 			}
-			uint32_t f = 1 << idx;
-			if(flags_ & f) {
-				flags_ &= ~f;
+			uint32_t w = idx >> 5;
+			uint32_t f = bit_(idx);
+			if(flags_[w] & f) {
+				flags_[w] &= ~f;
+				count_ = count_ - 1;
 				return true;
 			}
 			return false;
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  利用中のブロックを探す
+			@param[in]	org	探し始める位置
+			@return org 以降の利用中の位置（無い場合「SIZE」）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t next_alloc(uint32_t org) const noexcept { return find_alloc_(org, false); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  利用中で、ロックされていないブロックを探す
+			@param[in]	org	探し始める位置
+			@return org 以降の位置（無い場合「SIZE」）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t next_active(uint32_t org) const noexcept { return find_alloc_(org, true); }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  ユニットの参照
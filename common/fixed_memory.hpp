@@ -1,34 +1,220 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	固定サイズ・メモリー・クラス
+	@brief	固定サイズ・メモリー・クラス @n
+			・fixed_pool   : 固定サイズ・ブロックのプール（O(1) の確保、解放）@n
+			・fixed_memory : サイズ・クラス別のスラブ（O(1) の確保、解放）@n
+			・fixed_arena  : 積み上げ式（mark/reset でまとめて解放、フレーム毎の作業領域など）@n
+			※ヒープを使わないので、断片化しない、例外、RTTI も使わない @n
+			※排他制御は行わないので、複数のコンテキストから使う場合は、呼ぶ側でロックする
     @author 平松邦仁 (hira@rvf-rc45.net)
-	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+	@copyright	Copyright (C) 2017, 2020 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/RX/blob/master/LICENSE
 */
 //=====================================================================//
+#include <cstdint>
 
 namespace utils {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
-		@brief  固定サイズ・メモリー・クラス
+		@brief  固定サイズ・ブロック・プール・クラス @n
+				空きブロックを、ブロック自身に繋いだリストで管理する
+		@param[in]	BSIZE	ブロックのサイズ（バイト）
+		@param[in]	NUM		ブロック数
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t BSIZE, uint32_t NUM>
+	class fixed_pool {
+
+		static constexpr uint32_t ALIGN = 8;
+		static constexpr uint32_t UNIT = ((BSIZE < sizeof(void*) ? sizeof(void*) : BSIZE) + ALIGN - 1) & ~(ALIGN - 1);
+
+		alignas(ALIGN) uint8_t	buff_[UNIT * NUM];
+
+		void*		free_;
+		uint32_t	carve_;		// まだリストに入れていない先頭
+		uint32_t	used_;
+		uint32_t	peak_;
+		uint32_t	fail_;
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクタ
+		*/
+		//-----------------------------------------------------------------//
+		fixed_pool() noexcept : free_(nullptr), carve_(0), used_(0), peak_(0), fail_(0) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ブロックのサイズを返す
+			@return ブロックのサイズ
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t block_size() const noexcept { return BSIZE; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ブロック数を返す
+			@return ブロック数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t capacity() const noexcept { return NUM; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ブロックを確保
+			@return ブロックのポインター（空きが無い場合「nullptr」）
+		*/
+		//-----------------------------------------------------------------//
+		void* alloc() noexcept
+		{
+			void* p = free_;
+			if(p != nullptr) {
+				free_ = *static_cast<void**>(p);
+			} else if(carve_ < NUM) {
+				p = &buff_[UNIT * carve_];
+				++carve_;
+			} else {
+				++fail_;
+				return nullptr;
+			}
+			++used_;
+			if(used_ > peak_) peak_ = used_;
+			return p;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ブロックを解放
+			@param[in]	ptr	alloc で得たポインター
+			@return 範囲外のポインターの場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool free(void* ptr) noexcept
+		{
+			if(!owns(ptr)) return false;
+			*static_cast<void**>(ptr) = free_;
+			free_ = ptr;
+			--used_;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  プールのポインターか検査
+			@param[in]	ptr	ポインター
+			@return プールのポインターなら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool owns(const void* ptr) const noexcept
+		{
+			auto p = static_cast<const uint8_t*>(ptr);
+			return p >= buff_ && p < &buff_[UNIT * NUM];
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  全て解放（統計は、ピークを残す）
+		*/
+		//-----------------------------------------------------------------//
+		void clear() noexcept
+		{
+			free_ = nullptr;
+			carve_ = 0;
+			used_ = 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  使用中のブロック数
+			@return 使用中のブロック数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t used() const noexcept { return used_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  使用中のブロック数の最大値
+			@return 最大値
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t peak() const noexcept { return peak_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  確保に失敗した回数
+			@return 回数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_fail() const noexcept { return fail_; }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  固定サイズ・メモリー・クラス @n
+				SIZE を DNUM 個のページに分け、ページを必要になったサイズ・クラス @n
+				（8, 16, 32 ... ページ・サイズ）に割り当てて、ブロックに切り出す。@n
+				解放したブロックは、クラス毎の空きリストに戻る（ページはクラスに @n
+				残るので、同じサイズの確保、解放を繰り返しても断片化しない）。@n
+				ページ・サイズより大きい確保は失敗する。
 		@param[in]	SIZE	格納サイズ（バイト）
-		@param[in]	DNUM	分割最大数
+		@param[in]	DNUM	分割最大数（ページ数、SIZE / DNUM は２のべき乗）
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	template <uint32_t SIZE, uint32_t DNUM>
 	class fixed_memory {
+	public:
+		static constexpr uint32_t PAGE = SIZE / DNUM;	///< ページ・サイズ
+		static constexpr uint32_t MIN_BLOCK = 8;		///< 最小ブロック・サイズ
+
+	private:
+		static_assert(DNUM > 0 && (SIZE % DNUM) == 0, "SIZE must be a multiple of DNUM");
+		static_assert(PAGE >= MIN_BLOCK && (PAGE & (PAGE - 1)) == 0, "SIZE / DNUM must be a power of two");
 
-		uint8_t	buff_[SIZE];
+		static constexpr uint32_t class_num_(uint32_t n) {
+			return n <= MIN_BLOCK ? 1 : class_num_(n / 2) + 1;
+		}
+		static constexpr uint32_t CNUM = class_num_(PAGE);
 
-		struct head {
-			uint16_t	pos_;
-			uint16_t	size_;
+		struct class_t {
+			void*		free_;
+			uint8_t*	carve_;		// 切り出し中のページの次の位置
+			uint32_t	rest_;		// 切り出し中のページの残りブロック数
+			uint32_t	used_;
 		};
 
-		head	head_[DNUM];
+		alignas(8) uint8_t	buff_[SIZE];
+
+		class_t		class_[CNUM];
+		uint8_t		page_class_[DNUM];
+		uint32_t	page_;		// 割り当て済みページ数
+		uint32_t	used_;		// 使用中のバイト数（ブロック単位）
+		uint32_t	peak_;
+		uint32_t	fail_;
+
+		static uint32_t size_class_(uint32_t size) noexcept
+		{
+			uint32_t c = 0;
+			uint32_t n = MIN_BLOCK;
+			while(n < size) {
+				n <<= 1;
+				++c;
+			}
+			return c;
+		}
 
 	public:
 		//-----------------------------------------------------------------//
@@ -36,7 +222,7 @@ namespace utils {
 			@brief  コンストラクタ
 		*/
 		//-----------------------------------------------------------------//
-		fixed_memory() noexcept { }
+		fixed_memory() noexcept : page_(0), used_(0), peak_(0), fail_(0) { clear(); }
 
 
 		//-----------------------------------------------------------------//
@@ -52,26 +238,247 @@ namespace utils {
 		/*!
 			@brief  メモリー・アロケーション
 			@param[in]	size	アロケーション・サイズ
-			@return メモリー・ポインター
+			@return メモリー・ポインター（確保出来ない場合「nullptr」）
+		*/
+		//-----------------------------------------------------------------//
+		void* alloc(uint32_t size) noexcept
+		{
+			if(size == 0 || size > PAGE) {
+				++fail_;
+				return nullptr;
+			}
+			auto c = size_class_(size);
+			auto& t = class_[c];
+			uint32_t bsize = MIN_BLOCK << c;
+			void* p = t.free_;
+			if(p != nullptr) {
+				t.free_ = *static_cast<void**>(p);
+			} else {
+				if(t.rest_ == 0) {
+					if(page_ >= DNUM) {
+						++fail_;
+						return nullptr;
+					}
+					page_class_[page_] = c;
+					t.carve_ = &buff_[PAGE * page_];
+					t.rest_ = PAGE / bsize;
+					++page_;
+				}
+				p = t.carve_;
+				t.carve_ += bsize;
+				--t.rest_;
+			}
+			++t.used_;
+			used_ += bsize;
+			if(used_ > peak_) peak_ = used_;
+			return p;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  メモリーの解放
+			@param[in]	ptr	alloc で得たポインター（nullptr は何もしない）
+			@return 範囲外のポインターの場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool free(void* ptr) noexcept
+		{
+			if(ptr == nullptr) return true;
+			if(!owns(ptr)) return false;
+			uint32_t pg = (static_cast<uint8_t*>(ptr) - buff_) / PAGE;
+			if(pg >= page_) return false;
+			auto c = page_class_[pg];
+			auto& t = class_[c];
+			*static_cast<void**>(ptr) = t.free_;
+			t.free_ = ptr;
+			--t.used_;
+			used_ -= MIN_BLOCK << c;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  領域のポインターか検査
+			@param[in]	ptr	ポインター
+			@return 領域のポインターなら「true」
 		*/
 		//-----------------------------------------------------------------//
-		void* alloc(uint16_t size)
+		bool owns(const void* ptr) const noexcept
 		{
-			uint8_t* ptr = nullptr;
+			auto p = static_cast<const uint8_t*>(ptr);
+			return p >= buff_ && p < &buff_[SIZE];
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  全て解放（統計は、ピークを残す）
+		*/
+		//-----------------------------------------------------------------//
+		void clear() noexcept
+		{
+			for(uint32_t i = 0; i < CNUM; ++i) {
+				class_[i].free_ = nullptr;
+				class_[i].carve_ = nullptr;
+				class_[i].rest_ = 0;
+				class_[i].used_ = 0;
+			}
+			page_ = 0;
+			used_ = 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  使用中のバイト数（ブロック単位に切り上げた値）
+			@return バイト数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t used() const noexcept { return used_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  使用中のバイト数の最大値
+			@return バイト数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t peak() const noexcept { return peak_; }
+
 
-			return ptr;
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  割り当て済みのページ数
+			@return ページ数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_page() const noexcept { return page_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  サイズ・クラス毎の使用中ブロック数
+			@param[in]	size	サイズ
+			@return ブロック数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_used(uint32_t size) const noexcept
+		{
+			if(size == 0 || size > PAGE) return 0;
+			return class_[size_class_(size)].used_;
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  確保に失敗した回数
+			@return 回数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_fail() const noexcept { return fail_; }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  積み上げ式メモリー・クラス @n
+				確保は先頭から積むだけで、個別の解放は無い。@n
+				mark() で得た位置に reset() すると、それ以降をまとめて解放する。
+		@param[in]	SIZE	格納サイズ（バイト）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t SIZE>
+	class fixed_arena {
+
+		alignas(8) uint8_t	buff_[SIZE];
+
+		uint32_t	pos_;
+		uint32_t	peak_;
+		uint32_t	fail_;
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクタ
+		*/
+		//-----------------------------------------------------------------//
+		fixed_arena() noexcept : pos_(0), peak_(0), fail_(0) { }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  最大サイズを返す
 			@return 最大サイズ
 		*/
 		//-----------------------------------------------------------------//
-		void free(void* ptr)
-		{
+		uint32_t capacity() const noexcept { return SIZE; }
+
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  メモリー・アロケーション
+			@param[in]	size	アロケーション・サイズ
+			@param[in]	align	アライメント（２のべき乗、最大８）
+			@return メモリー・ポインター（確保出来ない場合「nullptr」）
+		*/
+		//-----------------------------------------------------------------//
+		void* alloc(uint32_t size, uint32_t align = 4) noexcept
+		{
+			uint32_t p = (pos_ + align - 1) & ~(align - 1);
+			if(p > SIZE || size > (SIZE - p)) {
+				++fail_;
+				return nullptr;
+			}
+			pos_ = p + size;
+			if(pos_ > peak_) peak_ = pos_;
+			return &buff_[p];
 		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  現在の位置を得る
+			@return 位置
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t mark() const noexcept { return pos_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  位置を戻す（それ以降に確保した領域は全て解放される）
+			@param[in]	pos	mark() で得た位置（省略すると全て）
+		*/
+		//-----------------------------------------------------------------//
+		void reset(uint32_t pos = 0) noexcept { if(pos < pos_) pos_ = pos; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  使用中のバイト数
+			@return バイト数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t used() const noexcept { return pos_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  使用中のバイト数の最大値
+			@return バイト数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t peak() const noexcept { return peak_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  確保に失敗した回数
+			@return 回数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_fail() const noexcept { return fail_; }
 	};
 }
@@ -118,7 +118,7 @@ namespace utils {
 		const UNIT& pop() noexcept
 		{
 			if(pos_ == 0) {
-				static const UNIT u;
+				static const UNIT u { };
 				return u;
 			}
 			--pos_;
@@ -35,7 +35,7 @@ namespace utils {
 		//-----------------------------------------------------------------//
 		fixed_string(const char* str = nullptr) noexcept : pos_(0) {
 			if(str != nullptr) {
-				utils::str::strncpy_(str_, str, SIZE);
+				utils::str::strncpy_(str_, str, SIZE + 1);
 				pos_ = std::strlen(str_);
 			}
 			str_[pos_] = 0;
@@ -186,7 +186,7 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		fixed_string& operator = (const char* src) noexcept {
-			utils::str::strncpy_(str_, src, SIZE);
+			utils::str::strncpy_(str_, src, SIZE + 1);
 			pos_ = std::strlen(str_);
 			return *this;
 		}
@@ -200,7 +200,7 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		fixed_string& operator = (const fixed_string& src) noexcept {
-			utils::str::strncpy_(str_, src.c_str(), SIZE);
+			utils::str::strncpy_(str_, src.c_str(), SIZE + 1);
 			pos_ = src.pos_;
 			return *this;
 		}
@@ -241,7 +241,7 @@ namespace utils {
 				pos_ += l;
 			} else {  // バッファが許す範囲でコピー
 				l = SIZE - pos_;
-				utils::str::strncpy_(&str_[pos_], str, l);
+				utils::str::strncpy_(&str_[pos_], str, l + 1);
 				pos_ = SIZE;
 			}
 			str_[pos_] = 0; 
@@ -33,6 +33,11 @@
 			! 2020/11/20 07:44- sformat 時の nega_ フラグの初期化漏れ
 			! 2020/11/20 07:44- nega_ 符号表示の順番、不具合
 			! 2020/11/20 16:59- uint 型を削除
+			+ 2020/12/01 10:12- 出力ファンクタに、まとめて出力する write() を追加（static_format.hpp 用） @n
+			+ 2020/12/03 09:20- インスタンス毎の出力ファンクタを指定するコンストラクター、@n
+			                    行単位でまとめて出力する line_chaout を追加
+			+ 2020/12/05 18:30- float、double を正確に変換（real_conv.hpp）、%e、%g の指数は２桁以上、@n
+			                    精度を省略した場合は printf と同じ６桁
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2013, 2020 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -44,6 +49,9 @@
 #include <cstdint>
 #include <cstring>
 #include <string>
+#ifndef NO_FLOAT_FORM
+#include "common/real_conv.hpp"
+#endif
 
 // 最終的な出力として putchar を使う場合有効にする（通常は write [stdout] 関数）
 // #define USE_PUTCHAR
@@ -102,6 +110,8 @@ namespace utils {
 
 		void operator() (char ch) noexcept { }
 
+		void write(const char* src, uint32_t len) noexcept { }
+
 		void clear() noexcept { };
 
 		uint size() const noexcept { return 0; }
@@ -133,6 +143,10 @@ namespace utils {
 			++size_;
 		}
 
+		void write(const char* src, uint32_t len) noexcept {
+			size_ += len;
+		}
+
 		void clear() noexcept { size_ = 0; };
 
 		uint size() const noexcept { return size_; }
@@ -165,11 +179,23 @@ namespace utils {
 			putchar(ch);
 #else
 			char tmp = ch;
-			write(STDOUT_FILENO, &tmp, 1);
+			::write(STDOUT_FILENO, &tmp, 1);
 #endif
 			++size_;
 		}
 
+		void write(const char* src, uint32_t len) noexcept
+		{
+#ifdef USE_PUTCHAR
+			for(uint32_t i = 0; i < len; ++i) {
+				putchar(src[i]);
+			}
+#else
+			::write(STDOUT_FILENO, src, len);
+#endif
+			size_ += len;
+		}
+
 		void clear() noexcept { size_ = 0; };
 
 		uint size() const noexcept { return size_; }
@@ -209,6 +235,21 @@ namespace utils {
 			++size_;
 		}
 
+		void write(const char* src, uint32_t len) noexcept {
+			size_ += len;
+			while(len > 0) {
+				uint32_t l = BFN - pos_;
+				if(l > len) l = len;
+				std::memcpy(&buff_[pos_], src, l);
+				pos_ += l;
+				if(pos_ >= BFN || std::memchr(src, '\n', l) != nullptr) {
+					flush();
+				}
+				src += l;
+				len -= l;
+			}
+		}
+
 		void clear() noexcept { size_ = 0; };
 
 		auto size() const noexcept { return size_; }
@@ -224,7 +265,7 @@ namespace utils {
 				putchar(buff_[i]);
 			}
 #else
-			write(STDOUT_FILENO, buff_, pos_);
+			::write(STDOUT_FILENO, buff_, pos_);
 #endif
 			pos_ = 0;
 		}
@@ -312,6 +353,74 @@ namespace utils {
 	};
 
 
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  行単位出力ファンクタ @n
+				改行までをバッファに溜めて、１行をまとめてターミネーターに渡す。@n
+				タスク毎にインスタンスを持てば、書式変換は排他無しで行え、@n
+				行の出力（TERM）だけを排他すれば、行が混ざらない。
+		@param[in]	BFN		バッファサイズ（１行の最大長）
+		@param[in]	TERM	ターミネーター・ファンクタ
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t BFN, class TERM = stdout_term>
+	class line_chaout {
+
+		char		buff_[BFN];
+		uint32_t	pos_;
+		uint32_t	size_;
+		TERM		term_;
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		line_chaout() noexcept : pos_(0), size_(0), term_() { }
+
+		~line_chaout() { flush(); }
+
+		void operator() (char ch) noexcept {
+			buff_[pos_] = ch;
+			++pos_;
+			if(ch == '\n' || pos_ >= BFN) {
+				flush();
+			}
+			++size_;
+		}
+
+		void write(const char* src, uint32_t len) noexcept {
+			size_ += len;
+			while(len > 0) {
+				uint32_t l = BFN - pos_;
+				if(l > len) l = len;
+				auto p = static_cast<const char*>(std::memchr(src, '\n', l));
+				if(p != nullptr) l = p - src + 1;
+				std::memcpy(&buff_[pos_], src, l);
+				pos_ += l;
+				if(p != nullptr || pos_ >= BFN) {
+					flush();
+				}
+				src += l;
+				len -= l;
+			}
+		}
+
+		void clear() noexcept { size_ = 0; };
+
+		uint32_t size() const noexcept { return size_; }
+
+		void flush() noexcept {
+			if(pos_ == 0) return;
+			term_(buff_, pos_);
+			pos_ = 0;
+		}
+
+		TERM& at_term() noexcept { return term_; }
+	};
+
+
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
 		@brief  メモリー文字列クラス
@@ -332,6 +441,18 @@ namespace utils {
 		memory_chaout() noexcept : dst_(nullptr), limit_(0), pos_(0) { }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター（出力先を設定）
+			@param[in]	dst		文字バッファ
+			@param[in]	limit	文字バッファサイズ
+		*/
+		//-----------------------------------------------------------------//
+		memory_chaout(char* dst, uint32_t limit) noexcept : dst_(nullptr), limit_(0), pos_(0) {
+			set(dst, limit);
+		}
+
+
 		bool set(char* dst, uint32_t limit) noexcept
 		{
 			if(dst == nullptr || limit <= 1) {
@@ -359,6 +480,15 @@ namespace utils {
 		}
 
 
+		void write(const char* src, uint32_t len) noexcept {
+			if(pos_ >= limit_) return;
+			if(len > (limit_ - pos_)) len = limit_ - pos_;
+			std::memcpy(&dst_[pos_], src, len);
+			pos_ += len;
+			dst_[pos_] = 0;
+		}
+
+
 		void clear() noexcept { pos_ = 0; }
 
 
@@ -373,7 +503,7 @@ namespace utils {
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	class base_format {
 	public:
-		static constexpr uint16_t VERSION = 93;		///< バージョン番号（整数）
+		static constexpr uint16_t VERSION = 94;		///< バージョン番号（整数）
 
 		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 		/*!
@@ -422,6 +552,7 @@ namespace utils {
 
 		static CHAOUT	chaout_;
 
+		CHAOUT&		out_;
 		const char*	form_;
 
 		char		buff_[34];
@@ -429,6 +560,7 @@ namespace utils {
 		uint16_t	num_;
 
 		uint8_t		point_;
+		bool		prec_;
 		uint8_t		bitlen_;
 		error		error_;
 		mode		mode_;
@@ -438,12 +570,13 @@ namespace utils {
 
 		void str_(const char* str) {
 			char ch;
-			while((ch = *str++) != 0) chaout_(ch);
+			while((ch = *str++) != 0) out_(ch);
 		}
 
 		void reset_() {
 			num_ = 0;
 			point_ = 0;
+			prec_ = false;
 			bitlen_ = 0;
 			mode_ = mode::NONE;
 			zerosupp_ = false;
@@ -488,6 +621,7 @@ namespace utils {
 						}
 					} else if(ch == '.') {
 						md = apmd::point;
+						prec_ = true;
 					} else if(ch == ':') {
 						md = apmd::bitlen;
 					} else if(ch == 's') {
@@ -540,7 +674,7 @@ namespace utils {
 						mode_ = mode::POINTER;
 						return;
 					} else if(ch == '%') {
-						chaout_(ch);
+						out_(ch);
 						md = apmd::none;
 					} else {
 						error_ = error::unknown;
@@ -549,7 +683,7 @@ namespace utils {
 				} else if(ch == '%') {
 					md = apmd::num;
 				} else {
-					chaout_(ch);
+					out_(ch);
 				}
 			}
 		}
@@ -558,7 +692,7 @@ namespace utils {
 		void out_str_(const char* str, char sign, uint16_t n)
 		{
 			if(nega_) {
-				if(sign != 0) { chaout_(sign); }
+				if(sign != 0) { out_(sign); }
 				str_(str);
 			}
 
@@ -567,21 +701,21 @@ namespace utils {
 			if(n > 0 && n < num) {
 				auto spc = num - n;
 				if(zerosupp_) {
-					if(sign != 0) { chaout_(sign); }
+					if(sign != 0) { out_(sign); }
 					while(spc) {
 						--spc;
-						chaout_('0');
+						out_('0');
 					}
 				} else {
 					auto spc = num - n;
 					while(spc) {
 						--spc;
-						chaout_(' ');
+						out_(' ');
 					}
-					if(!nega_ && sign != 0) { chaout_(sign); }
+					if(!nega_ && sign != 0) { out_(sign); }
 				}
 			} else {
-				if(!nega_ && sign != 0) { chaout_(sign); }
+				if(!nega_ && sign != 0) { out_(sign); }
 			}
 
 			if(!nega_) { str_(str); }
@@ -767,59 +901,154 @@ namespace utils {
 
 
 #ifndef NO_FLOAT_FORM
-		void out_real_(float v, char e)
+		void fill_(char ch, uint32_t n) {
+			while(n > 0) {
+				out_(ch);
+				--n;
+			}
+		}
+
+
+		// printf と同じ変換（e: 0 = %f、'e'/'E'、'g'/'G'）
+		template <typename T>
+		void out_real_(T v, char e)
 		{
-			void* p = &v;
-			uint32_t fpv = *(uint32_t*)p;
-			bool sign = fpv >> 31;
-			int16_t exp = (fpv >> 23) & 0xff;
-			if(exp == 0xff) {
-				if(sign) chaout_('-');
-				str_("inf");
+			real_conv<T> conv(v);
+			char sch = 0;
+			if(conv.sign()) sch = '-';
+			else if(sign_) sch = '+';
+			bool caps = e == 'E' || e == 'G';
+			if(conv.is_inf() || conv.is_nan()) {
+				zerosupp_ = false;
+				if(conv.is_inf()) out_str_(caps ? "INF" : "inf", sch, 3);
+				else out_str_(caps ? "NAN" : "nan", sch, 3);
 				return;
 			}
 
-			exp -= 127;	// bias (-127)
-			int32_t val = fpv & 0x7fffff;	// 23 bits
-			int16_t shift = 23;
-			if(val == 0 && exp == -127) ; // [0.0]
-			else {
-				val |= 0x800000; // add offset 1.0
+			bool gmode = e == 'g' || e == 'G';
+			int32_t prec = prec_ ? point_ : 6;
+			if(gmode && prec == 0) prec = 1;
+
+			// 有効桁の取り出し（0.d1d2... x 10^k）、CAP 桁までは保存して再利用する
+			static constexpr int32_t CAP = 40;
+			uint8_t dig[CAP];
+			int32_t k = 1;
+			bool zero = conv.is_zero();
+			if(!zero) k = conv.start();
+			int32_t n;
+			if(e == 0) n = k + prec;
+			else if(gmode) n = prec;
+			else n = prec + 1;
+
+			int32_t last9 = -1;
+			int32_t lastnz = -1;
+			bool up = false;
+			if(!zero && n >= 0) {
+				uint8_t d = 0;
+				for(int32_t i = 0; i < n; ++i) {
+					d = conv.digit();
+					if(i < CAP) dig[i] = d;
+					if(d != 9) last9 = i;
+					if(d != 0) lastnz = i;
+				}
+				up = conv.round_up(d);
 			}
-			shift -= exp;
-
-			// 64 ビットに拡張
-			uint64_t v64 = static_cast<uint64_t>(val);
-			if(shift < 28) {
-				shift += 32;
-				v64 <<= 32;
+			bool carry = up && last9 < 0;  // 全て 9 の切り上げ
+			if(carry) {
+				++k;
+				if(e == 0) ++n;
+				lastnz = 0;
+			} else if(up) {
+				lastnz = last9;
 			}
 
-			// エキスポーネント表記の場合
-			int8_t dexp = 0;
-			if(e != 0) {
-				if(v64 > (static_cast<uint64_t>(2) << shift)) {  // 2.0 以上の場合
-					while(v64 > (static_cast<uint64_t>(2) << shift)) {
-						v64 /= 10;
-						++dexp;
-					}
-				} else if(v64 < (static_cast<uint64_t>(1) << shift)) {  // 1.0 以下
-					while(v64 < (static_cast<uint64_t>(1) << shift)) {
-						v64 *= 10;
-						--dexp;
+			// CAP を超える場合は、最初から取り出し直す
+			bool regen = !zero && n > CAP;
+			if(regen) conv.start();
+			int32_t pos = 0;
+			uint8_t cur = 0;
+			auto get = [&](int32_t i) -> char {
+				if(zero || i < 0 || i >= n) return '0';
+				if(carry) return i == 0 ? '1' : '0';
+				if(up && i > last9) return '0';
+				uint8_t d;
+				if(regen) {
+					while(pos <= i) {
+						cur = conv.digit();
+						++pos;
 					}
+					d = cur;
+				} else {
+					d = dig[i];
+				}
+				if(up && i == last9) ++d;
+				return '0' + d;
+			};
+
+			bool expo = e == 'e' || e == 'E';
+			int32_t fr = prec;
+			if(gmode) {
+				int32_t x = k - 1;
+				if(x >= -4 && x < prec) {
+					fr = prec - 1 - x;
+				} else {
+					expo = true;
+					fr = prec - 1;
 				}
+				// 末尾の 0 を取り除く
+				int32_t need = expo ? lastnz : lastnz + 1 - k;
+				if(need < 0) need = 0;
+				if(fr > need) fr = need;
 			}
 
-			out_fixed_point_<uint64_t>(v64, shift, sign);
+			int32_t x = k - 1;
+			uint32_t ax = x < 0 ? -x : x;
+			uint32_t len;
+			if(expo) {
+				len = 1 + (fr > 0 ? fr + 1 : 0) + 2 + (ax >= 100 ? 3 : 2);
+			} else {
+				len = (k > 0 ? k : 1) + (fr > 0 ? fr + 1 : 0);
+			}
+			uint32_t num = num_;
+			if(sch != 0 && num > 0) --num;
+			uint32_t pad = len < num ? num - len : 0;
+			if(nega_) {
+				if(sch != 0) out_(sch);
+			} else if(zerosupp_) {
+				if(sch != 0) out_(sch);
+				fill_('0', pad);
+			} else {
+				fill_(' ', pad);
+				if(sch != 0) out_(sch);
+			}
 
-			if(e) {
-				chaout_(e);
-				zerosupp_ = true;
-				sign_ = true;
-				num_ = 3;
-				out_dec_(dexp);
+			if(expo) {
+				out_(get(0));
+				if(fr > 0) {
+					out_('.');
+					for(int32_t i = 1; i <= fr; ++i) out_(get(i));
+				}
+				out_(caps ? 'E' : 'e');
+				out_(x < 0 ? '-' : '+');
+				if(ax >= 100) {
+					out_('0' + ax / 100);
+					ax %= 100;
+				}
+				out_('0' + ax / 10);
+				out_('0' + ax % 10);
+			} else {
+				if(k > 0) {
+					for(int32_t i = 0; i < k; ++i) out_(get(i));
+				} else {
+					out_('0');
+				}
+				if(fr > 0) {
+					out_('.');
+					for(int32_t i = 0; i < fr; ++i) out_(get(k + i));
+				}
 			}
+
+			if(nega_) fill_(' ', pad);
 		}
 #endif
 
@@ -861,9 +1090,9 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		basic_format(const char* form) noexcept :
-			form_(form),
+			out_(chaout_), form_(form),
 			num_(0),
-			point_(0),
+			point_(0), prec_(false),
 			bitlen_(0),
 			error_(error::none),
 			mode_(mode::NONE), zerosupp_(false), sign_(false), nega_(false)
@@ -882,8 +1111,8 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		basic_format(const char* form, char* buff, uint32_t size, bool append = false) noexcept :
-			form_(form),
-			num_(0), point_(0),
+			out_(chaout_), form_(form),
+			num_(0), point_(0), prec_(false),
 			bitlen_(0),
 			error_(error::none),
 			mode_(mode::NONE), zerosupp_(false), sign_(false), nega_(false)
@@ -901,13 +1130,42 @@ namespace utils {
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  出力ファンクタの参照
+			@brief  コンストラクター（インスタンス毎の出力ファンクタ） @n
+					static な出力ファンクタを使わないので、複数のタスクから @n
+					同時に使える（出力ファンクタはタスク毎に用意する）
+			@param[in]	out		出力ファンクタ
+			@param[in]	form	フォーマット式
+		*/
+		//-----------------------------------------------------------------//
+		basic_format(CHAOUT& out, const char* form) noexcept :
+			out_(out), form_(form),
+			num_(0), point_(0), prec_(false),
+			bitlen_(0),
+			error_(error::none),
+			mode_(mode::NONE), zerosupp_(false), sign_(false), nega_(false)
+		{
+			next_();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  出力ファンクタ（static）の参照
 			@return 出力ファンクタ
 		*/
 		//-----------------------------------------------------------------//
 		static CHAOUT& chaout() { return chaout_; }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  このインスタンスの出力ファンクタの参照
+			@return 出力ファンクタ
+		*/
+		//-----------------------------------------------------------------//
+		CHAOUT& at_chaout() noexcept { return out_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  エラー種別を返す
@@ -932,7 +1190,7 @@ namespace utils {
 			@return 出力サイズ
 		*/
 		//-----------------------------------------------------------------//
-		int size() const noexcept { return chaout_.size(); }
+		int size() const noexcept { return out_.size(); }
 
 
 		//-----------------------------------------------------------------//
@@ -1089,7 +1347,7 @@ namespace utils {
 				if(mode_ == mode::CHA) {
 					auto chn = static_cast<int32_t>(val);
 					if(chn > -128 && chn < 128) {
-						chaout_(chn);
+						out_(chn);
 					} else {  // over range
 						error_ = error::over;
 					}
@@ -1098,23 +1356,24 @@ namespace utils {
 				}
 #ifndef NO_FLOAT_FORM
 			} else if(std::is_floating_point<T>::value) {
-				if(num_ == 0 && !zerosupp_ && point_ == 0) {
-					num_ = 6;
-					point_ = 6;
-				}
+				// long double は double として変換
+				typedef typename std::conditional<(sizeof(T) <= 4), float, double>::type R;
+				auto v = static_cast<R>(val);
 				switch(mode_) {
 				case mode::REAL:
-					out_real_(val, 0);
+					out_real_(v, 0);
 					break;
 				case mode::EXPONENT_CAPS:
-					out_real_(val, 'E');
+					out_real_(v, 'E');
 					break;
 				case mode::EXPONENT:
-					out_real_(val, 'e');
+					out_real_(v, 'e');
 					break;
 				case mode::REAL_AUTO_CAPS:
+					out_real_(v, 'G');
+					break;
 				case mode::REAL_AUTO:
-					out_real_(val, 0);
+					out_real_(v, 'g');
 					break;
 				default:
 					error_ = error::different;
@@ -100,6 +100,33 @@ struct intmath {
 	}
 
 
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	６４ビットレンジの平方根を求める
+		@param[int]	in	整数値
+		@return	答え
+	 */
+	//-----------------------------------------------------------------//
+	static sqrt_t<uint64_t> sqrt64(uint64_t in)
+	{
+		uint64_t a = in;
+		uint64_t r = 0;
+		uint64_t b = static_cast<uint64_t>(1) << 62;
+		while(b > a) b >>= 2;
+		while(b != 0) {
+			if(a >= r + b) {
+				a -= r + b;
+				r = (r >> 1) + b;
+			} else {
+				r >>= 1;
+			}
+			b >>= 2;
+		}
+		sqrt_t<uint64_t> ans(r, a);
+		return ans;
+	}
+
+
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
 		@brief	Ｍ系列乱数クラス
@@ -288,7 +315,7 @@ static short randTapTables[] = {
 		 */
 		//-----------------------------------------------------------------//
 		int16_t operator [] (uint16_t idx) const {
-			if(sizeof(tbl_) <= idx) return 0;
+			if((TN + 1) <= idx) return 0;
 			return tbl_[idx];
 		}
 	};
@@ -0,0 +1,496 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	浮動小数点、１０進変換クラス @n
+			・float、double の値を、正確な１０進の桁列に変換する @n
+			・指定桁数の変換（丸めは、printf と同じ最近接偶数） @n
+			・最短桁数の変換（読み戻すと同じ値になる最短の桁列） @n
+			・多倍長整数（スタック上の固定長配列）で計算するので、@n
+			　１０の累乗の為の表は、5^0 から 5^13 までの１４ワードのみ @n
+			・値が 2^-60 単位の 64 ビット固定小数点で表せる場合は、@n
+			　多倍長を使わずに、64 ビット演算だけで桁を取り出す @n
+			・double が４バイトの場合（RX の標準）は、float と同じ扱い
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  固定長、多倍長整数（符号無し）
+		@param[in]	N	ワード数（３２ビット）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t N>
+	class big_uint {
+
+		uint32_t	w_[N];
+		uint32_t	n_;
+
+		void trim_() {
+			while(n_ > 0 && w_[n_ - 1] == 0) --n_;
+		}
+
+	public:
+		big_uint() noexcept : n_(0) { }
+
+		void set(uint64_t v) noexcept {
+			w_[0] = v;
+			w_[1] = v >> 32;
+			n_ = 2;
+			trim_();
+		}
+
+		uint32_t size() const noexcept { return n_; }
+
+		uint32_t word(uint32_t i) const noexcept { return i < n_ ? w_[i] : 0; }
+
+		uint32_t top() const noexcept { return n_ > 0 ? w_[n_ - 1] : 0; }
+
+		void mul(uint32_t m) noexcept {
+			uint64_t c = 0;
+			for(uint32_t i = 0; i < n_; ++i) {
+				c += static_cast<uint64_t>(w_[i]) * m;
+				w_[i] = c;
+				c >>= 32;
+			}
+			if(c != 0 && n_ < N) w_[n_++] = c;
+		}
+
+		void mul_pow5(uint32_t k) noexcept {
+			static const uint32_t pow5[14] = {
+				1, 5, 25, 125, 625, 3125, 15625, 78125, 390625, 1953125,
+				9765625, 48828125, 244140625, 1220703125
+			};
+			while(k >= 13) {
+				mul(pow5[13]);
+				k -= 13;
+			}
+			if(k > 0) mul(pow5[k]);
+		}
+
+		void shl(uint32_t bits) noexcept {
+			if(n_ == 0) return;
+			uint32_t ws = bits >> 5;
+			uint32_t bs = bits & 31;
+			if(bs != 0) {
+				uint32_t c = 0;
+				for(uint32_t i = 0; i < n_; ++i) {
+					uint32_t t = w_[i];
+					w_[i] = (t << bs) | c;
+					c = t >> (32 - bs);
+				}
+				if(c != 0 && n_ < N) w_[n_++] = c;
+			}
+			if(ws != 0) {
+				if((n_ + ws) > N) ws = N - n_;
+				for(uint32_t i = n_; i > 0; --i) w_[i - 1 + ws] = w_[i - 1];
+				for(uint32_t i = 0; i < ws; ++i) w_[i] = 0;
+				n_ += ws;
+			}
+		}
+
+		void mul_pow10(uint32_t k) noexcept {
+			mul_pow5(k);
+			shl(k);
+		}
+
+		void add(const big_uint& o) noexcept {
+			uint32_t n = n_ > o.n_ ? n_ : o.n_;
+			uint64_t c = 0;
+			for(uint32_t i = 0; i < n; ++i) {
+				c += static_cast<uint64_t>(word(i)) + o.word(i);
+				w_[i] = c;
+				c >>= 32;
+			}
+			n_ = n;
+			if(c != 0 && n_ < N) w_[n_++] = c;
+		}
+
+		// this >= o である事
+		void sub(const big_uint& o) noexcept {
+			uint32_t b = 0;
+			for(uint32_t i = 0; i < n_; ++i) {
+				uint64_t t = static_cast<uint64_t>(w_[i]) - o.word(i) - b;
+				w_[i] = t;
+				b = (t >> 32) & 1;
+			}
+			trim_();
+		}
+
+		// this -= o * q（結果が負にならない事）
+		void sub_mul(const big_uint& o, uint32_t q) noexcept {
+			uint64_t c = 0;
+			uint32_t b = 0;
+			for(uint32_t i = 0; i < n_; ++i) {
+				c += static_cast<uint64_t>(o.word(i)) * q;
+				uint64_t t = static_cast<uint64_t>(w_[i]) - static_cast<uint32_t>(c) - b;
+				w_[i] = t;
+				b = (t >> 32) & 1;
+				c >>= 32;
+			}
+			trim_();
+		}
+
+		int compare(const big_uint& o) const noexcept {
+			if(n_ != o.n_) return n_ < o.n_ ? -1 : 1;
+			for(uint32_t i = n_; i > 0; --i) {
+				if(w_[i - 1] != o.w_[i - 1]) return w_[i - 1] < o.w_[i - 1] ? -1 : 1;
+			}
+			return 0;
+		}
+
+		// (this * 2) と o の比較
+		int compare2(const big_uint& o) const noexcept {
+			uint32_t n = (n_ > o.n_ ? n_ : o.n_) + 1;
+			for(uint32_t i = n; i > 0; --i) {
+				uint32_t a = (word(i - 1) << 1) | (i > 1 ? (word(i - 2) >> 31) : 0);
+				uint32_t b = o.word(i - 1);
+				if(a != b) return a < b ? -1 : 1;
+			}
+			return 0;
+		}
+
+		// (this + a) と o の比較
+		int compare_sum(const big_uint& a, const big_uint& o) const noexcept {
+			big_uint t = *this;
+			t.add(a);
+			return t.compare(o);
+		}
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  浮動小数点の形式（サイズで選択）
+		@param[in]	SIZE	バイト数
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t SIZE> struct real_layout;
+
+	template <> struct real_layout<4> {
+		typedef uint32_t bits_type;
+		static constexpr uint32_t MANT = 23;	///< 仮数部のビット数
+		static constexpr uint32_t EXPB = 8;		///< 指数部のビット数
+		static constexpr int32_t  BIAS = 127;
+		static constexpr uint32_t WORDS = 8;	///< 多倍長の最大ワード数
+		static constexpr uint32_t SHORTEST = 9;	///< 最短変換の最大桁数
+	};
+
+	template <> struct real_layout<8> {
+		typedef uint64_t bits_type;
+		static constexpr uint32_t MANT = 52;
+		static constexpr uint32_t EXPB = 11;
+		static constexpr int32_t  BIAS = 1023;
+		static constexpr uint32_t WORDS = 40;
+		static constexpr uint32_t SHORTEST = 17;
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  浮動小数点、１０進変換クラス @n
+				値を 0.d1d2d3... x 10^K の形で、上位の桁から順に取り出す。@n
+				Ex: 指定桁数 @n
+					real_conv<double> c(v); @n
+					auto k = c.start(); @n
+					for(n 桁) d = c.digit(); @n
+					if(c.round_up(d)) 切り上げ
+		@param[in]	T	float、double
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <typename T>
+	class real_conv {
+	public:
+		typedef real_layout<sizeof(T)> LAYOUT;
+		typedef big_uint<LAYOUT::WORDS> BIG;
+
+	private:
+		typedef typename LAYOUT::bits_type bits_type;
+
+		uint64_t	f_;		// v = f_ * 2^e_
+		int32_t		e_;
+		uint32_t	bexp_;	// 指数部（バイアス付き）
+		bool		sign_;
+		bool		inf_;
+		bool		nan_;
+
+		// 64 ビット固定小数点（整数部の桁、小数部）で取り出す場合
+		bool		fast_;
+		uint8_t		inum_;
+		uint8_t		ipos_;
+		uint8_t		idig_[20];
+		uint32_t	sh_;
+		uint64_t	frac_;
+
+		BIG			r_;
+		BIG			s_;
+
+		static uint32_t bitlen_(uint64_t v) noexcept {
+			uint32_t n = 0;
+			while(v != 0) { ++n; v >>= 1; }
+			return n;
+		}
+
+		// 10^(k-1) <= v となる k（真の値以下）
+		int32_t estimate_() const noexcept {
+			int32_t b = static_cast<int32_t>(bitlen_(f_)) + e_ - 1;  // 2^b <= v
+			// log10(2) = 0.30103 を、正では小さめ、負では大きめに近似
+			if(b >= 0) return ((b * 1233) >> 12) + 1;
+			else return -(((-b) * 1234 + 4095) >> 12) + 1;
+		}
+
+		static void scale_(int32_t k, BIG& r, BIG& s) noexcept {
+			if(k >= 0) s.mul_pow10(k);
+			else r.mul_pow10(-k);
+		}
+
+		// s の最上位ワードを 28 ビット長にそろえる（商の推定を 32 ビットの除算で行う為）
+		static uint32_t norm_shift_(const BIG& s) noexcept {
+			uint32_t bl = bitlen_(s.top());
+			return (28 + 32 - bl) & 31;
+		}
+
+		static uint8_t quotient_(BIG& r, const BIG& s) noexcept {
+			uint32_t q = r.word(s.size() - 1) / (s.top() + 1);
+			if(q != 0) r.sub_mul(s, q);
+			while(r.compare(s) >= 0) {
+				r.sub(s);
+				++q;
+			}
+			return q;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+			@param[in]	v	値
+		*/
+		//-----------------------------------------------------------------//
+		real_conv(T v) noexcept : f_(0), e_(0), bexp_(0), sign_(false), inf_(false), nan_(false),
+			fast_(false), inum_(0), ipos_(0), sh_(0), frac_(0)
+		{
+			bits_type bits;
+			std::memcpy(&bits, &v, sizeof(bits));
+			sign_ = (bits >> (sizeof(bits) * 8 - 1)) != 0;
+			bexp_ = (bits >> LAYOUT::MANT) & ((1 << LAYOUT::EXPB) - 1);
+			f_ = bits & ((static_cast<bits_type>(1) << LAYOUT::MANT) - 1);
+			if(bexp_ == ((1u << LAYOUT::EXPB) - 1)) {
+				if(f_ == 0) inf_ = true;
+				else nan_ = true;
+				return;
+			}
+			if(bexp_ == 0) {  // 非正規化数
+				e_ = 1 - LAYOUT::BIAS - static_cast<int32_t>(LAYOUT::MANT);
+			} else {
+				f_ |= static_cast<uint64_t>(1) << LAYOUT::MANT;
+				e_ = static_cast<int32_t>(bexp_) - LAYOUT::BIAS - static_cast<int32_t>(LAYOUT::MANT);
+			}
+		}
+
+
+		bool sign() const noexcept { return sign_; }
+		bool is_inf() const noexcept { return inf_; }
+		bool is_nan() const noexcept { return nan_; }
+		bool is_zero() const noexcept { return !inf_ && !nan_ && f_ == 0; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  桁の取り出しを開始（何度でも最初からやり直せる） @n
+					※値が０、inf、nan で無い事
+			@return １０進の指数 K（10^(K-1) <= |v| < 10^K）
+		*/
+		//-----------------------------------------------------------------//
+		int32_t start() noexcept
+		{
+			fast_ = e_ >= -60 && (e_ <= 0 || (bitlen_(f_) + e_) <= 64);
+			if(fast_) {
+				uint64_t ip;
+				if(e_ >= 0) {
+					ip = f_ << e_;
+					sh_ = 0;
+					frac_ = 0;
+				} else {
+					sh_ = -e_;
+					ip = f_ >> sh_;
+					frac_ = f_ & ((static_cast<uint64_t>(1) << sh_) - 1);
+				}
+				uint8_t tmp[20];
+				inum_ = 0;
+				ipos_ = 0;
+				while(ip > 0xffffffff) {
+					tmp[inum_++] = ip % 10;
+					ip /= 10;
+				}
+				uint32_t ip32 = ip;
+				while(ip32 != 0) {
+					tmp[inum_++] = ip32 % 10;
+					ip32 /= 10;
+				}
+				for(uint32_t i = 0; i < inum_; ++i) idig_[i] = tmp[inum_ - 1 - i];
+				if(inum_ > 0) return inum_;
+				// 小数部の先頭の 0 を読み飛ばす
+				int32_t k = 0;
+				while(((frac_ * 10) >> sh_) == 0) {
+					frac_ *= 10;
+					--k;
+				}
+				return k;
+			}
+
+			r_.set(f_);
+			s_.set(1);
+			if(e_ >= 0) r_.shl(e_);
+			else s_.shl(-e_);
+
+			int32_t k = estimate_();
+			scale_(k, r_, s_);
+			while(r_.compare(s_) >= 0) {
+				s_.mul(10);
+				++k;
+			}
+			auto sh = norm_shift_(s_);
+			r_.shl(sh);
+			s_.shl(sh);
+			return k;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  次の桁を取り出す
+			@return 桁（0 ～ 9）
+		*/
+		//-----------------------------------------------------------------//
+		uint8_t digit() noexcept
+		{
+			if(fast_) {
+				if(ipos_ < inum_) return idig_[ipos_++];
+				frac_ *= 10;
+				uint8_t d = frac_ >> sh_;
+				frac_ &= (static_cast<uint64_t>(1) << sh_) - 1;
+				return d;
+			}
+			r_.mul(10);
+			return quotient_(r_, s_);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  残りを丸めた場合に、切り上げるか（最近接偶数）
+			@param[in]	last	最後に取り出した桁
+			@return 切り上げる場合「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool round_up(uint8_t last) const noexcept
+		{
+			if(fast_) {
+				if(ipos_ < inum_) {  // 整数部の途中
+					auto d = idig_[ipos_];
+					if(d != 5) return d > 5;
+					for(uint32_t i = ipos_ + 1; i < inum_; ++i) {
+						if(idig_[i] != 0) return true;
+					}
+					if(frac_ != 0) return true;
+					return (last & 1) != 0;
+				}
+				if(sh_ == 0) return false;
+				auto h = static_cast<uint64_t>(1) << sh_;
+				auto f2 = frac_ << 1;
+				if(f2 != h) return f2 > h;
+				return (last & 1) != 0;
+			}
+			auto c = r_.compare2(s_);
+			if(c != 0) return c > 0;
+			return (last & 1) != 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  最短桁数の変換（読み戻すと同じ値になる最短の桁列） @n
+					※値が０、inf、nan で無い事
+			@param[out]	dig	桁（0 ～ 9）、LAYOUT::SHORTEST 以上の大きさ
+			@param[out]	k	１０進の指数（0.d1d2... x 10^k）
+			@return 桁数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t shortest(uint8_t* dig, int32_t& k) noexcept
+		{
+			// 下側の間隔が半分になるのは、仮数が 1.0 で、最小の指数では無い場合
+			bool half = f_ == (static_cast<uint64_t>(1) << LAYOUT::MANT) && bexp_ > 1;
+			bool even = (f_ & 1) == 0;
+			BIG mp;
+			BIG mm;
+			r_.set(f_);
+			s_.set(1);
+			mp.set(1);
+			mm.set(1);
+			uint32_t m = half ? 2 : 1;
+			r_.shl(m);
+			s_.shl(m);
+			if(half) mp.shl(1);
+			if(e_ >= 0) {
+				r_.shl(e_);
+				mp.shl(e_);
+				mm.shl(e_);
+			} else {
+				s_.shl(-e_);
+			}
+
+			k = estimate_();
+			if(k >= 0) {
+				s_.mul_pow10(k);
+			} else {
+				r_.mul_pow10(-k);
+				mp.mul_pow10(-k);
+				mm.mul_pow10(-k);
+			}
+			while(1) {
+				auto c = r_.compare_sum(mp, s_);
+				if(c < 0 || (c == 0 && !even)) break;
+				s_.mul(10);
+				++k;
+			}
+			auto sh = norm_shift_(s_);
+			r_.shl(sh);
+			s_.shl(sh);
+			mp.shl(sh);
+			mm.shl(sh);
+
+			uint32_t n = 0;
+			while(n < LAYOUT::SHORTEST) {
+				r_.mul(10);
+				mp.mul(10);
+				mm.mul(10);
+				uint8_t d = quotient_(r_, s_);
+				auto cl = r_.compare(mm);
+				bool low = even ? cl <= 0 : cl < 0;
+				auto ch = r_.compare_sum(mp, s_);
+				bool high = even ? ch >= 0 : ch > 0;
+				if(!low && !high) {
+					dig[n++] = d;
+					continue;
+				}
+				if(low && high) {
+					auto c = r_.compare2(s_);
+					if(c > 0 || (c == 0 && (d & 1) != 0)) ++d;
+				} else if(high) {
+					++d;
+				}
+				dig[n++] = d;
+				break;
+			}
+			return n;
+		}
+	};
+}
@@ -10,6 +10,7 @@
 			・ボーレート、サービスする内容に応じて適切に設定して下さい。@n
 			  typedef utils::fixed_fifo<char, 512>  RBF;  // 受信バッファ定義 @n
 			  typedef utils::fixed_fifo<char, 1024> SBF;  // 送信バッファ定義 @n
+			  ※ utils::spsc_fifo（サイズは２のべき乗）も使えます。@n
 			  typedef device::sci_io<device::SCI1, RBF, SBF> SCI;  // SCI1 の場合 @n
 			  SCI	sci_; // 実態の宣言 @n
 			Ex: 開始例 @n
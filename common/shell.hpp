@@ -16,6 +16,7 @@
 #include "common/file_io.hpp"
 #include "common/format.hpp"
 #include "common/string_utils.hpp"
+#include "common/command_map.hpp"
 
 namespace utils {
 
@@ -34,6 +35,21 @@ namespace utils {
 
 		bool	state_;
 
+		enum class FS_CMD : uint8_t {
+			LS,
+			PWD,
+			CD,
+			FREE,
+		};
+
+		static constexpr auto fs_map_ = make_command_map<FS_CMD>({
+			{ "ls",   FS_CMD::LS },
+			{ "pwd",  FS_CMD::PWD },
+			{ "cd",   FS_CMD::CD },
+			{ "free", FS_CMD::FREE },
+		});
+		static_assert(fs_map_.unique(), "shell: command name duplicated");
+
 		void make_prompt_(const char* src = nullptr)
 		{
 			if(src == nullptr) {
@@ -88,63 +104,77 @@ namespace utils {
 			auto cmdn = cmd_.get_words();
 			if(cmdn >= 1) {
 
+				FS_CMD id;
+				if(!cmd_.find_word(0, fs_map_, id)) return false;
+
 				int opt = 0;
 				int path = 0;
-				for(uint32_t n = 1; n < cmd_.get_words(); ++n) {
-					char tmp[16];
+				for(uint32_t n = 1; n < cmdn; ++n) {
+					char tmp[2];
 					cmd_.get_word(n, tmp, sizeof(tmp));
 					if(tmp[0] == '-') opt = n;
 					else path = n;
 				}
 
-                if(cmd_.cmp_word(0, "ls")) {  // ls [xxx]
-					char tmp[utils::file_io::PATH_MAX_SIZE];
-					bool ll = false;
-					if(opt > 0 && cmd_.cmp_word(opt, "-l")) ll = true;
-					if(path == 0) {
-						if(!utils::file_io::pwd(tmp, sizeof(tmp))) {
-							state_ = false;
+				switch(id) {
+				case FS_CMD::LS:  // ls [xxx]
+					{
+						char tmp[utils::file_io::PATH_MAX_SIZE];
+						bool ll = false;
+						if(opt > 0 && cmd_.cmp_word(opt, "-l")) ll = true;
+						if(path == 0) {
+							if(!utils::file_io::pwd(tmp, sizeof(tmp))) {
+								state_ = false;
+							} else {
+								state_ = utils::file_io::dir(tmp, ll);
+							}
 						} else {
+							cmd_.get_word(path, tmp, sizeof(tmp));
 							state_ = utils::file_io::dir(tmp, ll);
 						}
-					} else {
-						cmd_.get_word(path, tmp, sizeof(tmp));
-						state_ = utils::file_io::dir(tmp, ll);
 					}
-				} else if(cmd_.cmp_word(0, "pwd")) {  // pwd
-					char tmp[utils::file_io::PATH_MAX_SIZE];
-					if(!utils::file_io::pwd(tmp, sizeof(tmp))) {
-						state_ = false;
-					} else {
-						utils::format("%s\n") % tmp;
-						make_prompt_();
-					}
-				} else if(cmd_.cmp_word(0, "cd")) {  // cd [xxx]
-					char tmp[utils::file_io::PATH_MAX_SIZE];
-					if(path == 0) {
-						strcpy(tmp, "/");
-					} else {
-						cmd_.get_word(1, tmp, sizeof(tmp));
+					break;
+				case FS_CMD::PWD:  // pwd
+					{
+						char tmp[utils::file_io::PATH_MAX_SIZE];
+						if(!utils::file_io::pwd(tmp, sizeof(tmp))) {
+							state_ = false;
+						} else {
+							utils::format("%s\n") % tmp;
+							make_prompt_();
+						}
 					}
-					state_ = utils::file_io::cd(tmp);
-					if(state_) {
-						make_prompt_();
-					} else {
-						utils::format("Illegal file path: '%s'\n") % tmp; 
+					break;
+				case FS_CMD::CD:  // cd [xxx]
+					{
+						char tmp[utils::file_io::PATH_MAX_SIZE];
+						if(path == 0) {
+							strcpy(tmp, "/");
+						} else {
+							cmd_.get_word(1, tmp, sizeof(tmp));
+						}
+						state_ = utils::file_io::cd(tmp);
+						if(state_) {
+							make_prompt_();
+						} else {
+							utils::format("Illegal file path: '%s'\n") % tmp; 
+						}
 					}
-				} else if(cmd_.cmp_word(0, "free")) {  // free
-					uint32_t fre;
-					uint32_t max;
-					if(utils::file_io::get_free_space(fre, max)) {
-						uint32_t rate = fre * 1000 / max;
-						utils::format("%u/%u [KB] (%u.%u%%)\n")
-							% fre % max % (rate / 10) % (rate % 10);
-						state_ = true;
-					} else {
-						state_ = false;
+					break;
+				case FS_CMD::FREE:  // free
+					{
+						uint32_t fre;
+						uint32_t max;
+						if(utils::file_io::get_free_space(fre, max)) {
+							uint32_t rate = fre * 1000 / max;
+							utils::format("%u/%u [KB] (%u.%u%%)\n")
+								% fre % max % (rate / 10) % (rate % 10);
+							state_ = true;
+						} else {
+							state_ = false;
+						}
 					}
-				} else {
-					return false;
+					break;
 				}
 			} else {
 				make_prompt_();
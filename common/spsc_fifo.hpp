@@ -0,0 +1,266 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	SPSC (single producer single consumer) FIFO テンプレート @n
+			・書き込み、読み出しが、それぞれ１つのコンテキスト（割り込みとタスクなど）@n
+			　なら、割り込みを禁止せずに使える @n
+			・位置はフリーランのカウンターで、サイズ（２のべき乗）のマスクで参照する @n
+			　（剰余を使わず、SIZE 個全てを使える）@n
+			・write_span()、read_span() で連続領域を得て、memcpy、DMA でまとめて転送できる @n
+			・fixed_fifo と同じ put/get/put_at/put_go/get_at/get_go を持つので、置き換えられる
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <atomic>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  SPSC FIFO クラス
+		@param[in]	UNIT	基本形
+		@param[in]	SIZE	バッファサイズ（２のべき乗、最低２）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class UNIT, uint32_t SIZE>
+	class spsc_fifo {
+
+		static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "SIZE must be a power of two");
+
+		volatile uint32_t	get_;
+		volatile uint32_t	put_;
+
+		UNIT	buff_[SIZE];
+
+	public:
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  連続領域
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		template <class T>
+		struct span_t {
+			T*			ptr;	///< 先頭
+			uint32_t	len;	///< 要素数
+		};
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		spsc_fifo() noexcept : get_(0), put_(0) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  バッファのサイズを返す
+			@return	バッファのサイズ
+		*/
+		//-----------------------------------------------------------------//
+		inline uint32_t size() const noexcept { return SIZE; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  長さを返す
+			@return	長さ
+		*/
+		//-----------------------------------------------------------------//
+		inline uint32_t length() const noexcept { return put_ - get_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  空きを返す
+			@return	空き
+		*/
+		//-----------------------------------------------------------------//
+		inline uint32_t space() const noexcept { return SIZE - (put_ - get_); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  クリア（書き込み、読み出しが止まっている事）
+		*/
+		//-----------------------------------------------------------------//
+		inline void clear() noexcept { get_ = put_ = 0; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  値の格納参照を得る
+			@param[in]	ofs	オフセット（空きを超えたオフセットは未定義）
+			@return 値の格納参照
+		*/
+		//-----------------------------------------------------------------//
+		inline UNIT& put_at(uint32_t ofs = 0) noexcept {
+			return buff_[(put_ + ofs) & (SIZE - 1)];
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  値の格納ポイントの移動 @n
+					格納した値が見えてから、位置を更新する
+			@param[in]	n	移動数（空き以下）
+		*/
+		//-----------------------------------------------------------------//
+		inline void put_go(uint32_t n = 1) noexcept {
+			std::atomic_signal_fence(std::memory_order_release);
+			put_ = put_ + n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  値の格納
+			@param[in]	v	値
+		*/
+		//-----------------------------------------------------------------//
+		void put(const UNIT& v) noexcept {
+			buff_[put_ & (SIZE - 1)] = v;
+			put_go();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  格納できる連続領域を得る（終端で折り返す手前まで）@n
+					書き込んだら put_go(n) で確定する
+			@return 連続領域
+		*/
+		//-----------------------------------------------------------------//
+		span_t<UNIT> write_span() noexcept {
+			uint32_t p = put_;
+			uint32_t n = SIZE - (p - get_);
+			std::atomic_signal_fence(std::memory_order_acquire);
+			uint32_t ofs = p & (SIZE - 1);
+			if(n > (SIZE - ofs)) n = SIZE - ofs;
+			return span_t<UNIT>{ &buff_[ofs], n };
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  まとめて格納
+			@param[in]	src	格納する値
+			@param[in]	len	個数
+			@return 格納した個数（空きが足りない場合は少なくなる）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t write(const UNIT* src, uint32_t len) noexcept {
+			uint32_t n = 0;
+			while(n < len) {
+				auto sp = write_span();
+				if(sp.len == 0) break;
+				if(sp.len > (len - n)) sp.len = len - n;
+				for(uint32_t i = 0; i < sp.len; ++i) sp.ptr[i] = src[n + i];
+				put_go(sp.len);
+				n += sp.len;
+			}
+			return n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  値の取得参照を得る
+			@param[in]	ofs	オフセット（長さを超えたオフセットは未定義）
+			@return	値の取得参照
+		*/
+		//-----------------------------------------------------------------//
+		inline const UNIT& get_at(uint32_t ofs = 0) const noexcept {
+			std::atomic_signal_fence(std::memory_order_acquire);
+			return buff_[(get_ + ofs) & (SIZE - 1)];
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  値の取得ポイントの移動 @n
+					値を読み終えてから、位置を更新する
+			@param[in]	n	移動数（長さ以下）
+		*/
+		//-----------------------------------------------------------------//
+		inline void get_go(uint32_t n = 1) noexcept {
+			std::atomic_signal_fence(std::memory_order_release);
+			get_ = get_ + n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  値の取得
+			@return	値
+		*/
+		//-----------------------------------------------------------------//
+		UNIT get() noexcept {
+			std::atomic_signal_fence(std::memory_order_acquire);
+			UNIT v = buff_[get_ & (SIZE - 1)];
+			get_go();
+			return v;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  取得できる連続領域を得る（終端で折り返す手前まで）@n
+					読み終えたら get_go(n) で解放する
+			@return 連続領域
+		*/
+		//-----------------------------------------------------------------//
+		span_t<const UNIT> read_span() const noexcept {
+			uint32_t g = get_;
+			uint32_t n = put_ - g;
+			std::atomic_signal_fence(std::memory_order_acquire);
+			uint32_t ofs = g & (SIZE - 1);
+			if(n > (SIZE - ofs)) n = SIZE - ofs;
+			return span_t<const UNIT>{ &buff_[ofs], n };
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  まとめて取得
+			@param[out]	dst	取得先
+			@param[in]	len	最大個数
+			@return 取得した個数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t read(UNIT* dst, uint32_t len) noexcept {
+			uint32_t n = 0;
+			while(n < len) {
+				auto sp = read_span();
+				if(sp.len == 0) break;
+				if(sp.len > (len - n)) sp.len = len - n;
+				for(uint32_t i = 0; i < sp.len; ++i) dst[n + i] = sp.ptr[i];
+				get_go(sp.len);
+				n += sp.len;
+			}
+			return n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  get 位置を返す
+			@return	位置
+		*/
+		//-----------------------------------------------------------------//
+		inline uint32_t pos_get() const noexcept { return get_ & (SIZE - 1); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  put 位置を返す
+			@return	位置
+		*/
+		//-----------------------------------------------------------------//
+		inline uint32_t pos_put() const noexcept { return put_ & (SIZE - 1); }
+	};
+}
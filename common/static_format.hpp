@@ -0,0 +1,629 @@
+#pragma once
+//=============================================================================//
+/*! @file
+    @brief  utils::static_format クラス @n
+			・フォーマット文字列をコンパイル時に解析する format @n
+			・引数の「型」は、コンパイル時に検査する（static_assert） @n
+			・リテラル部分、変換した数字は、まとめて出力ファンクタに送る @n
+			（出力ファンクタに write(const char*, uint32_t) があれば使う） @n
+			・書式は utils::format と同じ（「%b」、「%N.M:Ly」を含む） @n
+			・浮動小数点、固定小数点は、utils::basic_format で変換する @n
+			・出力ファンクタは、utils::basic_format と共有する（インスタンス毎の指定も可） @n
+			・C++17 が必要 @n
+			Ex: utils::cformat(UTILS_FORM("%d: %s\n")) % 123 % "abc"; @n
+			Ex: char tmp[64]; @n
+			    utils::csformat(UTILS_FORM("%08X"), tmp, sizeof(tmp)) % 0x1234;
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=============================================================================//
+#include "common/format.hpp"
+
+//-----------------------------------------------------------------//
+/*!
+	@brief  フォーマット文字列を「型」にする
+	@param[in]	s	フォーマット文字列（リテラル）
+*/
+//-----------------------------------------------------------------//
+#define UTILS_FORM(s) \
+	([] { struct form_t { static constexpr const char* str() { return s; } }; return form_t(); }())
+
+namespace utils {
+
+	namespace static_form {
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  変換の種類
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class kind : uint8_t {
+			LIT,			///< リテラル
+			CHA,			///< 文字
+			STR,			///< 文字列
+			BINARY,			///< ２進
+			OCTAL,			///< ８進
+			DECIMAL,		///< １０進
+			U_DECIMAL,		///< １０進（符号無し）
+			HEX_CAPS,		///< １６進（大文字）
+			HEX,			///< １６進（小文字）
+			POINTER,		///< ポインター（１６進）
+			FIXED_REAL,		///< 固定小数点（basic_format で変換）
+			REAL,			///< 浮動小数点（basic_format で変換）
+			UNKNOWN			///< 不明な変換
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  解析済みの要素
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct item_t {
+			kind		kind_ = kind::LIT;
+			uint16_t	org_ = 0;		///< 文字列の位置（変換の場合「%」の位置）
+			uint16_t	len_ = 0;		///< 文字列の長さ
+			uint16_t	num_ = 0;
+			uint8_t		point_ = 0;
+			bool		zerosupp_ = false;
+			bool		sign_ = false;
+			bool		nega_ = false;
+		};
+
+
+		constexpr uint32_t length_(const char* s) {
+			uint32_t n = 0;
+			while(s[n] != 0) ++n;
+			return n;
+		}
+
+
+		// utils::basic_format::next_() と同じ規則で解析する（out が nullptr なら数えるだけ）
+		constexpr uint32_t parse_(const char* s, item_t* out) {
+			uint32_t n = 0;
+			uint32_t i = 0;
+			while(s[i] != 0) {
+				if(s[i] != '%') {  // リテラル
+					item_t t;
+					t.org_ = i;
+					while(s[i] != 0 && s[i] != '%') ++i;
+					t.len_ = i - t.org_;
+					if(out != nullptr) out[n] = t;
+					++n;
+					continue;
+				}
+				item_t t;
+				t.org_ = i;
+				++i;
+				uint8_t md = 0;  // 0: num, 1: point, 2: bitlen
+				bool fin = false;
+				while(!fin) {
+					char ch = s[i];
+					if(ch == 0) {
+						t.kind_ = kind::UNKNOWN;
+						break;
+					}
+					++i;
+					if(ch == '+') {
+						t.sign_ = true;
+					} else if(ch == '-') {
+						t.nega_ = true;
+					} else if(ch >= '0' && ch <= '9') {
+						if(md == 0) {
+							if(t.num_ == 0 && ch == '0') t.zerosupp_ = true;
+							t.num_ = t.num_ * 10 + (ch - '0');
+						} else if(md == 1) {
+							t.point_ = t.point_ * 10 + (ch - '0');
+						}
+					} else if(ch == '.') {
+						md = 1;
+					} else if(ch == ':') {
+						md = 2;
+					} else {
+						fin = true;
+						switch(ch) {
+						case 's': t.kind_ = kind::STR; break;
+						case 'c': t.kind_ = kind::CHA; break;
+#ifndef NO_BIN_FORM
+						case 'b': t.kind_ = kind::BINARY; break;
+#endif
+#ifndef NO_OCTAL_FORM
+						case 'o': t.kind_ = kind::OCTAL; break;
+#endif
+						case 'd':
+						case 'i': t.kind_ = kind::DECIMAL; break;
+						case 'u': t.kind_ = kind::U_DECIMAL; break;
+						case 'x': t.kind_ = kind::HEX; break;
+						case 'X': t.kind_ = kind::HEX_CAPS; break;
+						case 'p': t.kind_ = kind::POINTER; break;
+						case 'y': t.kind_ = kind::FIXED_REAL; break;
+						case 'f':
+						case 'F':
+						case 'e':
+						case 'E':
+						case 'g':
+						case 'G': t.kind_ = kind::REAL; break;
+						case '%':  // 「%」の出力
+							t.kind_ = kind::LIT;
+							t.org_ = i - 1;
+							t.len_ = 1;
+							break;
+						default:
+							t.kind_ = kind::UNKNOWN;
+							break;
+						}
+					}
+				}
+				if(t.kind_ != kind::LIT) {
+					t.len_ = i - t.org_;
+				}
+				if(out != nullptr) out[n] = t;
+				++n;
+				if(t.kind_ == kind::UNKNOWN) break;
+			}
+			return n;
+		}
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  解析済みテーブル
+			@param[in]	FORM	フォーマット文字列の「型」（UTILS_FORM）
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		template <class FORM>
+		struct table {
+			static constexpr const char* str = FORM::str();
+			static constexpr uint32_t num = parse_(FORM::str(), nullptr);
+
+			struct array_t {
+				item_t	t[num + 1];
+			};
+
+			static constexpr array_t make_() {
+				array_t a;
+				parse_(FORM::str(), a.t);
+				return a;
+			}
+			static constexpr array_t items = make_();
+
+			// 変換の数
+			static constexpr uint32_t count_args_() {
+				uint32_t n = 0;
+				for(uint32_t i = 0; i < num; ++i) {
+					if(items.t[i].kind_ != kind::LIT) ++n;
+				}
+				return n;
+			}
+			static constexpr uint32_t args = count_args_();
+
+			// 変換に不明な物が無いか
+			static constexpr bool valid_() {
+				for(uint32_t i = 0; i < num; ++i) {
+					if(items.t[i].kind_ == kind::UNKNOWN) return false;
+				}
+				return true;
+			}
+			static_assert(valid_(), "static_format: unknown conversion in format string");
+
+			// ARG 番目の変換の要素位置（ARG == args なら num）
+			static constexpr uint32_t index_(uint32_t arg) {
+				for(uint32_t i = 0; i < num; ++i) {
+					if(items.t[i].kind_ != kind::LIT) {
+						if(arg == 0) return i;
+						--arg;
+					}
+				}
+				return num;
+			}
+
+			// ARG 番目の変換の書式（basic_format に渡す、終端付き）
+			template <uint32_t ARG>
+			struct text_t {
+				static constexpr item_t item = items.t[index_(ARG)];
+				struct array_t {
+					char	t[item.len_ + 1];
+				};
+				static constexpr array_t make_() {
+					array_t a = { };
+					for(uint32_t i = 0; i < item.len_; ++i) a.t[i] = str[item.org_ + i];
+					a.t[item.len_] = 0;
+					return a;
+				}
+				static constexpr array_t text = make_();
+			};
+		};
+	}
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  コンパイル時解析 format クラス
+		@param[in]	CHAOUT	文字出力ファンクタ
+		@param[in]	FORM	フォーマット文字列の「型」（UTILS_FORM）
+		@param[in]	ARG		次の引数の番号
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class CHAOUT, class FORM, uint32_t ARG = 0>
+	class static_format : public base_format {
+
+		template <class C, class F, uint32_t A> friend class static_format;
+
+		typedef static_form::table<FORM> TABLE;
+		typedef static_form::kind kind;
+		typedef static_form::item_t item_t;
+
+		static constexpr uint32_t POS = TABLE::index_(ARG);
+
+		CHAOUT&		out_;
+		error		error_;
+
+		template <class T>
+		static auto write_(T& out, const char* src, uint32_t len, int) -> decltype(out.write(src, len), void()) {
+			out.write(src, len);
+		}
+
+		template <class T>
+		static void write_(T& out, const char* src, uint32_t len, long) {
+			for(uint32_t i = 0; i < len; ++i) out(src[i]);
+		}
+
+		void write_(const char* src, uint32_t len) { write_(out_, src, len, 0); }
+
+		void fill_(char ch, uint32_t len) {
+			static const char spc[] = "                ";
+			static const char zero[] = "0000000000000000";
+			const char* p = ch == '0' ? zero : spc;
+			while(len > 0) {
+				uint32_t l = len < 16 ? len : 16;
+				write_(p, l);
+				len -= l;
+			}
+		}
+
+		// ORG から次の変換までのリテラルを出力
+		void literal_(uint32_t org) {
+			for(uint32_t i = org; i < TABLE::num; ++i) {
+				const auto& t = TABLE::items.t[i];
+				if(t.kind_ != kind::LIT) break;
+				write_(&TABLE::str[t.org_], t.len_);
+			}
+		}
+
+		// utils::basic_format::out_str_() と同じ配置
+		void out_str_(const item_t& t, const char* str, uint32_t n, char sign) {
+			if(t.nega_) {
+				if(sign != 0) write_(&sign, 1);
+				write_(str, n);
+			}
+			uint32_t num = t.num_;
+			if(sign != 0 && num > 0) --num;
+			if(n > 0 && n < num) {
+				if(t.zerosupp_) {
+					if(sign != 0) write_(&sign, 1);
+					fill_('0', num - n);
+				} else {
+					fill_(' ', num - n);
+					if(!t.nega_ && sign != 0) write_(&sign, 1);
+				}
+			} else {
+				if(!t.nega_ && sign != 0) write_(&sign, 1);
+			}
+			if(!t.nega_) write_(str, n);
+		}
+
+		template <typename U>
+		void out_radix_(const item_t& t, U v, uint32_t shift, char top, char sign) {
+			char buff[sizeof(U) * 8];
+			char* p = &buff[sizeof(buff)];
+			U mask = (static_cast<U>(1) << shift) - 1;
+			do {
+				char ch = v & mask;
+				*--p = ch < 10 ? (ch + '0') : (ch - 10 + top);
+				v >>= shift;
+			} while(v != 0);
+			out_str_(t, p, &buff[sizeof(buff)] - p, sign);
+		}
+
+		template <typename U>
+		void out_udec_(const item_t& t, U v, char sign) {
+			char buff[20];
+			char* p = &buff[sizeof(buff)];
+			do {
+				*--p = (v % 10) + '0';
+				v /= 10;
+			} while(v != 0);
+			out_str_(t, p, &buff[sizeof(buff)] - p, sign);
+		}
+
+		template <typename T>
+		void integer_(const item_t& t, T val) {
+#ifdef USE_INT64
+			typedef typename std::conditional<(sizeof(T) > 4), uint64_t, uint32_t>::type U;
+			typedef typename std::conditional<(sizeof(T) > 4), int64_t, int32_t>::type S;
+#else
+			typedef uint32_t U;
+			typedef int32_t S;
+#endif
+			switch(t.kind_) {
+			case kind::CHA:
+				{
+					auto chn = static_cast<int32_t>(val);
+					if(chn > -128 && chn < 128) {
+						char ch = chn;
+						write_(&ch, 1);
+					} else {
+						error_ = error::over;
+					}
+				}
+				break;
+#ifndef NO_BIN_FORM
+			case kind::BINARY:
+				out_radix_<U>(t, static_cast<U>(static_cast<S>(val)), 1, '0', 0);
+				break;
+#endif
+#ifndef NO_OCTAL_FORM
+			case kind::OCTAL:
+				out_radix_<U>(t, static_cast<U>(static_cast<S>(val)), 3, '0', 0);
+				break;
+#endif
+			case kind::DECIMAL:
+				{
+					auto v = static_cast<S>(val);
+					char sign = 0;
+					U u = static_cast<U>(v);
+					if(v < 0) {
+						u = static_cast<U>(0) - u;
+						sign = '-';
+					} else if(t.sign_) {
+						sign = '+';
+					}
+					out_udec_<U>(t, u, sign);
+				}
+				break;
+			case kind::U_DECIMAL:
+				out_udec_<U>(t, static_cast<U>(static_cast<S>(val)), t.sign_ ? '+' : 0);
+				break;
+			case kind::HEX:
+				out_radix_<U>(t, static_cast<U>(static_cast<S>(val)), 4, 'a', 0);
+				break;
+			case kind::HEX_CAPS:
+				out_radix_<U>(t, static_cast<U>(static_cast<S>(val)), 4, 'A', 0);
+				break;
+			default:
+				break;
+			}
+		}
+
+		void pointer_(const item_t& t, const void* val) {
+			auto v = reinterpret_cast<uintptr_t>(val);
+			item_t h;
+			h.zerosupp_ = true;
+			h.num_ = 8;
+			if(sizeof(val) > 4) {
+				out_radix_<uint32_t>(h, static_cast<uint64_t>(v) >> 32, 4, 'a', 0);
+			}
+			out_radix_<uint32_t>(h, static_cast<uint32_t>(v), 4, 'a', 0);
+		}
+
+		void str_(const item_t& t, const char* val) {
+			if(val == nullptr) {
+				static const char nullstr[] = "(nullptr)";
+				out_str_(t, nullstr, sizeof(nullstr) - 1, 0);
+				error_ = error::null;
+			} else {
+				item_t tt = t;
+				tt.zerosupp_ = false;
+				out_str_(tt, val, std::strlen(val), 0);
+			}
+		}
+
+		static_format(CHAOUT& out, error err) noexcept : out_(out), error_(err) { }
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター（最初の変換までのリテラルを出力）
+			@param[in]	form	フォーマット文字列の「型」（UTILS_FORM）
+		*/
+		//-----------------------------------------------------------------//
+		explicit static_format(FORM form) noexcept :
+			out_(basic_format<CHAOUT>::chaout()), error_(error::none)
+		{
+			static_assert(ARG == 0, "static_format: construct with the first argument");
+			literal_(0);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター（インスタンス毎の出力ファンクタ） @n
+					出力ファンクタを共有しないので、タスク毎に使える
+			@param[in]	out		出力ファンクタ
+			@param[in]	form	フォーマット文字列の「型」（UTILS_FORM）
+		*/
+		//-----------------------------------------------------------------//
+		static_format(CHAOUT& out, FORM form) noexcept : out_(out), error_(error::none)
+		{
+			static_assert(ARG == 0, "static_format: construct with the first argument");
+			literal_(0);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター（文字バッファへの出力）
+			@param[in]	form	フォーマット文字列の「型」（UTILS_FORM）
+			@param[in]	buff	文字バッファ
+			@param[in]	size	文字バッファサイズ
+			@param[in]	append	文字バッファに追加する場合「true」
+		*/
+		//-----------------------------------------------------------------//
+		static_format(FORM form, char* buff, uint32_t size, bool append = false) noexcept :
+			out_(basic_format<CHAOUT>::chaout()), error_(error::none)
+		{
+			static_assert(ARG == 0, "static_format: construct with the first argument");
+			if(!out_.set(buff, size)) {
+				error_ = error::out_null;
+				return;
+			}
+			if(!append) {
+				out_.clear();
+			}
+			literal_(0);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  引数の数を返す
+			@return 引数の数
+		*/
+		//-----------------------------------------------------------------//
+		static constexpr uint32_t args() noexcept { return TABLE::args; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  エラー種別を返す
+			@return エラー
+		*/
+		//-----------------------------------------------------------------//
+		error get_error() const noexcept { return error_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  変換ステータスを返す
+			@return 変換が全て正常なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool status() const noexcept { return error_ == error::none; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  出力サイズを返す
+			@return 出力サイズ
+		*/
+		//-----------------------------------------------------------------//
+		int size() const noexcept { return out_.size(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  オペレーター「%」@n
+					引数の「型」と、変換の組み合わせは、コンパイル時に検査する
+			@param[in]	val	値
+			@return	次の引数の static_format
+		*/
+		//-----------------------------------------------------------------//
+		template <typename T>
+		static_format<CHAOUT, FORM, ARG + 1> operator % (const T& val) noexcept
+		{
+			static_assert(ARG < TABLE::args, "static_format: too many arguments");
+			constexpr item_t t = TABLE::items.t[POS];
+			typedef typename std::decay<T>::type D;
+			constexpr bool str_type = std::is_same<D, char*>::value || std::is_same<D, const char*>::value
+				|| std::is_same<D, std::string>::value;
+			if constexpr (t.kind_ == kind::STR) {
+				static_assert(str_type, "static_format: '%s' needs a string");
+			} else if constexpr (t.kind_ == kind::POINTER) {
+				static_assert(std::is_pointer<D>::value, "static_format: '%p' needs a pointer");
+			} else if constexpr (t.kind_ == kind::REAL) {
+#ifdef NO_FLOAT_FORM
+				static_assert(!std::is_same<D, D>::value, "static_format: float is disabled (NO_FLOAT_FORM)");
+#else
+				static_assert(std::is_floating_point<D>::value, "static_format: '%f/%e/%g' needs a floating point");
+#endif
+			} else {
+				static_assert(std::is_integral<D>::value || std::is_enum<D>::value,
+					"static_format: integer conversion needs an integer");
+			}
+
+			if(error_ == error::none) {
+				if constexpr (t.kind_ == kind::STR) {
+					if constexpr (std::is_same<D, std::string>::value) {
+						str_(t, val.c_str());
+					} else {
+						str_(t, val);
+					}
+				} else if constexpr (t.kind_ == kind::POINTER) {
+					pointer_(t, static_cast<const void*>(val));
+				} else if constexpr (t.kind_ == kind::REAL || t.kind_ == kind::FIXED_REAL) {
+#ifndef NO_FLOAT_FORM
+					basic_format<CHAOUT>(out_, TABLE::template text_t<ARG>::text.t) % val;
+#else
+					if constexpr (t.kind_ == kind::FIXED_REAL) {
+						basic_format<CHAOUT>(out_, TABLE::template text_t<ARG>::text.t) % val;
+					}
+#endif
+				} else if constexpr (std::is_enum<D>::value) {
+					integer_(t, static_cast<typename std::underlying_type<D>::type>(val));
+				} else {
+					integer_(t, val);
+				}
+				literal_(POS + 1);
+			}
+			return static_format<CHAOUT, FORM, ARG + 1>(out_, error_);
+		}
+	};
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  標準出力（utils::format と同じ出力先）
+		@param[in]	form	フォーマット文字列の「型」（UTILS_FORM）
+		@return static_format
+	*/
+	//-----------------------------------------------------------------//
+	template <class FORM>
+	inline auto cformat(FORM form) noexcept {
+		return static_format<stdout_buffered_chaout<256>, FORM>(form);
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  インスタンス毎の出力ファンクタへ出力
+		@param[in]	out		出力ファンクタ
+		@param[in]	form	フォーマット文字列の「型」（UTILS_FORM）
+		@return static_format
+	*/
+	//-----------------------------------------------------------------//
+	template <class CHAOUT, class FORM>
+	inline auto cformat(CHAOUT& out, FORM form) noexcept {
+		return static_format<CHAOUT, FORM>(out, form);
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  文字バッファ出力（utils::sformat と同じ出力先）
+		@param[in]	form	フォーマット文字列の「型」（UTILS_FORM）
+		@param[in]	buff	文字バッファ
+		@param[in]	size	文字バッファサイズ
+		@param[in]	append	文字バッファに追加する場合「true」
+		@return static_format
+	*/
+	//-----------------------------------------------------------------//
+	template <class FORM>
+	inline auto csformat(FORM form, char* buff, uint32_t size, bool append = false) noexcept {
+		return static_format<memory_chaout, FORM>(form, buff, size, append);
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  出力サイズの計測（utils::size_format と同じ出力先）
+		@param[in]	form	フォーマット文字列の「型」（UTILS_FORM）
+		@return static_format
+	*/
+	//-----------------------------------------------------------------//
+	template <class FORM>
+	inline auto csize_format(FORM form) noexcept {
+		return static_format<size_chaout, FORM>(form);
+	}
+}
@@ -12,6 +12,9 @@
 #ifdef FAT_FS
 #include "ff14/source/ff.h"
 #include "ff14/mmc_io.hpp"
+#if FF_CODE_PAGE == 932
+#include "common/sjis_utf16_tbl.hpp"
+#endif
 #endif
 #include "common/time.h"
 #include "common/format.hpp"
@@ -82,11 +85,12 @@ namespace utils {
 			}
 			const auto* pp = strrchr(p, '.');
 			if(pp != nullptr && p < pp) {
+				if(len == 0) return false;
 				uint32_t n = pp - p;
 				if(n >= len) {
-					n = len;
+					n = len - 1;
 				}
-				strncpy_(dst, p, n);
+				strncpy_(dst, p, n + 1);
 				return true;
 			} else {
 				return false;
@@ -120,10 +124,123 @@ namespace utils {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ASCII（0x01 to 0x7f）が続く長さ @n
+					※境界を合わせてから、４バイト単位で検査する
+			@param[in]	src	ソース
+			@return 長さ
+		*/
+		//-----------------------------------------------------------------//
+		static uint32_t ascii_span_(const char* src) noexcept
+		{
+			auto p = src;
+			while((reinterpret_cast<uintptr_t>(p) & 3) != 0) {
+				auto c = static_cast<uint8_t>(*p);
+				if(c == 0 || c >= 0x80) return p - src;
+				++p;
+			}
+			while(1) {
+				uint32_t w;
+				std::memcpy(&w, p, 4);
+				// どれかのバイトが 0 か 0x80 以上
+				if(((w - 0x01010101) | w) & 0x80808080) break;
+				p += 4;
+			}
+			while(1) {
+				auto c = static_cast<uint8_t>(*p);
+				if(c == 0 || c >= 0x80) break;
+				++p;
+			}
+			return p - src;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  UTF-8 の１文字を取り出す @n
+					※不正な並び、冗長な表現、サロゲート、0x10FFFF を超える値はエラー
+			@param[in,out]	src	ソース（成功したら次の文字に進む）
+			@param[out]	code	コード
+			@return 正常なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		static bool get_utf8_(const char*& src, uint32_t& code) noexcept
+		{
+			auto p = reinterpret_cast<const uint8_t*>(src);
+			uint32_t c = p[0];
+			uint32_t n;
+			uint32_t min;
+			if(c < 0x80) {
+				code = c;
+				++src;
+				return true;
+			} else if(c < 0xc2) {
+				return false;
+			} else if(c < 0xe0) {
+				n = 1;
+				c &= 0x1f;
+				min = 0x80;
+			} else if(c < 0xf0) {
+				n = 2;
+				c &= 0x0f;
+				min = 0x800;
+			} else if(c < 0xf5) {
+				n = 3;
+				c &= 0x07;
+				min = 0x10000;
+			} else {
+				return false;
+			}
+			for(uint32_t i = 1; i <= n; ++i) {
+				uint32_t t = p[i];  // 終端（0）はここで止まる
+				if((t & 0xc0) != 0x80) return false;
+				c = (c << 6) | (t & 0x3f);
+			}
+			if(c < min || c > 0x10ffff || (0xd800 <= c && c <= 0xdfff)) return false;
+			code = c;
+			src += n + 1;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  UTF-8 の１文字を格納
+			@param[in]	code	コード（0x10FFFF 以下）
+			@param[out]	dst		格納先（最大４バイト）
+			@return 格納サイズ
+		*/
+		//-----------------------------------------------------------------//
+		static uint32_t put_utf8_(uint32_t code, char* dst) noexcept
+		{
+			if(code < 0x80) {
+				dst[0] = code;
+				return 1;
+			} else if(code < 0x800) {
+				dst[0] = 0xc0 | (code >> 6);
+				dst[1] = 0x80 | (code & 0x3f);
+				return 2;
+			} else if(code < 0x10000) {
+				dst[0] = 0xe0 | (code >> 12);
+				dst[1] = 0x80 | ((code >> 6) & 0x3f);
+				dst[2] = 0x80 | (code & 0x3f);
+				return 3;
+			} else {
+				dst[0] = 0xf0 | (code >> 18);
+				dst[1] = 0x80 | ((code >> 12) & 0x3f);
+				dst[2] = 0x80 | ((code >> 6) & 0x3f);
+				dst[3] = 0x80 | (code & 0x3f);
+				return 4;
+			}
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  半角相当文字数を数える @n
-					※半角： +1、全角： +2
+					※半角： +1、全角： +2 @n
+					※不正な UTF-8 の手前までを数える
 			@param[in]	src	ソース
 			@return 半角相当文字数
 		*/
@@ -133,30 +250,15 @@ namespace utils {
 			uint32_t len = 0;
 			if(src == nullptr) return len;
 
-			uint8_t cnt = 0;
-			uint16_t code = 0;
-			char tc;
-			while((tc = *src++) != 0) {
-				uint8_t c = static_cast<uint8_t>(tc);
-				if(c < 0x80) { code = c; cnt = 0; }
-				else if((c & 0xf0) == 0xe0) { code = (c & 0x0f); cnt = 2; }
-				else if((c & 0xe0) == 0xc0) { code = (c & 0x1f); cnt = 1; }
-				else if((c & 0xc0) == 0x80) {
-					code <<= 6;
-					code |= c & 0x3f;
-					cnt--;
-					if(cnt == 0 && code < 0x80) {
-						code = 0;	// 不正なコードとして無視
-						break;
-					} else if(cnt < 0) {
-						code = 0;
-					}
-				}
-				if(cnt == 0 && code != 0) {
-					if(code < 256) len += 1;
-					else len += 2;
-					code = 0;
-				}
+			while(1) {
+				auto n = ascii_span_(src);
+				len += n;
+				src += n;
+				if(*src == 0) break;
+				uint32_t code;
+				if(!get_utf8_(src, code)) break;
+				if(code < 256) len += 1;
+				else len += 2;
 			}
 			return len;
 		}
@@ -164,45 +266,52 @@ namespace utils {
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  UTF-8 から UTF-16 への変換
+			@brief  UTF-8 から UTF-16 への変換 @n
+					※0x10000 以上は、サロゲート・ペアになる
 			@param[in]	src	ソース
 			@param[in]	dst	変換先
 			@param[in]	dsz	変換先のサイズ（バイトサイズ）
-			@return 正常終了なら「true」
+			@return 正常終了なら「true」（不正な UTF-8、変換先が足りない場合「false」）
 		*/
 		//-----------------------------------------------------------------//
 		static bool utf8_to_utf16(const char* src, uint16_t* dst, uint32_t dsz) noexcept
 		{
 			uint32_t len = dsz / 2;
 			if(len <= 1) return false;
- 
-			uint8_t cnt = 0;
-			uint16_t code = 0;
-			char tc;
-			while((tc = *src++) != 0 && len > 1) {
-				uint8_t c = static_cast<uint8_t>(tc);
-				if(c < 0x80) { code = c; cnt = 0; }
-				else if((c & 0xf0) == 0xe0) { code = (c & 0x0f); cnt = 2; }
-				else if((c & 0xe0) == 0xc0) { code = (c & 0x1f); cnt = 1; }
-				else if((c & 0xc0) == 0x80) {
-					code <<= 6;
-					code |= c & 0x3f;
-					cnt--;
-					if(cnt == 0 && code < 0x80) {
-						code = 0;	// 不正なコードとして無視
+
+			bool ok = true;
+			while(1) {
+				auto n = ascii_span_(src);
+				if(n >= len) n = len - 1;
+				for(uint32_t i = 0; i < n; ++i) {
+					dst[i] = static_cast<uint8_t>(src[i]);
+				}
+				dst += n;
+				src += n;
+				len -= n;
+				if(*src == 0) break;
+
+				uint32_t code;
+				if(len <= 1 || !get_utf8_(src, code)) {
+					ok = false;
+					break;
+				}
+				if(code >= 0x10000) {
+					if(len <= 2) {
+						ok = false;
 						break;
-					} else if(cnt < 0) {
-						code = 0;
 					}
-				}
-				if(cnt == 0 && code != 0) {
+					code -= 0x10000;
+					*dst++ = 0xd800 | (code >> 10);
+					*dst++ = 0xdc00 | (code & 0x3ff);
+					len -= 2;
+				} else {
 					*dst++ = code;
 					--len;
-					code = 0;
 				}
 			}
 			*dst = 0;
-			return len >= 1;
+			return ok;
 		}
 
 
@@ -217,105 +326,138 @@ namespace utils {
 		//-----------------------------------------------------------------//
 		static uint32_t utf16_to_utf8(uint16_t code, char* dst, uint32_t dsz) noexcept
 		{
-			uint32_t len = 0;
-			if(code < 0x0080) {
-				if(dsz >= 1) {
-					*dst++ = code;
-					len = 1;
-				}
-			} else if(code >= 0x0080 && code <= 0x07ff) {
-				if(dsz >= 2) {
-					*dst++ = 0xc0 | ((code >> 6) & 0x1f);
-					*dst++ = 0x80 | (code & 0x3f);
-					len = 2;
-				}
-			} else if(code >= 0x0800) {
-				if(dsz >= 3) {
-					*dst++ = 0xe0 | ((code >> 12) & 0x0f);
-					*dst++ = 0x80 | ((code >> 6) & 0x3f);
-					*dst++ = 0x80 | (code & 0x3f);
-					len = 3;
-				}
-			}
+			char tmp[4];
+			auto len = put_utf8_(code, tmp);
+			if(dsz < len) return 0;
+			std::memcpy(dst, tmp, len);
 			return len;
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  UTF-16 から UTF-8 への変換
+			@brief  UTF-16 から UTF-8 への変換 @n
+					※サロゲート・ペアは、４バイトの UTF-8 になる
 			@param[in]	src	ソース
 			@param[in]	dst	変換先
 			@param[in]	dsz	変換先のサイズ（バイトサイズ）
-			@return 正常終了なら「true」
+			@return 正常終了なら「true」（対の無いサロゲート、変換先が足りない場合「false」）
 		*/
 		//-----------------------------------------------------------------//
 		static bool utf16_to_utf8(const uint16_t* src, char* dst, uint32_t dsz) noexcept
 		{
 			if(dsz <= 1) return false;
 
-			uint16_t code;
-			while((code = *src++) != 0) {
-				auto len = utf16_to_utf8(code, dst, dsz);
-				if(dsz > len) {
-					dsz -= len;
-					dst += len;
-				} else {
+			bool ok = true;
+			uint32_t code;
+			while((code = *src) != 0) {
+				if(code < 0x80) {  // ASCII
+					if(dsz <= 1) {
+						ok = false;
+						break;
+					}
+					*dst++ = code;
+					--dsz;
+					++src;
+					continue;
+				}
+				uint32_t n = 1;
+				if(0xd800 <= code && code <= 0xdbff) {
+					uint32_t lo = src[1];
+					if(lo < 0xdc00 || lo > 0xdfff) {
+						ok = false;
+						break;
+					}
+					code = 0x10000 + ((code - 0xd800) << 10) + (lo - 0xdc00);
+					n = 2;
+				} else if(0xdc00 <= code && code <= 0xdfff) {
+					ok = false;
 					break;
 				}
+				char tmp[4];
+				auto len = put_utf8_(code, tmp);
+				if(dsz <= len) {
+					ok = false;
+					break;
+				}
+				std::memcpy(dst, tmp, len);
+				dst += len;
+				dsz -= len;
+				src += n;
 			}
 			*dst = 0;
-			return dsz >= 1;
+			return ok;
 		}
 
 #if FF_USE_LFN != 0
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  OEM code から UTF-16 への変換（１文字）@n
+					※CP932 は、直接参照の表（sjis_utf16_tbl.hpp）を先に引く
+			@param[in]	oem	OEM code
+			@return UTF-16 コード（変換出来ない場合０）
+		*/
+		//-----------------------------------------------------------------//
+		static uint16_t oem_to_utf16_(uint16_t oem) noexcept
+		{
+#if defined(FAT_FS) && FF_CODE_PAGE == 932
+			auto code = sjis::to_utf16(oem);
+			if(code != 0xffff) return code;
+#endif
+			return ff_oem2uni(oem, FF_CODE_PAGE);
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  OEM code から UTF-8 への変換
 			@param[in]	src	ソース
 			@param[in]	dst	変換先
 			@param[in]	dsz	変換先のサイズ
-			@return 正常終了なら「true」
+			@return 正常終了なら「true」（不正なコード、変換先が足りない場合「false」）
 		*/
 		//-----------------------------------------------------------------//
 		static bool oemc_to_utf8(const char* src, char* dst, uint32_t dsz) noexcept
 		{
-			if(src == nullptr) return false;
+			if(src == nullptr || dsz == 0) return false;
 
-			uint16_t wc = 0;
-			char ch;
-			while((ch = *src++) != 0 && dsz > 1) {
-				uint8_t c = static_cast<uint8_t>(ch);
-				if(wc) {
-					if(0x40 <= c && c <= 0x7e) {
-						wc <<= 8;
-						wc |= c;
-						uint16_t tmp = ff_oem2uni(wc, FF_CODE_PAGE);
-						auto len = utf16_to_utf8(tmp, dst, dsz);
-						if(len == 0) break;
-						dst += len;
-						dsz -= len;
-					} else if(0x80 <= c && c <= 0xfc) {
-						wc <<= 8;
-						wc |= c;
-						uint16_t tmp = ff_oem2uni(wc, FF_CODE_PAGE);
-						auto len = utf16_to_utf8(tmp, dst, dsz);
-						if(len == 0) break;
-						dst += len;
-						dsz -= len;
-					}
-					wc = 0;
-				} else {
-					if(0x81 <= c && c <= 0x9f) wc = c;
-					else if(0xe0 <= c && c <= 0xfc) wc = c;
-					else {
-						*dst++ = c;
-						dsz -= 1;
+			bool ok = true;
+			while(1) {
+				auto n = ascii_span_(src);
+				if(n >= dsz) n = dsz - 1;
+				std::memcpy(dst, src, n);
+				dst += n;
+				src += n;
+				dsz -= n;
+				uint8_t c = static_cast<uint8_t>(*src);
+				if(c == 0) break;
+
+				uint16_t oem = c;
+				uint32_t m = 1;
+				if((0x81 <= c && c <= 0x9f) || (0xe0 <= c && c <= 0xfc)) {  // ２バイト文字
+					uint8_t t = static_cast<uint8_t>(src[1]);
+					if(t < 0x40 || t > 0xfc || t == 0x7f) {
+						ok = false;
+						break;
 					}
+					oem = (oem << 8) | t;
+					m = 2;
+				}
+				auto code = oem_to_utf16_(oem);
+				char tmp[4];
+				uint32_t len = 0;
+				if(code != 0) len = put_utf8_(code, tmp);
+				if(len == 0 || dsz <= len) {
+					ok = false;
+					break;
 				}
+				std::memcpy(dst, tmp, len);
+				dst += len;
+				dsz -= len;
+				src += m;
 			}
 			*dst = 0;
-			return dsz > 0;
+			return ok;
 		}
 
 
@@ -325,49 +467,40 @@ namespace utils {
 			@param[in]	src	ソース
 			@param[out]	dst	変換先
 			@param[in]	dsz	変換先のサイズ
-			@return 正常終了なら「true」
+			@return 正常終了なら「true」（不正な UTF-8、変換出来ない文字、変換先が足りない場合「false」）
 		*/
 		//-----------------------------------------------------------------//
 		static bool utf8_to_oemc(const char* src, char* dst, uint32_t dsz) noexcept
 		{
-			int8_t cnt = 0;
-			uint16_t code = 0;
-			char tc;
-			while((tc = *src++) != 0) {
-				uint8_t c = static_cast<uint8_t>(tc);
-				if(c < 0x80) {
-					if(dsz <= 1) break;
-					*dst++ = tc;
-					code = 0;
-					--dsz;
-				} else if((c & 0xf0) == 0xe0) {
-					code = (c & 0x0f);
-					cnt = 2;
-				} else if((c & 0xe0) == 0xc0) {
-					code = (c & 0x1f);
-					cnt = 1;
-				} else if((c & 0xc0) == 0x80) {
-					code <<= 6;
-					code |= c & 0x3f;
-					cnt--;
-					if(cnt == 0 && code < 0x80) {
-						code = 0;	// 不正なコードとして無視
-						break;
-					} else if(cnt < 0) {
-						code = 0;
-					}
+			if(dsz == 0) return false;
+
+			bool ok = true;
+			while(1) {
+				auto n = ascii_span_(src);
+				if(n >= dsz) n = dsz - 1;
+				std::memcpy(dst, src, n);
+				dst += n;
+				src += n;
+				dsz -= n;
+				if(*src == 0) break;
+
+				uint32_t code;
+				if(!get_utf8_(src, code)) {
+					ok = false;
+					break;
+				}
+				auto wc = ff_uni2oem(code, FF_CODE_PAGE);
+				uint32_t len = wc >= 0x100 ? 2 : 1;
+				if(wc == 0 || dsz <= len) {
+					ok = false;
+					break;
 				}
-				if(cnt == 0 && code != 0) {
-					if(dsz <= 3) break;
-					auto wc = ff_uni2oem(code, FF_CODE_PAGE);
-					*dst++ = static_cast<char>(wc >> 8);
-					*dst++ = static_cast<char>(wc & 0xff);
-					dsz -= 2;
-					code = 0;
-				}			
+				if(len == 2) *dst++ = static_cast<char>(wc >> 8);
+				*dst++ = static_cast<char>(wc & 0xff);
+				dsz -= len;
 			}
 			*dst = 0;
-			return dsz > 0;
+			return ok;
 		}
 #endif
 
@@ -570,6 +703,7 @@ namespace utils {
 					continue;
 				} else if(bsc) {
 					bsc = false;
+					if(ch == 0) break;  // 行末のバックスラッシュ
 				} else {
 					if(ch == 0) break;
 					if(bc == sch && ch != sch) { 
@@ -610,6 +744,7 @@ namespace utils {
 					continue;
 				} else if(bsc) {
 					bsc = false;
+					if(ch == 0) break;  // 行末のバックスラッシュ
 				} else {
 					if(bc == sch && ch != sch) {
 						if(n == argc) {
@@ -659,6 +794,7 @@ namespace utils {
 					continue;
 				} else if(bsc) {
 					bsc = false;
+					if(ch == 0) break;  // 行末のバックスラッシュ
 				} else {
 					if(bc == sch && ch != sch) {
 						if(n == argc) {
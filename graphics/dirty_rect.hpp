@@ -0,0 +1,233 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ダーティー・レクタングル（更新領域）管理 @n
+			・描画した領域を、最大 N 個の重ならない矩形に統合して記録する @n
+			・重なる、又は接する矩形は１つに統合する @n
+			・N 個を超える場合、面積の増加が最小となる矩形と統合する @n
+			・描画した画素数（矩形面積の累計）を数える
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include "common/vtx.hpp"
+
+namespace graphics {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	ダーティー・レクタングル・クラス
+		@param[in]	N	矩形の最大数
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint32_t N>
+	class dirty_rect {
+
+		static_assert(N > 0, "dirty_rect: N must be greater than zero");
+
+		// 終点を含まない座標（x0 <= x < x1, y0 <= y < y1）
+		struct box_t {
+			int16_t	x0;
+			int16_t	y0;
+			int16_t	x1;
+			int16_t	y1;
+		};
+
+		box_t		box_[N];
+		uint32_t	num_;
+		uint32_t	last_;
+		uint32_t	pixels_;
+
+		static uint32_t area_(const box_t& b) noexcept
+		{
+			return static_cast<uint32_t>(b.x1 - b.x0) * static_cast<uint32_t>(b.y1 - b.y0);
+		}
+
+		static box_t union_(const box_t& a, const box_t& b) noexcept
+		{
+			box_t t;
+			t.x0 = a.x0 < b.x0 ? a.x0 : b.x0;
+			t.y0 = a.y0 < b.y0 ? a.y0 : b.y0;
+			t.x1 = a.x1 > b.x1 ? a.x1 : b.x1;
+			t.y1 = a.y1 > b.y1 ? a.y1 : b.y1;
+			return t;
+		}
+
+		static bool inside_(const box_t& a, const box_t& b) noexcept
+		{
+			return a.x0 <= b.x0 && a.y0 <= b.y0 && b.x1 <= a.x1 && b.y1 <= a.y1;
+		}
+
+		// 重なる、又は接する
+		static bool touch_(const box_t& a, const box_t& b) noexcept
+		{
+			return a.x0 <= b.x1 && b.x0 <= a.x1 && a.y0 <= b.y1 && b.y0 <= a.y1;
+		}
+
+		void remove_(uint32_t idx) noexcept
+		{
+			--num_;
+			box_[idx] = box_[num_];
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクタ
+		*/
+		//-----------------------------------------------------------------//
+		dirty_rect() noexcept : box_{ }, num_(0), last_(0), pixels_(0) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	クリア（画素数もクリアする）
+		*/
+		//-----------------------------------------------------------------//
+		void clear() noexcept
+		{
+			num_ = 0;
+			last_ = 0;
+			pixels_ = 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	矩形の最大数を返す
+			@return 矩形の最大数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t capacity() const noexcept { return N; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	矩形の数を返す
+			@return 矩形の数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t size() const noexcept { return num_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	空か検査
+			@return 空なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool empty() const noexcept { return num_ == 0; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	矩形を取得
+			@param[in]	idx	位置
+			@return 矩形
+		*/
+		//-----------------------------------------------------------------//
+		vtx::srect get(uint32_t idx) const noexcept
+		{
+			const auto& b = box_[idx];
+			return vtx::srect(b.x0, b.y0, b.x1 - b.x0, b.y1 - b.y0);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	追加された画素数（矩形面積の累計）を返す @n
+					※重なって描画された画素も数える
+			@return 画素数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_pixels() const noexcept { return pixels_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	更新領域の画素数（矩形面積の合計）を返す
+			@return 画素数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_area() const noexcept
+		{
+			uint32_t a = 0;
+			for(uint32_t i = 0; i < num_; ++i) {
+				a += area_(box_[i]);
+			}
+			return a;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	領域を追加（終点を含まない座標）
+			@param[in]	x0	開始位置Ｘ
+			@param[in]	y0	開始位置Ｙ
+			@param[in]	x1	終了位置Ｘ
+			@param[in]	y1	終了位置Ｙ
+		*/
+		//-----------------------------------------------------------------//
+		void add(int16_t x0, int16_t y0, int16_t x1, int16_t y1) noexcept
+		{
+			if(x0 >= x1 || y0 >= y1) return;
+
+			box_t t = { x0, y0, x1, y1 };
+			pixels_ += area_(t);
+
+			// 直前に追加した矩形に含まれる場合が多い
+			if(last_ < num_ && inside_(box_[last_], t)) return;
+			for(uint32_t i = 0; i < num_; ++i) {
+				if(inside_(box_[i], t)) {
+					last_ = i;
+					return;
+				}
+			}
+
+			while(1) {
+				uint32_t i = 0;
+				while(i < num_) {
+					if(touch_(box_[i], t)) {
+						t = union_(box_[i], t);
+						remove_(i);
+						i = 0;
+					} else {
+						++i;
+					}
+				}
+				if(num_ < N) break;
+
+				// 一杯の場合、面積の増加が最小の矩形と統合
+				uint32_t idx = 0;
+				uint32_t min = 0xffffffff;
+				for(uint32_t j = 0; j < num_; ++j) {
+					auto a = area_(union_(box_[j], t)) - area_(box_[j]);
+					if(a < min) {
+						min = a;
+						idx = j;
+					}
+				}
+				t = union_(box_[idx], t);
+				remove_(idx);
+			}
+			last_ = num_;
+			box_[num_] = t;
+			++num_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	領域を追加
+			@param[in]	rect	矩形
+		*/
+		//-----------------------------------------------------------------//
+		void add(const vtx::srect& rect) noexcept
+		{
+			add(rect.org.x, rect.org.y, rect.end_x(), rect.end_y());
+		}
+	};
+}
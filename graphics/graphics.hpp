@@ -11,11 +11,15 @@
 #include "graphics/pixel.hpp"
 #include "graphics/color.hpp"
 #include "graphics/font.hpp"
+#include "graphics/tri_raster.hpp"
+#include "graphics/dirty_rect.hpp"
 #include "common/intmath.hpp"
 #include "common/circle.hpp"
 #include "common/vtx.hpp"
 
 #include <cmath>
+#include <cstring>
+#include <algorithm>
 
 namespace graphics {
 
@@ -42,6 +46,12 @@ namespace graphics {
 		typedef share_color SHARE_COLOR;
 		typedef GLC glc_type;
 		typedef FONT font_type;
+		typedef tri_raster<GLC::line_width> RASTER;
+
+		static constexpr uint32_t TEXTURE_RGBA8888 = 0;	///< set_texture のフォーマット（DRW2D 互換）
+
+		static constexpr uint32_t DIRTY_NUM = 16;	///< 更新領域の最大矩形数
+		typedef dirty_rect<DIRTY_NUM> DIRTY;
 
 ///		static const int16_t line_offset = (((GLC::width * sizeof(T)) + 63) & 0x7fc0) / sizeof(T);
 
@@ -59,6 +69,37 @@ namespace graphics {
 
 		vtx::spos	ofs_;
 
+		RASTER		raster_;
+		int16_t		pen_size_;
+		vtx::spos	tex_size_;
+
+		DIRTY		dirty_;
+		bool		dirty_ena_;
+		bool		dirty_all_;
+		uint32_t	frame_pixels_;
+		uint32_t	frame_area_;
+		uint32_t	copy_pixels_;
+
+		// 更新領域の記録（画面の範囲に制限する）
+		void damage_(int32_t x0, int32_t y0, int32_t x1, int32_t y1) noexcept
+		{
+			if(!dirty_ena_) return;
+			x0 = std::max<int32_t>(x0, 0);
+			y0 = std::max<int32_t>(y0, 0);
+			x1 = std::min<int32_t>(x1, GLC::width);
+			y1 = std::min<int32_t>(y1, GLC::height);
+			dirty_.add(x0, y0, x1, y1);
+		}
+
+		// フレームの終わり（画素数を集計して、更新領域の記録をクリアする）
+		void end_frame_() noexcept
+		{
+			frame_pixels_ = dirty_.get_pixels();
+			frame_area_ = dirty_.get_area();
+			dirty_.clear();
+		}
+
+
 		// 1/8 円を拡張して、全周に点を打つ
 		void circle_pset_(const vtx::spos& cen, const vtx::spos& pos) noexcept
 		{
@@ -85,6 +126,185 @@ namespace graphics {
 			plot(vtx::spos(cen.x + org.x + ofs.x, cen.y - org.y        ), fore_color_.rgb565);
 		}
 
+
+		// カバレッジ（0 to 255）で、フォア・カラーを混ぜて点を打つ
+		void blend_plot_(int32_t x, int32_t y, uint32_t alpha) noexcept
+		{
+			if(alpha == 0) return;
+			if(x < clip_.org.x || x >= clip_.end_x()) return;
+			if(y < clip_.org.y || y >= clip_.end_y()) return;
+			T& d = fb_[y * GLC::line_width + x];
+			if(alpha >= 255) {
+				d = fore_color_.rgb565;
+			} else {
+				auto c = share_color::blend(fore_color_.rgba8.unit, alpha, share_color::conv_rgba8(d));
+				d = share_color::to_565(c.r, c.g, c.b);
+			}
+			if(dirty_ena_) dirty_.add(x, y, x + 1, y + 1);
+		}
+
+
+		static int64_t sq_(int32_t v) noexcept { return static_cast<int64_t>(v) * v; }
+
+
+		// ３２ビットに収まる場合は sqrt32（半径が約 720 画素を超えると、２乗が 32 ビットを超える）
+		static int32_t sqrt_(int64_t v) noexcept
+		{
+			if(v <= 0) return 0;
+			if(v <= 0xffffffff) return intmath::sqrt32(static_cast<uint32_t>(v)).val;
+			return intmath::sqrt64(static_cast<uint64_t>(v)).val;
+		}
+
+
+		// 角が丸い矩形のカバレッジ描画（座標、半径は小数６ビット、画素の中心は +32）
+		// fill: 「true」なら塗りつぶし、「false」なら幅１画素の枠
+		void round_aa_(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t r, bool fill) noexcept
+		{
+			int32_t cx0 = x0 + r;
+			int32_t cx1 = x1 - r;
+			int32_t cy0 = y0 + r;
+			int32_t cy1 = y1 - r;
+			// 内側の範囲（fill: 全て覆う、枠: 全く覆わない）、外側の範囲（覆う画素がある）
+			int32_t ri = fill ? r - 32 : r - 96;
+			int32_t ro = r + 32;
+			// 半径が８画素以上の場合、輪郭（rc）の近くでは d = rc + (d^2 - rc^2) / 2rc で近似する
+			// （平方根を省く、誤差は 1/16 画素以下）
+			int32_t rc = fill ? r : r - 32;
+			int64_t inv = rc >= 512 ? (static_cast<int64_t>(1) << 32) / (rc * 2) : 0;
+
+			int32_t iy0 = std::max<int32_t>(y0 >> 6, clip_.org.y);
+			int32_t iy1 = std::min<int32_t>((y1 + 63) >> 6, clip_.end_y());
+			int32_t ix0 = std::max<int32_t>(x0 >> 6, clip_.org.x);
+			int32_t ix1 = std::min<int32_t>((x1 + 63) >> 6, clip_.end_x());
+			for(int32_t y = iy0; y < iy1; ++y) {
+				int32_t py = y * 64 + 32;
+				int32_t dy = std::max<int32_t>(std::max<int32_t>(cy0 - py, py - cy1), 0);
+				if(dy >= ro) continue;
+				int32_t so = sqrt_(sq_(ro) - sq_(dy)) + 1;
+				int32_t ox0 = std::max<int32_t>((cx0 - so - 32) >> 6, ix0);
+				int32_t ox1 = std::min<int32_t>(((cx1 + so - 32) >> 6) + 1, ix1);
+				int32_t sx0 = ox1;
+				int32_t sx1 = ox1;
+				if(ri >= 0 && dy <= ri) {
+					int32_t s = sqrt_(sq_(ri) - sq_(dy));
+					sx0 = -((32 - (cx0 - s)) >> 6);  // ceil
+					sx1 = ((cx1 + s - 32) >> 6) + 1;
+					sx0 = std::max(sx0, ox0);
+					sx1 = std::min(sx1, ox1);
+					if(sx0 > sx1) sx0 = sx1;
+				}
+				if(fill && sx0 < sx1) {
+					T* out = &fb_[y * GLC::line_width + sx0];
+					fill_span_(out, sx1 - sx0, fore_color_.rgb565);
+					damage_(sx0, y, sx1, y + 1);
+				}
+				for(int32_t x = ox0; x < ox1; ++x) {
+					if(x == sx0 && sx0 < sx1) {
+						x = sx1 - 1;
+						continue;
+					}
+					int32_t px = x * 64 + 32;
+					int32_t dx = std::max<int32_t>(std::max<int32_t>(cx0 - px, px - cx1), 0);
+					int32_t d;
+					if(dx == 0 && dy == 0) {  // 内側の矩形では、近い辺までの距離（負）
+						d = -std::min(std::min(px - cx0, cx1 - px), std::min(py - cy0, cy1 - py));
+					} else if(dx == 0) d = dy;
+					else if(dy == 0) d = dx;
+					else if(inv != 0) d = rc + static_cast<int32_t>(((sq_(dx) + sq_(dy) - sq_(rc)) * inv) >> 32);
+					else d = sqrt_(sq_(dx) + sq_(dy));
+					int32_t c;
+					if(fill) {
+						c = r + 32 - d;
+					} else {
+						c = d - (r - 32);
+						c = 64 - (c < 0 ? -c : c);
+					}
+					if(c <= 0) continue;
+					blend_plot_(x, y, c >= 64 ? 255 : (c << 2));
+				}
+			}
+		}
+
+
+		// ２画素まとめて（32 ビット）書き込む
+		static void fill_span_(T* out, int32_t n, T c) noexcept
+		{
+			if(n <= 0) return;
+			if((reinterpret_cast<uintptr_t>(out) & 2) != 0) {
+				*out++ = c;
+				--n;
+			}
+			uint32_t c2 = (static_cast<uint32_t>(c) << 16) | c;
+			uint32_t* o = reinterpret_cast<uint32_t*>(out);
+			while(n >= 8) {
+				o[0] = c2;
+				o[1] = c2;
+				o[2] = c2;
+				o[3] = c2;
+				o += 4;
+				n -= 8;
+			}
+			while(n >= 2) {
+				*o++ = c2;
+				n -= 2;
+			}
+			if(n != 0) *reinterpret_cast<T*>(o) = c;
+		}
+
+
+		// bit 位置から n ビット（最大８）を取り出す（LSB が先の画素）
+		static uint32_t get_bits_(const uint8_t* p, uint32_t bit, uint32_t n) noexcept
+		{
+			p += bit >> 3;
+			uint32_t s = bit & 7;
+			uint32_t v = p[0] >> s;
+			if((s + n) > 8) v |= static_cast<uint32_t>(p[1]) << (8 - s);
+			return v & ((1 << n) - 1);
+		}
+
+
+		// １ビット画像の１ライン（背景も描く）、２ビット毎に２画素の表を引く
+		static void blit_span_(T* out, const uint8_t* src, uint32_t bit, int32_t n, const T (&lut)[4][2]) noexcept
+		{
+			while(n >= 8) {
+				auto b = get_bits_(src, bit, 8);
+				std::memcpy(&out[0], lut[b & 3], sizeof(T) * 2);
+				std::memcpy(&out[2], lut[(b >> 2) & 3], sizeof(T) * 2);
+				std::memcpy(&out[4], lut[(b >> 4) & 3], sizeof(T) * 2);
+				std::memcpy(&out[6], lut[b >> 6], sizeof(T) * 2);
+				out += 8;
+				bit += 8;
+				n -= 8;
+			}
+			if(n > 0) {
+				auto b = get_bits_(src, bit, n);
+				for(int32_t i = 0; i < n; ++i) {
+					out[i] = lut[(b >> i) & 1][0];
+				}
+			}
+		}
+
+
+		// １ビット画像の１ライン（１のビットだけ描く）
+		static void blit_span_(T* out, const uint8_t* src, uint32_t bit, int32_t n, T c) noexcept
+		{
+			while(n > 0) {
+				uint32_t l = n < 8 ? n : 8;
+				auto b = get_bits_(src, bit, l);
+				if(b == 0xff) {
+					fill_span_(out, 8, c);
+				} else {
+					while(b != 0) {
+						out[__builtin_ctz(b)] = c;
+						b &= b - 1;
+					}
+				}
+				out += l;
+				bit += l;
+				n -= l;
+			}
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -96,7 +316,9 @@ namespace graphics {
 		render(GLC& glc, FONT& font) noexcept : glc_(glc), font_(font),
 			fore_color_(255, 255, 255), back_color_(0, 0, 0),
 			clip_(0, 0, GLC::width, GLC::height),
-			stipple_(-1), stipple_mask_(1), ofs_(0)
+			stipple_(-1), stipple_mask_(1), ofs_(0),
+			raster_(), pen_size_(16), tex_size_(0),
+			dirty_(), dirty_ena_(false), dirty_all_(false), frame_pixels_(0), frame_area_(0), copy_pixels_(0)
 		{
 			fb_ = static_cast<T*>(glc_.get_fbp());
 		}
@@ -135,7 +357,9 @@ namespace graphics {
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	フレームの同期
+			@brief	フレームの同期 @n
+					※シングルバッファで更新領域の記録が有効な場合、画素数を集計して記録をクリアする @n
+					（ダブルバッファでは、flip で転送した後に行う）
 			@param[in]	vsync	垂直同期を行わない場合「false」
 		*/
 		//-----------------------------------------------------------------//
@@ -143,6 +367,7 @@ namespace graphics {
 		{
 			if(vsync) glc_.sync_vpos();
 			fb_ = static_cast<T*>(glc_.get_fbp());
+			if(dirty_ena_ && !glc_.is_double_buffer()) end_frame_();
 		}
 
 
@@ -157,17 +382,105 @@ namespace graphics {
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  バッファの FLIP
+			@brief  バッファの FLIP @n
+					※更新領域の記録が有効な場合、記録した領域を次のバッファへ転送し、@n
+					画素数を集計して記録をクリアする
 		*/
 		//-----------------------------------------------------------------//
 		void flip() noexcept
 		{
-			if(glc_.is_double_buffer()) {
+			if(!glc_.is_double_buffer()) return;
+
+			if(!dirty_ena_) {
 				glc_.flip();
+				return;
 			}
+
+			// 更新領域だけを、次に描画するバッファへ転送する
+			const T* src = fb_;
+			glc_.flip();
+			fb_ = static_cast<T*>(glc_.get_fbp());
+			copy_pixels_ = 0;
+			if(src == fb_) {
+				end_frame_();
+				return;
+			}
+			if(dirty_all_) {
+				dirty_all_ = false;
+				std::memcpy(fb_, src, sizeof(T) * GLC::line_width * GLC::height);
+				copy_pixels_ = GLC::line_width * GLC::height;
+			} else {
+				for(uint32_t i = 0; i < dirty_.size(); ++i) {
+					auto r = dirty_.get(i);
+					auto ofs = r.org.y * GLC::line_width + r.org.x;
+					for(int16_t y = 0; y < r.size.y; ++y) {
+						std::memcpy(&fb_[ofs], &src[ofs], sizeof(T) * r.size.x);
+						ofs += GLC::line_width;
+					}
+					copy_pixels_ += static_cast<uint32_t>(r.size.x) * static_cast<uint32_t>(r.size.y);
+				}
+			}
+			end_frame_();
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	更新領域の記録を有効にする @n
+					※描画した領域を記録し、flip では更新領域だけを転送する @n
+					※有効にした直後の flip では、全画面を転送する
+			@param[in]	ena		無効にする場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		void enable_dirty(bool ena = true) noexcept
+		{
+			dirty_ena_ = ena;
+			dirty_all_ = ena;
+			dirty_.clear();
+			frame_pixels_ = 0;
+			frame_area_ = 0;
+			copy_pixels_ = 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	更新領域の参照
+			@return 更新領域
+		*/
+		//-----------------------------------------------------------------//
+		const DIRTY& get_dirty() const noexcept { return dirty_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	前フレームで描画した画素数を取得 @n
+					※flip（シングルバッファでは sync_frame）で集計する
+			@return 画素数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_frame_pixels() const noexcept { return frame_pixels_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	前フレームの更新領域の画素数を取得 @n
+					※flip（シングルバッファでは sync_frame）で集計する
+			@return 画素数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_frame_area() const noexcept { return frame_area_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	直前の flip で転送した画素数を取得
+			@return 画素数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_copy_pixels() const noexcept { return copy_pixels_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	停止 @n
@@ -278,6 +591,7 @@ namespace graphics {
 			if(pos.x >= clip_.end_x()) return false;
 			if(pos.y >= clip_.end_y()) return false;
 			fb_[pos.y * GLC::line_width + pos.x] = c;
+			if(dirty_ena_) dirty_.add(pos.x, pos.y, pos.x + 1, pos.y + 1);
 			return true;
 		}
 
@@ -340,6 +654,7 @@ namespace graphics {
 			if((x + w) >= (clip_.end_x() << 4)) {
 				w = (clip_.end_x() << 4) - x;
 			}
+			damage_(x >> 4, y >> 4, (std::max<int32_t>(x + w, x) >> 4) + 1, (y >> 4) + 1);
 			uint16_t* out = &fb_[(y >> 4) * GLC::line_width + (x >> 4)];
 			auto end = x + w;
 			if(w < 16) {
@@ -383,20 +698,27 @@ namespace graphics {
 		void line_v(int16_t x, int16_t y, int16_t h) noexcept
 		{
 			if(h <= 0) return;
-			if(static_cast<uint16_t>(x) >= static_cast<uint16_t>(GLC::width)) return;
-			if(y < 0) {
-				h += y;
-				y = 0;
-			} else if(static_cast<uint16_t>(y) >= static_cast<uint16_t>(GLC::height)) {
-				return;
-			}
-			if(static_cast<uint16_t>(y + h) >= static_cast<uint16_t>(GLC::height)) {
-				h = GLC::height - y;
+			if(x < clip_.org.x || x >= clip_.end_x()) return;
+			int32_t y0 = std::max<int32_t>(y, clip_.org.y);
+			int32_t y1 = std::min<int32_t>(y + h, clip_.end_y());
+			if(y0 >= y1) return;
+			damage_(x, y0, x + 1, y1);
+
+			auto c = fore_color_.rgb565;
+			uint16_t* out = &fb_[y0 * GLC::line_width + x];
+			int32_t n = y1 - y0;
+			while(n >= 4) {
+				out[0] = c;
+				out[GLC::line_width * 1] = c;
+				out[GLC::line_width * 2] = c;
+				out[GLC::line_width * 3] = c;
+				out += GLC::line_width * 4;
+				n -= 4;
 			}
-			uint16_t* out = &fb_[y * GLC::line_width + x];
-			for(int16_t i = 0; i < h; ++i) {
-				*out = fore_color_.rgb565;
+			while(n > 0) {
+				*out = c;
 				out += GLC::line_width;
+				--n;
 			}
 		}
 
@@ -411,8 +733,17 @@ namespace graphics {
 		{
 			if(rect.size.x <= 0 || rect.size.y <= 0) return;
 
-			for(int16_t yy = rect.org.y; yy < (rect.org.y + rect.size.y); ++yy) {
-				line_h(yy << 4, rect.org.x << 4, rect.size.x << 4);
+			int32_t x0 = std::max<int32_t>(rect.org.x, clip_.org.x);
+			int32_t y0 = std::max<int32_t>(rect.org.y, clip_.org.y);
+			int32_t x1 = std::min<int32_t>(rect.org.x + rect.size.x, clip_.end_x());
+			int32_t y1 = std::min<int32_t>(rect.org.y + rect.size.y, clip_.end_y());
+			if(x0 >= x1 || y0 >= y1) return;
+			damage_(x0, y0, x1, y1);
+
+			T* out = &fb_[y0 * GLC::line_width + x0];
+			for(int32_t y = y0; y < y1; ++y) {
+				fill_span_(out, x1 - x0, fore_color_.rgb565);
+				out += GLC::line_width;
 			}
 		}
 
@@ -425,6 +756,7 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		void clear(const share_color& c) noexcept
 		{
+			damage_(0, 0, GLC::width, GLC::height);
 			uint32_t c32 = (static_cast<uint32_t>(c.rgb565) << 16) | c.rgb565;
 			uint32_t* out = reinterpret_cast<uint32_t*>(fb_);
 			for(uint32_t i = 0; i < (GLC::width * GLC::height) / 32; ++i) {
@@ -506,6 +838,139 @@ namespace graphics {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	三角形ラスタライザーの参照 @n
+					※シェーディング、深度バッファ、パースペクティブ補正の設定
+			@return 三角形ラスタライザー
+		*/
+		//-----------------------------------------------------------------//
+		RASTER& at_raster() noexcept { return raster_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	線幅の設定（DRW2D 互換）
+			@param[in]	size	線幅（小数４ビット）
+		*/
+		//-----------------------------------------------------------------//
+		void set_pen_size(int16_t size) noexcept { pen_size_ = size; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	テクスチャーの設定（DRW2D 互換）
+			@param[in]	image	RGBA8888 画像
+			@param[in]	size	画像サイズ（２のべき乗）
+			@param[in]	form	画像フォーマット（TEXTURE_RGBA8888 のみ）
+		*/
+		//-----------------------------------------------------------------//
+		void set_texture(const void* image, const vtx::spos& size, uint32_t form = TEXTURE_RGBA8888) noexcept
+		{
+			if(form != TEXTURE_RGBA8888) return;
+			raster_.set_texture(image, size.x, size.y);
+			tex_size_ = size;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	三角形の描画（頂点の属性を使う）
+			@param[in]	v0		頂点０
+			@param[in]	v1		頂点１
+			@param[in]	v2		頂点２
+			@param[in]	texture	テクスチャーを使う場合「true」
+			@return 面積が無い場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool triangle(const typename RASTER::vertex& v0, const typename RASTER::vertex& v1,
+			const typename RASTER::vertex& v2, bool texture = false) noexcept
+		{
+			raster_.set_color(fore_color_.rgb565);
+			if(!raster_.draw(fb_, clip_, v0, v1, v2, texture)) return false;
+			if(dirty_ena_) {
+				auto x0 = std::min(v0.x, std::min(v1.x, v2.x)) >> 4;
+				auto y0 = std::min(v0.y, std::min(v1.y, v2.y)) >> 4;
+				auto x1 = (std::max(v0.x, std::max(v1.x, v2.x)) >> 4) + 1;
+				auto y1 = (std::max(v0.y, std::max(v1.y, v2.y)) >> 4) + 1;
+				damage_(x0, y0, x1, y1);
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	三角形の描画（DRW2D 互換） @n
+					※テクスチャーは、画面座標で１画素が１テクセル
+			@param[in]	p0		頂点０（小数４ビット）
+			@param[in]	p1		頂点１（小数４ビット）
+			@param[in]	p2		頂点２（小数４ビット）
+			@param[in]	texture	テクスチャーを使う場合「true」
+			@return 面積が無い場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool triangle_d(const vtx::spos& p0, const vtx::spos& p1, const vtx::spos& p2, bool texture = false) noexcept
+		{
+			typename RASTER::vertex v[3] = { { p0.x, p0.y }, { p1.x, p1.y }, { p2.x, p2.y } };
+			if(texture && tex_size_.x > 0 && tex_size_.y > 0) {
+				for(auto& t : v) {
+					t.u = static_cast<float>(t.x) / static_cast<float>(tex_size_.x << 4);
+					t.v = static_cast<float>(t.y) / static_cast<float>(tex_size_.y << 4);
+				}
+			}
+			return triangle(v[0], v[1], v[2], texture);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	四角形の描画（DRW2D 互換） @n
+					※２つの三角形（p0, p1, p2）、（p0, p2, p3）で描画
+			@param[in]	p0		頂点０（小数４ビット）
+			@param[in]	p1		頂点１（小数４ビット）
+			@param[in]	p2		頂点２（小数４ビット）
+			@param[in]	p3		頂点３（小数４ビット）
+			@param[in]	texture	テクスチャーを使う場合「true」
+			@return 面積が無い場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool quad_d(const vtx::spos& p0, const vtx::spos& p1, const vtx::spos& p2, const vtx::spos& p3,
+			bool texture = false) noexcept
+		{
+			bool a = triangle_d(p0, p1, p2, texture);
+			bool b = triangle_d(p0, p2, p3, texture);
+			return a || b;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	線の描画（DRW2D 互換） @n
+					※線幅が１画素を超える場合、四角形で描画する
+			@param[in]	org		開始位置（小数４ビット）
+			@param[in]	end		終端位置（小数４ビット）
+			@return 長さが無い場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool line_d(const vtx::spos& org, const vtx::spos& end) noexcept
+		{
+			if(pen_size_ <= 16) {
+				line(vtx::spos(org.x >> 4, org.y >> 4), vtx::spos(end.x >> 4, end.y >> 4));
+				return true;
+			}
+			float dx = end.x - org.x;
+			float dy = end.y - org.y;
+			float len = vtx::fsqrt(dx * dx + dy * dy);
+			if(len <= 0.0f) return false;
+			float k = static_cast<float>(pen_size_) * 0.5f / len;
+			int16_t nx = static_cast<int16_t>(-dy * k);
+			int16_t ny = static_cast<int16_t>( dx * k);
+			return quad_d(vtx::spos(org.x + nx, org.y + ny), vtx::spos(end.x + nx, end.y + ny),
+				vtx::spos(end.x - nx, end.y - ny), vtx::spos(org.x - nx, org.y - ny));
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	フレーム（線の箱）を描画する
@@ -722,6 +1187,119 @@ namespace graphics {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	アンチエイリアスした線を描画する（Wu のアルゴリズム） @n
+					※画素の中心は +8、下地の色と混ぜる
+			@param[in]	org		開始点（小数４ビット）
+			@param[in]	end		終了点（小数４ビット）
+		*/
+		//-----------------------------------------------------------------//
+		void line_aa(const vtx::spos& org, const vtx::spos& end) noexcept
+		{
+			int32_t x0 = org.x;
+			int32_t y0 = org.y;
+			int32_t x1 = end.x;
+			int32_t y1 = end.y;
+			bool steep = std::abs(y1 - y0) > std::abs(x1 - x0);
+			if(steep) {
+				std::swap(x0, y0);
+				std::swap(x1, y1);
+			}
+			if(x0 > x1) {
+				std::swap(x0, x1);
+				std::swap(y0, y1);
+			}
+			int32_t dx = x1 - x0;
+			if(dx == 0) {  // 長さが無い場合、１画素
+				if(steep) blend_plot_(y0 >> 4, x0 >> 4, 255);
+				else blend_plot_(x0 >> 4, y0 >> 4, 255);
+				return;
+			}
+			// 傾き（16.16）、Y は画素の中心での位置（16.16）
+			int32_t grad = static_cast<int64_t>(y1 - y0) * 65536 / dx;
+			int32_t px0 = x0 >> 4;
+			int32_t px1 = (x1 - 1) >> 4;
+			int32_t y = y0 * 4096 + (((px0 * 16 + 8 - x0) * grad) >> 4) - 0x8000;
+			for(int32_t px = px0; px <= px1; ++px) {
+				// 端点の画素は、覆う長さで薄くする
+				int32_t w = std::min(px * 16 + 16, x1) - std::max(px * 16, x0);
+				int32_t iy = y >> 16;
+				uint32_t f = (y >> 8) & 0xff;
+				uint32_t a0 = ((255 - f) * w) >> 4;
+				uint32_t a1 = (f * w) >> 4;
+				if(steep) {
+					blend_plot_(iy, px, a0);
+					blend_plot_(iy + 1, px, a1);
+				} else {
+					blend_plot_(px, iy, a0);
+					blend_plot_(px, iy + 1, a1);
+				}
+				y += grad;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	アンチエイリアスした円（線）を描画する
+			@param[in]	cen	中心位置
+			@param[in]	rad	半径
+		*/
+		//-----------------------------------------------------------------//
+		void circle_aa(const vtx::spos& cen, int16_t rad) noexcept
+		{
+			if(rad < 0) return;
+			round_aa_((cen.x - rad) * 64, (cen.y - rad) * 64, (cen.x + rad + 1) * 64, (cen.y + rad + 1) * 64,
+				rad * 64 + 32, false);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	アンチエイリアスした円を描画する
+			@param[in]	cen	中心位置
+			@param[in]	rad	半径
+		*/
+		//-----------------------------------------------------------------//
+		void fill_circle_aa(const vtx::spos& cen, int16_t rad) noexcept
+		{
+			if(rad < 0) return;
+			round_aa_((cen.x - rad) * 64, (cen.y - rad) * 64, (cen.x + rad + 1) * 64, (cen.y + rad + 1) * 64,
+				rad * 64 + 32, true);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	アンチエイリアスした、角がラウンドしたフレーム（線）を描画する
+			@param[in]	rect	短形を指定
+			@param[in]	rad		ラウンドの半径
+		*/
+		//-----------------------------------------------------------------//
+		void round_frame_aa(const vtx::srect& rect, int16_t rad) noexcept
+		{
+			if(rect.size.x <= 0 || rect.size.y <= 0) return;
+			rad = std::max<int16_t>(std::min<int16_t>(rad, std::min(rect.size.x, rect.size.y) / 2), 1);
+			round_aa_(rect.org.x * 64, rect.org.y * 64, rect.end_x() * 64, rect.end_y() * 64, rad * 64, false);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	アンチエイリアスした、角がラウンドした塗りつぶされた箱を描画する
+			@param[in]	rect	短形を指定
+			@param[in]	rad		ラウンドの半径
+		*/
+		//-----------------------------------------------------------------//
+		void round_box_aa(const vtx::srect& rect, int16_t rad) noexcept
+		{
+			if(rect.size.x <= 0 || rect.size.y <= 0) return;
+			rad = std::max<int16_t>(std::min<int16_t>(rad, std::min(rect.size.x, rect.size.y) / 2), 1);
+			round_aa_(rect.org.x * 64, rect.org.y * 64, rect.end_x() * 64, rect.end_y() * 64, rad * 64, true);
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	スクロール
@@ -730,16 +1308,14 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		void scroll(int16_t h) noexcept
 		{
+			if(h >= GLC::height || h <= -GLC::height) return;
+			damage_(0, 0, GLC::width, GLC::height);
 			if(h > 0) {
-				for(int32_t i = 0; i < (GLC::line_width * (GLC::height - h)); ++i) {
-					fb_[i] = fb_[i + (GLC::line_width * h)];
-				}
+				std::memmove(&fb_[0], &fb_[GLC::line_width * h], sizeof(T) * GLC::line_width * (GLC::height - h));
 			} else if(h < 0) {
 				h = -h;
-				for(int32_t i = (GLC::line_width * (GLC::height - h)) - 1; i >= 0; --i) {
-					fb_[i + (GLC::line_width * h)] = fb_[i];
-				}
-			}			
+				std::memmove(&fb_[GLC::line_width * h], &fb_[0], sizeof(T) * GLC::line_width * (GLC::height - h));
+			}
 		}
 
 
@@ -752,11 +1328,20 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		void move(const vtx::srect& src, const vtx::spos& dst) noexcept
 		{
-			for(int16_t y = 0; y < src.size.y; ++y) {
-				auto* d = &fb_[dst.x + (dst.y + y) * GLC::line_width];
-				const auto* s = &fb_[src.org.x + (src.org.y + y) * GLC::line_width];
-				for(int16_t x = src.org.x; x < src.end_x(); ++x) {
-					*d++ = *s++;
+			if(src.size.x <= 0 || src.size.y <= 0) return;
+			damage_(dst.x, dst.y, dst.x + src.size.x, dst.y + src.size.y);
+
+			// 重なる場合に壊さないよう、下へ移動する時は下のラインから転送
+			auto len = sizeof(T) * src.size.x;
+			if(dst.y > src.org.y) {
+				for(int16_t y = src.size.y - 1; y >= 0; --y) {
+					std::memmove(&fb_[dst.x + (dst.y + y) * GLC::line_width],
+						&fb_[src.org.x + (src.org.y + y) * GLC::line_width], len);
+				}
+			} else {
+				for(int16_t y = 0; y < src.size.y; ++y) {
+					std::memmove(&fb_[dst.x + (dst.y + y) * GLC::line_width],
+						&fb_[src.org.x + (src.org.y + y) * GLC::line_width], len);
 				}
 			}
 		}
@@ -775,23 +1360,33 @@ namespace graphics {
 		noexcept {
 			if(img == nullptr) return;
 
-			const uint8_t* p = static_cast<const uint8_t*>(img);
-			uint8_t k = 1;
-			uint8_t c = *p++;
-			vtx::spos loc = pos;
-			for(uint8_t i = 0; i < ssz.y; ++i) {
-				loc.x = pos.x;
-				for(uint8_t j = 0; j < ssz.x; ++j) {
-					if(c & k) fast_plot(loc, fore_color_.rgb565);
-					else if(back) fast_plot(loc, back_color_.rgb565);
-					k <<= 1;
-					if(k == 0) {
-						k = 1;
-						c = *p++;
-					}
-					++loc.x;
+			// クリップは一度だけ行い、ライン単位で描画する
+			int32_t x0 = std::max<int32_t>(pos.x, clip_.org.x);
+			int32_t y0 = std::max<int32_t>(pos.y, clip_.org.y);
+			int32_t x1 = std::min<int32_t>(pos.x + ssz.x, clip_.end_x());
+			int32_t y1 = std::min<int32_t>(pos.y + ssz.y, clip_.end_y());
+			if(x0 >= x1 || y0 >= y1) return;
+			damage_(x0, y0, x1, y1);
+
+			const uint8_t* src = static_cast<const uint8_t*>(img);
+			uint32_t bit = (y0 - pos.y) * ssz.x + (x0 - pos.x);
+			int32_t n = x1 - x0;
+			T* out = &fb_[y0 * GLC::line_width + x0];
+			if(back) {
+				auto f = fore_color_.rgb565;
+				auto b = back_color_.rgb565;
+				const T lut[4][2] = { { b, b }, { f, b }, { b, f }, { f, f } };
+				for(int32_t y = y0; y < y1; ++y) {
+					blit_span_(out, src, bit, n, lut);
+					bit += ssz.x;
+					out += GLC::line_width;
+				}
+			} else {
+				for(int32_t y = y0; y < y1; ++y) {
+					blit_span_(out, src, bit, n, fore_color_.rgb565);
+					bit += ssz.x;
+					out += GLC::line_width;
 				}
-				++loc.y;
 			}
 		}
 
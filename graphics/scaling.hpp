@@ -10,6 +10,8 @@
 //=====================================================================//
 #include <cstdint>
 #include <cmath>
+#include <cstring>
+#include <algorithm>
 #include "common/vtx.hpp"
 #include "graphics/color.hpp"
 // #include <unordered_map>
@@ -37,209 +39,6 @@ namespace img {
 //		typedef std::unordered_map<uint32_t, xy_pad> MAP;
 //		MAP			map_;
 
-#if 0
-		static float sinc_(float l)
-		{
-			return std::sin(vtx::get_pi<float>() * l) / (vtx::get_pi<float>() * l);
-		}
-
-
-		static float lanczos_(float d, float n)
-		{
-			if(d == 0.0f) {
-				return 1.0f;
-			} else if(std::abs(d) >= n) {
-				return 0.0f;
-			} else {
-				return sinc_(d) * sinc_(d / n);
-			}
-		}
-
-
-		float lanczos_tbl_[(12 + 1) * (12 + 1)];
-		float lanczos_n_;
-		// -3.0, -2.5, -2.0, -1.5, -1.0, -0.5, 0.0, 0.5, 1.0, 1.5, 2.0, 2.5, 3.0
-		void init_lanczos_(float n)
-		{
-			if(lanczos_n_ == n) return;
-
-			float y = -3.0f;
-			for(int i = 0; i < (12 + 1); ++i) {
-				float yl = lanczos_(y, n);
-				float x = -3.0f;
-				for(int j = 0; j < (12 + 1); ++j) {
-					float xl = lanczos_(x, n);
-					lanczos_tbl_[i * (12 + 1) + j] = xl * yl;
-					x += 0.5f;
-				}
-				y += 0.5f;
-			}
-			lanczos_n_ = n;
-		}
-
-
-		float lanczos_t_(float x, float y, float n)
-		{
-			int i = static_cast<int>(y * 2.0f);
-			i += 6;
-			int j = static_cast<int>(x * 2.0f);
-			j += 6;
-			if(i >= 0 && i < (12 + 1) && j >= 0 && j < (12 + 1)) {
-				return lanczos_tbl_[i * (12 + 1) + j];
-			} else {
-				return lanczos_(x, n) * lanczos_(y, n);
-			}
-		}
-#endif
-
-#if 0
-	static void color_div_(const rgbaf& col, float total, rgba8& c)
-	{
-		rgbaf cc;
-		if(total != 0.0f) {
-			float sf = 1.0f / total;
-			cc.r = col.r * sf;
-			cc.g = col.g * sf;
-			cc.b = col.b * sf;
-			cc.a = col.a * sf;
-		} else {
-			cc = col;
-		}
-
-		if(cc.r < 0.0f) {
-			c.r = 0;
-		} else if(cc.r > 255.0f) {
-			c.r = 255;
-		} else {
-			c.r = static_cast<unsigned char>(cc.r);
-		}
-
-		if(cc.g < 0.0f) {
-			c.g = 0;
-		} else if(cc.g > 255.0f) {
-			c.g = 255;
-		} else {
-			c.g = static_cast<unsigned char>(cc.g);
-		}
-
-		if(cc.b < 0.0f) {
-			c.b = 0;
-		} else if(cc.b > 255.0f) {
-			c.b = 255;
-		} else {
-			c.b = static_cast<unsigned char>(cc.b);
-		}
-
-		if(cc.a < 0.0f) {
-			c.a = 0;
-		} else if(cc.a > 255.0f) {
-			c.a = 255;
-		} else {
-			c.a = static_cast<unsigned char>(cc.a);
-		}
-	}
-
-
-	//-----------------------------------------------------------------//
-	/*!
-		@brief	画像をリサイズする（lanczos-3 アルゴリズム）
-		@param[in]	src	ソースのイメージ
-		@param[out]	dst	リサイズイメージ
-		@param[in]	scale	スケール・ファクター
-	*/
-	//-----------------------------------------------------------------//
-	void resize_image(const i_img* src, img_rgba8& dst, float scale)
-	{
-		if(scale <= 0.0f) return;
-
-		int sw = src->get_size().x;
-		int sh = src->get_size().y;
-		int dw = static_cast<int>(static_cast<float>(sw) * scale);
-		int dh = static_cast<int>(static_cast<float>(sh) * scale);
-		dst.create(vtx::spos(dw, dh), src->test_alpha());
-
-		float n = 3.0f;
-		init_lanczos_(n);
-
-		float scn = 1.0f / scale;
-		if(scale > 1.0f) {
-			vtx::spos out;
-			for(out.y = 0; out.y < dh; ++out.y) {
-				float yy = (static_cast<float>(out.y) + 0.5f) * scn;
-				int ys = static_cast<int>(yy - n);
-				if(ys < 0) ys = 0;
-				int ye = static_cast<int>(yy + n);
-				if(ye > (sh - 1)) ye = sh - 1;
-				for(out.x = 0; out.x < dw; ++out.x) {
-					float xx = (static_cast<float>(out.x) + 0.5f) * scn;
-					int xs = static_cast<int>(xx - n);
-					if(xs < 0) xs = 0;
-					int xe = static_cast<int>(xx + n);
-					if(xe > (sw - 1)) xe = sw - 1;
-
-					rgbaf col(0.0f);
-					float weight_total = 0.0f;
-					vtx::spos pos;
-					for(pos.y = ys; pos.y <= ye; ++pos.y) {
-						float yl = fabs((pos.y + 0.5f) - yy);
-						for(pos.x = xs; pos.x <= xe; ++pos.x) {
-							float xl = std::abs((static_cast<float>(pos.x) + 0.5f) - xx);
-							float weight = lanczos_t_(xl, yl, n);
-							rgba8 c;
-							src->get_pixel(pos, c);
-							col.r += c.r * weight;
-							col.g += c.g * weight;
-							col.b += c.b * weight;
-							col.a += c.a * weight;
-							weight_total += weight;
-						}
-					}
-					rgba8 c;
-					color_div_(col, weight_total, c);
-					dst.put_pixel(out, c);
-				}
-			}
-		} else {
-			vtx::spos out;
-			for(out.y = 0; out.y < dh; ++out.y) {
-				float yy = static_cast<float>(out.y) + 0.5f;
-				int ys = static_cast<int>((yy - n) * scn);
-				if(ys < 0) ys = 0;
-				int ye = static_cast<int>((yy + n) * scn);
-				if(ye > (sh - 1)) ye = sh - 1;
-				for(out.x = 0; out.x < dw; ++out.x) {
-					float xx = static_cast<float>(out.x) + 0.5f;
-					int xs = static_cast<int>((xx - n) * scn);
-					if(xs < 0) xs = 0;
-					int xe = static_cast<int>((xx + n) * scn);
-					if(xe > (sw - 1)) xe = sw - 1;
-
-					rgbaf col(0.0f);
-					float weight_total = 0.0f;
-					vtx::spos pos;
-					for(pos.y = ys; pos.y <= ye; ++pos.y) {
-						float yl = std::abs(((static_cast<float>(pos.y) + 0.5f) * scale) - yy);
-						for(pos.x = xs; pos.x <= xe; ++pos.x) {
-							float xl = std::abs(((static_cast<float>(pos.x) + 0.5f) * scale) - xx);
-							float weight = lanczos_t_(xl, yl, n);
-							rgba8 c;
-							src->get_pixel(pos, c);
-							col.r += static_cast<float>(c.r) * weight;
-							col.g += static_cast<float>(c.g) * weight;
-							col.b += static_cast<float>(c.b) * weight;
-							col.a += static_cast<float>(c.a) * weight;
-							weight_total += weight;
-						}
-					}
-					rgba8 c;
-					color_div_(col, weight_total, c);
-					dst.put_pixel(out, c);
-				}
-			}
-		}
-	}
-#endif
-
 		vtx::spos	ofs_;
 		struct step_t {
 			int32_t	up;
@@ -256,7 +55,6 @@ namespace img {
 		*/
 		//-----------------------------------------------------------------//
 		scaling(RENDER& render) noexcept : render_(render),
-//			lanczos_n_(0.0f),
 			ofs_(0), scale_()
 		{ }
 
@@ -348,4 +146,410 @@ namespace img {
 #endif
 		}
 	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	分離型リサンプラー（拡大、縮小） @n
+				・水平、垂直の２パスで処理する（タップ数は各軸ごと） @n
+				・係数は start で、固定小数点（Q14）の表として作成する @n
+				・描画ファンクタとして、デコーダーから画素を直接受け取る @n
+				　（SMAX x STRIP のバッファに貯め、ストリップ単位で処理する） @n
+				・垂直方向は、拡大では水平パス結果のリングから出力ラインを作り、 @n
+				　縮小では出力ラインに加算する（保持ライン数は倍率に依存しない） @n
+				・下から上に並んだ画像（BMP）は、最初の画素で判定して反転する @n
+				・結果は、PLOT の描画ファンクタへ出力する @n
+				・作業領域は、約 SMAX * STRIP * 4 + DMAX * (RMAX + 1) * 16 + CMAX * 2 バイト @n
+				Ex: @n
+				img_info ifo; img_in_.info(fin, ifo); @n
+				resampler_.start(vtx::spos(ifo.width, ifo.height), vtx::spos(120, 90)); @n
+				img_in_.load(fin); @n
+				resampler_.flush();
+		@param[in]	PLOT	出力描画ファンクタ（render など）
+		@param[in]	SMAX	ソース画像の最大幅
+		@param[in]	DMAX	出力画像の最大幅、最大高さ
+		@param[in]	STRIP	ストリップの高さ（JPEG の MCU 高さの倍数）
+		@param[in]	RMAX	保持ライン数（拡大時の垂直タップ数、縮小時の処理中の出力ライン数）
+		@param[in]	CMAX	係数表の最大数（水平と垂直の合計）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class PLOT, uint16_t SMAX = 640, uint16_t DMAX = 320, uint16_t STRIP = 16,
+		uint16_t RMAX = 8, uint32_t CMAX = 8192>
+	class resampler {
+	public:
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	フィルター
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class FILTER : uint8_t {
+			BOX,		///< 面積平均（拡大では最近傍に近い）
+			BILINEAR,	///< バイリニア（縮小ではテント・フィルター）
+			LANCZOS3,	///< Lanczos-3
+		};
+
+	private:
+		static constexpr int32_t COEF_SHIFT = 14;	///< 係数の小数部
+		static constexpr int32_t LINE_SHIFT = 6;	///< 水平パス結果の小数部
+
+		struct tap_t {
+			int16_t		org;	///< 最初のソース位置
+			uint16_t	num;	///< タップ数
+			uint32_t	ofs;	///< 係数表の位置
+		};
+
+		PLOT&		plot_;
+
+		FILTER		filter_;
+		vtx::spos	src_size_;
+		vtx::spos	dst_size_;
+
+		tap_t		xtap_[DMAX];
+		tap_t		ytap_[DMAX];
+		int16_t		coef_[CMAX];
+
+		uint8_t		strip_[STRIP][SMAX * 4];	///< ソース（RGBA）
+		int32_t		line_buf_[DMAX * 4];		///< 水平パスの結果（RGBA）
+		int32_t		ring_[RMAX][DMAX * 4];		///< 水平パス結果のリング、又は、出力ラインの加算
+
+		int16_t		strip_org_;		///< ストリップ先頭のソース・ライン
+		int16_t		strip_end_;		///< 受け取った最後のライン + 1
+		int16_t		line_;			///< 水平パス済みのライン数
+		int16_t		out_;			///< 出力済みのライン数
+		bool		down_;			///< 垂直方向が縮小
+		bool		active_;
+		bool		first_;
+		bool		flip_;
+
+		static float sinc_(float x) noexcept
+		{
+			if(x == 0.0f) return 1.0f;
+			x *= vtx::get_pi<float>();
+			return std::sin(x) / x;
+		}
+
+		// 出力 i のソース中心 c に対する、ソース j の重み
+		float weight_(float c, int32_t j, float sc) const noexcept
+		{
+			float fs = sc > 1.0f ? sc : 1.0f;
+			float d = static_cast<float>(j) - c;
+			switch(filter_) {
+			case FILTER::BOX:
+				{  // [j - 0.5, j + 0.5] と [c - sc/2, c + sc/2] の重なり
+					float l = std::max(d - 0.5f, -sc * 0.5f);
+					float r = std::min(d + 0.5f,  sc * 0.5f);
+					return r > l ? r - l : 0.0f;
+				}
+			case FILTER::BILINEAR:
+				{
+					float t = 1.0f - std::abs(d) / fs;
+					return t > 0.0f ? t : 0.0f;
+				}
+			case FILTER::LANCZOS3:
+				{
+					float t = std::abs(d) / fs;
+					if(t >= 3.0f) return 0.0f;
+					return sinc_(t) * sinc_(t / 3.0f);
+				}
+			}
+			return 0.0f;
+		}
+
+		float support_(float sc) const noexcept
+		{
+			float fs = sc > 1.0f ? sc : 1.0f;
+			switch(filter_) {
+			case FILTER::BOX:      return fs * 0.5f + 0.5f;
+			case FILTER::BILINEAR: return fs;
+			case FILTER::LANCZOS3: return fs * 3.0f;
+			}
+			return 1.0f;
+		}
+
+		// 係数表の作成（sn から dn へ）
+		bool build_(int16_t sn, int16_t dn, tap_t* tap, uint32_t& pos, uint16_t limit) noexcept
+		{
+			float sc = static_cast<float>(sn) / static_cast<float>(dn);
+			float sup = support_(sc);
+			for(int16_t i = 0; i < dn; ++i) {
+				float c = (static_cast<float>(i) + 0.5f) * sc - 0.5f;
+				int32_t j0 = std::max(static_cast<int32_t>(std::floor(c - sup)), static_cast<int32_t>(0));
+				int32_t j1 = std::min(static_cast<int32_t>(std::ceil(c + sup)), static_cast<int32_t>(sn - 1));
+				// 両端の重みが無いタップを除く
+				while(j0 < j1 && weight_(c, j0, sc) == 0.0f) ++j0;
+				while(j1 > j0 && weight_(c, j1, sc) == 0.0f) --j1;
+				uint32_t n = j1 - j0 + 1;
+				if(n > limit || (pos + n) > CMAX) return false;
+
+				float sum = 0.0f;
+				for(int32_t j = j0; j <= j1; ++j) sum += weight_(c, j, sc);
+				if(sum == 0.0f) sum = 1.0f;
+				int32_t total = 0;
+				uint32_t big = 0;
+				for(uint32_t k = 0; k < n; ++k) {
+					float w = weight_(c, j0 + k, sc) / sum * static_cast<float>(1 << COEF_SHIFT);
+					int16_t q = static_cast<int16_t>(std::floor(w + 0.5f));
+					coef_[pos + k] = q;
+					total += q;
+					if(q > coef_[pos + big]) big = k;
+				}
+				// 合計が 1.0 になるよう、最大の係数で調整
+				coef_[pos + big] += (1 << COEF_SHIFT) - total;
+				tap[i].org = j0;
+				tap[i].num = n;
+				tap[i].ofs = pos;
+				pos += n;
+			}
+			return true;
+		}
+
+		static uint8_t clamp_(int32_t v) noexcept
+		{
+			v >>= COEF_SHIFT + LINE_SHIFT;
+			if(v < 0) return 0;
+			else if(v > 255) return 255;
+			return v;
+		}
+
+		// 縮小時、ソース・ラインを加算する出力ライン数が RMAX に収まるか
+		bool check_down_() const noexcept
+		{
+			int16_t out = 0;
+			int16_t end = 0;
+			for(int16_t j = 0; j < src_size_.y; ++j) {
+				while(end < dst_size_.y && ytap_[end].org <= j) ++end;
+				if((end - out) > RMAX) return false;
+				while(out < dst_size_.y && (ytap_[out].org + ytap_[out].num) <= (j + 1)) ++out;
+			}
+			return true;
+		}
+
+		// ソース・ラインの水平パス
+		void filter_h_(const uint8_t* src) noexcept
+		{
+			int32_t* out = line_buf_;
+			for(int16_t x = 0; x < dst_size_.x; ++x) {
+				const auto& t = xtap_[x];
+				const int16_t* w = &coef_[t.ofs];
+				const uint8_t* s = &src[t.org * 4];
+				int32_t r = 1 << (COEF_SHIFT - LINE_SHIFT - 1);
+				int32_t g = r;
+				int32_t b = r;
+				int32_t a = r;
+				for(uint16_t k = 0; k < t.num; ++k) {
+					int32_t c = w[k];
+					r += c * s[0];
+					g += c * s[1];
+					b += c * s[2];
+					a += c * s[3];
+					s += 4;
+				}
+				out[0] = r >> (COEF_SHIFT - LINE_SHIFT);
+				out[1] = g >> (COEF_SHIFT - LINE_SHIFT);
+				out[2] = b >> (COEF_SHIFT - LINE_SHIFT);
+				out[3] = a >> (COEF_SHIFT - LINE_SHIFT);
+				out += 4;
+			}
+		}
+
+		void plot_line_(int16_t oy, const int32_t* src) noexcept
+		{
+			int16_t y = flip_ ? (dst_size_.y - 1 - oy) : oy;
+			for(int16_t x = 0; x < dst_size_.x; ++x) {
+				plot_(x, y, clamp_(src[0]), clamp_(src[1]), clamp_(src[2]), clamp_(src[3]));
+				src += 4;
+			}
+		}
+
+		// 拡大時、リングの水平パス結果から出力ラインを作る
+		void filter_v_(int16_t oy) noexcept
+		{
+			static constexpr int32_t RND = 1 << (COEF_SHIFT + LINE_SHIFT - 1);
+			const auto& t = ytap_[oy];
+			const int16_t* w = &coef_[t.ofs];
+			int32_t* out = line_buf_;
+			const int32_t* s = ring_[t.org % RMAX];
+			int32_t c = w[0];
+			for(int16_t i = 0; i < (dst_size_.x * 4); ++i) {
+				out[i] = RND + c * s[i];
+			}
+			for(uint16_t k = 1; k < t.num; ++k) {
+				s = ring_[(t.org + k) % RMAX];
+				c = w[k];
+				for(int16_t i = 0; i < (dst_size_.x * 4); ++i) {
+					out[i] += c * s[i];
+				}
+			}
+			plot_line_(oy, out);
+		}
+
+		// 水平パス結果（line_buf_）を、垂直方向に流す
+		void feed_() noexcept
+		{
+			auto n = dst_size_.x * 4;
+			if(down_) {
+				// line_ を含む出力ラインに加算する
+				for(int16_t o = out_; o < dst_size_.y; ++o) {
+					const auto& t = ytap_[o];
+					if(t.org > line_) break;
+					int16_t k = line_ - t.org;
+					if(k >= static_cast<int16_t>(t.num)) continue;
+					int32_t* acc = ring_[o % RMAX];
+					int32_t c = coef_[t.ofs + k];
+					if(k == 0) {
+						for(int16_t i = 0; i < n; ++i) acc[i] = (1 << (COEF_SHIFT + LINE_SHIFT - 1)) + c * line_buf_[i];
+					} else {
+						for(int16_t i = 0; i < n; ++i) acc[i] += c * line_buf_[i];
+					}
+				}
+				++line_;
+				while(out_ < dst_size_.y) {
+					const auto& t = ytap_[out_];
+					if((t.org + t.num) > line_) break;
+					plot_line_(out_, ring_[out_ % RMAX]);
+					++out_;
+				}
+			} else {
+				std::memcpy(ring_[line_ % RMAX], line_buf_, n * sizeof(int32_t));
+				++line_;
+				while(out_ < dst_size_.y) {
+					const auto& t = ytap_[out_];
+					if((t.org + t.num) > line_) break;
+					filter_v_(out_);
+					++out_;
+				}
+			}
+		}
+
+		// 揃ったソース・ラインを処理して、出力出来るラインを出す
+		void process_(int16_t end) noexcept
+		{
+			while(line_ < end) {
+				filter_h_(strip_[line_ - strip_org_]);
+				feed_();
+			}
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクタ
+			@param[in]	plot	出力描画ファンクタ（参照）
+		*/
+		//-----------------------------------------------------------------//
+		resampler(PLOT& plot) noexcept : plot_(plot),
+			filter_(FILTER::BOX), src_size_(0), dst_size_(0),
+			strip_org_(0), strip_end_(0), line_(0), out_(0),
+			down_(false), active_(false), first_(false), flip_(false)
+		{ }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	開始（係数表を作成する）
+			@param[in]	src		ソース画像のサイズ
+			@param[in]	dst		出力画像のサイズ
+			@param[in]	filter	フィルター
+			@return サイズ、タップ数、係数表が範囲外なら「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool start(const vtx::spos& src, const vtx::spos& dst, FILTER filter = FILTER::LANCZOS3) noexcept
+		{
+			active_ = false;
+			if(src.x <= 0 || src.y <= 0 || dst.x <= 0 || dst.y <= 0) return false;
+			if(src.x > SMAX || dst.x > DMAX || dst.y > DMAX) return false;
+
+			filter_ = filter;
+			src_size_ = src;
+			dst_size_ = dst;
+			down_ = src.y > dst.y;
+			uint32_t pos = 0;
+			if(!build_(src.x, dst.x, xtap_, pos, SMAX)) return false;
+			if(!build_(src.y, dst.y, ytap_, pos, down_ ? src.y : RMAX)) return false;
+			if(down_ && !check_down_()) return false;
+
+			strip_org_ = 0;
+			strip_end_ = 0;
+			line_ = 0;
+			out_ = 0;
+			first_ = true;
+			flip_ = false;
+			active_ = true;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	描画ファンクタ（デコーダーから呼ばれる） @n
+					※ストリップより前のラインは無視する
+			@param[in]	x	X 座標
+			@param[in]	y	Y 座標
+			@param[in]	r	R カラー
+			@param[in]	g	G カラー
+			@param[in]	b	B カラー
+			@param[in]	a	アルファ
+		*/
+		//-----------------------------------------------------------------//
+		void operator() (int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) noexcept
+		{
+			if(!active_) return;
+			if(x < 0 || x >= src_size_.x || y < 0 || y >= src_size_.y) return;
+
+			if(first_) {  // 最終ラインから始まる場合、下から上
+				flip_ = src_size_.y > 1 && y == (src_size_.y - 1);
+				first_ = false;
+			}
+			if(flip_) y = src_size_.y - 1 - y;
+
+			while(y >= (strip_org_ + STRIP)) {
+				process_(strip_org_ + STRIP);
+				strip_org_ += STRIP;
+			}
+			if(y < strip_org_) return;
+
+			uint8_t* p = &strip_[y - strip_org_][x * 4];
+			p[0] = r;
+			p[1] = g;
+			p[2] = b;
+			p[3] = a;
+			if(y >= strip_end_) strip_end_ = y + 1;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	残りのラインを処理して終了（デコード後に呼ぶ） @n
+					※受け取っていないラインは、最後に受け取ったラインを使う
+		*/
+		//-----------------------------------------------------------------//
+		void flush() noexcept
+		{
+			if(!active_) return;
+
+			if(strip_end_ > strip_org_) {
+				process_(strip_end_);
+			}
+			// 足りないラインは、最後のラインを複製する @n
+			// （拡大では filter_v_ が line_buf_ を上書きするので、毎回水平パスをやり直す） @n
+			// （ストリップの先頭は STRIP の倍数なので、最後のラインはストリップに残っている）
+			if(line_ > 0) {
+				const uint8_t* last = strip_[(line_ - 1) % STRIP];
+				while(out_ < dst_size_.y) {
+					filter_h_(last);
+					feed_();
+				}
+			}
+			active_ = false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	出力済みのライン数を取得
+			@return 出力済みのライン数
+		*/
+		//-----------------------------------------------------------------//
+		int16_t get_output_lines() const noexcept { return out_; }
+	};
 }
@@ -18,7 +18,7 @@ namespace graphics {
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
 		@brief	TinyGL class
-		@param[in]	RDR		レンダークラス（DRW2D インスタンス）
+		@param[in]	RDR		レンダークラス（DRW2D インスタンス、又は、render）
 		@param[in]	VNUM	最大頂点数
 		@param[in]	PNUM	最大プリミティブ数
 		@param[in]	TNUM	テクスチャー管理数
@@ -99,7 +99,7 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	コンストラクター
-			@param[in]	rdr		レンダークラス（DRW2D インスタンス）
+			@param[in]	rdr		レンダークラス（DRW2D インスタンス、又は、render）
 		*/
 		//-----------------------------------------------------------------//
 		tgl(RDR& rdr) noexcept : rdr_(rdr),
@@ -385,7 +385,7 @@ namespace graphics {
 				rdr_.set_fore_color(t.col_);
 
 
-				rdr_.set_texture(tex_[0].image_, tex_[0].size_, d2_mode_rgba8888);
+				rdr_.set_texture(tex_[0].image_, tex_[0].size_, RDR::TEXTURE_RGBA8888);
 
 
 				uint32_t k = 0;
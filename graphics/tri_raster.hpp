@@ -0,0 +1,462 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	三角形ラスタライザー（ソフトウェア） @n
+			・頂点は小数４ビットの固定小数点（DRW2D と同じ）@n
+			・エッジ関数を 8x8 のタイル単位で評価し、完全に内側のタイルは判定を省く @n
+			・左上ルールで、辺を共有する三角形の画素は重ならない @n
+			・フラット、グーロー・シェーディング @n
+			・RGBA8888 テクスチャー（アフィン、パースペクティブ補正、最近傍、ラップ）@n
+			・16 ビット深度バッファ（オプション、小さい値が手前）@n
+			・出力は RGB565
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <algorithm>
+#include "common/vtx.hpp"
+#include "graphics/color.hpp"
+
+namespace graphics {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	三角形ラスタライザー・クラス
+		@param[in]	LW	フレームバッファのライン幅（ピクセル）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <int16_t LW>
+	class tri_raster {
+	public:
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	頂点
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct vertex {
+			int32_t		x;		///< X（小数４ビット）
+			int32_t		y;		///< Y（小数４ビット）
+			uint16_t	z;		///< 深度（小さい値が手前）
+			uint8_t		r;		///< 赤（グーロー）
+			uint8_t		g;		///< 緑（グーロー）
+			uint8_t		b;		///< 青（グーロー）
+			float		u;		///< テクスチャー U（1.0 で一周）
+			float		v;		///< テクスチャー V（1.0 で一周）
+			float		w;		///< 同次座標 W（パースペクティブ補正に使う）
+
+			vertex(int32_t x_ = 0, int32_t y_ = 0) noexcept : x(x_), y(y_), z(0),
+				r(255), g(255), b(255), u(0.0f), v(0.0f), w(1.0f) { }
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	シェーディング
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class SHADE : uint8_t {
+			FLAT,		///< フラット（set_color の色）
+			GOURAUD,	///< 頂点の色を補間
+		};
+
+	private:
+		static constexpr int32_t TILE = 8;
+
+		// 描画方法のフラグ
+		static constexpr uint32_t F_GOURAUD = 1;
+		static constexpr uint32_t F_TEXTURE = 2;
+		static constexpr uint32_t F_PERSP   = 4;
+		static constexpr uint32_t F_DEPTH   = 8;
+
+		const uint8_t*	tex_;
+		int16_t		tex_w_;
+		int16_t		tex_h_;
+
+		uint16_t*	depth_;
+
+		SHADE		shade_;
+		bool		perspective_;
+		uint16_t	color_;
+
+		// エッジ関数 E(x, y) = a * x + b * y + c（x, y は小数４ビット）
+		struct edge_t {
+			int32_t	a;
+			int32_t	b;
+			int64_t	c;
+
+			void setup(const vertex& p, const vertex& q) noexcept
+			{
+				a = p.y - q.y;
+				b = q.x - p.x;
+				c = -(static_cast<int64_t>(a) * p.x + static_cast<int64_t>(b) * p.y);
+				// 左上ルール：上辺、左辺以外は、辺上の画素を含めない
+				if(!(a > 0 || (a == 0 && b > 0))) c -= 1;
+			}
+
+			int64_t at(int32_t px, int32_t py) const noexcept
+			{
+				return static_cast<int64_t>(a) * ((px << 4) + 8) + static_cast<int64_t>(b) * ((py << 4) + 8) + c;
+			}
+		};
+
+		// 属性の平面 val(px, py) = o + dx * px + dy * py（画素の中心で評価）
+		struct plane_t {
+			float	o;
+			float	dx;
+			float	dy;
+
+			void setup(float a0, float a1, float a2, float x10, float y10, float x20, float y20,
+				float x0, float y0, float idet) noexcept
+			{
+				dx = ((a1 - a0) * y20 - (a2 - a0) * y10) * idet;
+				dy = ((a2 - a0) * x10 - (a1 - a0) * x20) * idet;
+				o = a0 + dx * (0.5f - x0) + dy * (0.5f - y0);
+			}
+
+			float at(int32_t px, int32_t py) const noexcept { return o + dx * px + dy * py; }
+		};
+
+		struct setup_t {
+			edge_t	e[3];
+			plane_t	r;
+			plane_t	g;
+			plane_t	b;
+			plane_t	z;
+			plane_t	u;
+			plane_t	v;
+			plane_t	q;
+		};
+
+		static int32_t clamp_(int32_t v, int32_t max) noexcept
+		{
+			if(v < 0) return 0;
+			else if(v > max) return max;
+			return v;
+		}
+
+		static int32_t fix16_(float v) noexcept { return static_cast<int32_t>(v * 65536.0f); }
+
+		template <uint32_t F>
+		void tile_(uint16_t* fb, const setup_t& st, int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+			uint32_t test) noexcept
+		{
+			int32_t s0 = (test & 1) ? st.e[0].a << 4 : 0;
+			int32_t s1 = (test & 2) ? st.e[1].a << 4 : 0;
+			int32_t s2 = (test & 4) ? st.e[2].a << 4 : 0;
+			int32_t dr = 0, dg = 0, db = 0, dz = 0, du = 0, dv = 0;
+			if(F & F_GOURAUD) {
+				dr = fix16_(st.r.dx);
+				dg = fix16_(st.g.dx);
+				db = fix16_(st.b.dx);
+			}
+			if(F & F_DEPTH) dz = static_cast<int32_t>(st.z.dx * 4096.0f);
+			if((F & F_TEXTURE) && !(F & F_PERSP)) {
+				du = fix16_(st.u.dx);
+				dv = fix16_(st.v.dx);
+			}
+			uint32_t mu = tex_w_ - 1;
+			uint32_t mv = tex_h_ - 1;
+
+			for(int32_t py = y0; py <= y1; ++py) {
+				int32_t e0 = (test & 1) ? static_cast<int32_t>(st.e[0].at(x0, py)) : 0;
+				int32_t e1 = (test & 2) ? static_cast<int32_t>(st.e[1].at(x0, py)) : 0;
+				int32_t e2 = (test & 4) ? static_cast<int32_t>(st.e[2].at(x0, py)) : 0;
+				int32_t r = 0, g = 0, b = 0, z = 0, u = 0, v = 0;
+				float uq = 0.0f, vq = 0.0f, q = 0.0f;
+				if(F & F_GOURAUD) {
+					r = fix16_(st.r.at(x0, py));
+					g = fix16_(st.g.at(x0, py));
+					b = fix16_(st.b.at(x0, py));
+				}
+				if(F & F_DEPTH) z = static_cast<int32_t>(st.z.at(x0, py) * 4096.0f);
+				if(F & F_TEXTURE) {
+					if(F & F_PERSP) {
+						uq = st.u.at(x0, py);
+						vq = st.v.at(x0, py);
+						q  = st.q.at(x0, py);
+					} else {
+						u = fix16_(st.u.at(x0, py));
+						v = fix16_(st.v.at(x0, py));
+					}
+				}
+				uint16_t* out = &fb[py * LW + x0];
+				uint16_t* zb = nullptr;
+				if(F & F_DEPTH) zb = &depth_[py * LW + x0];
+				for(int32_t px = x0; px <= x1; ++px) {
+					if((e0 | e1 | e2) >= 0) {
+						uint16_t c = color_;
+						bool draw = true;
+						if(F & F_TEXTURE) {
+							int32_t tu;
+							int32_t tv;
+							if(F & F_PERSP) {
+								float iq = 1.0f / q;
+								tu = fix16_(uq * iq) >> 16;
+								tv = fix16_(vq * iq) >> 16;
+							} else {
+								tu = u >> 16;
+								tv = v >> 16;
+							}
+							const uint8_t* t = &tex_[((tv & mv) * tex_w_ + (tu & mu)) * 4];
+							if(t[3] == 0) {
+								draw = false;
+							} else if(F & F_GOURAUD) {
+								c = share_color::to_565(
+									(t[0] * clamp_(r >> 16, 255)) >> 8,
+									(t[1] * clamp_(g >> 16, 255)) >> 8,
+									(t[2] * clamp_(b >> 16, 255)) >> 8);
+							} else {
+								c = share_color::to_565(t[0], t[1], t[2]);
+							}
+						} else if(F & F_GOURAUD) {
+							c = share_color::to_565(clamp_(r >> 16, 255), clamp_(g >> 16, 255), clamp_(b >> 16, 255));
+						}
+						if(F & F_DEPTH) {
+							uint16_t zz = clamp_(z >> 12, 65535);
+							if(zz >= *zb) draw = false;
+							else if(draw) *zb = zz;
+						}
+						if(draw) *out = c;
+					}
+					e0 += s0;
+					e1 += s1;
+					e2 += s2;
+					++out;
+					if(F & F_DEPTH) {
+						++zb;
+						z += dz;
+					}
+					if(F & F_GOURAUD) {
+						r += dr;
+						g += dg;
+						b += db;
+					}
+					if(F & F_TEXTURE) {
+						if(F & F_PERSP) {
+							uq += st.u.dx;
+							vq += st.v.dx;
+							q  += st.q.dx;
+						} else {
+							u += du;
+							v += dv;
+						}
+					}
+				}
+			}
+		}
+
+		template <uint32_t F>
+		void scan_(uint16_t* fb, const setup_t& st, int32_t x0, int32_t y0, int32_t x1, int32_t y1) noexcept
+		{
+			for(int32_t ty = y0 & ~(TILE - 1); ty <= y1; ty += TILE) {
+				int32_t ya = ty < y0 ? y0 : ty;
+				int32_t yb = (ty + TILE - 1) > y1 ? y1 : (ty + TILE - 1);
+				for(int32_t tx = x0 & ~(TILE - 1); tx <= x1; tx += TILE) {
+					int32_t xa = tx < x0 ? x0 : tx;
+					int32_t xb = (tx + TILE - 1) > x1 ? x1 : (tx + TILE - 1);
+					// タイルの４隅で判定（エッジ関数は一次式なので、最小、最大は隅にある）
+					uint32_t test = 0;
+					bool skip = false;
+					for(uint32_t i = 0; i < 3; ++i) {
+						const auto& e = st.e[i];
+						auto c0 = e.at(xa, ya);
+						auto c1 = e.at(xb, ya);
+						auto c2 = e.at(xa, yb);
+						auto c3 = e.at(xb, yb);
+						if(c0 < 0 && c1 < 0 && c2 < 0 && c3 < 0) {
+							skip = true;
+							break;
+						}
+						if(c0 < 0 || c1 < 0 || c2 < 0 || c3 < 0) test |= 1 << i;
+					}
+					if(skip) continue;
+					tile_<F>(fb, st, xa, ya, xb, yb, test);
+				}
+			}
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		tri_raster() noexcept : tex_(nullptr), tex_w_(0), tex_h_(0), depth_(nullptr),
+			shade_(SHADE::FLAT), perspective_(false), color_(0xffff) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	テクスチャーの設定
+			@param[in]	image	RGBA8888 画像（メモリー上の並びが R, G, B, A）
+			@param[in]	w		幅（２のべき乗）
+			@param[in]	h		高さ（２のべき乗）
+		*/
+		//-----------------------------------------------------------------//
+		void set_texture(const void* image, int16_t w, int16_t h) noexcept
+		{
+			tex_ = static_cast<const uint8_t*>(image);
+			tex_w_ = w;
+			tex_h_ = h;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	深度バッファの設定 @n
+					※大きさは、ライン幅 x 高さ、無効にする場合「nullptr」
+			@param[in]	depth	深度バッファ
+		*/
+		//-----------------------------------------------------------------//
+		void set_depth(uint16_t* depth) noexcept { depth_ = depth; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	深度バッファのクリア
+			@param[in]	h	高さ
+		*/
+		//-----------------------------------------------------------------//
+		void clear_depth(int16_t h) noexcept
+		{
+			if(depth_ == nullptr) return;
+			for(int32_t i = 0; i < (LW * h); ++i) depth_[i] = 0xffff;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	シェーディングの設定
+			@param[in]	shade	シェーディング
+		*/
+		//-----------------------------------------------------------------//
+		void set_shade(SHADE shade) noexcept { shade_ = shade; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	テクスチャーのパースペクティブ補正
+			@param[in]	ena	補正しない場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		void set_perspective(bool ena = true) noexcept { perspective_ = ena; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	フラット・シェーディングの色
+			@param[in]	c	RGB565 カラー
+		*/
+		//-----------------------------------------------------------------//
+		void set_color(uint16_t c) noexcept { color_ = c; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	三角形を描画
+			@param[in]	fb		フレームバッファ
+			@param[in]	clip	クリッピング領域
+			@param[in]	v0		頂点０
+			@param[in]	v1		頂点１
+			@param[in]	v2		頂点２
+			@param[in]	texture	テクスチャーを使う場合「true」
+			@return 面積が無い場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool draw(uint16_t* fb, const vtx::srect& clip,
+			const vertex& v0, const vertex& v1, const vertex& v2, bool texture = false) noexcept
+		{
+			const vertex* p0 = &v0;
+			const vertex* p1 = &v1;
+			const vertex* p2 = &v2;
+			int64_t area = static_cast<int64_t>(p1->x - p0->x) * (p2->y - p0->y)
+				- static_cast<int64_t>(p1->y - p0->y) * (p2->x - p0->x);
+			if(area == 0) return false;
+			if(area < 0) {  // 向きを揃える（裏面も描画する）
+				std::swap(p1, p2);
+				area = -area;
+			}
+
+			// 画素の中心が含まれる範囲
+			int32_t minx = std::min(p0->x, std::min(p1->x, p2->x));
+			int32_t maxx = std::max(p0->x, std::max(p1->x, p2->x));
+			int32_t miny = std::min(p0->y, std::min(p1->y, p2->y));
+			int32_t maxy = std::max(p0->y, std::max(p1->y, p2->y));
+			int32_t x0 = (minx + 7) >> 4;
+			int32_t x1 = (maxx - 8) >> 4;
+			int32_t y0 = (miny + 7) >> 4;
+			int32_t y1 = (maxy - 8) >> 4;
+			if(x0 < clip.org.x) x0 = clip.org.x;
+			if(y0 < clip.org.y) y0 = clip.org.y;
+			if(x1 >= clip.end_x()) x1 = clip.end_x() - 1;
+			if(y1 >= clip.end_y()) y1 = clip.end_y() - 1;
+			if(x0 > x1 || y0 > y1) return true;
+
+			setup_t st;
+			st.e[0].setup(*p1, *p2);
+			st.e[1].setup(*p2, *p0);
+			st.e[2].setup(*p0, *p1);
+
+			uint32_t f = 0;
+			if(shade_ == SHADE::GOURAUD) f |= F_GOURAUD;
+			if(texture && tex_ != nullptr) {
+				f |= F_TEXTURE;
+				if(perspective_) f |= F_PERSP;
+			}
+			if(depth_ != nullptr) f |= F_DEPTH;
+
+			if(f != 0) {
+				float fx0 = p0->x * (1.0f / 16.0f);
+				float fy0 = p0->y * (1.0f / 16.0f);
+				float x10 = (p1->x - p0->x) * (1.0f / 16.0f);
+				float y10 = (p1->y - p0->y) * (1.0f / 16.0f);
+				float x20 = (p2->x - p0->x) * (1.0f / 16.0f);
+				float y20 = (p2->y - p0->y) * (1.0f / 16.0f);
+				float idet = 256.0f / static_cast<float>(area);
+				if(f & F_GOURAUD) {
+					st.r.setup(p0->r, p1->r, p2->r, x10, y10, x20, y20, fx0, fy0, idet);
+					st.g.setup(p0->g, p1->g, p2->g, x10, y10, x20, y20, fx0, fy0, idet);
+					st.b.setup(p0->b, p1->b, p2->b, x10, y10, x20, y20, fx0, fy0, idet);
+				}
+				if(f & F_DEPTH) {
+					st.z.setup(p0->z, p1->z, p2->z, x10, y10, x20, y20, fx0, fy0, idet);
+				}
+				if(f & F_TEXTURE) {
+					float tw = tex_w_;
+					float th = tex_h_;
+					if(f & F_PERSP) {  // u/w, v/w, 1/w を補間する
+						float q0 = 1.0f / p0->w;
+						float q1 = 1.0f / p1->w;
+						float q2 = 1.0f / p2->w;
+						st.u.setup(p0->u * tw * q0, p1->u * tw * q1, p2->u * tw * q2, x10, y10, x20, y20, fx0, fy0, idet);
+						st.v.setup(p0->v * th * q0, p1->v * th * q1, p2->v * th * q2, x10, y10, x20, y20, fx0, fy0, idet);
+						st.q.setup(q0, q1, q2, x10, y10, x20, y20, fx0, fy0, idet);
+					} else {
+						st.u.setup(p0->u * tw, p1->u * tw, p2->u * tw, x10, y10, x20, y20, fx0, fy0, idet);
+						st.v.setup(p0->v * th, p1->v * th, p2->v * th, x10, y10, x20, y20, fx0, fy0, idet);
+					}
+				}
+			}
+
+			switch(f) {
+			case 0:  scan_<0>(fb, st, x0, y0, x1, y1); break;
+			case 1:  scan_<1>(fb, st, x0, y0, x1, y1); break;
+			case 2:  scan_<2>(fb, st, x0, y0, x1, y1); break;
+			case 3:  scan_<3>(fb, st, x0, y0, x1, y1); break;
+			case 6:  scan_<6>(fb, st, x0, y0, x1, y1); break;
+			case 7:  scan_<7>(fb, st, x0, y0, x1, y1); break;
+			case 8:  scan_<8>(fb, st, x0, y0, x1, y1); break;
+			case 9:  scan_<9>(fb, st, x0, y0, x1, y1); break;
+			case 10: scan_<10>(fb, st, x0, y0, x1, y1); break;
+			case 11: scan_<11>(fb, st, x0, y0, x1, y1); break;
+			case 14: scan_<14>(fb, st, x0, y0, x1, y1); break;
+			case 15: scan_<15>(fb, st, x0, y0, x1, y1); break;
+			default: break;
+			}
+			return true;
+		}
+	};
+}
@@ -717,9 +717,9 @@ debug_format("(EST) CMP:  SEQ: 0x%08X, ACK: 0x%08X\n")
 			}
 
 			// 同じポートがある場合は無効（ロック状態）
-			for(uint32_t i = 0; i < NMAX; ++i) {
-				if(!common_.at_blocks().is_alloc(i)) continue;
-				const context& ctx = common_.get_blocks().get(i);
+			const auto& blks = common_.get_blocks();
+			for(uint32_t i = blks.next_alloc(0); i < NMAX; i = blks.next_alloc(i + 1)) {
+				const context& ctx = blks.get(i);
 				uint16_t pp;
 				if(server) {
 					pp = ctx.src_port_;
@@ -1014,10 +1014,9 @@ debug_format("(EST) CMP:  SEQ: 0x%08X, ACK: 0x%08X\n")
 		{
 			// 該当するコンテキストを探す
 			uint32_t idx = NMAX;
-			for(uint32_t i = 0; i < NMAX; ++i) {
-				if(!probe(i)) continue;
-
-				context& ctx = common_.at_blocks().at(i);  // コンテキスト取得
+			auto& blks = common_.at_blocks();
+			for(uint32_t i = blks.next_active(0); i < NMAX; i = blks.next_active(i + 1)) {
+				context& ctx = blks.at(i);  // コンテキスト取得
 
 				uint16_t sum = tools::calc_sum(&ih, sizeof(ipv4_h));
 				if(sum != 0) {
@@ -1066,10 +1065,9 @@ debug_format("(EST) CMP:  SEQ: 0x%08X, ACK: 0x%08X\n")
 		//-----------------------------------------------------------------//
 		void service(ARP& arp) noexcept
 		{
-			for(uint32_t i = 0; i < NMAX; ++i) {
-				if(!probe(i)) continue;
-
-				context& ctx = common_.at_blocks().at(i);
+			auto& blks = common_.at_blocks();
+			for(uint32_t i = blks.next_active(0); i < NMAX; i = blks.next_active(i + 1)) {
+				context& ctx = blks.at(i);
 
 				switch(ctx.send_task_) {
 
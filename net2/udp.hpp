@@ -418,10 +418,9 @@ namespace net {
 		{
 			// 該当するコンテキストを探す
 			uint32_t idx = NMAX;
-			for(uint32_t i = 0; i < NMAX; ++i) {
-				if(!common_.at_blocks().is_alloc(i)) continue;  // alloc: 有効
-				if(common_.at_blocks().is_lock(i)) continue;  // lock:  無効
-				context& ctx = common_.at_blocks().at(i);  // コンテキスト取得
+			auto& blks = common_.at_blocks();
+			for(uint32_t i = blks.next_active(0); i < NMAX; i = blks.next_active(i + 1)) {  // alloc: 有効、lock: 無効
+				context& ctx = blks.at(i);  // コンテキスト取得
 
 				// 転送先の確認
 				if(info_.ip != ih.get_dst_ipa()) continue;
@@ -471,11 +470,9 @@ namespace net {
 		//-----------------------------------------------------------------//
 		void service() noexcept
 		{
-			for(uint32_t i = 0; i < NMAX; ++i) {
-
-				if(!common_.at_blocks().is_alloc(i)) continue;
-
-				context& ctx = common_.at_blocks().at(i);
+			auto& blks = common_.at_blocks();
+			for(uint32_t i = blks.next_alloc(0); i < NMAX; i = blks.next_alloc(i + 1)) {
+				context& ctx = blks.at(i);
 				switch(ctx.send_task_) {
 				case send_task::sync_mac:
 					if(common_.check_mac(ctx, info_)) {
@@ -0,0 +1,216 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	遅延バイナリ・ログ、レコードの解析クラス @n
+			common/dlog.hpp が出力したバイト列から、レコードを切り出し、@n
+			書式文字列と合わせて、utils::format と同じ規則で文字列に戻す。@n
+			書式文字列は、ID（マイコン上のアドレス）から、関数で取り出す。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <string>
+#include <vector>
+#include <cstring>
+#include <functional>
+#include <boost/format.hpp>
+
+#include "common/dlog.hpp"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	遅延バイナリ・ログ、レコードの解析クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class dlog_dec {
+	public:
+		typedef std::function<bool (uint32_t id, std::string& form)> form_func;
+		typedef std::function<void (uint32_t tick, const std::string& text)> out_func;
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	統計
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct stat_t {
+			uint32_t	record = 0;
+			uint32_t	sum_error = 0;
+			uint32_t	unknown = 0;
+			uint32_t	skip = 0;
+		};
+
+	private:
+		form_func				form_;
+		stat_t					stat_;
+		std::vector<uint8_t>	buff_;
+
+		// ホストのポインターは６４ビットなので、"%p" はマイコンと同じ "%08x" にする
+		static std::string conv_pointer_(const std::string& form)
+		{
+			std::string out;
+			for(uint32_t i = 0; i < form.size(); ++i) {
+				out += form[i];
+				if(form[i] != '%') continue;
+				++i;
+				while(i < form.size() && std::strchr("+-.:0123456789", form[i]) != nullptr) {
+					out += form[i];
+					++i;
+				}
+				if(i >= form.size()) break;
+				if(form[i] == 'p') out += "08x";
+				else out += form[i];
+			}
+			return out;
+		}
+
+
+		static uint32_t get32_(const uint8_t* p)
+		{
+			return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+				| (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	form	ID から書式文字列を取り出す関数
+		*/
+		//-----------------------------------------------------------------//
+		dlog_dec(const form_func& form) : form_(form), stat_(), buff_() { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	レコードの文字列化
+			@param[in]	src	ID の先頭
+			@param[in]	len	LEN（ID から引数の最後までのバイト数）
+			@return 文字列
+		*/
+		//-----------------------------------------------------------------//
+		std::string decode(const uint8_t* src, uint32_t len)
+		{
+			typedef utils::dlog_base::tag tag;
+
+			uint32_t id = get32_(src);
+			std::string form;
+			if(!form_(id, form)) {
+				++stat_.unknown;
+				return (boost::format("(dlog: unknown format id 0x%08X)\n") % id).str();
+			}
+			form = conv_pointer_(form);
+
+			char tmp[1024];
+			utils::sformat fmt(form.c_str(), tmp, sizeof(tmp));
+			uint32_t pos = 8;
+			while(pos < len) {
+				auto t = static_cast<tag>(src[pos++]);
+				switch(t) {
+				case tag::INT:
+					if((pos + 4) > len) break;
+					fmt % static_cast<int32_t>(get32_(&src[pos]));
+					pos += 4;
+					continue;
+				case tag::UINT:
+				case tag::PTR:
+					if((pos + 4) > len) break;
+					fmt % get32_(&src[pos]);
+					pos += 4;
+					continue;
+				case tag::FLOAT:
+					if((pos + 4) > len) break;
+					{
+						float v;
+						std::memcpy(&v, &src[pos], 4);
+						fmt % v;
+					}
+					pos += 4;
+					continue;
+				case tag::DOUBLE:
+					if((pos + 8) > len) break;
+					{
+						double v;
+						std::memcpy(&v, &src[pos], 8);
+						fmt % v;
+					}
+					pos += 8;
+					continue;
+				case tag::STR:
+					if(pos >= len || (pos + 1 + src[pos]) > len) break;
+					{
+						std::string s(reinterpret_cast<const char*>(&src[pos + 1]), src[pos]);
+						fmt % s;
+						pos += 1 + src[pos];
+					}
+					continue;
+				}
+				break;
+			}
+			std::string out = tmp;
+			if(pos != len) {
+				out += "(dlog: broken argument)\n";
+			} else if(!fmt.status()) {
+				out += (boost::format("(dlog: format error %d)\n") % static_cast<int>(fmt.get_error())).str();
+			}
+			return out;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信したバイト列を追加して、揃ったレコードを出力する @n
+					同期が外れたら、１バイトずつ読み飛ばす
+			@param[in]	src	バイト列
+			@param[in]	len	長さ
+			@param[in]	eof	終端（足りないレコードは、偽の SYNC として読み飛ばす）
+			@param[in]	out	レコード毎の出力関数
+		*/
+		//-----------------------------------------------------------------//
+		void put(const uint8_t* src, uint32_t len, bool eof, const out_func& out)
+		{
+			buff_.insert(buff_.end(), src, src + len);
+			uint32_t pos = 0;
+			while((buff_.size() - pos) >= 3) {
+				const uint8_t* p = &buff_[pos];
+				if(p[0] != utils::dlog_base::SYNC || p[1] < 8 || p[1] > (utils::dlog_base::RECORD_MAX - 3)) {
+					++pos;
+					++stat_.skip;
+					continue;
+				}
+				uint32_t l = p[1];
+				if((buff_.size() - pos) < (l + 3)) {
+					if(!eof) break;
+					++pos;
+					++stat_.skip;
+					continue;
+				}
+				uint8_t sum = 0;
+				for(uint32_t i = 1; i < (l + 2); ++i) sum += p[i];
+				if(sum != p[l + 2]) {
+					++pos;
+					++stat_.skip;
+					++stat_.sum_error;
+					continue;
+				}
+				auto text = decode(&p[2], l);
+				++stat_.record;
+				out(get32_(&p[6]), text);
+				pos += l + 3;
+			}
+			buff_.erase(buff_.begin(), buff_.begin() + pos);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	統計を取得
+			@return 統計
+		*/
+		//-----------------------------------------------------------------//
+		const stat_t& get_stat() const { return stat_; }
+	};
+}
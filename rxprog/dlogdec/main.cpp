@@ -0,0 +1,142 @@
+//=====================================================================//
+/*!	@file
+	@brief	遅延バイナリ・ログ・デコーダー @n
+			common/dlog.hpp が出力したレコードを、ELF ファイルの書式文字列 @n
+			と合わせて、utils::format と同じ規則で文字列に戻す @n
+			Ex: @n
+				stty -F /dev/ttyUSB0 115200 raw; dlog_dec app.elf /dev/ttyUSB0
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "motsx_io.hpp"
+#include "dlog_dec.hpp"
+
+namespace {
+
+	const std::string version_ = "0.10b";
+
+	struct options {
+		std::string	elf;
+		std::string	input;
+		bool		time = false;
+		bool		verbose = false;
+	};
+
+
+	void help_(const char* cmd)
+	{
+		std::string c = cmd;
+		auto n = c.rfind('/');
+		if(n != std::string::npos) c = c.substr(n + 1);
+
+		std::cout << "Deferred binary log decoder Version " << version_ << std::endl;
+		std::cout << "Copyright (C) 2020, Hiramatsu Kunihito (hira@rvf-rc45.net)" << std::endl;
+		std::cout << "usage:" << std::endl;
+		std::cout << c << " [options] ELF-file [log-file]" << std::endl;
+		std::cout << "    (log-file omitted or '-': read from stdin)" << std::endl;
+		std::cout << std::endl;
+		std::cout << "Options :" << std::endl;
+		std::cout << "    --time                     Put the time stamp at each record" << std::endl;
+		std::cout << "    --verbose                  Display statistics at the end" << std::endl;
+		std::cout << "    -h, --help                 Display this" << std::endl;
+	}
+
+
+	// ELF イメージから書式文字列を取り出す
+	bool get_form_(const utils::motsx_io& mot, uint32_t id, std::string& form)
+	{
+		form.clear();
+		while(1) {
+			uint32_t page = id & ~(utils::sparse_image::PAGE_SIZE - 1);
+			if(!mot.find_page(page)) return false;
+			char ch = mot.get_memory(page)[id - page];
+			if(ch == 0) break;
+			form += ch;
+			++id;
+			if(form.size() > 4096) return false;
+		}
+		return true;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	options opts;
+	for(int i = 1; i < argc; ++i) {
+		std::string p = argv[i];
+		if(p == "--time") {
+			opts.time = true;
+		} else if(p == "--verbose") {
+			opts.verbose = true;
+		} else if(p == "-h" || p == "--help") {
+			help_(argv[0]);
+			return 0;
+		} else if(p.size() > 1 && p[0] == '-') {
+			std::cerr << "Option error: '" << p << "'" << std::endl;
+			help_(argv[0]);
+			return -1;
+		} else if(opts.elf.empty()) {
+			opts.elf = p;
+		} else if(opts.input.empty()) {
+			opts.input = p;
+		} else {
+			std::cerr << "Too many files: '" << p << "'" << std::endl;
+			return -1;
+		}
+	}
+	if(opts.elf.empty()) {
+		help_(argv[0]);
+		return -1;
+	}
+
+	utils::motsx_io mot;
+	if(!mot.load(opts.elf)) {
+		std::cerr << "Can't load ELF file: '" << opts.elf << "'" << std::endl;
+		return -1;
+	}
+
+	int fd = 0;
+	if(!opts.input.empty() && opts.input != "-") {
+		fd = open(opts.input.c_str(), O_RDONLY);
+		if(fd < 0) {
+			std::cerr << "Can't open log file: '" << opts.input << "'" << std::endl;
+			return -1;
+		}
+	}
+
+	// 受信しながら、レコード単位で出力する（同期が外れたら、１バイトずつ読み飛ばす）
+	utils::dlog_dec dec([&mot](uint32_t id, std::string& form) { return get_form_(mot, id, form); });
+	uint8_t tmp[4096];
+	bool eof = false;
+	while(!eof) {
+		auto n = read(fd, tmp, sizeof(tmp));
+		if(n <= 0) {
+			eof = true;
+			n = 0;
+		}
+		dec.put(tmp, n, eof, [&opts](uint32_t tick, const std::string& text) {
+			if(opts.time) {
+				std::cout << boost::format("%10u: ") % tick;
+			}
+			std::cout << text << std::flush;
+		});
+	}
+	if(fd != 0) close(fd);
+
+	if(opts.verbose) {
+		const auto& st = dec.get_stat();
+		std::cerr << boost::format("Records: %u, Unknown ID: %u, Sum error: %u, Skip bytes: %u")
+			% st.record % st.unknown % st.sum_error % st.skip << std::endl;
+	}
+}
@@ -8,21 +8,32 @@
 */
 //=====================================================================//
 #include <iostream>
+#include <thread>
+#include <mutex>
+#include <algorithm>
+#include <iterator>
 #include "rx_prog.hpp"
 #include "conf_in.hpp"
 #include "motsx_io.hpp"
 #include "string_utils.hpp"
 #include "area.hpp"
+#include "speed_cache.hpp"
+#include "prog_journal.hpp"
 
 namespace {
 
 	const std::string version_ = "1.30";
 	const std::string conf_file_ = "rx_prog.conf";
+	const std::string speed_cache_file_ = ".rx_prog_cache";
+	const std::string journal_file_ = ".rx_prog_journal";
 	const uint32_t progress_num_ = 50;
 	const char progress_cha_ = '#';
 
 	utils::conf_in conf_in_;
 	utils::motsx_io motsx_;
+	utils::speed_cache speed_cache_;
+	utils::prog_journal journal_;
+	uint64_t image_hash_ = 0;
 
 	void memory_dump_()
 	{
@@ -74,19 +85,21 @@ namespace {
 	}
 
 
-	struct page_t {
-		uint32_t	n = 0;
-		uint32_t	c = 0;
-	};
-
-
-	void progress_(uint32_t pageall, page_t& page)
+	rx::prog::pages create_pages_()
 	{
-		uint32_t pos = progress_num_ * page.n / pageall;
-		for(uint32_t i = 0; i < (pos - page.c); ++i) {
-			std::cout << progress_cha_ << std::flush;
+		rx::prog::pages ps;
+		auto areas = motsx_.create_area_map();
+		for(const auto& a : areas) {
+			uint32_t adr = a.min_ & 0xffffff00;
+			while(adr <= a.max_) {
+				if(ps.empty() || ps.back() != adr) {
+					ps.push_back(adr);
+				}
+				adr += 256;
+				if(adr == 0) break;  // アドレス空間の終わり
+			}
 		}
-		page.c = pos;
+		return ps;
 	}
 
 
@@ -96,6 +109,7 @@ namespace {
 		std::string platform;
 
 		std::string	inp_file;
+		std::string	bin_base;
 
 		std::string	device;
 		bool	dv = false;
@@ -104,14 +118,15 @@ namespace {
 		bool	br = false;
 
 		std::string com_path;
-		std::string com_name;
 		bool	dp = false;
 
+		utils::strings	gang_ports;
+
 		std::string id_val;
 		bool	id = false;
 
 		std::string erase_page_wait = "2000";
-		std::string write_page_wait = "5000";
+		std::string write_page_wait = "0";
 
 		utils::areas area_val;
 		bool	area = false;
@@ -120,6 +135,10 @@ namespace {
 		bool	erase = false;
 		bool	write = false;
 		bool	verify = false;
+		bool	verify_crc = false;
+		bool	skip_blank = false;
+		bool	incremental = false;
+		bool	resume = false;
 		bool	device_list = false;
 		bool	progress = false;
 		bool	erase_data = false;
@@ -187,11 +206,12 @@ namespace {
 		cout << "Renesas RX Series Programmer Version " << version_ << endl;
 		cout << "Copyright (C) 2016,2020 Hiramatsu Kunihito (hira@rvf-rc45.net)" << endl;
 		cout << "usage:" << endl;
-		cout << c << " [options] [mot file] ..." << endl;
+		cout << c << " [options] [mot/hex/elf file] ..." << endl;
 		cout << endl;
 		cout << "Options :" << endl;
 		cout << "    -P PORT,   --port=PORT     Specify serial port" << endl;
-		cout << "    -s SPEED,  --speed=SPEED   Specify serial speed" << endl;
+		cout << "    --ports=PORT,PORT,...      Gang programming (one thread per port)" << endl;
+		cout << "    -s SPEED,  --speed=SPEED   Specify serial speed ('auto': fastest stable, cached)" << endl;
 		cout << "    -d DEVICE, --device=DEVICE Specify device name" << endl;
 		cout << "    -e, --erase                Perform a device erase to a minimum" << endl;
 ///		cout << "    --erase-all, --erase-chip\tPerform rom and data flash erase" << endl;
@@ -201,14 +221,381 @@ namespace {
 ///		cout << "    -r, --read                 Perform data read" << endl;
 ///		cout << "    --area=ORG[:,]END          Specify read area" << endl;
 		cout << "    -v, --verify               Perform data verify" << endl;
+		cout << "    --verify-crc               Perform data verify by device CRC (read back on mismatch)" << endl;
 		cout << "    -w, --write                Perform data write" << endl;
+		cout << "    --skip-blank               Do not write pages that are all 0xFF" << endl;
+		cout << "    --incremental              Erase/Write only blocks that differ from the device" << endl;
+		cout << "    --resume                   Continue an interrupted Erase/Write from the journal" << endl;
 		cout << "    --progress                 display Progress output" << endl;
 		cout << "    --erase-page-wait=WAIT     Delay per read page  (2000) [uS]" << endl;
-		cout << "    --write-page-wait=WAIT     Delay per write page (5000) [uS]" << endl;
+		cout << "    --write-page-wait=WAIT     Delay per write page (0: wait for response) [uS]" << endl;
+		cout << "    --bin-base=ADDR            Load input file as raw binary at ADDR (hex)" << endl;
 		cout << "    --device-list              Display device list" << endl;
 		cout << "    --verbose                  Verbose output" << endl;
 		cout << "    -h, --help                 Display this" << endl;
 	}
+
+
+	std::mutex	out_mutex_;
+
+
+	// ホーム・ディレクトリーのファイル（HOME が無い場合はカレント）
+	std::string home_file_(const std::string& file)
+	{
+		auto home = getenv("HOME");
+		if(home != nullptr) {
+			return std::string(home) + '/' + file;
+		}
+		return file;
+	}
+
+
+	std::string convert_com_path_(const std::string& path, bool verbose)
+	{
+		// Windwos系シリアル・ポート（COMx）の変換
+		if(path.empty() || path[0] == '/') return path;
+
+		std::string out = path;
+		std::string s = utils::to_lower_text(path);
+		if(s.size() > 3 && s[0] == 'c' && s[1] == 'o' && s[2] == 'm') {
+			int val;
+			if(utils::string_to_int(&s[3], val)) {
+				if(val >= 1 ) {
+					--val;
+					out = "/dev/ttyS" + (boost::format("%d") % val).str();
+				}
+			}
+		}
+		if(verbose) {
+			std::cout << "# Serial port alias: " << path << " ---> " << out << std::endl;
+		}
+		return out;
+	}
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	プログレス表示 @n
+				単独接続では「#」を並べ、ギャング接続では、ポート毎に @n
+				１０％単位の進捗を行で出力する。
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class progress_t {
+		const options&	opts_;
+		std::string		port_;
+		std::string		title_;
+		uint32_t		all_;
+		uint32_t		n_;
+		uint32_t		c_;
+
+	public:
+		progress_t(const options& opts, const std::string& port) :
+			opts_(opts), port_(port), title_(), all_(0), n_(0), c_(0) { }
+
+		void start(const std::string& title, uint32_t all) {
+			title_ = title;
+			all_ = all;
+			n_ = 0;
+			c_ = 0;
+			if(opts_.progress && port_.empty()) {
+				std::cout << (boost::format("%-8s") % (title_ + ":")) << std::flush;
+			}
+		}
+
+		void step(uint32_t adr) {
+			if(opts_.progress) {
+				if(port_.empty()) {
+					uint32_t pos = progress_num_ * n_ / all_;
+					for(uint32_t i = 0; i < (pos - c_); ++i) {
+						std::cout << progress_cha_ << std::flush;
+					}
+					c_ = pos;
+				} else {
+					uint32_t pos = 10 * n_ / all_;
+					if(pos != c_) {
+						std::lock_guard<std::mutex> lock(out_mutex_);
+						std::cout << boost::format("[%s] %s: %d%%") % port_ % title_ % (pos * 10)
+							<< std::endl;
+						c_ = pos;
+					}
+				}
+			} else if(opts_.verbose) {
+				std::lock_guard<std::mutex> lock(out_mutex_);
+				if(!port_.empty()) std::cout << '[' << port_ << "] ";
+				std::cout << boost::format("%s: %08X to %08X") % title_ % adr % (adr + 255) << std::endl;
+			}
+			++n_;
+		}
+
+		void end() {
+			if(!opts_.progress) return;
+			if(port_.empty()) {
+				std::cout << std::endl << std::flush;
+			} else {
+				std::lock_guard<std::mutex> lock(out_mutex_);
+				std::cout << boost::format("[%s] %s: done") % port_ % title_ << std::endl;
+			}
+		}
+
+		void message(const std::string& text) {
+			std::lock_guard<std::mutex> lock(out_mutex_);
+			if(!port_.empty()) std::cout << '[' << port_ << "] ";
+			std::cout << text << std::endl;
+		}
+	};
+
+
+	struct session_t {
+		int		com_speed = 0;
+		bool	auto_speed = false;
+		int		erase_page_wait = 0;
+		int		write_page_wait = 0;
+		rx::protocol::rx_t	rx;
+	};
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	速度自動選択で接続 @n
+				速い方から順に試し、通信を検査して、結果をキャッシュに記録する。@n
+				速度変更に失敗したブート・ローダーは、リセットしないと @n
+				再同期出来ないので、１回の起動で試すのは一つの速度だけとする。@n
+				速度変更以降で失敗した速度は、次回の起動で飛ばされる @n
+				（speed_cache::NG_EXPIRE 秒が過ぎると、再び試す）。
+		@param[in]	prog	rx::prog
+		@param[in]	prg		プログレス（メッセージ出力）
+		@param[in]	path	シリアル・デバイス・パス
+		@param[in]	ses		セッション設定
+		@return 成功なら「true」
+	*/
+	//-----------------------------------------------------------------//
+	bool connect_auto_(rx::prog& prog, progress_t& prg, const std::string& path,
+		const session_t& ses)
+	{
+		static const uint32_t probe_num = 8;
+
+		std::vector<uint32_t> list;
+		const auto& dev = ses.rx.cpu_type_;
+#ifdef WIN32
+		if(dev != "RX63T" && dev != "RX24T") {
+			list.push_back(576000);
+			list.push_back(500000);
+			list.push_back(460800);
+		}
+#endif
+		list.push_back(230400);
+		list.push_back(115200);
+		list.push_back(57600);
+		list.push_back(38400);
+		list.push_back(19200);
+
+		// ポートが無い場合は、速度の失敗として記録しない
+		if(!utils::probe_file(path)) {
+			std::cerr << "Can't open path: '" << path << "'" << std::endl;
+			return false;
+		}
+
+		uint32_t speed = 0;
+		if(!speed_cache_.get_ok(path, dev, speed)) {
+			// 失敗した速度を飛ばす（最も遅い速度は常に試す）
+			for(auto s : list) {
+				speed = s;
+				if(!speed_cache_.is_ng(path, dev, s)) break;
+			}
+		}
+		if(ses.rx.verbose_) {
+			prg.message((boost::format("# Serial port speed (auto): %d") % speed).str());
+		}
+
+		uint32_t rate = 0;
+		bool start = prog.start(path, speed, ses.rx);
+		if(start && prog.probe_speed(probe_num, rate)) {
+			speed_cache_.set(path, dev, speed, true, rate);
+			if(ses.rx.verbose_) {
+				prg.message((boost::format("# Probe: %d bps, %d bytes/sec") % speed % rate).str());
+			}
+			return true;
+		}
+
+		// ボーレート変更より前の失敗（電源、配線、ポート違い）は、速度を記録しない
+		if(start || prog.is_speed_tried()) {
+			speed_cache_.set(path, dev, speed, false);
+			prg.message((boost::format("Speed %d failed, reset the device and run again.") % speed).str());
+		}
+		return false;
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	１デバイス分のプログラミング（接続、消去、書き込み、ベリファイ）@n
+				イメージ（motsx_）は読み出しのみなので、複数スレッドから呼べる。
+		@param[in]	opts	オプション
+		@param[in]	path	シリアル・デバイス・パス
+		@param[in]	port	ギャング時のポート名（単独なら空）
+		@param[in]	ses		セッション設定
+		@return 成功なら「true」
+	*/
+	//-----------------------------------------------------------------//
+	bool program_(const options& opts, const std::string& path, const std::string& port,
+		const session_t& ses)
+	{
+		progress_t prg(opts, port);
+		auto get = [](uint32_t adr) { return motsx_.get_memory(adr); };
+		auto pf = [&](uint32_t adr) { prg.step(adr); };
+
+		//============================ 接続
+		rx::prog prog_(opts.verbose);
+		if(ses.auto_speed) {
+			if(!connect_auto_(prog_, prg, path, ses)) {
+				prog_.end();
+				return false;
+			}
+		} else if(!prog_.start(path, ses.com_speed, ses.rx)) {
+			prog_.end();
+			return false;
+		}
+
+		//============================ 書き換えが必要なページ
+		auto ps = create_pages_();
+
+		//============================ ジャーナル（イレース・ブロック単位で、書き込み応答を記録する）
+		bool journal = false;
+		std::string devid;
+		uint32_t bsz = 0;
+		if(opts.erase && opts.write && !ps.empty()) {
+			bsz = prog_.get_erase_block_size(ps[0]);
+			journal = bsz != 0;
+		}
+		if(journal) {
+			devid = prog_.get_device_id();
+			if(opts.resume) {
+				auto bs = journal_.resume(path, devid, image_hash_);
+				rx::prog::pages out;
+				rx::prog::pages jps;
+				for(auto adr : ps) {
+					auto blk = adr & ~(prog_.get_erase_block_size(adr) - 1);
+					if(std::binary_search(bs.begin(), bs.end(), blk)) {
+						jps.push_back(adr);
+					} else {
+						out.push_back(adr);
+					}
+				}
+				// デバイス ID は種別だけなので、同じ種別の別のボードかもしれない、
+				// 記録されたブロックは、デバイスの内容（CRC）を確認してから飛ばす
+				rx::prog::pages changed;
+				if(!jps.empty()) {
+					prg.start("Check", jps.size());
+					if(!prog_.select_changed_pages(jps, get, changed, pf, true)) {
+						prog_.end();
+						return false;
+					}
+					prg.end();
+				}
+				if(!changed.empty()) {
+					rx::prog::pages tmp;
+					std::merge(out.begin(), out.end(), changed.begin(), changed.end(),
+						std::back_inserter(tmp));
+					out.swap(tmp);
+				}
+				prg.message((boost::format("Resume: %d blocks recorded, %d pages differ, %d / %d pages left")
+					% bs.size() % changed.size() % out.size() % ps.size()).str());
+				ps.swap(out);
+			} else {
+				journal_.remove(path);
+			}
+		} else if(opts.resume) {
+			prg.message("Resume not supported (erase block unknown or no erase/write).");
+		}
+		if(opts.incremental && (opts.erase || opts.write)) {
+			prg.start("Read", ps.size());
+			rx::prog::pages out;
+			if(!prog_.select_changed_pages(ps, get, out, pf)) {
+				prog_.end();
+				return false;
+			}
+			prg.end();
+			if(opts.verbose || opts.progress) {
+				prg.message((boost::format("Incremental: %d / %d pages changed")
+					% out.size() % ps.size()).str());
+			}
+			ps.swap(out);
+		}
+
+		//============================ 消去
+		if(opts.erase) {  // erase
+			prg.start("Erase", ps.size());
+			for(auto adr : ps) {
+				prg.step(adr);
+				if(!prog_.erase_page(adr)) {  // 256 バイト単位で消去要求を送る
+					prog_.end();
+					return false;
+				}
+				usleep(ses.erase_page_wait);	// 2[ms] wait 待ちを入れないとマイコン側がロストする・・
+			}
+			prg.end();
+		}
+
+		//=====================================
+		if(opts.write) {  // write
+			rx::prog::pages wps;
+			for(auto adr : ps) {
+				if(opts.skip_blank && motsx_.is_blank_page(adr)) continue;
+				wps.push_back(adr);
+			}
+			if(!wps.empty()) {
+				if(!prog_.start_write(true)) {
+					prog_.end();
+					return false;
+				}
+			}
+
+			// ブロックの最後のページの書き込み応答を受けたら、ジャーナルに記録する
+			// （ベリファイ前なので、再開時にデバイスの内容を確認する）
+			rx::prog::progress_func df = nullptr;
+			if(journal) {
+				df = [&](uint32_t adr) {
+					auto it = std::upper_bound(wps.begin(), wps.end(), adr);
+					auto mask = ~(prog_.get_erase_block_size(adr) - 1);
+					if(it == wps.end() || (*it & mask) != (adr & mask)) {
+						journal_.add(path, devid, image_hash_, adr & mask);
+					}
+				};
+			}
+
+			prg.start("Write", wps.size());
+			// write_page_wait が「０」なら、ブート・ローダーのレスポンスだけで進める
+			if(!prog_.write_pages(wps, get, ses.write_page_wait, pf, df)) {
+				prog_.end();
+				return false;
+			}
+			prg.end();
+			if(opts.verbose || opts.progress) {
+				prg.message((boost::format("Write: %d bytes, %.2f sec, %d bytes/sec")
+					% prog_.get_write_bytes() % prog_.get_write_time() % prog_.get_write_rate()).str());
+			}
+			if(!wps.empty() && !prog_.final_write()) {
+				prog_.end();
+				return false;
+			}
+		}
+
+		//=====================================
+		if(opts.verify) {  // verify
+			auto vps = create_pages_();
+			prg.start("Verify", vps.size());
+			if(!prog_.verify_pages(vps, get, opts.verify_crc, pf)) {
+				prog_.end();
+				if(journal) journal_.remove(path);  // 内容が不明なので、再開しない
+				return false;
+			}
+			prg.end();
+		}
+
+		prog_.end();
+		if(journal) journal_.remove(path);
+		return true;
+	}
 }
 
 int main(int argc, char* argv[])
@@ -272,7 +659,9 @@ int main(int argc, char* argv[])
 			else if(p.find("--device=") == 0) {
 				opts.device = &p[std::strlen("--device=")];
 			} else if(p == "-P") opts.dp = true;
-			else if(p.find("--port=") == 0) {
+			else if(p.find("--ports=") == 0) {
+				opts.gang_ports = utils::split_text(&p[std::strlen("--ports=")], ",");
+			} else if(p.find("--port=") == 0) {
 				opts.com_path = &p[std::strlen("--port=")];
 ///			} else if(p == "-a") {
 ///				opts.area = true;
@@ -290,8 +679,19 @@ int main(int argc, char* argv[])
 				opts.write = true;
 			} else if(p == "-v" || p == "--verify") {
 				opts.verify = true;
+			} else if(p == "--verify-crc") {
+				opts.verify = true;
+				opts.verify_crc = true;
+			} else if(p == "--skip-blank") {
+				opts.skip_blank = true;
+			} else if(p == "--incremental") {
+				opts.incremental = true;
+			} else if(p == "--resume") {
+				opts.resume = true;
 			} else if(p == "--progress") {
 				opts.progress = true;
+			} else if(p.find("--bin-base=") == 0) {
+				opts.bin_base = &p[std::strlen("--bin-base=")];
 			} else if(p == "--device-list") {
 				opts.device_list = true;
 			} else if(p == "-e" || p == "--erase") {
@@ -363,57 +763,66 @@ int main(int argc, char* argv[])
 		return 0;
 	}
 
-	// 入力ファイルの読み込み
-	uint32_t pageall = 0;
+	// 入力ファイルの読み込み（ギャング接続では、全てのセッションで共有する）
 	if(!opts.inp_file.empty()) {
 		if(opts.verbose) {
 			std::cout << "# Input file path: '" << opts.inp_file << '\'' << std::endl;
 		}
-		if(!motsx_.load(opts.inp_file)) {
+		auto st = std::chrono::steady_clock::now();
+		bool ok;
+		if(!opts.bin_base.empty()) {
+			uint32_t base = 0;
+			if(!utils::string_to_hex(opts.bin_base, base)) {
+				std::cerr << "Binary base address conversion error: '" << opts.bin_base << "'" << std::endl;
+				return -1;
+			}
+			ok = motsx_.load_binary(opts.inp_file, base);
+		} else {
+			ok = motsx_.load(opts.inp_file);
+		}
+		if(!ok) {
 			std::cerr << "Can't open input file: '" << opts.inp_file << "'" << std::endl;
 			return -1;
 		}
-		pageall = motsx_.get_total_page();
 		if(opts.verbose) {
+			auto d = std::chrono::steady_clock::now() - st;
+			std::cout << boost::format("# Load time: %.3f sec, %d pages")
+				% std::chrono::duration<double>(d).count() % motsx_.get_total_page() << std::endl;
 			motsx_.list_area_map("# ");
 		}
 	}
 
-    // Windwos系シリアル・ポート（COMx）の変換
-    if(!opts.com_path.empty() && opts.com_path[0] != '/') {
-		std::string s = utils::to_lower_text(opts.com_path);
-        if(s.size() > 3 && s[0] == 'c' && s[1] == 'o' && s[2] == 'm') {
-            int val;
-            if(utils::string_to_int(&s[3], val)) {
-                if(val >= 1 ) {
-                    --val;
-                    opts.com_name = opts.com_path;
-                    opts.com_path = "/dev/ttyS" + (boost::format("%d") % val).str();
-                }
-            }
-        }
+	// 書き込みジャーナル
+	if(opts.erase && opts.write) {
+		auto path = home_file_(journal_file_);
+		journal_.load(path);
+		image_hash_ = motsx_.get_hash();
 		if(opts.verbose) {
-			std::cout << "# Serial port alias: " << opts.com_name << " ---> " << opts.com_path << std::endl;
+			std::cout << "# Journal path: '" << path << '\'' << std::endl;
+			std::cout << boost::format("# Image hash: %016X") % image_hash_ << std::endl;
 		}
-    }
-	if(opts.com_path.empty()) {
-		std::cerr << "Serial port path not found." << std::endl;
-		return -1;
 	}
-	if(opts.verbose) {
-		std::cout << "# Serial port path: '" << opts.com_path << '\'' << std::endl;
-	}
-	int com_speed = 0;
-	if(!utils::string_to_int(opts.com_speed, com_speed)) {
+
+	session_t ses;
+	ses.erase_page_wait = erase_page_wait;
+	ses.write_page_wait = write_page_wait;
+	std::string speed_cache_path;
+	if(opts.com_speed == "auto") {
+		ses.auto_speed = true;
+		speed_cache_path = home_file_(speed_cache_file_);
+		speed_cache_.load(speed_cache_path);
+		if(opts.verbose) {
+			std::cout << "# Speed cache path: '" << speed_cache_path << '\'' << std::endl;
+		}
+	} else if(!utils::string_to_int(opts.com_speed, ses.com_speed)) {
 		std::cerr << "Serial speed conversion error: '" << opts.com_speed << '\'' << std::endl;
 		return -1;
 	}
 
-	rx::protocol::rx_t rx;
-	rx.verbose_ = opts.verbose;
-	rx.cpu_type_ = opts.device;
+	ses.rx.verbose_ = opts.verbose;
+	ses.rx.cpu_type_ = opts.device;
 
-	if(rx.cpu_type_ == "RX63T") {
+	if(ses.rx.cpu_type_ == "RX63T") {
 		// rx.master_ = 1200;  // 12.00MHz
 		// rx.sys_div_ = 8;    // x8 (96MHz)
 		// rx.ext_div_ = 4;    // x4 (48MHz)
@@ -423,134 +832,65 @@ int main(int argc, char* argv[])
 			std::cerr << "RX63T 'clock' tag conversion error: '" << devt.clock_ << '\'' << std::endl;
 			return -1;
 		}
-		rx.master_ = val;
+		ses.rx.master_ = val;
 
 		if(!utils::string_to_int(devt.divide_sys_, val)) {
 			std::cerr << "RX63T 'divide_sys' tag conversion error: '" << devt.divide_sys_ << '\'' << std::endl;
 			return -1;
 		}
-		rx.sys_div_ = val;
+		ses.rx.sys_div_ = val;
 
 		if(!utils::string_to_int(devt.divide_ext_, val)) {
 			std::cerr << "RX63T 'divide_ext' tag conversion error: '" << devt.divide_ext_ << '\'' << std::endl;
 			return -1;
 		}
-		rx.ext_div_ = val;
-	}
-
-	//============================ 接続
-	rx::prog prog_(opts.verbose);
-	if(!prog_.start(opts.com_path, com_speed, rx)) {
-		prog_.end();
-		return -1;
+		ses.rx.ext_div_ = val;
 	}
 
-	//============================ 消去
-	if(opts.erase) {  // erase
-		auto areas = motsx_.create_area_map();
-
-		if(opts.progress) {
-			std::cout << "Erase:  " << std::flush;
-		}
-
-		page_t page;
-		for(const auto& a : areas) {
-			uint32_t adr = a.min_ & 0xffffff00;
-			uint32_t len = 0;
-			while(len < (a.max_ - a.min_ + 1)) {
-				if(opts.progress) {
-					progress_(pageall, page);
-				} else if(opts.verbose) {
-					std::cout << boost::format("Erase: %08X to %08X") % adr % (adr + 255) << std::endl;
-				}
-				if(!prog_.erase_page(adr)) {  // 256 バイト単位で消去要求を送る
-					prog_.end();
-					return -1;
-				}
-				adr += 256;
-				len += 256;
-				++page.n;
-				usleep(erase_page_wait);	// 2[ms] wait 待ちを入れないとマイコン側がロストする・・
+	//============================ ギャング接続
+	// 終了コードは、失敗したポートのビット・マスク（n 番目のポートが bit n、８番目以降は bit 7）
+	if(!opts.gang_ports.empty()) {
+		auto n = opts.gang_ports.size();
+		std::vector<char> result(n, 0);
+		std::vector<std::thread> threads;
+		for(uint32_t i = 0; i < n; ++i) {
+			const auto& port = opts.gang_ports[i];
+			auto path = convert_com_path_(port, opts.verbose);
+			threads.emplace_back([&opts, &ses, &result, port, path, i]() {
+				result[i] = program_(opts, path, port, ses);
+			});
+		}
+		int ret = 0;
+		for(uint32_t i = 0; i < n; ++i) {
+			threads[i].join();
+		}
+		if(ses.auto_speed) {
+			speed_cache_.save(speed_cache_path);
+		}
+		for(uint32_t i = 0; i < n; ++i) {
+			std::cout << boost::format("[%s] %s") % opts.gang_ports[i] % (result[i] ? "OK" : "NG")
+				<< std::endl;
+			if(!result[i]) {
+				ret |= 1 << std::min(i, static_cast<uint32_t>(7));
 			}
 		}
-		if(opts.progress) {
-			std::cout << std::endl << std::flush;
-		}
+		return ret;
 	}
 
-	//=====================================
-	if(opts.write) {  // write
-		auto areas = motsx_.create_area_map();
-		if(!areas.empty()) {
-			if(!prog_.start_write(true)) {
-				prog_.end();
-				return -1;
-			}
-		}
-		
-		if(opts.progress) {
-			std::cout << "Write:  " << std::flush;
-		}
-		page_t page;
-		for(const auto& a : areas) {
-			uint32_t adr = a.min_ & 0xffffff00;
-			uint32_t len = 0;
-			while(len < (a.max_ - a.min_ + 1)) {
-				if(opts.progress) {
-					progress_(pageall, page);
-				} else if(opts.verbose) {
-					std::cout << boost::format("Write: %08X to %08X") % adr % (adr + 255) << std::endl;
-				}
-				auto mem = motsx_.get_memory(adr);
-				if(!prog_.write(adr, &mem[0])) {
-					prog_.end();
-					return -1;
-				}
-				adr += 256;
-				len += 256;
-				++page.n;
-				usleep(write_page_wait);	// 5[ms] wait 待ちを入れないとマイコン側がロストする・・
-			}
-		}
-		if(opts.progress) {
-			std::cout << std::endl << std::flush;
-		}
-		if(!prog_.final_write()) {
-			prog_.end();
-			return -1;
-		}
+	opts.com_path = convert_com_path_(opts.com_path, opts.verbose);
+	if(opts.com_path.empty()) {
+		std::cerr << "Serial port path not found." << std::endl;
+		return -1;
 	}
-
-	//=====================================
-	if(opts.verify) {  // verify
-		auto areas = motsx_.create_area_map();
-		if(opts.progress) {
-			std::cout << "Verify: " << std::flush;
-		}
-		page_t page;
-		for(const auto& a : areas) {
-			uint32_t adr = a.min_ & 0xffffff00;
-			uint32_t len = 0;
-			while(len < (a.max_ - a.min_ + 1)) {
-				if(opts.progress) {
-					progress_(pageall, page);
-				} else if(opts.verbose) {
-					std::cout << boost::format("Verify: %08X to %08X") % adr % (adr + 255) << std::endl;
-				}
-				auto mem = motsx_.get_memory(adr);
-				if(!prog_.verify_page(adr, &mem[0])) {
-					prog_.end();
-					return -1;
-				}
-				adr += 256;
-				len += 256;
-				++page.n;
-			}
-		}
-		if(opts.progress) {
-			std::cout << std::endl << std::flush;
-		}
+	if(opts.verbose) {
+		std::cout << "# Serial port path: '" << opts.com_path << '\'' << std::endl;
 	}
 
-	prog_.end();
+	bool ok = program_(opts, opts.com_path, "", ses);
+	if(ses.auto_speed) {
+		speed_cache_.save(speed_cache_path);
+	}
+	if(!ok) {
+		return -1;
+	}
 }
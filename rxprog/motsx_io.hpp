@@ -1,18 +1,18 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	モトローラーＳフォーマット入出力
+	@brief	モトローラーＳフォーマット入出力（インテル HEX、ELF32、バイナリー入力）
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2016, 2017 Kunihito Hiramatsu @n
 				Released under the MIT license @n
 				https://github.com/hirakuni45/RX/blob/master/LICENSE
 */
 //=====================================================================//
+#include <iostream>
 #include <vector>
-#include <map>
 #include <string>
-#include <array>
 #include "file_io.hpp"
+#include "sparse_image.hpp"
 #include <iomanip>
 #include <boost/format.hpp>
 
@@ -20,231 +20,283 @@ namespace utils {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
-		@brief	Motolora Sx I/O クラス
+		@brief	Motolora Sx I/O クラス @n
+				インテル HEX、ELF32、バイナリーも、同じイメージに読み込める
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	class motsx_io {
 	public:
-		typedef std::array<uint8_t, 256> array;
-
-		struct area_t {
-			uint32_t	min_;
-			uint32_t	max_;
-			area_t(uint32_t min = 0xffffffff, uint32_t max = 0) : min_(min), max_(max) { } 			
-		};
-		typedef std::vector<area_t> areas;
-
-		struct array_t {
-			area_t	area_;
-			array	array_;
-
-			array_t() : area_(), array_() { array_.fill(0xff); }
-
-			void set(uint32_t adr, uint8_t data) {
-				if(area_.min_ > adr) area_.min_ = adr;
-				if(area_.max_ < adr) area_.max_ = adr;
-				array_[adr & 0xff] = data;
-			}
-		};
+		typedef sparse_image::area_t area_t;
+		typedef sparse_image::areas areas;
 
 	private:
 		area_t		area_;
 		uint32_t	exec_;
 
-		typedef std::map<uint32_t, array_t>	memory_map;
+		sparse_image	image_;
+
+		uint8_t		fill_array_[sparse_image::PAGE_SIZE];
 
-		memory_map	memory_map_;
+		static int hex_(char ch) {
+			if(ch >= '0' && ch <= '9') return ch - '0';
+			else if(ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+			else if(ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+			return -1;
+		}
 
-		array		fill_array_;
 
-		void write_byte_(uint32_t address, uint8_t val) {
-			uint32_t base = address & 0xffff00;
-			memory_map::iterator it = memory_map_.find(base);
-			if(it == memory_map_.end()) {
-				array_t t;
-				t.set(address, val);
-				memory_map_.emplace(base, t);
+		static void illegal_(const char* fmt, char ch) {
+			std::cerr << fmt << " format illegual character: '";
+			if(ch >= 0x20 && ch <= 0x7f) {
+				std::cerr << ch;
 			} else {
-				array_t& t = it->second;
-				t.set(address, val);
+				std::cerr << boost::format("0x%02X") % static_cast<int>(ch);
 			}
+			std::cerr << "'" << std::endl;
 		}
 
 
-		bool load_(utils::file_io& fio) {
-			area_.min_ = 0xffffffff;
-			area_.max_ = 0x00000000;
+		// １６進の文字列をバイト列に変換（空白は無視）
+		static bool decode_hex_(const char* fmt, const char* top, const char* end,
+			uint8_t* dst, uint32_t max, uint32_t& n) {
+			n = 0;
+			int hi = -1;
+			for(const char* p = top; p < end; ++p) {
+				char ch = *p;
+				if(ch == ' ') continue;
+				int v = hex_(ch);
+				if(v < 0) {
+					illegal_(fmt, ch);
+					return false;
+				}
+				if(hi < 0) {
+					hi = v;
+				} else {
+					if(n >= max) {
+						std::cerr << fmt << " format record too long." << std::endl;
+						return false;
+					}
+					dst[n] = (hi << 4) | v;
+					++n;
+					hi = -1;
+				}
+			}
+			return true;
+		}
 
-			uint32_t value = 0;
-			uint32_t type = 0;
-			uint32_t length = 0;
-			uint32_t address = 0;
-			uint32_t sum = 0;
-			int vcnt = 0;
 
-			bool toend = false;
-			int mode = 0;
+		static uint32_t get_(const uint8_t* p, uint32_t len, bool big) {
+			uint32_t v = 0;
+			for(uint32_t i = 0; i < len; ++i) {
+				v <<= 8;
+				v |= big ? p[i] : p[len - 1 - i];
+			}
+			return v;
+		}
 
-			while(1) {
-				char ch;
-				if(!fio.get_char(ch)) {
-					break;
-				}
 
-			   	if(ch == ' ') {
-			   	} else if(ch == 0x0d || ch == 0x0a) {
-				   	if(toend) break;
-			   	} else if(mode == 0 && ch == 'S') {
-			   		mode = 1;
-			   		value = vcnt = 0;
-			   	} else if(ch >= '0' && ch <= '9') {
-			   		value <<= 4;
-			   		value |= ch - '0';
-			   		++vcnt;
-			   	} else if(ch >= 'A' && ch <= 'F') {
-			   		value <<= 4;
-			   		value |= ch - 'A' + 10;
-			   		++vcnt;
-			   	} else {
-					std::cerr << "S format illegual character: '";
-			   		if(ch >= 0x20 && ch <= 0x7f) {
-						std::cerr << ch;
-			   		} else {
-						std::cerr << boost::format("0x%02X") % static_cast<int>(ch);
-			   		}
-					std::cerr << "'" << std::endl;
-			   		return false;
-			   	}
-
-			   	if(mode == 1) {		// タイプ取得
-			   		if(vcnt == 1) {
-			   			type = value;
-			   			mode = 2;
-			   			value = vcnt = 0;
-			   		}
-			   	} else if(mode == 2) {	// レングス取得
-			   		if(vcnt == 2) {
-			   			length = value;
-			   			sum = value;
-			   			mode = 3;
-			   			value = vcnt = 0;
-			   		}
-			   	} else if(mode == 3) {	// アドレス取得
-			   		int alen = 0;
-			   		if(type == 0) {
-			   			alen = 4;
-			   		} else if(type == 1) {
-			   			alen = 4;
-			   		} else if(type == 2) {
-			   			alen = 6;
-			   		} else if(type == 3) {
-			   			alen = 8;
-			   		} else if(type == 5) {
-			   			alen = 4;
-			   		} else if(type == 7) {
-			   			alen = 8;
-			   		} else if(type == 8) {
-			   			alen = 6;
-			   		} else if(type == 9) {
-			   			alen = 4;
-			   		} else {
-			   			return false;
-			   		}
-
-			   		if(vcnt == alen) {
-			   			address = value;
-			   			if(type >= 1 && type <= 3) {
-			   				if(area_.min_ > address) area_.min_ = address;
-			   			}
-			   			alen >>= 1;
-			   			length -= alen;
-			   			length -= 1;	// SUM の分サイズを引く
-			   			while(alen > 0) {
-			   				sum += value;
-			   				value >>= 8;
-			   				--alen;
-			   			}
-				   		if(type >= 1 && type <= 3) {
-				   			mode = 4;
-				   		} else if(type >= 7 && type <= 9) {
-							exec_ = value;
-				   			mode = 5;
-				   		} else {
-				   			mode = 4;
-				   		}
-				   		value = vcnt = 0;
-				   	}
-			   	} else if(mode == 4) {	// データ・レコード
-			   		if(vcnt >= 2) {
-			   			if(type >= 1 && type <= 3) {
-			   				write_byte_(address, value);
-			   				if(area_.max_ < address) area_.max_ = address;
-			   				++address;
-			   			}
-			   			sum += value;
-			   			value = vcnt = 0;
-			   			--length;
-			   			if(length == 0) {
-			   				mode = 5;
-			   			}
-			   		}
-			   	} else if(mode == 5) {	// SUM
-			   		if(vcnt >= 2) {
-			   			value &= 0xff;
-			   			sum ^= 0xff;
-			   			sum &= 0xff;
-			   			if(sum != value) {	// SUM エラー
-							std::cerr << "S format SUM error: ";
-							std::cerr << boost::format("0x%02X -> %02X")
-							    % static_cast<int>(value)
-								% static_cast<int>(sum)
-								<< std::endl;
-			   				return false;
-			   			} else {
-			   				if(type >= 7 && type <= 9) {
-			   					toend = true;
-			   				}
-			   				mode = 0;
-			   				value = vcnt = 0;
-			   			}
-			   		}
-			   	}
-		   	}
-		   	return true;
+		void write_area_(uint32_t address, const uint8_t* src, uint32_t len) {
+			if(len == 0) return;
+			image_.write(address, src, len);
+			if(area_.min_ > address) area_.min_ = address;
+			if(area_.max_ < (address + len - 1)) area_.max_ = address + len - 1;
 		}
 
 
-		bool save_(utils::file_io& fio, const memory_map::value_type& m) {
-			const array_t& a = m.second;
-			fio.put_char('S');
+		// S フォーマット１行（'S' から行末まで）を解析して、データ・レコードならイメージに書き込む
+		bool parse_s_line_(const char* top, const char* end, bool& toend) {
+			++top;
+			while(top < end && *top == ' ') {
+				++top;
+			}
+			if(top >= end || *top < '0' || *top > '9') {
+				illegal_("S", top < end ? *top : ' ');
+				return false;
+			}
+			char type = *top++;
+			uint8_t rec[256 + 1];
+			uint32_t n = 0;
+			if(!decode_hex_("S", top, end, rec, sizeof(rec), n)) {
+				return false;
+			}
+			if(n < 1 || (static_cast<uint32_t>(rec[0]) + 1) != n) {
+				std::cerr << "S format length error." << std::endl;
+				return false;
+			}
+
+			uint32_t alen = 0;
+			switch(type) {
+			case '0': case '1': case '5': case '9': alen = 2; break;
+			case '2': case '6': case '8': alen = 3; break;
+			case '3': case '7': alen = 4; break;
+			default:
+				return false;
+			}
+			if(rec[0] < (alen + 1)) {
+				std::cerr << "S format length error." << std::endl;
+				return false;
+			}
+
+			uint8_t sum = 0;
+			for(uint32_t i = 0; i < (n - 1); ++i) {
+				sum += rec[i];
+			}
+			sum ^= 0xff;
+			if(sum != rec[n - 1]) {	// SUM エラー
+				std::cerr << "S format SUM error: ";
+				std::cerr << boost::format("0x%02X -> %02X")
+					% static_cast<int>(rec[n - 1])
+					% static_cast<int>(sum)
+					<< std::endl;
+				return false;
+			}
+
+			uint32_t address = get_(&rec[1], alen, true);
+			if(type >= '1' && type <= '3') {
+				write_area_(address, &rec[1 + alen], rec[0] - alen - 1);
+			} else if(type >= '7' && type <= '9') {
+				exec_ = address;
+				toend = true;
+			}
+			return true;
+		}
+
 
+		// インテル HEX フォーマット１行（':' から行末まで）を解析
+		bool parse_i_line_(const char* top, const char* end, uint32_t& base, bool& toend) {
+			uint8_t rec[4 + 255 + 1];
+			uint32_t n = 0;
+			if(!decode_hex_("Intel HEX", top + 1, end, rec, sizeof(rec), n)) {
+				return false;
+			}
+			if(n < 5 || (static_cast<uint32_t>(rec[0]) + 5) != n) {
+				std::cerr << "Intel HEX format length error." << std::endl;
+				return false;
+			}
 			uint8_t sum = 0;
-			uint32_t len = (a.area_.max_ - a.area_.min_ + 1) * 2;
-			std::string adr;
-			if(a.area_.max_ <= 0xffff) {
-				adr = (boost::format("1%04X") % a.area_.max_).str();
-				len += 4;
-			} else if(a.area_.max_ <= 0xffffff) {
-				adr = (boost::format("2%06X") % a.area_.max_).str();
-				len += 6;
-			} else {
-				adr = (boost::format("3%08X") % a.area_.max_).str();
-				len += 8;
+			for(uint32_t i = 0; i < n; ++i) {
+				sum += rec[i];
+			}
+			if(sum != 0) {	// SUM エラー
+				std::cerr << "Intel HEX format SUM error: ";
+				std::cerr << boost::format("0x%02X") % static_cast<int>(rec[n - 1]) << std::endl;
+				return false;
+			}
+
+			uint32_t len = rec[0];
+			uint32_t ofs = get_(&rec[1], 2, true);
+			const uint8_t* dat = &rec[4];
+			switch(rec[3]) {
+			case 0x00:  // data
+				write_area_(base + ofs, dat, len);
+				break;
+			case 0x01:  // end of file
+				toend = true;
+				break;
+			case 0x02:  // extended segment address
+				if(len != 2) return false;
+				base = get_(dat, 2, true) << 4;
+				break;
+			case 0x03:  // start segment address (CS:IP)
+				if(len != 4) return false;
+				exec_ = (get_(dat, 2, true) << 4) + get_(&dat[2], 2, true);
+				break;
+			case 0x04:  // extended linear address
+				if(len != 2) return false;
+				base = get_(dat, 2, true) << 16;
+				break;
+			case 0x05:  // start linear address
+				if(len != 4) return false;
+				exec_ = get_(dat, 4, true);
+				break;
+			default:
+				std::cerr << boost::format("Intel HEX format record type error: %02X")
+					% static_cast<int>(rec[3]) << std::endl;
+				return false;
+			}
+			return true;
+		}
+
+
+		// テキスト（S フォーマット、インテル HEX）のロード
+		bool load_text_(const utils::array_uc& buff) {
+			const char* p = reinterpret_cast<const char*>(buff.data());
+			const char* end = p + buff.size();
+			bool toend = false;
+			uint32_t base = 0;
+			while(p < end && !toend) {
+				const char* eol = p;
+				while(eol < end && *eol != 0x0d && *eol != 0x0a) {
+					++eol;
+				}
+				const char* top = p;
+				while(top < eol && *top == ' ') {
+					++top;
+				}
+				if(top < eol) {
+					if(*top == 'S') {
+						if(!parse_s_line_(top, eol, toend)) {
+							return false;
+						}
+					} else if(*top == ':') {
+						if(!parse_i_line_(top, eol, base, toend)) {
+							return false;
+						}
+					} else {
+						illegal_("S", *top);
+						return false;
+					}
+				}
+				p = eol + 1;
 			}
-			len += 2; // for check sum
-			fio.put((boost::format("%02X") % len).str());
-			fio.put(adr);
+			return true;
+		}
+
 
-			for(uint32_t i = a.area_.min_; i <= a.area_.max_; ++i) {
-				uint8_t data = a.array_[i & 255];
-				fio.put((boost::format("%02X") % data).str());
-				sum += data;
+		// ELF32 のロード（PT_LOAD セグメントを、物理アドレスにそのまま配置する）
+		bool load_elf_(const utils::array_uc& buff) {
+			const uint8_t* top = buff.data();
+			if(buff.size() < 0x34 || top[4] != 1) {  // ELFCLASS32
+				std::cerr << "ELF format error (not ELF32)." << std::endl;
+				return false;
+			}
+			bool big = top[5] == 2;  // ELFDATA2MSB
+			exec_ = get_(&top[0x18], 4, big);
+			uint32_t phoff = get_(&top[0x1C], 4, big);
+			uint32_t phentsize = get_(&top[0x2A], 2, big);
+			uint32_t phnum = get_(&top[0x2C], 2, big);
+			if(phentsize < 0x20 || (static_cast<uint64_t>(phoff) + phentsize * phnum) > buff.size()) {
+				std::cerr << "ELF format error (program header)." << std::endl;
+				return false;
+			}
+			for(uint32_t i = 0; i < phnum; ++i) {
+				const uint8_t* ph = &top[phoff + i * phentsize];
+				if(get_(&ph[0x00], 4, big) != 1) continue;  // PT_LOAD のみ
+				uint32_t ofs = get_(&ph[0x04], 4, big);
+				uint32_t paddr = get_(&ph[0x0C], 4, big);
+				uint32_t filesz = get_(&ph[0x10], 4, big);
+				if((static_cast<uint64_t>(ofs) + filesz) > buff.size()) {
+					std::cerr << "ELF format error (segment)." << std::endl;
+					return false;
+				}
+				write_area_(paddr, &top[ofs], filesz);
 			}
+			return true;
+		}
 
-			fio.put((boost::format("%02X") % static_cast<uint32_t>(sum)).str());
 
-			fio.put_char('\n');
-			return false;
+		bool save_(utils::file_io& fio, uint32_t address, const uint8_t* src, uint32_t len) {
+			uint8_t sum = len + 4 + 1;
+			std::string line = (boost::format("S3%02X%08X") % (len + 4 + 1) % address).str();
+			for(uint32_t i = 0; i < 4; ++i) {
+				sum += address >> (i * 8);
+			}
+			for(uint32_t i = 0; i < len; ++i) {
+				line += (boost::format("%02X") % static_cast<uint32_t>(src[i])).str();
+				sum += src[i];
+			}
+			line += (boost::format("%02X") % static_cast<uint32_t>(sum ^ 0xff)).str();
+			return fio.put_line(line);
 		}
 
 
@@ -254,14 +306,15 @@ namespace utils {
 			@brief	コンストラクター
 		*/
 		//-----------------------------------------------------------------//
-		motsx_io() : area_(), exec_(0x000000) {
-			fill_array_.fill(0xff);
+		motsx_io() : area_(), exec_(0x000000), image_() {
+			std::memset(fill_array_, 0xff, sizeof(fill_array_));
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	ロード
+			@brief	ロード @n
+					ファイルの内容から、S フォーマット、インテル HEX、ELF32 を判別する。
 			@param[in]	path	ファイルパス
 			@return エラー無しなら「true」
 		*/
@@ -271,39 +324,87 @@ namespace utils {
 			if(!fio.open(path, "rb")) {
 				return false;
 			}
+			utils::array_uc buff;
+			bool ok = utils::read_array(fio, buff);
+			fio.close();
+			if(!ok) {
+				return false;
+			}
 
-			memory_map_.clear();
+			image_.clear();
+			area_ = area_t();
+			exec_ = 0;
 
-			if(!load_(fio)) {
-				return false;
+			if(buff.size() >= 4 && buff[0] == 0x7f && buff[1] == 'E' && buff[2] == 'L' && buff[3] == 'F') {
+				return load_elf_(buff);
+			} else {
+				return load_text_(buff);
 			}
+		}
+
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	バイナリーのロード
+			@param[in]	path	ファイルパス
+			@param[in]	base	配置するアドレス
+			@return エラー無しなら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool load_binary(const std::string& path, uint32_t base) {
+			utils::file_io fio;
+			if(!fio.open(path, "rb")) {
+				return false;
+			}
+			utils::array_uc buff;
+			bool ok = utils::read_array(fio, buff);
 			fio.close();
+			if(!ok || (static_cast<uint64_t>(base) + buff.size()) > 0x100000000ULL) {
+				return false;
+			}
+
+			image_.clear();
+			area_ = area_t();
+			exec_ = base;
 
+			write_area_(base, buff.data(), buff.size());
 			return true;
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	セーブ
+			@brief	セーブ（S3 レコード、１行３２バイト）
 			@param[in]	path	ファイルパス
 			@return エラー無しなら「true」
 		*/
 		//-----------------------------------------------------------------//
 		bool save(const std::string& path) {
-			if(memory_map_.empty()) return false;
+			if(image_.empty()) return false;
 
 			utils::file_io fio;
 			if(!fio.open(path, "wb")) {
 				return false;
 			}
 
-			for(const auto& m : memory_map_) {
-				if(!save_(fio, m)) {
-					return false;
+			for(const auto& a : image_.get_areas()) {
+				uint64_t adr = a.min_;
+				uint64_t end = static_cast<uint64_t>(a.max_) + 1;
+				while(adr < end) {
+					uint32_t len = 32 - (adr & 31);
+					if((adr + len) > end) len = end - adr;
+					auto p = image_.get_page(adr);
+					if(!save_(fio, adr, p + (adr & 0xff), len)) {
+						return false;
+					}
+					adr += len;
 				}
 			}
+			uint8_t sum = 4 + 1;
+			for(uint32_t i = 0; i < 4; ++i) {
+				sum += exec_ >> (i * 8);
+			}
+			fio.put_line((boost::format("S705%08X%02X") % exec_ % static_cast<uint32_t>(sum ^ 0xff)).str());
 
 			fio.close();
 
@@ -320,9 +421,7 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		void write(uint32_t address, const uint8_t* data, uint32_t len) {
-			for(uint32_t i = 0; i < len; ++i) {
-				write_byte_(address + i, data[i]);
-			}
+			image_.write(address, data, len);
 		}
 
 
@@ -333,27 +432,24 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		uint32_t get_total_page() const {
-			return memory_map_.size();
+			return image_.get_page_num();
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	エリア・マップの作成
+			@brief	エリア・マップの作成 @n
+					同じページにかかる領域は、一つにまとめる
 			@return エリア・マップ
 		*/
 		//-----------------------------------------------------------------//
 		areas create_area_map() const {
 			areas as;
-			for(const auto& m : memory_map_) {
-				if(as.empty()) {
-					as.emplace_back(m.second.area_);
+			for(const auto& a : image_.get_areas()) {
+				if(!as.empty() && (as.back().max_ >> 8) == (a.min_ >> 8)) {
+					as.back().max_ = a.max_;
 				} else {
-					if((as.back().max_ + 1) == m.second.area_.min_) {
-						as.back().max_ = m.second.area_.max_;
-					} else {
-						as.emplace_back(m.second.area_);
-					}
+					as.push_back(a);
 				}
 			}
 			return as;
@@ -367,7 +463,7 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		void list_area_map(const std::string& head) const {
-			std::cout << head << boost::format("Motolola Sx format load map: (exec: 0x%08X)") % exec_;
+			std::cout << head << boost::format("Load map: (exec: 0x%08X)") % exec_;
 			std::cout << std::endl;
 
 			auto as = create_area_map();
@@ -408,7 +504,26 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		bool find_page(uint32_t address) const {
-			return memory_map_.find(address & 0xffff00) != memory_map_.end();
+			return image_.get_page(address) != nullptr;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ブランク・ページ（全て 0xFF）か検査
+			@param[in]	address	アドレス
+			@return ブランク・ページなら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool is_blank_page(uint32_t address) const {
+			auto p = image_.get_page(address);
+			if(p == nullptr) {
+				return true;
+			}
+			for(uint32_t i = 0; i < sparse_image::PAGE_SIZE; ++i) {
+				if(p[i] != 0xff) return false;
+			}
+			return true;
 		}
 
 
@@ -416,16 +531,43 @@ namespace utils {
 		/*!
 			@brief	ページメモリーの取得
 			@param[in]	address	ベースとなるアドレス
-			@return ページメモリー @n
+			@return ページメモリー（２５６バイト） @n
 					無効なページの場合、内部データは全て 0xff となっている。
 		*/
 		//-----------------------------------------------------------------//
-		const array& get_memory(uint32_t address) const {
-			memory_map::const_iterator cit = memory_map_.find(address & 0xffff00);
-			if(cit == memory_map_.end()) {
+		const uint8_t* get_memory(uint32_t address) const {
+			auto p = image_.get_page(address);
+			if(p == nullptr) {
 				return fill_array_;
 			}
-			return cit->second.array_;
+			return p;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	イメージのハッシュ（FNV-1a 64 ビット）を取得 @n
+					ページ・アドレスとページ・データから計算する
+			@return ハッシュ値
+		*/
+		//-----------------------------------------------------------------//
+		uint64_t get_hash() const {
+			uint64_t h = 0xcbf29ce484222325ULL;
+			auto step = [&h](uint8_t v) {
+				h ^= v;
+				h *= 0x100000001b3ULL;
+			};
+			for(const auto& a : create_area_map()) {
+				uint32_t adr = a.min_ & ~(sparse_image::PAGE_SIZE - 1);
+				while(adr <= a.max_) {
+					for(int i = 0; i < 4; ++i) step((adr >> (i * 8)) & 0xff);
+					auto p = get_memory(adr);
+					for(uint32_t i = 0; i < sparse_image::PAGE_SIZE; ++i) step(p[i]);
+					adr += sparse_image::PAGE_SIZE;
+					if(adr == 0) break;  // アドレス空間の終わり
+				}
+			}
+			return h;
 		}
 	};
 }
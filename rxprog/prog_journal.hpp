@@ -0,0 +1,191 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	書き込みジャーナル @n
+			消去、書き込みの応答を受けたイレース・ブロックを記録して、@n
+			中断したセッションを続きから再開出来るようにする @n
+			（ベリファイ前の記録なので、再開する側でデバイスの内容を確認する） @n
+			１行に「ポート デバイス ID イメージ・ハッシュ ブロック・アドレス」
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "string_utils.hpp"
+#include "file_io.hpp"
+#include <mutex>
+#include <algorithm>
+#include <boost/format.hpp>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	書き込みジャーナル・クラス（ギャング接続の為、スレッド・セーフ）@n
+				ブロックの記録は、中断に備えて、その都度ファイルに追加する
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class prog_journal {
+	public:
+		typedef std::vector<uint32_t> blocks;
+
+	private:
+		struct entry_t {
+			std::string	port_;
+			std::string	device_;
+			std::string	hash_;
+			uint32_t	block_;
+			entry_t() : port_(), device_(), hash_(), block_(0) { }
+		};
+		typedef std::vector<entry_t> entries;
+
+		std::string		file_;
+		entries			entries_;
+		std::mutex		mutex_;
+
+		static std::string hash_text_(uint64_t hash) {
+			return (boost::format("%016X") % hash).str();
+		}
+
+		bool save_() {
+			if(entries_.empty()) {
+				if(utils::probe_file(file_)) {
+					return utils::remove_file(file_);
+				}
+				return true;
+			}
+			utils::file_io fio;
+			if(!fio.open(file_, "wb")) {
+				return false;
+			}
+			for(const auto& t : entries_) {
+				fio.put_line((boost::format("%s %s %s %08X")
+					% t.port_ % t.device_ % t.hash_ % t.block_).str());
+			}
+			fio.close();
+			return true;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		prog_journal() : file_(), entries_(), mutex_() { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	読み込み（ファイルが無い場合は、空のジャーナルとなる）
+			@param[in]	file	ファイル名
+		*/
+		//-----------------------------------------------------------------//
+		void load(const std::string& file)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			file_ = file;
+			entries_.clear();
+			utils::file_io fio;
+			if(!fio.open(file, "rb")) {
+				return;
+			}
+			while(!fio.eof()) {
+				auto line = fio.get_line();
+				auto ss = utils::split_text(line, " \t");
+				if(ss.size() != 4) continue;
+				entry_t t;
+				t.port_ = ss[0];
+				t.device_ = ss[1];
+				t.hash_ = ss[2];
+				if(!utils::string_to_hex(ss[3], t.block_)) continue;
+				entries_.push_back(t);
+			}
+			fio.close();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	再開するブロックの取得 @n
+					デバイス ID、イメージが異なる記録は破棄する
+			@param[in]	port	ポート
+			@param[in]	device	デバイス ID
+			@param[in]	hash	イメージ・ハッシュ
+			@return 書き込み応答を受けたブロック（昇順）
+		*/
+		//-----------------------------------------------------------------//
+		blocks resume(const std::string& port, const std::string& device, uint64_t hash)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			auto h = hash_text_(hash);
+			blocks bs;
+			entries es;
+			for(const auto& t : entries_) {
+				if(t.port_ != port) {
+					es.push_back(t);
+				} else if(t.device_ == device && t.hash_ == h) {
+					es.push_back(t);
+					bs.push_back(t.block_);
+				}
+			}
+			if(es.size() != entries_.size()) {
+				entries_.swap(es);
+				save_();
+			}
+			std::sort(bs.begin(), bs.end());
+			bs.erase(std::unique(bs.begin(), bs.end()), bs.end());
+			return bs;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	書き込み応答を受けたブロックを記録（ファイルに追加する）
+			@param[in]	port	ポート
+			@param[in]	device	デバイス ID
+			@param[in]	hash	イメージ・ハッシュ
+			@param[in]	block	ブロック・アドレス
+			@return 書けたら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool add(const std::string& port, const std::string& device, uint64_t hash, uint32_t block)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			entry_t t;
+			t.port_ = port;
+			t.device_ = device;
+			t.hash_ = hash_text_(hash);
+			t.block_ = block;
+			entries_.push_back(t);
+
+			utils::file_io fio;
+			if(!fio.open(file_, "ab")) {
+				return false;
+			}
+			fio.put_line((boost::format("%s %s %s %08X")
+				% t.port_ % t.device_ % t.hash_ % t.block_).str());
+			fio.close();
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ポートの記録を消去（全て消えたら、ファイルを削除する）
+			@param[in]	port	ポート
+			@return 成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool remove(const std::string& port)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			auto n = entries_.size();
+			entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+				[&port](const entry_t& t) { return t.port_ == port; }), entries_.end());
+			if(n == entries_.size()) return true;
+			return save_();
+		}
+	};
+}
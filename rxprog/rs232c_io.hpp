@@ -1,7 +1,9 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	RS232C 入出力クラス
+	@brief	RS232C 入出力クラス @n
+			poll によるイベント駆動で、送信（ベクター書き込み）と、@n
+			事前に登録した受信バッファへの受信を、期限（デッドライン）付きで行う。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2016, 2017 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -15,11 +17,16 @@
 #include <unistd.h>
 #include <limits.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <poll.h>
 
 #include <string>
+#include <vector>
+#include <chrono>
 #include <iostream>
 #include <cstring>
 #include <cstdio>
+#include <cerrno>
 
 namespace utils {
 
@@ -64,16 +71,159 @@ namespace utils {
 			two		///< ２ビット
 		};
 
+
+		typedef std::chrono::steady_clock::time_point deadline_t;
+
 	private:
+		static const int IOV_NUM = 16;
+
+		struct req_t {
+			uint8_t*	ptr_;
+			size_t		len_;
+			uint64_t	gate_;	///< 送信を開始する受信総数
+			const uint8_t*	rcv_;	///< 送信の条件とする受信データ（nullptr なら無条件）
+			const uint8_t*	ref_;	///< 条件の期待値
+			size_t		num_;	///< 条件の長さ
+			req_t(uint8_t* ptr, size_t len, uint64_t gate) :
+				ptr_(ptr), len_(len), gate_(gate), rcv_(nullptr), ref_(nullptr), num_(0) { }
+
+			// 受信が条件と一致するか（門が開いてから判定する）
+			bool match() const {
+				return rcv_ == nullptr || std::memcmp(rcv_, ref_, num_) == 0;
+			}
+		};
+		typedef std::vector<req_t> reqs;
+
 		int    fd_;
 
 		termios		attr_back_;
 		termios		attr_;
 
+		reqs		tx_;
+		reqs		rx_;
+		uint64_t	rx_total_;
+
+		bool		modem_;		///< モデム制御線（DTR/RTS）の有無
+
 		void close_() {
 			tcsetattr(fd_, TCSANOW, &attr_back_);
 			::close(fd_);
 			fd_ = -1;
+			cancel();
+		}
+
+
+		static int remain_ms_(deadline_t dl) {
+			auto now = std::chrono::steady_clock::now();
+			if(dl <= now) return 0;
+			auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(dl - now).count();
+			return static_cast<int>(ms) + 1;
+		}
+
+
+		// 送信可能な要求をまとめて writev する
+		bool send_ready_() {
+			iovec iov[IOV_NUM];
+			int n = 0;
+			for(const auto& t : tx_) {
+				if(n >= IOV_NUM || t.gate_ > rx_total_ || !t.match()) break;
+				iov[n].iov_base = t.ptr_;
+				iov[n].iov_len  = t.len_;
+				++n;
+			}
+			if(n == 0) return true;
+
+			auto ret = ::writev(fd_, iov, n);
+			if(ret < 0) {
+				return errno == EAGAIN || errno == EINTR;
+			}
+			size_t l = ret;
+			auto it = tx_.begin();
+			while(it != tx_.end() && l >= it->len_) {
+				l -= it->len_;
+				++it;
+			}
+			if(it != tx_.end() && l > 0) {
+				it->ptr_ += l;
+				it->len_ -= l;
+			}
+			tx_.erase(tx_.begin(), it);
+			return true;
+		}
+
+
+		// 登録済みの受信バッファへ直接 readv する
+		bool recv_ready_() {
+			iovec iov[IOV_NUM];
+			int n = 0;
+			for(const auto& t : rx_) {
+				if(n >= IOV_NUM) break;
+				iov[n].iov_base = t.ptr_;
+				iov[n].iov_len  = t.len_;
+				++n;
+			}
+			if(n == 0) return true;
+
+			auto ret = ::readv(fd_, iov, n);
+			if(ret < 0) {
+				return errno == EAGAIN || errno == EINTR;
+			} else if(ret == 0) {  // 相手側がクローズした
+				return false;
+			}
+			size_t l = ret;
+			rx_total_ += l;
+			auto it = rx_.begin();
+			while(it != rx_.end() && l >= it->len_) {
+				l -= it->len_;
+				++it;
+			}
+			if(it != rx_.end() && l > 0) {
+				it->ptr_ += l;
+				it->len_ -= l;
+			}
+			rx_.erase(rx_.begin(), it);
+			return true;
+		}
+
+
+		bool pump_(deadline_t dl, bool all) {
+			if(fd_ < 0) return false;
+
+			while(1) {
+				bool txr = !tx_.empty() && tx_.front().gate_ <= rx_total_;
+				// 条件付きの送信で、受信が期待と違う（エラー応答など）
+				if(txr && !tx_.front().match()) return false;
+				if(all) {
+					// 受信待ちの送信は、次の受信で送られるので残す
+					if(rx_.empty() && !txr) break;
+				} else {
+					if(tx_.empty()) break;
+					if(rx_.empty() && !txr) return false;
+				}
+				pollfd pfd;
+				pfd.fd = fd_;
+				pfd.events = 0;
+				pfd.revents = 0;
+				if(txr) pfd.events |= POLLOUT;
+				if(!rx_.empty()) pfd.events |= POLLIN;
+				int ret = ::poll(&pfd, 1, remain_ms_(dl));
+				if(ret < 0) {
+					if(errno == EINTR) continue;
+					return false;
+				} else if(ret == 0) {  // time out
+					return false;
+				}
+				if(pfd.revents & (POLLERR | POLLNVAL)) {
+					return false;
+				}
+				if(pfd.revents & POLLOUT) {
+					if(!send_ready_()) return false;
+				}
+				if(pfd.revents & (POLLIN | POLLHUP)) {
+					if(!recv_ready_()) return false;
+				}
+			}
+			return true;
 		}
 
 	public:
@@ -82,7 +232,115 @@ namespace utils {
 			@brief	コンストラクター
 		*/
 		//-----------------------------------------------------------------//
-		rs232c_io() : fd_(-1) { }
+		rs232c_io() : fd_(-1), attr_back_(), attr_(), tx_(), rx_(), rx_total_(0), modem_(false) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	期限（デッドライン）を作成
+			@param[in]	ms	現在からの時間（ミリ秒）
+			@return 期限
+		*/
+		//-----------------------------------------------------------------//
+		static deadline_t make_deadline(uint32_t ms) noexcept
+		{
+			return std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	送信の登録 @n
+					※送信が完了するまで、src の内容を保持する事
+			@param[in]	src		送信データ転送元
+			@param[in]	len		送信長さ
+			@param[in]	after	この後に受信するバイト数を待ってから送信する場合に指定
+		*/
+		//-----------------------------------------------------------------//
+		void post_send(const void* src, size_t len, uint32_t after = 0)
+		{
+			if(len == 0) return;
+			auto p = static_cast<uint8_t*>(const_cast<void*>(src));
+			tx_.emplace_back(p, len, rx_total_ + after);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	条件付きの送信の登録 @n
+					after バイトを受信した時、rcv の num バイトが ref と一致したら送信する @n
+					一致しない場合、送信せずに、run は直ちに失敗する @n
+					※送信が完了するまで、src、rcv、ref の内容を保持する事
+			@param[in]	src		送信データ転送元
+			@param[in]	len		送信長さ
+			@param[in]	after	この後に受信するバイト数（rcv の受信が完了する数）
+			@param[in]	rcv		条件とする受信データ（post_recv で登録したバッファ）
+			@param[in]	ref		期待値
+			@param[in]	num		比較する長さ
+		*/
+		//-----------------------------------------------------------------//
+		void post_send_if(const void* src, size_t len, uint32_t after,
+			const void* rcv, const void* ref, size_t num)
+		{
+			if(len == 0) return;
+			post_send(src, len, after);
+			auto& t = tx_.back();
+			t.rcv_ = static_cast<const uint8_t*>(rcv);
+			t.ref_ = static_cast<const uint8_t*>(ref);
+			t.num_ = num;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信バッファの登録 @n
+					※登録順に、受信データが直接書き込まれる
+			@param[out]	dst	受信データ転送先
+			@param[in]	len	受信長さ
+		*/
+		//-----------------------------------------------------------------//
+		void post_recv(void* dst, size_t len)
+		{
+			if(len == 0) return;
+			rx_.emplace_back(static_cast<uint8_t*>(dst), len, 0);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	登録済みの送信、受信を全て完了させる @n
+					※受信を待つ送信で、待つ受信が未登録の物は残る
+			@param[in]	dl	期限
+			@return 期限内に全て完了したら「true」（失敗時、残りの要求は破棄される）
+		*/
+		//-----------------------------------------------------------------//
+		bool run(deadline_t dl)
+		{
+			if(pump_(dl, true)) return true;
+			cancel();
+			return false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	登録済みの要求を破棄
+		*/
+		//-----------------------------------------------------------------//
+		void cancel() noexcept
+		{
+			tx_.clear();
+			rx_.clear();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信総数を取得
+			@return 受信総数
+		*/
+		//-----------------------------------------------------------------//
+		uint64_t get_recv_total() const noexcept { return rx_total_; }
 
 
 		//-----------------------------------------------------------------//
@@ -174,10 +432,16 @@ namespace utils {
 				return false;
 			}
 
+			// 疑似端末（pty）等、モデム制御線が無いポートも受け付ける
 			int status;
 			if(ioctl(fd_, TIOCMGET, &status) == -1) {
-				close_();
-				return false;
+				if(errno != ENOTTY && errno != EINVAL) {
+					close_();
+					return false;
+				}
+				modem_ = false;
+			} else {
+				modem_ = true;
 			}
 
 			return true;
@@ -217,6 +481,11 @@ namespace utils {
 		{
 			if(fd_ < 0) return false;
 
+			if(!modem_) {
+				close_();
+				return true;
+			}
+
 			int status;
 			if(ioctl(fd_, TIOCMGET, &status) == -1) {
 				close_();
@@ -271,7 +540,9 @@ namespace utils {
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	受信
+			@brief	受信（無受信のタイムアウト） @n
+					tv の間、何も受信しない事が５回あったら終了する @n
+					（受信が続いている間は、全体の時間を制限しない）
 			@param[out]	dst	受信データ転送先
 			@param[in]	len	受信最大長さ
 			@param[in]	tv	タイムアウト指定
@@ -282,32 +553,42 @@ namespace utils {
 		{
 			if(fd_ < 0) return 0;
 
-			size_t total = 0;
-			uint8_t* p = static_cast<uint8_t*>(dst);
+			uint32_t ms = tv.tv_sec * 1000 + tv.tv_usec / 1000;
+			auto org = rx_total_;
+			post_recv(dst, len);
 			int retry = 5;
-			while(total < len) {
-				fd_set fds;
-				FD_ZERO(&fds);
-				FD_SET(fd_, &fds);
-				timeval t;
-				t = tv;
-				int ret = select(fd_ + 1, &fds, NULL, NULL, &t);
-				if(ret == -1) {  // for error..
-					std::cout << "recv select: 'error'" << std::endl;
-					retry--;
-				} else if(ret == 1) {
-					size_t rl = ::read(fd_, p, len - total);
-					total += rl;
-					p += rl;
-				} else {
-					retry--;
-				}
-				if(retry == 0) {
-					break;
+			while(1) {
+				auto n = rx_total_;
+				if(pump_(make_deadline(ms), true)) break;
+				if(rx_total_ == n) {  // 受信が無いまま、時間切れ
+					--retry;
+					if(retry == 0) {
+						cancel();
+						break;
+					}
 				}
 			}
+			return rx_total_ - org;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信（期限付き）
+			@param[out]	dst	受信データ転送先
+			@param[in]	len	受信長さ
+			@param[in]	dl	期限
+			@return 受信した長さ
+		*/
+		//-----------------------------------------------------------------//
+		size_t recv(void* dst, size_t len, deadline_t dl) noexcept
+		{
+			if(fd_ < 0) return 0;
 
-			return total;
+			auto org = rx_total_;
+			post_recv(dst, len);
+			run(dl);
+			return rx_total_ - org;
 		}
 
 
@@ -337,10 +618,38 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		size_t send(const void* src, size_t len) noexcept
+		{
+			iovec iov;
+			iov.iov_base = const_cast<void*>(src);
+			iov.iov_len  = len;
+			return send(&iov, 1);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ベクター送信（全て送り終えるまで待つ） @n
+					※登録済みの送信要求がある場合は、その後に送信される
+			@param[in]	iov	送信データ列
+			@param[in]	num	送信データ列の数
+			@param[in]	ms	タイムアウト（ミリ秒）
+			@return 送信した長さ
+		*/
+		//-----------------------------------------------------------------//
+		size_t send(const iovec* iov, int num, uint32_t ms = 5000) noexcept
 		{
 			if(fd_ < 0) return 0;
 
-			return ::write(fd_, src, len);
+			size_t len = 0;
+			for(int i = 0; i < num; ++i) {
+				post_send(iov[i].iov_base, iov[i].iov_len);
+				len += iov[i].iov_len;
+			}
+			if(!pump_(make_deadline(ms), false)) {
+				for(const auto& t : tx_) len -= t.len_;
+				tx_.clear();
+			}
+			return len;
 		}
 
 
@@ -462,6 +771,7 @@ namespace utils {
 		bool enable_DTR(bool ena = true) noexcept
 		{
 			if(fd_ < 0) return false;
+			if(!modem_) return true;
 
 			int status;
 			if(ioctl(fd_, TIOCMGET, &status) == -1) {
@@ -489,6 +799,7 @@ namespace utils {
 		bool enable_RTS(bool ena = true) noexcept
 		{
 			if(fd_ < 0) return false;
+			if(!modem_) return true;
 
 			int status;
 			if(ioctl(fd_, TIOCMGET, &status) == -1) {
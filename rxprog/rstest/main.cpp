@@ -0,0 +1,320 @@
+//=====================================================================//
+/*!	@file
+	@brief	rs232c_io、プロトコル・クラスのループバック・テスト @n
+			擬似端末（pty）の相手側で、台本通りに応答するブート・ローダーの @n
+			代役（rxsim）を動かし、タイムアウト、送信の順序、エラー応答を検査する @n
+			--bench では、数メガバイトの S フォーマットの読み込み速度を測る
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <thread>
+#include <fstream>
+#include <vector>
+
+#include "rxsim/rx64m_target.hpp"
+#include "rx64m_protocol.hpp"
+#include "motsx_io.hpp"
+
+namespace {
+
+	typedef std::chrono::steady_clock CLOCK;
+
+	uint32_t ng_ = 0;
+
+	void check_(const char* name, bool ok)
+	{
+		std::cout << (ok ? "  OK: " : "  NG: ") << name << std::endl;
+		if(!ok) ++ng_;
+	}
+
+
+	uint32_t msec_(CLOCK::time_point org)
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(CLOCK::now() - org).count();
+	}
+
+
+	// 相手側から、len バイトを ms 間隔で１バイトずつ送る
+	void trickle_(rxsim::target_io& io, uint32_t len, uint32_t ms)
+	{
+		for(uint32_t i = 0; i < len; ++i) {
+			io.put(0x30 + i);
+			usleep(ms * 1000);
+		}
+	}
+
+
+	timeval tv_(uint32_t ms)
+	{
+		timeval tv;
+		tv.tv_sec  = ms / 1000;
+		tv.tv_usec = (ms % 1000) * 1000;
+		return tv;
+	}
+
+
+	void test_rs232c_(rxsim::target_io& io)
+	{
+		std::cout << "rs232c_io:" << std::endl;
+
+		utils::rs232c_io rs;
+		if(!rs.open(io.get_name(), B115200)) {
+			check_("open", false);
+			return;
+		}
+
+		uint8_t buf[16];
+		{  // 受信が続く間は、tv の５回分を超えても待つ
+			std::thread t(trickle_, std::ref(io), 12, 40);
+			auto n = rs.recv(buf, 12, tv_(50));
+			t.join();
+			check_("recv(tv): slow stream is not cut off", n == 12);
+		}
+		{  // 無受信が５回続いたら終了
+			std::thread t(trickle_, std::ref(io), 3, 0);
+			auto org = CLOCK::now();
+			auto n = rs.recv(buf, 12, tv_(50));
+			auto ms = msec_(org);
+			t.join();
+			check_("recv(tv): silence ends after 5 idle windows", n == 3 && ms >= 240 && ms < 1000);
+		}
+		{  // 期限付きは、受信が続いていても期限で終了
+			std::thread t(trickle_, std::ref(io), 12, 40);
+			auto n = rs.recv(buf, 12, utils::rs232c_io::make_deadline(200));
+			t.join();
+			check_("recv(deadline): ends at the deadline", n > 0 && n < 12);
+			rs.flush();
+		}
+		{  // 受信を待つ送信は、指定バイト数を受信するまで送られない
+			static const uint8_t req[] = { 0x81, 0x00, 0x01, 0x15, 0xEA, 0x03 };
+			bool early = true;
+			bool later = false;
+			std::thread t([&]() {
+				uint8_t tmp[sizeof(req)];
+				early = io.read(tmp, 1, 100);
+				static const uint8_t st[] = { 0x81, 0x00, 0x01, 0x15 };
+				io.write(st, sizeof(st));
+				later = io.read(tmp, sizeof(tmp), 1000) && std::memcmp(tmp, req, sizeof(req)) == 0;
+			});
+			usleep(10000);
+			rs.post_send(req, sizeof(req), 4);
+			rs.post_recv(buf, 4);
+			bool ok = rs.run(utils::rs232c_io::make_deadline(1000));
+			t.join();
+			check_("post_send(after): held until the status arrives", ok && !early && later);
+		}
+		{  // 条件付きの送信は、期待通りのステータスでだけ送られる
+			static const uint8_t ok[] = { 0x81, 0x00, 0x01, 0x13, 0xEC, 0x03 };
+			static const uint8_t ng[] = { 0x81, 0x00, 0x02, 0x93, 0xE2, 0x88, 0x03 };
+			static const uint8_t frame[] = { 0x01, 0x00, 0x01, 0x13, 0xEC, 0x03 };
+			bool pass = true;
+			for(int i = 0; i < 2; ++i) {
+				const uint8_t* st = i == 0 ? ok : ng;
+				bool sent = false;
+				std::thread t([&]() {
+					io.write(st, sizeof(ok));
+					uint8_t tmp[sizeof(frame)];
+					sent = io.read(tmp, sizeof(tmp), 300);
+				});
+				uint8_t res[sizeof(ok)];
+				rs.post_recv(res, sizeof(res));
+				rs.post_send_if(frame, sizeof(frame), sizeof(res), res, ok, sizeof(ok));
+				auto org = CLOCK::now();
+				bool run = rs.run(utils::rs232c_io::make_deadline(1000));
+				auto ms = msec_(org);
+				t.join();
+				if(i == 0) pass = pass && run && sent;
+				else pass = pass && !run && !sent && ms < 100;
+			}
+			rs.flush();
+			check_("post_send_if: error status holds the frame, fails at once", pass);
+		}
+		{  // ベクター送信は、続けて届く
+			static const uint8_t a[] = { 0x01, 0x00, 0x09 };
+			static const uint8_t b[] = { 0x15, 0xFF, 0xF0, 0x00, 0x00 };
+			static const uint8_t c[] = { 0xFF, 0xF0, 0x00, 0xFF, 0x0B, 0x03 };
+			iovec iov[3];
+			iov[0].iov_base = const_cast<uint8_t*>(a);
+			iov[0].iov_len  = sizeof(a);
+			iov[1].iov_base = const_cast<uint8_t*>(b);
+			iov[1].iov_len  = sizeof(b);
+			iov[2].iov_base = const_cast<uint8_t*>(c);
+			iov[2].iov_len  = sizeof(c);
+			auto n = rs.send(iov, 3);
+			uint8_t tmp[sizeof(a) + sizeof(b) + sizeof(c)];
+			bool ok = io.read(tmp, sizeof(tmp), 1000);
+			ok = ok && std::memcmp(&tmp[0], a, sizeof(a)) == 0
+				&& std::memcmp(&tmp[sizeof(a)], b, sizeof(b)) == 0
+				&& std::memcmp(&tmp[sizeof(a) + sizeof(b)], c, sizeof(c)) == 0;
+			check_("send(iov): frames arrive in order", n == sizeof(tmp) && ok);
+		}
+		rs.close();
+	}
+
+
+	void test_protocol_(rxsim::target_io& io)
+	{
+		std::cout << "rx64m::protocol:" << std::endl;
+
+		static const uint32_t ADR = 0xFFF00000;
+		rxsim::flash_memory flash;
+		uint8_t pat[256];
+		for(uint32_t i = 0; i < sizeof(pat); ++i) pat[i] = i ^ 0x5A;
+		flash.write(ADR, pat, sizeof(pat));
+
+		typedef rxsim::rx64m_target::fault FAULT;
+		rxsim::rx64m_target target(io, flash, 0xC1, 0, false);
+		std::thread t([&]() { target.session(false); });
+
+		rx64m::protocol proto;
+		rx::protocol::rx_t rx;
+		rx.cpu_type_ = "RX64M";
+		bool ok = proto.bind(io.get_name(), 115200, rx);
+		check_("bind", ok);
+		if(ok) {
+			uint8_t tmp[256];
+			ok = proto.read_page(ADR, tmp) && std::memcmp(tmp, pat, sizeof(pat)) == 0;
+			check_("read_page", ok);
+
+			// エラー応答は、コマンドの期限（20 秒）を待たずに失敗する
+			target.set_fault(FAULT::status);
+			auto org = CLOCK::now();
+			ok = !proto.read_page(ADR, tmp) && msec_(org) < 1000;
+			check_("read_page: error status fails at once", ok);
+
+			target.set_fault(FAULT::data);
+			org = CLOCK::now();
+			ok = !proto.read_page(ADR, tmp) && msec_(org) < 1000;
+			check_("read_page: error reply to the data request fails at once", ok);
+
+			target.set_fault(FAULT::etx);
+			ok = !proto.read_page(ADR, tmp);
+			check_("read_page: bad ETX fails", ok);
+
+			// 失敗の後も、フレームの同期は保たれる
+			target.set_fault(FAULT::none);
+			ok = proto.read_page(ADR, tmp) && std::memcmp(tmp, pat, sizeof(pat)) == 0;
+			check_("read_page: link in sync after the errors", ok);
+		}
+		proto.end();
+		t.join();
+
+		// エラー応答の後に、データ要求を送っていない事
+		check_("no data request after an error status", target.get_stat().stray_ == 0);
+	}
+
+
+	// アドレス空間の終わりまでの mb メガバイトを、昇順の S3 レコードで保存
+	bool make_mot_(const std::string& path, uint32_t mb, utils::motsx_io& src)
+	{
+		uint32_t size = mb << 20;
+		uint32_t org = 0 - size;
+		uint8_t tmp[4096];
+		for(uint32_t ofs = 0; ofs < size; ofs += sizeof(tmp)) {
+			for(uint32_t i = 0; i < sizeof(tmp); ++i) {
+				tmp[i] = (ofs + i) * 7 + ((ofs + i) >> 9);
+			}
+			src.write(org + ofs, tmp, sizeof(tmp));
+		}
+		return src.save(path);
+	}
+
+
+	// 64K 毎のセクションを、逆順に並べ替える（複数セクションのリンク出力の代わり）
+	bool reverse_sections_(const std::string& in, const std::string& out)
+	{
+		std::ifstream ifs(in);
+		std::vector<std::string> lines;
+		std::string line;
+		while(std::getline(ifs, line)) {
+			lines.push_back(line);
+		}
+		if(lines.size() < 2) return false;
+		static const uint32_t SECTION = 0x10000 / 32;  // １行３２バイト
+		std::ofstream ofs(out);
+		uint32_t n = lines.size() - 1;
+		uint32_t top = ((n - 1) / SECTION) * SECTION;
+		while(1) {
+			for(uint32_t i = top; i < std::min(top + SECTION, n); ++i) {
+				ofs << lines[i] << '\n';
+			}
+			if(top == 0) break;
+			top -= SECTION;
+		}
+		ofs << lines.back() << '\n';
+		return ofs.good();
+	}
+
+
+	// 読み込み（３回の最短時間）
+	void load_rate_(const char* name, const std::string& path, uint32_t mb, const utils::motsx_io& src)
+	{
+		double best = 0.0;
+		bool ok = true;
+		for(int i = 0; i < 3; ++i) {
+			utils::motsx_io mot;
+			auto org = CLOCK::now();
+			ok = ok && mot.load(path);
+			double t = std::chrono::duration<double>(CLOCK::now() - org).count();
+			if(i == 0 || t < best) best = t;
+			ok = ok && mot.get_total_page() == src.get_total_page() && mot.get_hash() == src.get_hash();
+		}
+		uint32_t lines = (mb << 20) / 32;
+		std::cout << boost::format("  %2d MB %-10s %.3f sec, %6.1f MB/s, %8.0f lines/s")
+			% mb % name % best % (mb / best) % (lines / best) << std::endl;
+		check_((boost::format("motsx_io::load: %d MB %s, same image") % mb % name).str().c_str(), ok);
+	}
+
+
+	void bench_motsx_()
+	{
+		std::cout << "motsx_io::load:" << std::endl;
+
+		auto base = (boost::format("/tmp/rs_test_%d") % getpid()).str();
+		auto asc = base + "_asc.mot";
+		auto sec = base + "_sec.mot";
+		static const uint32_t mbs[] = { 1, 4, 16 };
+		for(auto mb : mbs) {
+			utils::motsx_io src;
+			if(!make_mot_(asc, mb, src) || !reverse_sections_(asc, sec)) {
+				check_("make .mot", false);
+				break;
+			}
+			load_rate_("ascending", asc, mb, src);
+			load_rate_("sections", sec, mb, src);
+		}
+		unlink(asc.c_str());
+		unlink(sec.c_str());
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	if(argc > 1 && std::strcmp(argv[1], "--bench") == 0) {
+		bench_motsx_();
+		return ng_ > 0 ? 1 : 0;
+	}
+
+	rxsim::target_io io;
+	if(!io.open()) {
+		std::cerr << "Can't open pty" << std::endl;
+		return -1;
+	}
+
+	test_rs232c_(io);
+	test_protocol_(io);
+
+	if(ng_ > 0) {
+		std::cout << boost::format("%d test(s) failed") % ng_ << std::endl;
+		return 1;
+	}
+	std::cout << "All tests passed" << std::endl;
+	return 0;
+}
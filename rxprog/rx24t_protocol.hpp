@@ -35,6 +35,7 @@ namespace rx24t {
 		rx::protocol::blocks		blocks_;
 		bool						id_protect_ = false;
 		bool						pe_turn_on_ = false;
+		bool						speed_tried_ = false;	///< ボーレート変更まで進んだ
 		bool						select_write_area_ = false;
 
 		uint32_t	   				baud_speed_ = 0;
@@ -42,6 +43,10 @@ namespace rx24t {
 
 		uint8_t						last_error_ = 0;
 
+		// 次に送るライト・ページのコマンド・フレーム（CMD + ADR + DATA + SUM）
+		uint8_t						page_frame_[5 + 256 + 1] = { 0 };
+		uint32_t					page_frame_adr_ = 0xFFFFFFFF;
+
 		bool command_(uint8_t cmd) {
 			bool f = rs232c_.send(static_cast<char>(cmd));
 			rs232c_.sync_send();
@@ -135,6 +140,7 @@ namespace rx24t {
 		bool bind(const std::string& path, uint32_t brate, const rx::protocol::rx_t& rx)
 		{
 			verbose_ = rx.verbose_;
+			speed_tried_ = false;
 
 			if(!start(path)) {
 				std::cerr << "Can't open path: '" << path << "'" << std::endl;
@@ -240,6 +246,7 @@ namespace rx24t {
 
 			// ボーレート変更
 			{
+				speed_tried_ = true;
 				if(!change_speed(rx, brate)) {
 					std::cerr << "Can't change speed." << std::endl;
 					return false;
@@ -271,6 +278,16 @@ namespace rx24t {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	接続で、ボーレート変更まで進んだか @n
+					（それより前の失敗は、配線、電源、ポートの問題で、速度とは無関係）
+			@return ボーレート変更を試したら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool is_speed_tried() const { return speed_tried_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	開始
@@ -282,6 +299,7 @@ namespace rx24t {
 			if(!rs232c_.open(path, B9600)) {
 				return false;
 			}
+			rs232c_.flush();  // 中断したセッションの残りを捨てる
 			if(!rs232c_.enable_RTS(false)) {
 				return false;
 			}
@@ -749,6 +767,17 @@ namespace rx24t {
 		bool get_protect() const { return id_protect_; }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	イレース・ブロックのサイズを取得 @n
+					※ページ単位の消去をサポートしない為、常に「０」
+			@param[in]	address	アドレス
+			@return イレース・ブロックのサイズ（バイト）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_erase_block_size(uint32_t address) const { return 0; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	イレース・ページ
@@ -796,49 +825,66 @@ namespace rx24t {
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	ライト・ページ（２５６バイト）
+			@brief	ライト・ページのコマンド・フレームを準備 @n
+					前のページの書き込み完了を待つ間に、次のページを用意しておく
 			@param[in]	address	アドレス
 			@param[in]	src	ライト・データ
 			@return エラー無ければ「true」
 		*/
 		//-----------------------------------------------------------------//
-		bool write_page(uint32_t address, const uint8_t* src) {
+		bool write_page_prepare(uint32_t address, const uint8_t* src) {
+			if(src == nullptr) return false;
+
+			page_frame_[0] = 0x50;
+			put32_big_(&page_frame_[1], address);
+			std::memcpy(&page_frame_[5], src, 256);
+			page_frame_[5 + 256] = sum_(page_frame_, 5 + 256);
+			page_frame_adr_ = address;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ライト・ページの送信（準備済みのフレームを送る） @n
+					※書き込み結果は「write_page_response」で受け取る
+			@param[in]	address	アドレス
+			@return エラー無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool write_page_send(uint32_t address) {
 			if(!connection_) return false;
 			if(!pe_turn_on_) return false;
 			if(!select_write_area_) return false;
+			if(page_frame_adr_ != address) return false;
 
-			uint8_t cmd[5 + 256 + 1];
-			cmd[0] = 0x50;
-///			std::cout << boost::format("Address: %08X") % address << std::endl;			
-			if(address != 0xffffffff) {
-				put32_big_(&cmd[1], address);
-				std::memcpy(&cmd[5], src, 256);
-				cmd[5 + 256] = sum_(cmd, 5 + 256);
-
-				if(!write_(cmd, 5)) {
-					select_write_area_ = false;
-					return false;
-				}
-				for(uint32_t i = 0; i < 16; ++i) {
-					if(!write_(&cmd[5 + i * 16], 16)) {
-						select_write_area_ = false;
-						return false;
-					}
-				}
-				if(!write_(&cmd[5 + 256], 1)) {  // SUM
-				  	select_write_area_ = false;
-					return false;
-				}
-			} else {
-				put32_big_(&cmd[1], address);
+			page_frame_adr_ = 0xFFFFFFFF;
+			if(!write_(page_frame_, 5)) {
 				select_write_area_ = false;
-				cmd[5] = sum_(cmd, 5);
-				if(!write_(cmd, 6)) {
+				return false;
+			}
+			for(uint32_t i = 0; i < 16; ++i) {
+				if(!write_(&page_frame_[5 + i * 16], 16)) {
+					select_write_area_ = false;
 					return false;
 				}
 			}
+			if(!write_(&page_frame_[5 + 256], 1)) {  // SUM
+			  	select_write_area_ = false;
+				return false;
+			}
+			return true;
+		}
 
-			// レスポンス
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ライト・ページのレスポンス（ブート・ローダーの書き込み完了）待ち
+			@param[in]	address	アドレス（エラー表示用）
+			@return エラー無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool write_page_response(uint32_t address) {
 			timeval tv;
 			tv.tv_sec  = 10;
 			tv.tv_usec = 0;
@@ -865,6 +911,93 @@ namespace rx24t {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ライト・ページのレスポンス待ちと、次のページの送信 @n
+					準備済みのページのフレームを先に登録しておき、@n
+					前のページの ACK（0x06）を受信したら、同じ送受信ループの中で @n
+					直ちに送る（エラー・レスポンスなら送らない）
+			@param[in]	prev	レスポンスを待つページのアドレス
+			@param[in]	address	次のページのアドレス
+			@return エラー無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool write_page_chain(uint32_t prev, uint32_t address) {
+			if(!connection_) return false;
+			if(!pe_turn_on_) return false;
+			if(!select_write_area_) return false;
+			if(page_frame_adr_ != address) return false;
+
+			static const uint8_t ok[] = { 0x06 };
+			uint8_t head[1] = { 0 };
+			page_frame_adr_ = 0xFFFFFFFF;
+			rs232c_.post_recv(head, sizeof(head));
+			rs232c_.post_send_if(page_frame_, 5, sizeof(head), head, ok, sizeof(ok));
+			for(uint32_t i = 0; i < 16; ++i) {
+				rs232c_.post_send(&page_frame_[5 + i * 16], 16, sizeof(head));
+			}
+			rs232c_.post_send(&page_frame_[5 + 256], 1, sizeof(head));  // SUM
+			if(rs232c_.run(utils::rs232c_io::make_deadline(10000))) {
+				return true;
+			}
+
+			select_write_area_ = false;
+			if(head[0] == 0x00) {  // 前のページのレスポンスが来ない
+				std::cout << "Respons timeout" << std::endl;
+			} else if(head[0] == 0x06) {  // 前のページは ACK、次のページの送信が失敗
+				std::cout << "Send error" << std::endl;
+			} else {
+				std::cout << "Respons error" << std::endl;
+				if(head[0] == 0xd0) {
+					timeval tv;
+					tv.tv_sec  = 10;
+					tv.tv_usec = 0;
+					if(read_(head, 1, tv)) {
+						last_error_ = head[0];
+					}
+				}
+			}
+			return false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ライト・ページ（２５６バイト）
+			@param[in]	address	アドレス
+			@param[in]	src	ライト・データ
+			@return エラー無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool write_page(uint32_t address, const uint8_t* src) {
+			if(!connection_) return false;
+			if(!pe_turn_on_) return false;
+			if(!select_write_area_) return false;
+
+///			std::cout << boost::format("Address: %08X") % address << std::endl;			
+			if(address != 0xffffffff) {
+				if(!write_page_prepare(address, src)) {
+					return false;
+				}
+				if(!write_page_send(address)) {
+					return false;
+				}
+			} else {
+				uint8_t cmd[6];
+				cmd[0] = 0x50;
+				put32_big_(&cmd[1], address);
+				select_write_area_ = false;
+				cmd[5] = sum_(cmd, 5);
+				if(!write_(cmd, 6)) {
+					return false;
+				}
+			}
+
+			// レスポンス
+			return write_page_response(address);
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	リード・ページ（２５６バイト）
@@ -956,6 +1089,19 @@ namespace rx24t {
 		}
 
 #endif
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ＣＲＣ（CRC-32）の取得 @n
+					※サポートしない為、常に「false」
+			@param[in]	org	開始アドレス
+			@param[in]	end	終了アドレス
+			@param[out]	crc	CRC 値
+			@return エラー無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool read_crc(uint32_t org, uint32_t end, uint32_t& crc) { return false; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	終了
@@ -23,7 +23,10 @@ namespace rx65x {
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	class protocol {
 
+		static const uint32_t COMMAND_TIMEOUT = 20000;	///< コマンド毎の応答期限（ミリ秒）
+
 		utils::rs232c_io	rs232c_;
+		utils::rs232c_io::deadline_t	deadline_;
 
 		bool				verbose_ = false;
 
@@ -40,12 +43,19 @@ namespace rx65x {
 		bool				enable_id_ = false;
 
 		bool				pe_turn_on_ = false;
+		bool				speed_tried_ = false;	///< ボーレート変更まで進んだ
 		bool				data_area_ = false;
 		bool				select_write_area_ = false;
 
 		typedef std::set<uint32_t> erase_map;
 		erase_map erase_map_;
 
+		// 次に送るライト・ページのデータ・フレーム（SOD + LEN + CMD + DATA + SUM + ETX）
+		uint8_t				page_frame_[1 + 2 + 1 + 256 + 1 + 1] = { 0 };
+		// 次に送るライト・コマンド（SOH + LEN + CMD + 開始、終了アドレス + SUM + ETX）
+		uint8_t				page_cmd_[1 + 2 + 1 + 8 + 1 + 1] = { 0 };
+		uint32_t			page_frame_adr_ = 0xFFFFFFFF;
+
 //		uint8_t				last_error_ = 0;
 
 
@@ -95,34 +105,35 @@ namespace rx65x {
 		}
 
 
+		// 最後に送ったコマンドの期限まで待つ
 		bool read_(void* buff, uint32_t len) {
-			timeval tv;
-			tv.tv_sec  = 5;
-			tv.tv_usec = 0;
-			return rs232c_.recv(buff, len, tv) == len;
+			return rs232c_.recv(buff, len, deadline_) == len;
 		}
 
 
 		bool write_(const void* buff, uint32_t len) {
-			uint32_t wr = rs232c_.send(buff, len);
-			rs232c_.sync_send();
-			return wr == len;
+			deadline_ = utils::rs232c_io::make_deadline(COMMAND_TIMEOUT);
+			return rs232c_.send(buff, len) == len;
 		}
 
 
 		bool com_(uint8_t soh, uint8_t cmd, uint8_t ext, const uint8_t* src = nullptr, uint32_t len = 0) {
-			uint8_t tmp[1 + 2 + 1 + len + 1 + 1];
-			tmp[0] = soh;
-			put16_big_(&tmp[1], 1 + len);
-			tmp[3] = cmd;
-			if(len > 0) {
-				std::memcpy(&tmp[4], src, len);
-			}
-			tmp[4 + len] = sum_(&tmp[1], 3 + len);
-			tmp[4 + len + 1] = ext;
-			uint32_t l = rs232c_.send(tmp, sizeof(tmp));
-			rs232c_.sync_send();
-			return l == sizeof(tmp);
+			uint8_t head[1 + 2 + 1];
+			head[0] = soh;
+			put16_big_(&head[1], 1 + len);
+			head[3] = cmd;
+			uint8_t tail[2];
+			tail[0] = sum_(&head[1], 3) + sum_(src, len);
+			tail[1] = ext;
+			iovec iov[3];
+			iov[0].iov_base = head;
+			iov[0].iov_len  = sizeof(head);
+			iov[1].iov_base = const_cast<uint8_t*>(src);
+			iov[1].iov_len  = len;
+			iov[2].iov_base = tail;
+			iov[2].iov_len  = sizeof(tail);
+			deadline_ = utils::rs232c_io::make_deadline(COMMAND_TIMEOUT);
+			return rs232c_.send(iov, 3) == (sizeof(head) + len + sizeof(tail));
 		}
 
 
@@ -223,31 +234,37 @@ namespace rx65x {
 		}
 
 
+		// ヘッダー、データ、SUM/ETX の受信バッファを先に登録し、データを dst へ直接受信する
 		bool status_data_(uint8_t res, uint8_t* dst, uint32_t len) {
-			uint8_t tmp[4 + len + 2];
-			if(!read_(tmp, 4)) {
+			uint8_t head[4];
+			if(!read_(head, sizeof(head))) {
 				return false;
 			}
-			if(tmp[0] != 0x81) {
+			if(head[0] != 0x81) {
 				return false;
 			}
-			if(tmp[3] != res) {
+			auto l = get16_big_(&head[1]);
+			if(head[3] != res || l != (len + 1)) {
+				// エラー応答（res | 0x80、エラー・コード）は、残りを読み捨てて直ちに失敗する
+				if(head[3] == (res | 0x80) && l == 2) {
+					uint8_t tmp[1 + 1 + 1];
+					read_(tmp, sizeof(tmp));
+				}
 				return false;
 			}
-			auto l = get16_big_(&tmp[1]);
-			if(l != (len + 1)) {
+			uint8_t tail[2];
+			rs232c_.post_recv(dst, len);
+			rs232c_.post_recv(tail, sizeof(tail));
+			if(!rs232c_.run(deadline_)) {
 				return false;
 			}
-			if(!read_(&tmp[4], len + 2)) {
+			uint8_t sum = sum_(&head[1], 3) + sum_(dst, len);
+			if(sum != tail[0]) {
 				return false;
 			}
-			auto sum = sum_(&tmp[1], len + 3);
-			if(sum != tmp[4 + len]) {
+			if(tail[1] != 0x03) {
 				return false;
 			}
-			if(len > 0) {
-				std::memcpy(dst, &tmp[4], len);
-			}
 			return true;
 		}
 
@@ -277,6 +294,7 @@ namespace rx65x {
 		bool bind(const std::string& path, uint32_t brate, const rx::protocol::rx_t& rx)
 		{
 			verbose_ = rx.verbose_;
+			speed_tried_ = false;
 
 			if(!start(path)) {
 				std::cerr << "Can't open path: '" << path << "'" << std::endl;
@@ -330,6 +348,7 @@ namespace rx65x {
 
 			// ボーレート変更
 			{
+				speed_tried_ = true;
 				if(!change_speed(rx, brate)) {
 					std::cerr << "Can't change speed." << std::endl;
 					return false;
@@ -364,6 +383,16 @@ namespace rx65x {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	接続で、ボーレート変更まで進んだか @n
+					（それより前の失敗は、配線、電源、ポートの問題で、速度とは無関係）
+			@return ボーレート変更を試したら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool is_speed_tried() const { return speed_tried_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	開始
@@ -375,6 +404,7 @@ namespace rx65x {
 			if(!rs232c_.open(path, B9600)) {
 				return false;
 			}
+			rs232c_.flush();  // 中断したセッションの残りを捨てる
 			if(!rs232c_.enable_RTS(false)) {
 				return false;
 			}
@@ -627,6 +657,23 @@ namespace rx65x {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	イレース・ブロックのサイズを取得
+			@param[in]	address	アドレス
+			@return イレース・ブロックのサイズ（バイト）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_erase_block_size(uint32_t address) const {
+			if(address >= 0xFFFF0000) {  // 8K block
+				return 8192;
+			} else if(address >= 0xFFC00000) {  // 32K block
+				return 32768;
+			}
+			return 256;
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	イレース・ページ
@@ -660,11 +707,7 @@ namespace rx65x {
 				}
 				// erase NG;
 				// std::cout << boost::format("Erase NG: %08X") % address << std::endl;
-				if(address >= 0xFFFF0000) {  // 8K block
-					org = address & 0xFFFFE000;
-				} else if(address >= 0xFFC00000) {  // 32K block
-					org = address & 0xFFFF8000;
-				}
+				org = address & ~(get_erase_block_size(address) - 1);
 				put32_big_(&tmp[0], org);
 				if(!command_(0x12, tmp, 4)) {  // erase command
 					return false;
@@ -705,21 +748,48 @@ namespace rx65x {
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	ライト・ページ（２５６バイト）
+			@brief	ライト・ページのデータ・フレームを準備 @n
+					前のページの書き込み完了を待つ間に、次のページを用意しておく
 			@param[in]	address	アドレス
 			@param[in]	src	ライト・データ
 			@return エラー無ければ「true」
 		*/
 		//-----------------------------------------------------------------//
-		bool write_page(uint32_t address, const uint8_t* src) {
+		bool write_page_prepare(uint32_t address, const uint8_t* src) {
+			if(src == nullptr) return false;
+
+			page_frame_[0] = 0x81;
+			put16_big_(&page_frame_[1], 1 + 256);
+			page_frame_[3] = 0x13;
+			std::memcpy(&page_frame_[4], src, 256);
+			page_frame_[4 + 256] = sum_(&page_frame_[1], 3 + 256);
+			page_frame_[4 + 256 + 1] = 0x03;
+
+			page_cmd_[0] = 0x01;
+			put16_big_(&page_cmd_[1], 1 + 8);
+			page_cmd_[3] = 0x13;
+			put32_big_(&page_cmd_[4], address);
+			put32_big_(&page_cmd_[8], address + 255);
+			page_cmd_[4 + 8] = sum_(&page_cmd_[1], 3 + 8);
+			page_cmd_[4 + 8 + 1] = 0x03;
+			page_frame_adr_ = address;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ライト・ページの送信（準備済みのフレームを送る） @n
+					※書き込み結果は「write_page_response」で受け取る
+			@param[in]	address	アドレス
+			@return エラー無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool write_page_send(uint32_t address) {
 			if(!connection_) return false;
 			if(!pe_turn_on_) return false;
 			if(!select_write_area_) return false;
-
-			// final method to pass...
-			if(address == 0xFFFFFFFF || src == nullptr) {
-				return true;
-			}
+			if(page_frame_adr_ != address) return false;
 
 			uint8_t tmp[8];
 			put32_big_(&tmp[0], address);
@@ -732,10 +802,19 @@ namespace rx65x {
 				return false;
 			}
 
-			if(!com_(0x81, 0x13, 0x03, src, 256)) {
-				return false;
-			}
+			page_frame_adr_ = 0xFFFFFFFF;
+			return write_(page_frame_, sizeof(page_frame_));
+		}
 
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ライト・ページのレスポンス（ブート・ローダーの書き込み完了）待ち
+			@param[in]	address	アドレス（エラー表示用）
+			@return エラー無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool write_page_response(uint32_t address) {
 			uint8_t res;
 			uint8_t err;
 			if(!response_(res, err)) {
@@ -752,6 +831,78 @@ namespace rx65x {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ライト・ページのレスポンス待ちと、次のページの送信 @n
+					準備済みのページのコマンド、フレームを先に登録しておき、@n
+					前のページの OK レスポンスを受信したら、同じ送受信ループの中で @n
+					直ちに送る（エラー・レスポンスなら送らない）
+			@param[in]	prev	レスポンスを待つページのアドレス
+			@param[in]	address	次のページのアドレス
+			@return エラー無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool write_page_chain(uint32_t prev, uint32_t address) {
+			if(!connection_) return false;
+			if(!pe_turn_on_) return false;
+			if(!select_write_area_) return false;
+			if(page_frame_adr_ != address) return false;
+
+			// 書き込み完了、コマンド受付のステータス（0x13）
+			static const uint8_t ok[] = { 0x81, 0x00, 0x01, 0x13, 0xEC, 0x03 };
+			uint8_t res[sizeof(ok)] = { 0 };
+			uint8_t sta[sizeof(ok)] = { 0 };
+			page_frame_adr_ = 0xFFFFFFFF;
+			rs232c_.post_recv(res, sizeof(res));
+			rs232c_.post_send_if(page_cmd_, sizeof(page_cmd_), sizeof(res), res, ok, sizeof(ok));
+			rs232c_.post_recv(sta, sizeof(sta));
+			rs232c_.post_send_if(page_frame_, sizeof(page_frame_), sizeof(res) + sizeof(sta),
+				sta, ok, sizeof(ok));
+			deadline_ = utils::rs232c_io::make_deadline(COMMAND_TIMEOUT);
+			if(rs232c_.run(deadline_)) {
+				return true;
+			}
+
+			// 前のページのエラー・レスポンス（0x93、エラー・コード、SUM、ETX）
+			if(res[0] == 0x81 && get16_big_(&res[1]) == 2 && res[3] == 0x93) {
+				uint8_t etx[1];
+				read_(etx, sizeof(etx));
+				std::cerr << std::endl;
+				std::cerr << boost::format("Write error (%08X), status: %02X")
+					% prev % static_cast<uint32_t>(res[4]) << std::endl;
+			}
+			return false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ライト・ページ（２５６バイト）
+			@param[in]	address	アドレス
+			@param[in]	src	ライト・データ
+			@return エラー無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool write_page(uint32_t address, const uint8_t* src) {
+			if(!connection_) return false;
+			if(!pe_turn_on_) return false;
+			if(!select_write_area_) return false;
+
+			// final method to pass...
+			if(address == 0xFFFFFFFF || src == nullptr) {
+				return true;
+			}
+
+			if(!write_page_prepare(address, src)) {
+				return false;
+			}
+			if(!write_page_send(address)) {
+				return false;
+			}
+			return write_page_response(address);
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	リード・ページ（２５６バイト）
@@ -771,17 +922,69 @@ namespace rx65x {
 				return false;
 			}
 
+			// エラー応答（７バイト）なら、データ要求を送らずに失敗する
 			if(!status_(0x15)) {
 				return false;
 			}
 
-			if(!com_(0x81, 0x15, 0x03)) {
+			// データ要求フレームは、データの受信と同じループで送る
+			static const uint8_t req[] = { 0x81, 0x00, 0x01, 0x15, 0xEA, 0x03 };
+			rs232c_.post_send(req, sizeof(req));
+			deadline_ = utils::rs232c_io::make_deadline(COMMAND_TIMEOUT);
+			if(!status_data_(0x15, dst, 256)) {
 				return false;
 			}
-			if(!status_data_(0x15, dst, 256)) {
+
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ＣＲＣ（CRC-32）の取得 @n
+					デバイス側で、指定領域の CRC を計算させる
+			@param[in]	org	開始アドレス
+			@param[in]	end	終了アドレス
+			@param[out]	crc	CRC 値
+			@return エラー無ければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool read_crc(uint32_t org, uint32_t end, uint32_t& crc) {
+			if(!connection_) return false;
+			if(!pe_turn_on_) return false;
+
+			uint8_t tmp[4 + 4 + 2];
+			put32_big_(&tmp[0], org);
+			put32_big_(&tmp[4], end);
+			if(!command_(0x18, tmp, 8)) {
 				return false;
 			}
 
+			// エラー応答（0x98）も読み捨てる為、長さを見て受信する
+			if(!read_(tmp, 4)) {
+				return false;
+			}
+			if(tmp[0] != 0x81) {
+				return false;
+			}
+			auto l = get16_big_(&tmp[1]);
+			if(l < 1 || l > 5) {
+				return false;
+			}
+			if(!read_(&tmp[4], l + 1)) {
+				return false;
+			}
+			if(sum_(&tmp[1], 3 + l - 1) != tmp[4 + l - 1]) {
+				return false;
+			}
+			if(tmp[3] != 0x18 || l != 5) {
+				if(verbose_) {
+					std::cerr << boost::format("CRC response: %02X") % static_cast<uint32_t>(tmp[3])
+						<< std::endl;
+				}
+				return false;
+			}
+			crc = get32_big_(&tmp[4]);
 			return true;
 		}
 
@@ -14,6 +14,8 @@
 #include "rx65x_protocol.hpp"
 #include "rx66t_protocol.hpp"
 #include "rx72t_protocol.hpp"
+#include <chrono>
+#include <functional>
 #include <boost/format.hpp>
 #include <boost/variant.hpp>
 
@@ -25,8 +27,17 @@ namespace rx {
 	 */
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	class prog {
+	public:
+		typedef std::vector<uint32_t> pages;
+		typedef std::function<const uint8_t* (uint32_t adr)> get_page_func;
+		typedef std::function<void (uint32_t adr)> progress_func;
+
+	private:
 		bool		verbose_;
 
+		uint32_t	write_bytes_;
+		double		write_time_;
+
 		typedef utils::rs232c_io RS232C;
 		RS232C		rs232c_;
 
@@ -67,6 +78,19 @@ namespace rx {
 		};
 
 
+		struct erase_block_size_visitor {
+			using result_type = uint32_t;
+
+			uint32_t adr_;
+			erase_block_size_visitor(uint32_t adr) : adr_(adr) { }
+
+    		template <class T>
+    		uint32_t operator()(T& x) {
+				return x.get_erase_block_size(adr_);
+			}
+		};
+
+
 		struct read_page_visitor {
 			using result_type = bool;
 
@@ -81,6 +105,21 @@ namespace rx {
 		};
 
 
+		struct read_crc_visitor {
+			using result_type = bool;
+
+			uint32_t org_;
+			uint32_t end_;
+			uint32_t& crc_;
+			read_crc_visitor(uint32_t org, uint32_t end, uint32_t& crc) : org_(org), end_(end), crc_(crc) { }
+
+    		template <class T>
+    		bool operator()(T& x) {
+				return x.read_crc(org_, end_, crc_);
+			}
+		};
+
+
 		struct select_write_visitor {
 			using result_type = bool;
 
@@ -108,6 +147,96 @@ namespace rx {
 		};
 
 
+		struct write_prepare_visitor {
+			using result_type = bool;
+
+			uint32_t adr_;
+			const uint8_t* src_;
+			write_prepare_visitor(uint32_t adr, const uint8_t* src) : adr_(adr), src_(src) { }
+
+    		template <class T>
+    		bool operator()(T& x) {
+				return x.write_page_prepare(adr_, src_);
+			}
+		};
+
+
+		struct write_send_visitor {
+			using result_type = bool;
+
+			uint32_t adr_;
+			write_send_visitor(uint32_t adr) : adr_(adr) { }
+
+    		template <class T>
+    		bool operator()(T& x) {
+				return x.write_page_send(adr_);
+			}
+		};
+
+
+		struct write_response_visitor {
+			using result_type = bool;
+
+			uint32_t adr_;
+			write_response_visitor(uint32_t adr) : adr_(adr) { }
+
+    		template <class T>
+    		bool operator()(T& x) {
+				return x.write_page_response(adr_);
+			}
+		};
+
+
+		struct write_chain_visitor {
+			using result_type = bool;
+
+			uint32_t prev_;
+			uint32_t adr_;
+			write_chain_visitor(uint32_t prev, uint32_t adr) : prev_(prev), adr_(adr) { }
+
+    		template <class T>
+    		bool operator()(T& x) {
+				return x.write_page_chain(prev_, adr_);
+			}
+		};
+
+
+		// デバイス ID（RX63T/RX24T はデバイス・コード、それ以外はデバイス種別から作る）
+		struct device_id_visitor {
+			using result_type = std::string;
+
+			std::string operator()(rx63t::protocol& x) { return code_(x.get_device()); }
+			std::string operator()(rx24t::protocol& x) { return code_(x.get_device()); }
+
+    		template <class T>
+    		std::string operator()(T& x) {
+				const auto& t = x.get_device_type();
+				std::string s;
+				for(int i = 0; i < 8; ++i) {
+					s += (boost::format("%02X") % static_cast<uint32_t>(t.TYP[i])).str();
+				}
+				s += (boost::format("-%d") % t.CPA).str();
+				return s;
+			}
+
+		private:
+			static std::string code_(const rx::protocol::devices& ds) {
+				if(ds.empty()) return "UNKNOWN";
+				return (boost::format("%08X") % ds[0].code_).str();
+			}
+		};
+
+
+		struct speed_tried_visitor {
+			using result_type = bool;
+
+    		template <class T>
+    		bool operator()(T& x) {
+				return x.is_speed_tried();
+			}
+		};
+
+
 		struct end_visitor {
 			using result_type = void;
 
@@ -117,13 +246,35 @@ namespace rx {
 			}
 		};
 
+
+		bool write_prepare_(uint32_t adr, const get_page_func& get) {
+			write_prepare_visitor vis(adr, get(adr));
+			if(!boost::apply_visitor(vis, protocol_)) {
+				end();
+				std::cerr << "Write prepare error." << std::endl;
+				return false;
+			}
+			return true;
+		}
+
+
+		bool write_send_(uint32_t adr) {
+			write_send_visitor vis(adr);
+			if(!boost::apply_visitor(vis, protocol_)) {
+				end();
+				std::cerr << std::endl << boost::format("Write send error: %08X") % adr << std::endl;
+				return false;
+			}
+			return true;
+		}
+
 	public:
 		//-------------------------------------------------------------//
 		/*!
 			@brief	コンストラクター
 		*/
 		//-------------------------------------------------------------//
-		prog(bool verbose = false) : verbose_(verbose) { }
+		prog(bool verbose = false) : verbose_(verbose), write_bytes_(0), write_time_(0.0) { }
 
 
 		//-------------------------------------------------------------//
@@ -166,6 +317,19 @@ namespace rx {
 		}
 
 
+		//-------------------------------------------------------------//
+		/*!
+			@brief	最後の「start」が、ボーレート変更まで進んだか @n
+					（それより前の失敗は、速度の失敗として扱わない）
+			@return ボーレート変更を試したら「true」
+		*/
+		//-------------------------------------------------------------//
+		bool is_speed_tried() {
+			speed_tried_visitor vis;
+			return boost::apply_visitor(vis, protocol_);
+		}
+
+
 		//-------------------------------------------------------------//
 		/*!
 			@brief	ページ消去
@@ -236,6 +400,206 @@ namespace rx {
 		}
 
 
+		//-------------------------------------------------------------//
+		/*!
+			@brief	CRC-32 の計算（ISO-HDLC、0xEDB88320、初期値、最終 XOR 0xFFFFFFFF）
+			@param[in]	crc	前回までの値（最初は「０」）
+			@param[in]	src	データ
+			@param[in]	len	長さ
+			@return CRC 値
+		*/
+		//-------------------------------------------------------------//
+		static uint32_t calc_crc(uint32_t crc, const uint8_t* src, uint32_t len)
+		{
+			struct table_t {
+				uint32_t	t_[256];
+				table_t() {
+					for(uint32_t i = 0; i < 256; ++i) {
+						uint32_t c = i;
+						for(int j = 0; j < 8; ++j) {
+							c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+						}
+						t_[i] = c;
+					}
+				}
+			};
+			static const table_t table;  // ギャング接続でも安全に初期化される
+			crc = ~crc;
+			for(uint32_t i = 0; i < len; ++i) {
+				crc = table.t_[(crc ^ src[i]) & 0xff] ^ (crc >> 8);
+			}
+			return ~crc;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	デバイス側で計算した CRC-32 を取得
+			@param[in]	org	開始アドレス
+			@param[in]	end	終了アドレス
+			@param[out]	crc	CRC 値
+			@return サポートしない、又は、エラーなら「false」
+		*/
+		//-------------------------------------------------------------//
+		bool read_crc(uint32_t org, uint32_t end, uint32_t& crc) {
+			read_crc_visitor vis(org, end, crc);
+			return boost::apply_visitor(vis, protocol_);
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ページ列のベリファイ @n
+					crc が「true」なら、連続したページ毎にデバイスの CRC と比較し、@n
+					一致しない（又は CRC をサポートしない）場合だけ、ページを読み出して比較する。
+			@param[in]	ps		ページ・アドレス列（昇順）
+			@param[in]	get		ページ・データ取得関数
+			@param[in]	crc		CRC による高速ベリファイを行う場合「true」
+			@param[in]	pf		プログレス関数（ページ毎に呼ばれる）
+			@return 成功なら「true」
+		*/
+		//-------------------------------------------------------------//
+		bool verify_pages(const pages& ps, get_page_func get, bool crc, progress_func pf = nullptr)
+		{
+			uint32_t i = 0;
+			while(i < ps.size()) {
+				// 連続したページの範囲
+				uint32_t n = i + 1;
+				while(n < ps.size() && ps[n] == (ps[n - 1] + 256)) {
+					++n;
+				}
+				bool match = false;
+				if(crc) {
+					uint32_t c = 0;
+					for(uint32_t j = i; j < n; ++j) {
+						c = calc_crc(c, get(ps[j]), 256);
+					}
+					uint32_t dev = 0;
+					auto org = ps[i];
+					auto end = ps[n - 1] + 255;
+					if(read_crc(org, end, dev)) {
+						match = (c == dev);
+						if(verbose_) {
+							std::cout << boost::format("Verify CRC: %08X to %08X, D(%08X) to M(%08X)")
+								% org % end % dev % c << std::endl;
+						}
+					}
+				}
+				for(uint32_t j = i; j < n; ++j) {
+					if(pf) pf(ps[j]);
+					if(match) continue;
+					if(!verify_page(ps[j], get(ps[j]))) {
+						return false;
+					}
+				}
+				i = n;
+			}
+			return true;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	イレース・ブロックのサイズを取得
+			@param[in]	adr	アドレス
+			@return イレース・ブロックのサイズ（「０」ならブロック単位の消去をサポートしない）
+		*/
+		//-------------------------------------------------------------//
+		uint32_t get_erase_block_size(uint32_t adr) {
+			erase_block_size_visitor vis(adr);
+			return boost::apply_visitor(vis, protocol_);
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	デバイス ID の取得 @n
+					ブート・モードは固有のシリアル番号を持たないので、@n
+					デバイス種別（デバイス・コード）から作る
+			@return デバイス ID（空白を含まない文字列）
+		*/
+		//-------------------------------------------------------------//
+		std::string get_device_id() {
+			device_id_visitor vis;
+			return boost::apply_visitor(vis, protocol_);
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	内容が変化したイレース・ブロックに含まれるページを選別 @n
+					デバイスを読み出して比較し、一致しないページを含む @n
+					ブロックのページだけを「out」に出力する。@n
+					crc が「true」なら、ブロック内の連続したページ毎にデバイスの CRC と比較し、@n
+					一致しない（又は CRC をサポートしない）場合だけ、ページを読み出して比較する。
+			@param[in]	ps		ページ・アドレス列（昇順）
+			@param[in]	get		ページ・データ取得関数
+			@param[out]	out		書き換えが必要なページ・アドレス列
+			@param[in]	pf		プログレス関数（ページ毎に呼ばれる）
+			@param[in]	crc		CRC で比較する場合「true」
+			@return 成功なら「true」
+		*/
+		//-------------------------------------------------------------//
+		bool select_changed_pages(const pages& ps, get_page_func get, pages& out, progress_func pf = nullptr,
+			bool crc = false)
+		{
+			out.clear();
+			uint32_t i = 0;
+			while(i < ps.size()) {
+				auto bsz = get_erase_block_size(ps[i]);
+				if(bsz == 0) {
+					std::cerr << "Erase block size unknown (incremental write not supported)." << std::endl;
+					return false;
+				}
+				auto org = ps[i] & ~(bsz - 1);
+				// 同じブロックに含まれるページの範囲
+				uint32_t n = i;
+				while(n < ps.size() && (ps[n] & ~(bsz - 1)) == org) {
+					++n;
+				}
+				bool match = false;
+				if(crc) {
+					match = true;
+					uint32_t k = i;
+					while(match && k < n) {
+						uint32_t m = k + 1;
+						while(m < n && ps[m] == (ps[m - 1] + 256)) {
+							++m;
+						}
+						uint32_t c = 0;
+						for(uint32_t j = k; j < m; ++j) {
+							c = calc_crc(c, get(ps[j]), 256);
+						}
+						uint32_t dev = 0;
+						match = read_crc(ps[k], ps[m - 1] + 255, dev) && dev == c;
+						k = m;
+					}
+				}
+				bool diff = false;
+				for(uint32_t j = i; j < n; ++j) {
+					if(pf) pf(ps[j]);
+					if(diff || match) continue;
+					uint8_t dev[256];
+					if(!read_page(ps[j], &dev[0])) {
+						return false;
+					}
+					if(std::memcmp(dev, get(ps[j]), 256) != 0) {
+						diff = true;
+					}
+				}
+				if(diff) {
+					if(verbose_) {
+						std::cout << boost::format("Changed block: %08X to %08X") % org % (org + bsz - 1)
+							<< std::endl;
+					}
+					out.insert(out.end(), ps.begin() + i, ps.begin() + n);
+				}
+				i = n;
+			}
+			return true;
+		}
+
+
 		//-------------------------------------------------------------//
 		/*!
 			@brief	ライト開始
@@ -273,6 +637,136 @@ namespace rx {
 		}
 
 
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ページ列のライト（２５６バイト単位） @n
+					各ページの書き込み完了は、ブート・ローダーのレスポンスで判定する。@n
+					完了を待つ間に、次のページのフレームを用意して送受信に登録しておき、@n
+					OK のレスポンスを受信したら、直ちに次のページを送る。@n
+					wait に「０」以外を指定すると、各ページの後に固定の待ちを入れる。
+			@param[in]	ps		ページ・アドレス列
+			@param[in]	get		ページ・データ取得関数
+			@param[in]	wait	ページ毎の固定待ち時間 [uS]（0 なら待たない）
+			@param[in]	pf		プログレス関数（ページ毎に呼ばれる）
+			@param[in]	df		完了関数（ページの書き込み完了毎に呼ばれる）
+			@return 成功なら「true」
+		*/
+		//-------------------------------------------------------------//
+		bool write_pages(const pages& ps, get_page_func get, uint32_t wait, progress_func pf = nullptr,
+			progress_func df = nullptr)
+		{
+			write_bytes_ = 0;
+			write_time_ = 0.0;
+			if(ps.empty()) return true;
+
+			auto st = std::chrono::steady_clock::now();
+			if(pf) pf(ps[0]);
+			if(!write_prepare_(ps[0], get) || !write_send_(ps[0])) {
+				return false;
+			}
+			for(uint32_t i = 0; i < ps.size(); ++i) {
+				auto adr = ps[i];
+				bool next = (i + 1) < ps.size();
+				// 書き込み中に、次のページを用意
+				if(next && !write_prepare_(ps[i + 1], get)) {
+					return false;
+				}
+				if(next && wait == 0) {
+					// レスポンスを受信したら、同じループで次のページを送る
+					write_chain_visitor vis(adr, ps[i + 1]);
+					if(!boost::apply_visitor(vis, protocol_)) {
+						end();
+						std::cerr << std::endl << boost::format("Write body error: %08X") % adr << std::endl;
+						return false;
+					}
+				} else {
+					write_response_visitor res(adr);
+					if(!boost::apply_visitor(res, protocol_)) {
+						end();
+						std::cerr << std::endl << boost::format("Write body error: %08X") % adr << std::endl;
+						return false;
+					}
+					if(wait > 0) {
+						usleep(wait);
+					}
+					if(next && !write_send_(ps[i + 1])) {
+						return false;
+					}
+				}
+				write_bytes_ += 256;
+				if(df) df(adr);
+				if(next && pf) pf(ps[i + 1]);
+			}
+			auto d = std::chrono::steady_clock::now() - st;
+			write_time_ = std::chrono::duration<double>(d).count();
+
+			return true;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	最後の「write_pages」で書き込んだバイト数を取得
+			@return 書き込んだバイト数
+		*/
+		//-------------------------------------------------------------//
+		uint32_t get_write_bytes() const { return write_bytes_; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	最後の「write_pages」に掛かった時間を取得
+			@return 時間 [秒]
+		*/
+		//-------------------------------------------------------------//
+		double get_write_time() const { return write_time_; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	最後の「write_pages」の実効速度を取得
+			@return 速度 [bytes/sec]
+		*/
+		//-------------------------------------------------------------//
+		uint32_t get_write_rate() const {
+			if(write_time_ <= 0.0) return 0;
+			return static_cast<uint32_t>(static_cast<double>(write_bytes_) / write_time_);
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	現在の速度で通信を検査する @n
+					同じページを複数回読み出し、内容が一致するか確認して、@n
+					実効速度を計測する
+			@param[in]	num		読み出し回数
+			@param[out]	rate	実効速度 [bytes/sec]
+			@return 安定して通信出来たら「true」
+		*/
+		//-------------------------------------------------------------//
+		bool probe_speed(uint32_t num, uint32_t& rate) {
+			static const uint32_t adr = 0xFFFFFF00;  // 例外ベクタ（全デバイスに存在する）
+			uint8_t ref[256];
+			uint8_t tmp[256];
+			rate = 0;
+			auto st = std::chrono::steady_clock::now();
+			for(uint32_t i = 0; i < num; ++i) {
+				if(!read_page(adr, (i == 0) ? ref : tmp)) {
+					return false;
+				}
+				if(i > 0 && std::memcmp(ref, tmp, sizeof(tmp)) != 0) {
+					std::cerr << "Probe data missmatch." << std::endl;
+					return false;
+				}
+			}
+			double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - st).count();
+			if(t > 0.0) {
+				rate = static_cast<uint32_t>(static_cast<double>(num * 256) / t);
+			}
+			return true;
+		}
+
+
 		//-------------------------------------------------------------//
 		/*!
 			@brief	ライト終了
@@ -0,0 +1,96 @@
+#!/bin/bash
+# rx_sim と rx_prog で、書き込み速度（pages/sec）を測る
+#   プロトコル毎に、擬似的な書き込み時間（latency [us]）を変えて書き込む
+#   PROTO、LATENCY で、対象を変えられる（make bench BENCH_PROTO=... BENCH_LATENCY=...）
+CMDNAME=`basename $0`
+if [[ $1 = "-help" ]]; then
+    echo "Usage: [PROTO=\"rx24t rx64m\"] [LATENCY=\"0 500\"] $CMDNAME"
+    exit
+fi
+
+SIM_DIR=$(cd "$(dirname "$0")" && pwd)
+SIM="${SIM_DIR}/rx_sim"
+PROG="${SIM_DIR}/../rx_prog"
+PROTO=${PROTO:-"rx63t rx24t rx64m rx65x rx66t rx72t"}
+LATENCY=${LATENCY:-"0 200 500"}
+
+if [ ! -x "${SIM}" ] || [ ! -x "${PROG}" ]; then
+	echo "Build rx_sim and rx_prog first ('make bench' does it)."
+	exit 1
+fi
+
+WORK=`mktemp -d /tmp/rx_bench.XXXXXX`
+trap 'rm -rf "${WORK}"' EXIT
+
+# RX63T は、設定ファイルの標準デバイスから、クロックの設定を読む
+sed 's/^#device =$/device = R5F563T6/' "${SIM_DIR}/../rx_prog.conf" > "${WORK}/rx_prog.conf"
+
+# S3 レコードの書き込みファイル（$1: 開始アドレス、$2: バイト数、$3: 出力）
+make_mot()
+{
+	awk -v org=$(($1)) -v size=$(($2)) 'BEGIN {
+		for(a = 0; a < size; a += 16) {
+			adr = org + a;
+			sum = 21;
+			line = "S315";
+			for(k = 3; k >= 0; --k) {
+				b = int(adr / (2 ^ (k * 8))) % 256;
+				sum += b;
+				line = line sprintf("%02X", b);
+			}
+			for(i = 0; i < 16; ++i) {
+				b = (int(a / 16) + i * 17) % 255;
+				sum += b;
+				line = line sprintf("%02X", b);
+			}
+			printf("%s%02X\n", line, 255 - (sum % 256));
+		}
+		printf("S70500000000FA\n");
+	}' > "$3"
+}
+
+# プロトコル毎の、rx_prog のデバイス名と、書き込み領域
+target()
+{
+	case $1 in
+	rx63t) echo "RX63T 0xFFFF8000 0x8000" ;;
+	rx24t) echo "RX24T 0xFFFF8000 0x8000" ;;
+	rx64m) echo "RX64M 0xFFFE0000 0x20000" ;;
+	rx65x) echo "RX65N 0xFFFE0000 0x20000" ;;
+	rx66t) echo "RX66T 0xFFFE0000 0x20000" ;;
+	rx72t) echo "RX72T 0xFFFE0000 0x20000" ;;
+	*) return 1 ;;
+	esac
+}
+
+ERROR=0
+for p in ${PROTO}; do
+	t=(`target ${p}`)
+	if [ ${#t[@]} -ne 3 ]; then
+		echo "Protocol error: '${p}'"
+		ERROR=1
+		continue
+	fi
+	make_mot ${t[1]} ${t[2]} "${WORK}/${p}.mot"
+	for l in ${LATENCY}; do
+		rm -f "${WORK}/pty"
+		"${SIM}" --proto=${p} --latency=${l} --link="${WORK}/pty" --once > "${WORK}/sim.log" 2>&1 &
+		SIM_PID=$!
+		for i in `seq 50`; do
+			[ -e "${WORK}/pty" ] && break
+			sleep 0.1
+		done
+		# 設定ファイルは、カレントのものが使われる
+		if ! (cd "${WORK}" && "${PROG}" -P "${WORK}/pty" -s 115200 -d ${t[0]} -e -w "${p}.mot" > prog.log 2>&1); then
+			echo "${p}: latency ${l} us, rx_prog failed"
+			cat "${WORK}/prog.log"
+			kill ${SIM_PID} 2> /dev/null
+			wait ${SIM_PID} 2> /dev/null
+			ERROR=1
+			continue
+		fi
+		wait ${SIM_PID}
+		grep "pages/sec" "${WORK}/sim.log" || { cat "${WORK}/sim.log"; ERROR=1; }
+	done
+done
+exit ${ERROR}
@@ -0,0 +1,135 @@
+//=====================================================================//
+/*!	@file
+	@brief	RX ブート・ローダー・シミュレーター @n
+			擬似端末（pty）上で、各 RX マイコンのブート・モードの応答を返す @n
+			rx_prog のプロトコル検証、速度評価用
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+
+#include "rx64m_target.hpp"
+#include "rx63t_target.hpp"
+
+namespace {
+
+	const std::string version_ = "0.10b";
+
+	struct options {
+		std::string	proto = "rx64m";
+		uint32_t	latency = 0;
+		std::string	link;
+		bool		once = false;
+		bool		verbose = false;
+	};
+
+
+	void help_(const char* cmd)
+	{
+		std::string c = cmd;
+		auto n = c.rfind('/');
+		if(n != std::string::npos) c = c.substr(n + 1);
+
+		std::cout << "Renesas RX Series boot-loader simulator Version " << version_ << std::endl;
+		std::cout << "Copyright (C) 2020, Hiramatsu Kunihito (hira@rvf-rc45.net)" << std::endl;
+		std::cout << "usage:" << std::endl;
+		std::cout << c << " [options]" << std::endl;
+		std::cout << std::endl;
+		std::cout << "Options :" << std::endl;
+		std::cout << "    --proto=NAME               rx24t, rx63t, rx64m, rx65x, rx66t, rx72t (default rx64m)" << std::endl;
+		std::cout << "    --latency=USEC             Page write time [us] (default 0)" << std::endl;
+		std::cout << "    --link=PATH                Make symbolic link to pty" << std::endl;
+		std::cout << "    --once                     Exit after one session" << std::endl;
+		std::cout << "    --verbose                  Verbose output" << std::endl;
+		std::cout << "    -h, --help                 Display this" << std::endl;
+	}
+
+
+	std::string link_;
+
+	void remove_link_(int sig)
+	{
+		if(!link_.empty()) unlink(link_.c_str());
+		std::_Exit(0);
+	}
+
+
+	template <class TARGET>
+	void service_(TARGET& t, const options& opts)
+	{
+		bool sync = false;
+		while(1) {
+			sync = t.session(sync);
+			t.get_stat().list(opts.proto, opts.latency);
+			if(opts.once) break;
+		}
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	options opts;
+	for(int i = 1; i < argc; ++i) {
+		std::string p = argv[i];
+		if(p.find("--proto=") == 0) {
+			opts.proto = &p[std::strlen("--proto=")];
+		} else if(p.find("--latency=") == 0) {
+			opts.latency = std::strtoul(&p[std::strlen("--latency=")], nullptr, 10);
+		} else if(p.find("--link=") == 0) {
+			opts.link = &p[std::strlen("--link=")];
+		} else if(p == "--once") {
+			opts.once = true;
+		} else if(p == "--verbose") {
+			opts.verbose = true;
+		} else if(p == "-h" || p == "--help") {
+			help_(argv[0]);
+			return 0;
+		} else {
+			std::cerr << "Option error: '" << p << "'" << std::endl;
+			help_(argv[0]);
+			return -1;
+		}
+	}
+
+	rxsim::target_io io;
+	if(!io.open()) {
+		std::cerr << "Can't open pty" << std::endl;
+		return -1;
+	}
+	if(!opts.link.empty()) {
+		unlink(opts.link.c_str());
+		if(symlink(io.get_name().c_str(), opts.link.c_str()) != 0) {
+			std::cerr << "Can't make link: '" << opts.link << "'" << std::endl;
+			return -1;
+		}
+		link_ = opts.link;
+		signal(SIGINT, remove_link_);
+		signal(SIGTERM, remove_link_);
+	}
+	std::cout << io.get_name() << std::endl;
+
+	rxsim::flash_memory flash;
+	if(opts.proto == "rx24t" || opts.proto == "rx63t") {
+		rxsim::rx63t_target t(io, flash, opts.proto == "rx24t", opts.latency, opts.verbose);
+		service_(t, opts);
+	} else if(opts.proto == "rx64m" || opts.proto == "rx66t" || opts.proto == "rx72t") {
+		rxsim::rx64m_target t(io, flash, 0xC1, opts.latency, opts.verbose);
+		service_(t, opts);
+	} else if(opts.proto == "rx65x") {
+		rxsim::rx64m_target t(io, flash, 0xC2, opts.latency, opts.verbose);
+		service_(t, opts);
+	} else {
+		std::cerr << "Protocol error: '" << opts.proto << "'" << std::endl;
+		return -1;
+	}
+
+	if(!link_.empty()) unlink(link_.c_str());
+}
@@ -0,0 +1,322 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	RX63T/RX24T ブート・ローダー・シミュレーター @n
+			１バイト・コマンドと ACK(0x06) 応答のプロトコル @n
+			（rx63t_protocol.hpp、rx24t_protocol.hpp の相手）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "target_io.hpp"
+
+namespace rxsim {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	RX63T/RX24T ブート・ローダー・シミュレーター・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class rx63t_target {
+
+		static const uint32_t IDLE_TIMEOUT = 2000;	///< セッション終了と見なす無通信時間（ミリ秒）
+
+		static const uint32_t USER_ORG = 0xFFF80000;
+		static const uint32_t USER_END = 0xFFFFFFFF;
+		static const uint32_t DATA_ORG = 0x00100000;
+		static const uint32_t DATA_END = 0x00107FFF;
+
+		target_io&		io_;
+		flash_memory&	flash_;
+		bool			rx24t_;		///< RX24T の応答形式にする場合「true」
+		uint32_t		latency_;	///< ページ書き込み時間（マイクロ秒）
+		bool			verbose_;
+
+		stat_t			stat_;
+
+
+		static uint32_t get32_big_(const uint8_t* p) {
+			return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16)
+				| (static_cast<uint32_t>(p[2]) << 8) | p[3];
+		}
+
+
+		static void put32_big_(uint8_t* p, uint32_t val) {
+			p[0] = (val >> 24) & 0xff;
+			p[1] = (val >> 16) & 0xff;
+			p[2] = (val >> 8) & 0xff;
+			p[3] =  val & 0xff;
+		}
+
+
+		static void put16_big_(uint8_t* p, uint32_t val) {
+			p[0] = (val >> 8) & 0xff;
+			p[1] = val & 0xff;
+		}
+
+
+		static uint8_t sum_(const uint8_t* buff, uint32_t len) {
+			uint16_t sum = 0;
+			for(uint32_t i = 0; i < len; ++i) {
+				sum += *buff++;
+			}
+			return (0 - sum) & 0xff;
+		}
+
+
+		// 応答の最後に SUM を付けて送る
+		bool reply_(uint8_t* buff, uint32_t len) {
+			buff[len] = sum_(buff, len);
+			return io_.write(buff, len + 1);
+		}
+
+
+		// サイズ付きコマンドの残り（サイズ、データ、SUM）を受信する
+		bool param_(uint8_t cmd, uint8_t* dst, uint32_t& len) {
+			uint8_t size;
+			if(!io_.read(&size, 1, IDLE_TIMEOUT)) return false;
+			if(!io_.read(dst, size + 1, IDLE_TIMEOUT)) return false;
+			len = size;
+			uint8_t sum = cmd + size;
+			for(uint32_t i = 0; i < len + 1; ++i) sum += dst[i];
+			return sum == 0;
+		}
+
+
+		bool area_(uint8_t res, uint32_t org, uint32_t end) {
+			uint8_t tmp[3 + 8 + 1];
+			tmp[0] = res;
+			tmp[1] = 8 + 1;
+			tmp[2] = 1;
+			put32_big_(&tmp[3], org);
+			put32_big_(&tmp[7], end);
+			return reply_(tmp, 11);
+		}
+
+
+		bool connection_(bool sync) {
+			if(sync) {
+				io_.put(0x00);
+			}
+			while(1) {
+				int ch = io_.get(sync ? IDLE_TIMEOUT : 0x7fffffff);
+				if(ch == EOF) return false;
+				if(ch == 0x00) {
+					io_.put(0x00);
+					sync = true;
+				} else if(ch == 0x55 && sync) {
+					io_.put(0xE6);
+					return true;
+				}
+			}
+		}
+
+
+		bool device_() {
+			static const char name[] = "RXSIM";
+			uint32_t n = sizeof(name) - 1;
+			uint8_t tmp[32];
+			uint32_t code = 0x12345678;
+			if(rx24t_) {
+				tmp[0] = 0x30;
+				tmp[1] = 2 + 4 + n;
+				tmp[2] = 1;
+				tmp[3] = 4 + n;
+				for(int i = 0; i < 4; ++i) tmp[4 + i] = (code >> (i * 8)) & 0xff;
+				std::memcpy(&tmp[8], name, n);
+				return reply_(tmp, 8 + n);
+			} else {
+				tmp[0] = 0x30;
+				tmp[1] = 1 + 4 + n + 1;
+				tmp[2] = 1;
+				uint8_t* p = &tmp[3];
+				p[0] = 4 + n;
+				for(int i = 0; i < 4; ++i) p[1 + i] = (code >> (i * 8)) & 0xff;
+				std::memcpy(&p[5], name, n);
+				p[5 + n] = sum_(p, 5 + n);
+				return io_.write(tmp, 3 + 5 + n + 1);
+			}
+		}
+
+
+		bool block_() {
+			uint8_t tmp[4 + 24 + 1];
+			tmp[0] = 0x36;
+			if(rx24t_) {
+				put16_big_(&tmp[1], 1 + 24);
+				tmp[3] = 2;
+				put32_big_(&tmp[4],  USER_ORG);
+				put32_big_(&tmp[8],  0x800);
+				put32_big_(&tmp[12], (USER_END - USER_ORG + 1) / 0x800);
+				put32_big_(&tmp[16], DATA_ORG);
+				put32_big_(&tmp[20], 0x400);
+				put32_big_(&tmp[24], (DATA_END - DATA_ORG + 1) / 0x400);
+				return reply_(tmp, 28);
+			} else {
+				put16_big_(&tmp[1], 1 + 8);
+				tmp[3] = 1;
+				put32_big_(&tmp[4], USER_ORG);
+				put32_big_(&tmp[8], USER_END);
+				return reply_(tmp, 12);
+			}
+		}
+
+
+		bool write_(uint8_t* head) {
+			if(!io_.read(&head[1], 4, IDLE_TIMEOUT)) return false;
+			auto org = get32_big_(&head[1]);
+			if(org == 0xFFFFFFFF) {  // 書き込み終了
+				uint8_t sum;
+				if(!io_.read(&sum, 1, IDLE_TIMEOUT)) return false;
+				return io_.put(0x06);
+			}
+			uint8_t tmp[256 + 1];
+			if(!io_.read(tmp, sizeof(tmp), IDLE_TIMEOUT)) return false;
+			if(static_cast<uint8_t>(sum_(head, 5) + sum_(tmp, 256)) != tmp[256]) {
+				uint8_t err[2] = { 0xD0, 0x11 };
+				return io_.write(err, 2);
+			}
+			if(latency_ > 0) usleep(latency_);
+			flash_.write(org, tmp, 256);
+			++stat_.write_;
+			stat_.mark();
+			return io_.put(0x06);
+		}
+
+
+		bool read_(const uint8_t* param) {
+			auto org = get32_big_(&param[1]);
+			auto len = get32_big_(&param[5]);
+			if(len > 256) len = 256;
+			uint8_t tmp[5 + 256 + 1];
+			tmp[0] = 0x52;
+			put32_big_(&tmp[1], len);
+			flash_.read(org, &tmp[5], len);
+			++stat_.read_;
+			stat_.mark();
+			return reply_(tmp, 5 + len);
+		}
+
+
+		bool command_(uint8_t cmd) {
+			uint8_t tmp[64];
+			uint32_t len;
+			switch(cmd) {
+			case 0x20:  // サポート・デバイス
+				return device_();
+			case 0x10:  // デバイス選択
+				if(!param_(cmd, tmp, len)) return false;
+				return io_.put(rx24t_ ? 0x46 : 0x06);
+			case 0x21:  // クロック・モード
+				tmp[0] = 0x31;
+				tmp[1] = 1;
+				tmp[2] = 0x00;
+				return reply_(tmp, 3);
+			case 0x11:  // クロック・モード選択
+			case 0x3F:  // ボーレート
+				if(!param_(cmd, tmp, len)) return false;
+				return io_.put(0x06);
+			case 0x06:  // ボーレート変更の確認
+				return io_.put(0x06);
+			case 0x22:  // 逓倍比
+				tmp[0] = 0x32;
+				tmp[1] = 2 + 2 + 1;
+				tmp[2] = 2;
+				tmp[3] = 1; tmp[4] = 4;
+				tmp[5] = 1; tmp[6] = 2;
+				return reply_(tmp, 7);
+			case 0x23:  // 動作周波数
+				tmp[0] = 0x33;
+				tmp[1] = 4 * 2 + 1;
+				tmp[2] = 2;
+				put16_big_(&tmp[3],   800); put16_big_(&tmp[5], 10000);
+				put16_big_(&tmp[7],   800); put16_big_(&tmp[9],  5000);
+				return reply_(tmp, 11);
+			case 0x24:  // ユーザー・ブート領域
+				return area_(0x34, 0xFF7FC000, 0xFF7FFFFF);
+			case 0x25:  // ユーザー領域
+				return area_(0x35, USER_ORG, USER_END);
+			case 0x26:  // ブロック情報
+				return block_();
+			case 0x27:  // プログラム・サイズ
+				tmp[0] = 0x37;
+				tmp[1] = 2;
+				put16_big_(&tmp[2], 256);
+				return reply_(tmp, 4);
+			case 0x2A:  // データ領域の有無
+				tmp[0] = 0x3A;
+				tmp[1] = 1;
+				tmp[2] = rx24t_ ? 0x1D : 0x21;
+				return reply_(tmp, 3);
+			case 0x2B:  // データ領域
+				return area_(0x3B, DATA_ORG, DATA_END);
+			case 0x40:  // P/E ステータス（ID プロテクト無しなので、全消去される）
+				flash_.clear();
+				++stat_.erase_;
+				return io_.put(0x26);
+			case 0x42:  // ユーザー・ブート領域書き込み選択
+			case 0x43:  // ユーザー／データ領域書き込み選択
+				return io_.put(0x06);
+			case 0x50:  // ライト
+				tmp[0] = cmd;
+				return write_(tmp);
+			case 0x52:  // リード
+				if(!param_(cmd, tmp, len) || len < 9) return false;
+				return read_(tmp);
+			default:
+				if(verbose_) {
+					std::cout << boost::format("Unknown command: %02X") % static_cast<uint32_t>(cmd)
+						<< std::endl;
+				}
+				return io_.put(0x80 | cmd);
+			}
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	io		入出力
+			@param[in]	flash	フラッシュ・メモリー
+			@param[in]	rx24t	RX24T の応答形式にする場合「true」
+			@param[in]	latency	ページ書き込み時間（マイクロ秒）
+			@param[in]	verbose	詳細表示
+		*/
+		//-----------------------------------------------------------------//
+		rx63t_target(target_io& io, flash_memory& flash, bool rx24t, uint32_t latency, bool verbose) :
+			io_(io), flash_(flash), rx24t_(rx24t), latency_(latency), verbose_(verbose), stat_() { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	１回の接続を処理する（無通信で終了）
+			@param[in]	sync	同期（0x00）を既に受信している場合「true」
+			@return 次の接続の同期を受信した場合「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool session(bool sync)
+		{
+			if(!connection_(sync)) return false;
+
+			stat_.start();
+			while(1) {
+				int ch = io_.get(IDLE_TIMEOUT);
+				if(ch == EOF) break;
+				if(ch == 0x00) return true;
+				if(!command_(ch)) break;
+			}
+			return false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	統計を取得
+			@return 統計
+		*/
+		//-----------------------------------------------------------------//
+		const stat_t& get_stat() const { return stat_; }
+	};
+}
@@ -0,0 +1,332 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	RX64M/RX71M/RX65x/RX66T/RX72T ブート・ローダー・シミュレーター @n
+			SOH/SOD フレームのプロトコル（rx64m_protocol.hpp 等の相手）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <atomic>
+#include "target_io.hpp"
+
+namespace rxsim {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	RX64M 系ブート・ローダー・シミュレーター・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class rx64m_target {
+	public:
+		//=================================================================//
+		/*!
+			@brief	リード（0x15）に対する故障の注入
+		*/
+		//=================================================================//
+		enum class fault : uint8_t {
+			none,		///< 正常
+			status,		///< リード・コマンドにエラーを返す（データ要求は来ないはず）
+			data,		///< データ要求にエラーを返す
+			etx,		///< データ・フレームの ETX を壊す
+		};
+
+	private:
+		static const uint32_t IDLE_TIMEOUT = 2000;	///< セッション終了と見なす無通信時間（ミリ秒）
+
+		target_io&		io_;
+		flash_memory&	flash_;
+		uint8_t			code_;		///< 0x55 に対する応答（RX65x は 0xC2）
+		uint32_t		latency_;	///< ページ書き込み時間（マイクロ秒）
+		bool			verbose_;
+		std::atomic<fault>	fault_;
+
+		stat_t			stat_;
+
+		enum class frame_state {
+			ok,			///< 正常なフレーム
+			sync,		///< 同期（0x00）を受信した（新しい接続）
+			sum_error,	///< SUM エラー
+			closed		///< 無通信
+		};
+
+		uint8_t			cmd_;
+		uint8_t			data_[1024];
+		uint32_t		len_;
+
+
+		static uint32_t get32_big_(const uint8_t* p) {
+			return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16)
+				| (static_cast<uint32_t>(p[2]) << 8) | p[3];
+		}
+
+
+		static void put32_big_(uint8_t* p, uint32_t val) {
+			p[0] = (val >> 24) & 0xff;
+			p[1] = (val >> 16) & 0xff;
+			p[2] = (val >> 8) & 0xff;
+			p[3] =  val & 0xff;
+		}
+
+
+		static uint8_t sum_(const uint8_t* buff, uint32_t len) {
+			uint16_t sum = 0;
+			for(uint32_t i = 0; i < len; ++i) {
+				sum += *buff++;
+			}
+			return (0 - sum) & 0xff;
+		}
+
+
+		static uint32_t get_erase_block_size_(uint32_t address) {
+			if(address >= 0xFFFF0000) {
+				return 8192;
+			} else if(address >= 0xFFC00000) {
+				return 32768;
+			}
+			return 256;
+		}
+
+
+		bool status_(uint8_t res, const uint8_t* src = nullptr, uint32_t len = 0, uint8_t etx = 0x03) {
+			uint8_t tmp[4 + 256 + 2];
+			tmp[0] = 0x81;
+			tmp[1] = ((1 + len) >> 8) & 0xff;
+			tmp[2] = (1 + len) & 0xff;
+			tmp[3] = res;
+			if(len > 0) std::memcpy(&tmp[4], src, len);
+			tmp[4 + len] = sum_(&tmp[1], 3 + len);
+			tmp[4 + len + 1] = etx;
+			return io_.write(tmp, 4 + len + 2);
+		}
+
+
+		bool error_(uint8_t res, uint8_t err) {
+			return status_(res, &err, 1);
+		}
+
+
+		frame_state frame_(uint8_t soh) {
+			int ch = io_.get(IDLE_TIMEOUT);
+			if(ch == EOF) return frame_state::closed;
+			if(ch == 0x00) return frame_state::sync;
+			if(ch != soh) return frame_state::sum_error;
+
+			uint8_t head[3];
+			if(!io_.read(head, 3, IDLE_TIMEOUT)) return frame_state::closed;
+			uint32_t l = (static_cast<uint32_t>(head[0]) << 8) | head[1];
+			if(l == 0 || l > sizeof(data_)) return frame_state::sum_error;
+			cmd_ = head[2];
+			len_ = l - 1;
+			if(!io_.read(data_, len_, IDLE_TIMEOUT)) return frame_state::closed;
+			uint8_t tail[2];
+			if(!io_.read(tail, 2, IDLE_TIMEOUT)) return frame_state::closed;
+			uint8_t sum = sum_(head, 3) + sum_(data_, len_);
+			if(sum != tail[0] || tail[1] != 0x03) return frame_state::sum_error;
+			return frame_state::ok;
+		}
+
+
+		// ステータスの返送を受け取る（rx_prog は７バイト送るので、余分な１バイトを読み捨てる）
+		bool status_back_() {
+			if(frame_(0x81) != frame_state::ok) return false;
+			uint8_t tmp[1];
+			io_.read(tmp, 1, 100);
+			return true;
+		}
+
+
+		// 接続（0x00 には 0x00、0x55 には識別コードを返す）
+		bool connection_(bool sync) {
+			if(sync) {
+				io_.put(0x00);
+			}
+			while(1) {
+				int ch = io_.get(sync ? IDLE_TIMEOUT : 0x7fffffff);
+				if(ch == EOF) return false;
+				if(ch == 0x00) {
+					io_.put(0x00);
+					sync = true;
+				} else if(ch == 0x55 && sync) {
+					io_.put(code_);
+					return true;
+				}
+			}
+		}
+
+
+		bool command_() {
+			switch(cmd_) {
+			case 0x38:  // デバイス種別
+				{
+					status_(0x38);
+					if(!status_back_()) return false;
+					uint8_t tmp[24];
+					std::memset(tmp, 0, sizeof(tmp));
+					std::memcpy(tmp, "RXSIM   ", 8);
+					put32_big_(&tmp[8],  24000000);
+					put32_big_(&tmp[12],  8000000);
+					put32_big_(&tmp[16], 240000000);
+					put32_big_(&tmp[20],  8000000);
+					return status_(0x38, tmp, sizeof(tmp));
+				}
+			case 0x36:  // エンディアン
+			case 0x34:  // ボーレート
+			case 0x00:  // 同期
+				return status_(cmd_);
+			case 0x32:  // 周波数
+				{
+					uint8_t tmp[8];
+					std::memcpy(tmp, data_, sizeof(tmp));
+					status_(0x32);
+					if(!status_back_()) return false;
+					return status_(0x32, tmp, sizeof(tmp));
+				}
+			case 0x2C:  // ID 認証モード（無効）
+				{
+					status_(0x2C);
+					if(!status_back_()) return false;
+					uint8_t id = 0xFF;
+					return status_(0x2C, &id, 1);
+				}
+			case 0x10:  // ブランク・チェック
+				{
+					if(len_ < 8) return error_(0x90, 0xC1);
+					auto org = get32_big_(&data_[0]);
+					auto end = get32_big_(&data_[4]);
+					if(flash_.is_blank(org, end - org + 1)) return status_(0x10);
+					return error_(0x90, 0xE0);
+				}
+			case 0x12:  // イレース
+				{
+					if(len_ < 4) return error_(0x92, 0xC1);
+					auto org = get32_big_(&data_[0]);
+					auto sz = get_erase_block_size_(org);
+					flash_.erase(org & ~(sz - 1), sz);
+					++stat_.erase_;
+					return status_(0x12);
+				}
+			case 0x13:  // ライト
+				{
+					if(len_ < 8) return error_(0x93, 0xC1);
+					auto org = get32_big_(&data_[0]);
+					status_(0x13);
+					if(frame_(0x81) != frame_state::ok || cmd_ != 0x13 || len_ != 256) {
+						return false;
+					}
+					if(latency_ > 0) usleep(latency_);
+					// 消去されていない領域への書き込みはエラー
+					if(!flash_.is_blank(org, 256)) {
+						if(verbose_) {
+							std::cout << boost::format("Write not blank: %08X") % org << std::endl;
+						}
+						return error_(0x93, 0xE2);
+					}
+					flash_.write(org, data_, 256);
+					++stat_.write_;
+					stat_.mark();
+					return status_(0x13);
+				}
+			case 0x15:  // リード
+				{
+					if(len_ < 8) return error_(0x95, 0xC1);
+					auto org = get32_big_(&data_[0]);
+					auto end = get32_big_(&data_[4]);
+					uint32_t n = end - org + 1;
+					if(n > 256) n = 256;
+					auto f = fault_.load();
+					if(f == fault::status) return error_(0x95, 0xE0);
+					status_(0x15);
+					if(frame_(0x81) != frame_state::ok || cmd_ != 0x15) return false;
+					if(f == fault::data) return error_(0x95, 0xE0);
+					uint8_t tmp[256];
+					flash_.read(org, tmp, n);
+					++stat_.read_;
+					stat_.mark();
+					return status_(0x15, tmp, n, f == fault::etx ? 0x00 : 0x03);
+				}
+			case 0x18:  // ＣＲＣ
+				{
+					if(len_ < 8) return error_(0x98, 0xC1);
+					uint8_t tmp[4];
+					put32_big_(tmp, flash_.crc(get32_big_(&data_[0]), get32_big_(&data_[4])));
+					++stat_.crc_;
+					stat_.mark();
+					return status_(0x18, tmp, sizeof(tmp));
+				}
+			default:
+				if(verbose_) {
+					std::cout << boost::format("Unknown command: %02X") % static_cast<uint32_t>(cmd_)
+						<< std::endl;
+				}
+				return error_(0x80 | cmd_, 0xC0);
+			}
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	io		入出力
+			@param[in]	flash	フラッシュ・メモリー
+			@param[in]	code	0x55 に対する応答
+			@param[in]	latency	ページ書き込み時間（マイクロ秒）
+			@param[in]	verbose	詳細表示
+		*/
+		//-----------------------------------------------------------------//
+		rx64m_target(target_io& io, flash_memory& flash, uint8_t code, uint32_t latency, bool verbose) :
+			io_(io), flash_(flash), code_(code), latency_(latency), verbose_(verbose),
+			fault_(fault::none), stat_(), cmd_(0), data_{ 0 }, len_(0) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	１回の接続を処理する（無通信で終了）
+			@param[in]	sync	同期（0x00）を既に受信している場合「true」
+			@return 次の接続の同期を受信した場合「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool session(bool sync)
+		{
+			if(!connection_(sync)) return false;
+
+			stat_.start();
+			bool next = false;
+			while(1) {
+				auto st = frame_(0x01);
+				if(st == frame_state::closed) {
+					break;
+				} else if(st == frame_state::sync) {
+					next = true;
+					break;
+				} else if(st == frame_state::sum_error) {
+					++stat_.stray_;
+					error_(0x80, 0xC1);
+					continue;
+				}
+				if(!command_()) break;
+			}
+			return next;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リードへの故障の注入を設定（他のスレッドから呼べる）
+			@param[in]	f	故障の種類
+		*/
+		//-----------------------------------------------------------------//
+		void set_fault(fault f) { fault_ = f; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	統計を取得
+			@return 統計
+		*/
+		//-----------------------------------------------------------------//
+		const stat_t& get_stat() const { return stat_; }
+	};
+}
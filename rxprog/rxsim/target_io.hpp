@@ -0,0 +1,384 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	RX ブート・ローダー・シミュレーター、擬似端末入出力と、@n
+			フラッシュ・メモリーのモデル
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <poll.h>
+
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <boost/format.hpp>
+
+#include "sparse_image.hpp"
+
+namespace rxsim {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	擬似端末（pty）入出力クラス @n
+				スレーブ側を開いたままにして、rx_prog の接続、切断で @n
+				マスター側が HUP にならないようにする
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class target_io {
+
+		int			master_;
+		int			slave_;
+		std::string	name_;
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		target_io() : master_(-1), slave_(-1), name_() { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デストラクター
+		*/
+		//-----------------------------------------------------------------//
+		~target_io() { close(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	擬似端末を開く
+			@return 正常なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool open()
+		{
+			master_ = posix_openpt(O_RDWR | O_NOCTTY);
+			if(master_ < 0) return false;
+			if(grantpt(master_) != 0 || unlockpt(master_) != 0) {
+				close();
+				return false;
+			}
+			const char* p = ptsname(master_);
+			if(p == nullptr) {
+				close();
+				return false;
+			}
+			name_ = p;
+			slave_ = ::open(p, O_RDWR | O_NOCTTY);
+			if(slave_ < 0) {
+				close();
+				return false;
+			}
+			termios t;
+			if(tcgetattr(slave_, &t) == 0) {
+				cfmakeraw(&t);
+				tcsetattr(slave_, TCSANOW, &t);
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	閉じる
+		*/
+		//-----------------------------------------------------------------//
+		void close()
+		{
+			if(slave_ >= 0) ::close(slave_);
+			if(master_ >= 0) ::close(master_);
+			slave_ = -1;
+			master_ = -1;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	スレーブ側のパスを取得（rx_prog の -P に渡す）
+			@return パス
+		*/
+		//-----------------------------------------------------------------//
+		const std::string& get_name() const { return name_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信
+			@param[out]	dst	受信データ転送先
+			@param[in]	len	受信長さ
+			@param[in]	ms	タイムアウト（ミリ秒）
+			@return 全て受信したら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool read(void* dst, uint32_t len, uint32_t ms)
+		{
+			auto p = static_cast<uint8_t*>(dst);
+			auto dl = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+			while(len > 0) {
+				auto now = std::chrono::steady_clock::now();
+				if(now >= dl) return false;
+				auto t = std::chrono::duration_cast<std::chrono::milliseconds>(dl - now).count() + 1;
+				pollfd pfd;
+				pfd.fd = master_;
+				pfd.events = POLLIN;
+				pfd.revents = 0;
+				int ret = ::poll(&pfd, 1, static_cast<int>(t));
+				if(ret < 0) {
+					if(errno == EINTR) continue;
+					return false;
+				} else if(ret == 0) {
+					return false;
+				}
+				auto l = ::read(master_, p, len);
+				if(l < 0) {
+					if(errno == EAGAIN || errno == EINTR) continue;
+					return false;
+				}
+				p += l;
+				len -= l;
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	１バイト受信
+			@param[in]	ms	タイムアウト（ミリ秒）
+			@return 受信データ（タイムアウトなら「EOF」）
+		*/
+		//-----------------------------------------------------------------//
+		int get(uint32_t ms)
+		{
+			uint8_t ch;
+			if(!read(&ch, 1, ms)) return EOF;
+			return ch;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	送信
+			@param[in]	src	送信データ転送元
+			@param[in]	len	送信長さ
+			@return 正常なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool write(const void* src, uint32_t len)
+		{
+			auto p = static_cast<const uint8_t*>(src);
+			while(len > 0) {
+				auto l = ::write(master_, p, len);
+				if(l < 0) {
+					if(errno == EAGAIN || errno == EINTR) continue;
+					return false;
+				}
+				p += l;
+				len -= l;
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	１バイト送信
+			@param[in]	ch	送信データ
+			@return 正常なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool put(uint8_t ch) { return write(&ch, 1); }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	フラッシュ・メモリー・クラス（未書き込み領域は 0xFF）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class flash_memory {
+
+		utils::sparse_image	image_;
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	全消去
+		*/
+		//-----------------------------------------------------------------//
+		void clear() { image_.clear(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	読み出し
+			@param[in]	adr	アドレス
+			@param[out]	dst	転送先
+			@param[in]	len	長さ
+		*/
+		//-----------------------------------------------------------------//
+		void read(uint32_t adr, uint8_t* dst, uint32_t len) const
+		{
+			while(len > 0) {
+				auto ofs = adr & (utils::sparse_image::PAGE_SIZE - 1);
+				auto l = std::min(len, utils::sparse_image::PAGE_SIZE - ofs);
+				auto p = image_.get_page(adr);
+				if(p != nullptr) {
+					std::memcpy(dst, p + ofs, l);
+				} else {
+					std::memset(dst, 0xff, l);
+				}
+				adr += l;
+				dst += l;
+				len -= l;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	書き込み
+			@param[in]	adr	アドレス
+			@param[in]	src	転送元
+			@param[in]	len	長さ
+		*/
+		//-----------------------------------------------------------------//
+		void write(uint32_t adr, const uint8_t* src, uint32_t len) { image_.write(adr, src, len); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	消去
+			@param[in]	adr	アドレス
+			@param[in]	len	長さ
+		*/
+		//-----------------------------------------------------------------//
+		void erase(uint32_t adr, uint32_t len)
+		{
+			uint8_t tmp[utils::sparse_image::PAGE_SIZE];
+			std::memset(tmp, 0xff, sizeof(tmp));
+			while(len > 0) {
+				auto l = std::min(len, static_cast<uint32_t>(sizeof(tmp)));
+				if(image_.get_page(adr) != nullptr) {
+					image_.write(adr, tmp, l);
+				}
+				adr += l;
+				len -= l;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ブランク検査
+			@param[in]	adr	アドレス
+			@param[in]	len	長さ
+			@return ブランクなら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool is_blank(uint32_t adr, uint32_t len) const
+		{
+			uint8_t tmp[utils::sparse_image::PAGE_SIZE];
+			while(len > 0) {
+				auto l = std::min(len, static_cast<uint32_t>(sizeof(tmp)));
+				read(adr, tmp, l);
+				for(uint32_t i = 0; i < l; ++i) {
+					if(tmp[i] != 0xff) return false;
+				}
+				adr += l;
+				len -= l;
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ＣＲＣ（CRC-32）の計算
+			@param[in]	org	開始アドレス
+			@param[in]	end	終了アドレス
+			@return CRC 値
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t crc(uint32_t org, uint32_t end) const
+		{
+			static const struct table_t {
+				uint32_t	t[256];
+				table_t() {
+					for(uint32_t i = 0; i < 256; ++i) {
+						uint32_t c = i;
+						for(int j = 0; j < 8; ++j) {
+							c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+						}
+						t[i] = c;
+					}
+				}
+			} table;
+
+			uint32_t c = 0xffffffff;
+			uint8_t tmp[utils::sparse_image::PAGE_SIZE];
+			uint64_t a = org;
+			while(a <= end) {
+				auto l = static_cast<uint32_t>(std::min(static_cast<uint64_t>(sizeof(tmp)), end - a + 1));
+				read(a, tmp, l);
+				for(uint32_t i = 0; i < l; ++i) {
+					c = table.t[(c ^ tmp[i]) & 0xff] ^ (c >> 8);
+				}
+				a += l;
+			}
+			return c ^ 0xffffffff;
+		}
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	セッション統計
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct stat_t {
+		uint32_t	write_;
+		uint32_t	read_;
+		uint32_t	erase_;
+		uint32_t	crc_;
+		uint32_t	stray_;		///< 応答待ちでない時に受けた、不正なフレーム
+		std::chrono::steady_clock::time_point	org_;
+		std::chrono::steady_clock::time_point	end_;
+
+		stat_t() : write_(0), read_(0), erase_(0), crc_(0), stray_(0), org_(), end_() { }
+
+		void start() {
+			*this = stat_t();
+			org_ = std::chrono::steady_clock::now();
+			end_ = org_;
+		}
+
+		void mark() { end_ = std::chrono::steady_clock::now(); }
+
+		void list(const std::string& proto, uint32_t latency) const {
+			double t = std::chrono::duration<double>(end_ - org_).count();
+			auto pages = write_ + read_;
+			std::cout << boost::format("%s: latency %d us, write %d, read %d, erase %d, crc %d pages")
+				% proto % latency % write_ % read_ % erase_ % crc_;
+			if(t > 0.0) {
+				std::cout << boost::format(", %.3f sec, %.1f pages/sec") % t % (pages / t);
+			}
+			if(stray_ > 0) {
+				std::cout << boost::format(", stray %d frames") % stray_;
+			}
+			std::cout << std::endl;
+		}
+	};
+}
@@ -0,0 +1,224 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	疎なメモリー・イメージ・クラス @n
+			ページ（２５６バイト）境界に揃えた連続領域（エクステント）を、@n
+			アドレス順に保持する。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	疎なメモリー・イメージ・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class sparse_image {
+	public:
+		static const uint32_t PAGE_SIZE = 256;
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	書き込まれた領域（min_ から max_ まで）
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct area_t {
+			uint32_t	min_;
+			uint32_t	max_;
+			area_t(uint32_t min = 0xffffffff, uint32_t max = 0) : min_(min), max_(max) { }
+		};
+		typedef std::vector<area_t> areas;
+
+	private:
+		struct extent_t {
+			uint32_t				org_;
+			std::vector<uint8_t>	data_;
+			extent_t(uint32_t org = 0) : org_(org), data_() { }
+			uint64_t end() const { return static_cast<uint64_t>(org_) + data_.size(); }
+		};
+		typedef std::vector<extent_t> extents;
+
+		extents		extents_;
+		areas		areas_;
+		uint32_t	last_;		///< 最後に書き込んだエクステント（連続書き込みの高速化）
+
+		static uint64_t page_end_(uint64_t adr) {
+			return (adr + PAGE_SIZE - 1) & ~static_cast<uint64_t>(PAGE_SIZE - 1);
+		}
+
+
+		// [org, end) のページを含むエクステントを用意して、その位置を返す
+		uint32_t make_extent_(uint32_t org, uint64_t end)
+		{
+			// 直前のエクステントへの追加（S レコードの読み込みは殆どがこれ）
+			if(last_ < extents_.size()) {
+				auto& e = extents_[last_];
+				if(e.org_ <= org && org <= e.end()) {
+					bool next_ok = (last_ + 1) >= extents_.size() || end < extents_[last_ + 1].org_;
+					if(next_ok) {
+						if(e.end() < end) {
+							e.data_.resize(end - e.org_, 0xff);
+						}
+						return last_;
+					}
+				}
+			}
+
+			// 重なる、又は、隣接するエクステントを一つにまとめる
+			auto it = std::lower_bound(extents_.begin(), extents_.end(), org,
+				[](const extent_t& e, uint32_t a) { return e.end() < a; });
+			auto ed = it;
+			while(ed != extents_.end() && ed->org_ <= end) {
+				++ed;
+			}
+			if(it == ed) {
+				it = extents_.emplace(it, org);
+				it->data_.resize(end - org, 0xff);
+			} else {
+				uint32_t o = std::min(org, it->org_);
+				uint64_t e = std::max(end, (ed - 1)->end());
+				extent_t t(o);
+				t.data_.resize(e - o, 0xff);
+				for(auto i = it; i != ed; ++i) {
+					std::memcpy(&t.data_[i->org_ - o], i->data_.data(), i->data_.size());
+				}
+				it = extents_.erase(it, ed);
+				it = extents_.insert(it, std::move(t));
+			}
+			last_ = it - extents_.begin();
+			return last_;
+		}
+
+
+		void add_area_(uint32_t min, uint32_t max)
+		{
+			if(!areas_.empty() && areas_.back().max_ < min) {
+				if((areas_.back().max_ + 1) == min) {
+					areas_.back().max_ = max;
+				} else {
+					areas_.emplace_back(min, max);
+				}
+				return;
+			}
+
+			auto it = std::lower_bound(areas_.begin(), areas_.end(), min,
+				[](const area_t& a, uint32_t v) { return static_cast<uint64_t>(a.max_) + 1 < v; });
+			auto ed = it;
+			while(ed != areas_.end() && ed->min_ <= (static_cast<uint64_t>(max) + 1)) {
+				min = std::min(min, ed->min_);
+				max = std::max(max, ed->max_);
+				++ed;
+			}
+			it = areas_.erase(it, ed);
+			areas_.emplace(it, min, max);
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		sparse_image() : extents_(), areas_(), last_(0) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	クリア
+		*/
+		//-----------------------------------------------------------------//
+		void clear()
+		{
+			extents_.clear();
+			areas_.clear();
+			last_ = 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	空か検査
+			@return 空なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool empty() const { return extents_.empty(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	書き込み
+			@param[in]	address	アドレス
+			@param[in]	src		データ
+			@param[in]	len		長さ
+		*/
+		//-----------------------------------------------------------------//
+		void write(uint32_t address, const uint8_t* src, uint32_t len)
+		{
+			if(len == 0) return;
+
+			uint64_t tail = static_cast<uint64_t>(address) + len;
+			if(tail > 0x100000000ULL) {  // アドレス空間の終わりで切り詰める
+				len = 0x100000000ULL - address;
+				tail = 0x100000000ULL;
+			}
+			auto org = address & ~(PAGE_SIZE - 1);
+			auto n = make_extent_(org, page_end_(tail));
+			auto& e = extents_[n];
+			std::memcpy(&e.data_[address - e.org_], src, len);
+			add_area_(address, address + len - 1);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ページの取得
+			@param[in]	address	アドレス（ページ境界に丸める）
+			@return ページの先頭（無効なページなら「nullptr」）
+		*/
+		//-----------------------------------------------------------------//
+		const uint8_t* get_page(uint32_t address) const
+		{
+			address &= ~(PAGE_SIZE - 1);
+			auto it = std::upper_bound(extents_.begin(), extents_.end(), address,
+				[](uint32_t a, const extent_t& e) { return a < e.org_; });
+			if(it == extents_.begin()) return nullptr;
+			--it;
+			if(it->end() <= address) return nullptr;
+			return &it->data_[address - it->org_];
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	有効なページ数を取得
+			@return ページ数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_page_num() const
+		{
+			uint32_t n = 0;
+			for(const auto& e : extents_) {
+				n += e.data_.size() / PAGE_SIZE;
+			}
+			return n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	書き込まれた領域を取得（アドレス順、連続した領域はまとめられる）
+			@return 領域
+		*/
+		//-----------------------------------------------------------------//
+		const areas& get_areas() const { return areas_; }
+	};
+}
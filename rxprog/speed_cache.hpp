@@ -0,0 +1,207 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	シリアル速度のキャッシュ @n
+			ポートとデバイス毎に、自動選択で確認した速度を保存する @n
+			１行に「ポート デバイス 速度 ok/ng 転送速度(bytes/sec) 記録時刻(time_t)」 @n
+			失敗（ng）は NG_EXPIRE 秒で期限切れになり、再び試される
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2020 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "string_utils.hpp"
+#include "file_io.hpp"
+#include <mutex>
+#include <ctime>
+#include <cstdlib>
+#include <boost/format.hpp>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	シリアル速度キャッシュ・クラス（ギャング接続の為、スレッド・セーフ）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class speed_cache {
+	public:
+		static const int64_t NG_EXPIRE = 24 * 60 * 60;	///< 失敗を記録しておく時間（秒）
+
+	private:
+		struct entry_t {
+			std::string	port_;
+			std::string	device_;
+			uint32_t	speed_;
+			bool		ok_;
+			uint32_t	rate_;
+			int64_t		time_;
+			entry_t() : port_(), device_(), speed_(0), ok_(false), rate_(0), time_(0) { }
+		};
+		typedef std::vector<entry_t> entries;
+
+		entries				entries_;
+		bool				modify_;
+		mutable std::mutex	mutex_;
+
+		entries::iterator find_(const std::string& port, const std::string& device, uint32_t speed) {
+			for(auto it = entries_.begin(); it != entries_.end(); ++it) {
+				if(it->port_ == port && it->device_ == device && it->speed_ == speed) return it;
+			}
+			return entries_.end();
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		speed_cache() : entries_(), modify_(false), mutex_() { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	読み込み
+			@param[in]	file	ファイル名
+			@return 読めたら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool load(const std::string& file)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			utils::file_io fio;
+			if(!fio.open(file, "rb")) {
+				return false;
+			}
+			entries_.clear();
+			while(!fio.eof()) {
+				auto line = fio.get_line();
+				if(line.empty() || line[0] == '#') continue;
+				auto ss = utils::split_text(line, " \t");
+				// 時刻の無い古い形式は、記録時刻を 0（ng は期限切れ）とする
+				if(ss.size() != 5 && ss.size() != 6) continue;
+				entry_t t;
+				t.port_ = ss[0];
+				t.device_ = ss[1];
+				int32_t val;
+				if(!utils::string_to_int(ss[2], val)) continue;
+				t.speed_ = val;
+				t.ok_ = ss[3] == "ok";
+				if(!utils::string_to_int(ss[4], val)) continue;
+				t.rate_ = val;
+				if(ss.size() == 6) {
+					t.time_ = std::strtoll(ss[5].c_str(), nullptr, 10);
+				}
+				entries_.push_back(t);
+			}
+			fio.close();
+			modify_ = false;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	書き出し（変更が無ければ何もしない）
+			@param[in]	file	ファイル名
+			@return 書けたら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool save(const std::string& file)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if(!modify_) return true;
+
+			utils::file_io fio;
+			if(!fio.open(file, "wb")) {
+				return false;
+			}
+			fio.put_line("# rx_prog serial speed cache: port device speed ok/ng bytes/sec time");
+			for(const auto& t : entries_) {
+				fio.put_line((boost::format("%s %s %d %s %d %d")
+					% t.port_ % t.device_ % t.speed_ % (t.ok_ ? "ok" : "ng") % t.rate_ % t.time_).str());
+			}
+			fio.close();
+			modify_ = false;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	確認済みの速度を取得（複数ある場合は、最も速い速度）
+			@param[in]	port	ポート
+			@param[in]	device	デバイス
+			@param[out]	speed	速度
+			@return 確認済みの速度があれば「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool get_ok(const std::string& port, const std::string& device, uint32_t& speed) const
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			bool ret = false;
+			for(const auto& t : entries_) {
+				if(t.port_ == port && t.device_ == device && t.ok_) {
+					if(!ret || t.speed_ > speed) speed = t.speed_;
+					ret = true;
+				}
+			}
+			return ret;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	失敗した速度か検査（期限切れの失敗は含まない）
+			@param[in]	port	ポート
+			@param[in]	device	デバイス
+			@param[in]	speed	速度
+			@param[in]	now		現在時刻
+			@return 失敗した速度なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool is_ng(const std::string& port, const std::string& device, uint32_t speed,
+			int64_t now = std::time(nullptr)) const
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			for(const auto& t : entries_) {
+				if(t.port_ == port && t.device_ == device && t.speed_ == speed) {
+					return !t.ok_ && (now - t.time_) < NG_EXPIRE;
+				}
+			}
+			return false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	結果を記録（他の速度の記録は変えない）
+			@param[in]	port	ポート
+			@param[in]	device	デバイス
+			@param[in]	speed	速度
+			@param[in]	ok		成功なら「true」
+			@param[in]	rate	転送速度（bytes/sec）
+			@param[in]	now		現在時刻
+		*/
+		//-----------------------------------------------------------------//
+		void set(const std::string& port, const std::string& device, uint32_t speed, bool ok,
+			uint32_t rate = 0, int64_t now = std::time(nullptr))
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			auto it = find_(port, device, speed);
+			if(it == entries_.end()) {
+				entries_.emplace_back();
+				it = entries_.end() - 1;
+				it->port_ = port;
+				it->device_ = device;
+				it->speed_ = speed;
+			}
+			it->ok_ = ok;
+			it->rate_ = rate;
+			it->time_ = now;
+			modify_ = true;
+		}
+	};
+}
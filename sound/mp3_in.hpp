@@ -375,19 +375,31 @@ namespace sound {
 				mad_synth_frame(&mad_synth_, &mad_frame_);
 
 				// 1152 sample / frame
-				for(uint32_t i = 0; i < mad_synth_.pcm.length; ++i) {
-					while((out.at_fifo().size() - out.at_fifo().length()) < 64) {
-						system_delay(1);
-					}
-					typename SOUND_OUT::WAVE t;
-					if(MAD_NCHANNELS(&mad_frame_.header) == 1) {
-						t.l_ch = t.r_ch = MadFixedToSshort(mad_synth_.pcm.samples[0][i]);
-					} else {
-						t.l_ch = MadFixedToSshort(mad_synth_.pcm.samples[0][i]);
-						t.r_ch = MadFixedToSshort(mad_synth_.pcm.samples[1][i]);
+				{
+					// FIFO の連続領域に直接書き込む
+					auto& fifo = out.at_fifo();
+					uint32_t i = 0;
+					while(i < mad_synth_.pcm.length) {
+						auto sp = fifo.write_span();
+						if(sp.len == 0) {
+							system_delay(1);
+							continue;
+						}
+						uint32_t n = mad_synth_.pcm.length - i;
+						if(sp.len < n) n = sp.len;
+						for(uint32_t j = 0; j < n; ++j) {
+							auto& t = sp.ptr[j];
+							if(MAD_NCHANNELS(&mad_frame_.header) == 1) {
+								t.l_ch = t.r_ch = MadFixedToSshort(mad_synth_.pcm.samples[0][i + j]);
+							} else {
+								t.l_ch = MadFixedToSshort(mad_synth_.pcm.samples[0][i + j]);
+								t.r_ch = MadFixedToSshort(mad_synth_.pcm.samples[1][i + j]);
+							}
+						}
+						fifo.put_go(n);
+						i += n;
+						pos += n;
 					}
-					out.at_fifo().put(t);
-					++pos;
 				}
 
 				{
@@ -8,7 +8,7 @@
 				https://github.com/hirakuni45/RX/blob/master/LICENSE
 */
 //=====================================================================//
-#include "common/fixed_fifo.hpp"
+#include "common/spsc_fifo.hpp"
 
 namespace sound {
 
@@ -47,7 +47,7 @@ namespace sound {
 	/*!
 		@brief	サウンド出力クラス
 		@param[in]	T		基本型
-		@param[in]	BFS		fifo バッファのサイズ
+		@param[in]	BFS		fifo バッファのサイズ（２のべき乗）
 		@param[in]	OUTS	出力バッファのサイズ（外部ハードウェアの仕様による）
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
@@ -56,7 +56,7 @@ namespace sound {
 	public:
 		typedef T value_type;
 		typedef wave_t<T> WAVE;
-		typedef utils::fixed_fifo<WAVE, BFS> FIFO;
+		typedef utils::spsc_fifo<WAVE, BFS> FIFO;
 
 		static constexpr uint16_t PEAK_LEVEL_FRAME = 400;	///< 400 sample (48KHz : 0.5sec)
 
@@ -94,6 +94,15 @@ namespace sound {
 			}
 		}
 
+		void put_wave_(const WAVE& t) noexcept
+		{
+			wave_[w_put_] = t;
+			wave_[w_put_].offset(zero_ofs_);
+			++w_put_;
+			w_put_ &= (OUTS - 1);
+			peak_level_service_(t);
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -205,24 +214,25 @@ namespace sound {
 		//-----------------------------------------------------------------//
 		void service(uint32_t num) noexcept
 		{
-			volatile auto len = fifo_.length();
 			if(inp_rate_ == out_rate_) {
-				for(uint32_t i = 0; i < num; ++i) {
-					WAVE t;
-					if(len > 0) {
-						t = fifo_.get();
-						--len;
-					} else {
-						t.set(0);
+				// 連続領域単位で取り出す（足りない分は無音）
+				uint32_t i = 0;
+				while(i < num) {
+					auto sp = fifo_.read_span();
+					uint32_t n = num - i;
+					if(sp.len < n) n = sp.len;
+					if(n == 0) {
+						WAVE t(0);
+						for(; i < num; ++i) put_wave_(t);
+						break;
 					}
-					wave_[w_put_] = t;
-					wave_[w_put_].offset(zero_ofs_);
-					++w_put_;
-					w_put_ &= (OUTS - 1);
-					peak_level_service_(t);
+					for(uint32_t j = 0; j < n; ++j) put_wave_(sp.ptr[j]);
+					fifo_.get_go(n);
+					i += n;
 				}
 				sample_count_ += num;
 			} else {
+				volatile auto len = fifo_.length();
 				uint32_t i = 0;
 				WAVE next(0);
 				while(i < num) {
@@ -329,47 +329,52 @@ namespace sound {
 //					status = false;
 					break;
 				}
-				if(bits_ == 16) {
-					const uint16_t* src = reinterpret_cast<const uint16_t*>(tmp);
-					for(uint32_t i = 0; i < 256; ++i) {
-						while((out.at_fifo().size() - out.at_fifo().length()) < 64) {
-							system_delay(1);
-						}
-						typename SOUND_OUT::WAVE t;
-						if(get_channel() == 2) {
-							t.l_ch = src[0];
-							t.r_ch = src[1];
-							src += 2;
-						} else {
-							t.l_ch = src[0];
-							t.r_ch = t.l_ch;
-							++src;
-						}
-						out.at_fifo().put(t);
-						++pos;
+				// FIFO の連続領域に直接書き込む
+				auto& fifo = out.at_fifo();
+				uint32_t i = 0;
+				while(i < 256) {
+					auto sp = fifo.write_span();
+					if(sp.len == 0) {
+						system_delay(1);
+						continue;
 					}
-				} else {  // 8 bits
-					const uint8_t* src = reinterpret_cast<const uint8_t*>(tmp);
-					for(uint32_t i = 0; i < 256; ++i) {
-						while((out.at_fifo().size() - out.at_fifo().length()) < 64) {
-							system_delay(1);
+					uint32_t n = 256 - i;
+					if(sp.len < n) n = sp.len;
+					if(bits_ == 16) {
+						const uint16_t* src = reinterpret_cast<const uint16_t*>(tmp) + i * get_channel();
+						for(uint32_t j = 0; j < n; ++j) {
+							auto& t = sp.ptr[j];
+							if(get_channel() == 2) {
+								t.l_ch = src[0];
+								t.r_ch = src[1];
+								src += 2;
+							} else {
+								t.l_ch = src[0];
+								t.r_ch = t.l_ch;
+								++src;
+							}
 						}
-						typename SOUND_OUT::WAVE t;
-						if(get_channel() == 2) {
-							t.l_ch = static_cast<uint16_t>(src[0] ^ 0x80) << 8;
-							t.l_ch |= (src[0] & 0x7f) << 1;
-							t.r_ch = static_cast<uint16_t>(src[1] ^ 0x80) << 8;
-							t.r_ch |= (src[1] & 0x7f) << 1;
-							src += 2;
-						} else {
-							t.l_ch = static_cast<uint16_t>(src[0] ^ 0x80) << 8;
-							t.l_ch |= (src[0] & 0x7f) << 1;
-							t.r_ch = t.l_ch;
-							++src;
+					} else {  // 8 bits
+						const uint8_t* src = reinterpret_cast<const uint8_t*>(tmp) + i * get_channel();
+						for(uint32_t j = 0; j < n; ++j) {
+							auto& t = sp.ptr[j];
+							if(get_channel() == 2) {
+								t.l_ch = static_cast<uint16_t>(src[0] ^ 0x80) << 8;
+								t.l_ch |= (src[0] & 0x7f) << 1;
+								t.r_ch = static_cast<uint16_t>(src[1] ^ 0x80) << 8;
+								t.r_ch |= (src[1] & 0x7f) << 1;
+								src += 2;
+							} else {
+								t.l_ch = static_cast<uint16_t>(src[0] ^ 0x80) << 8;
+								t.l_ch |= (src[0] & 0x7f) << 1;
+								t.r_ch = t.l_ch;
+								++src;
+							}
 						}
-						out.at_fifo().put(t);
-						++pos;
 					}
+					fifo.put_go(n);
+					i += n;
+					pos += n;
 				}
 
 				{
@@ -0,0 +1,41 @@
+//=====================================================================//
+/*!	@file
+	@brief	common/ テンプレートの、ホスト用ユニット・テスト、ベンチマーク @n
+			host_test                  全テストを実行 @n
+			host_test --bench          全ベンチマークを実行 @n
+			host_test --filter=fifo    「group.name」に「fifo」を含むものだけ @n
+			host_test --min-time=0.5   ベンチマーク１項目の計測時間（秒）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include <cstdlib>
+
+int main(int argc, char* argv[])
+{
+	bool bench = false;
+	const char* filter = nullptr;
+	double min_time = 0.2;
+	for(int i = 1; i < argc; ++i) {
+		const char* p = argv[i];
+		if(std::strcmp(p, "--bench") == 0) {
+			bench = true;
+		} else if(std::strncmp(p, "--filter=", 9) == 0) {
+			filter = p + 9;
+		} else if(std::strncmp(p, "--min-time=", 11) == 0) {
+			min_time = std::atof(p + 11);
+		} else {
+			std::printf("Usage: %s [--bench] [--filter=group.name] [--min-time=sec]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if(bench) {
+		utest::run_benches(filter, min_time);
+		return 0;
+	}
+	return utest::run_tests(filter) == 0 ? 0 : 1;
+}
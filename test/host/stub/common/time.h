@@ -0,0 +1,27 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	common/time.h のホスト用スタブ @n
+			・RX 用の common/time.h は、struct tm、mktime などを独自に定義して @n
+			　glibc の <time.h> と衝突するので、ホストではこちらを使う @n
+			・get_wday、get_mon だけを追加する（実体は stub.cpp）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	const char* get_wday(uint8_t idx);
+
+	const char* get_mon(uint8_t idx);
+
+#ifdef __cplusplus
+}
+#endif
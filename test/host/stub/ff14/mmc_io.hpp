@@ -0,0 +1,12 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ff14/mmc_io.hpp のホスト用置き換え @n
+			・string_utils.hpp が FAT_FS で読む、ff.h の型と関数宣言だけ
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "ff14/source/ff.h"
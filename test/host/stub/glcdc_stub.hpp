@@ -0,0 +1,67 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	glcdc_mgr のホスト用置き換え @n
+			・graphics::render が使う、サイズ、フレームバッファ、flip だけ @n
+			・ダブルバッファの切り替えは、glcdc_mgr と同じ（flip で描画先が入れ替わる）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+
+namespace stub {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  GLCDC の置き換え（RGB565）
+		@param[in]	XSIZE	横幅
+		@param[in]	YSIZE	高さ
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <int16_t XSIZE, int16_t YSIZE>
+	class glcdc {
+	public:
+		static constexpr int16_t width  = XSIZE;
+		static constexpr int16_t height = YSIZE;
+		static constexpr int16_t line_width = XSIZE;
+
+	private:
+		uint16_t	fb_[2][XSIZE * YSIZE];
+		uint32_t	flip_count_;
+		bool		enable_double_;
+
+	public:
+		glcdc() noexcept : fb_{ }, flip_count_(0), enable_double_(false) { }
+
+		void* get_fbp() noexcept
+		{
+			if(!enable_double_) return fb_[0];
+			return (flip_count_ & 1) != 0 ? fb_[0] : fb_[1];
+		}
+
+		// 表示中のバッファ
+		const uint16_t* get_disp() const noexcept
+		{
+			if(!enable_double_) return fb_[0];
+			return (flip_count_ & 1) != 0 ? fb_[1] : fb_[0];
+		}
+
+		bool enable_double_buffer(bool ena = true) noexcept
+		{
+			enable_double_ = ena;
+			return true;
+		}
+
+		bool is_double_buffer() const noexcept { return enable_double_; }
+
+		void sync_vpos() const noexcept { }
+
+		void flip() noexcept { ++flip_count_; }
+
+		uint32_t get_flip_count() const noexcept { return flip_count_; }
+	};
+}
@@ -0,0 +1,69 @@
+//=====================================================================//
+/*!	@file
+	@brief	ホスト用、デバイス層のスタブ @n
+			・SCI 入出力（sci_putch、sci_puts、sci_getch、sci_length） @n
+			　出力は stub::sci_out() に貯め、入力は stub::sci_in() から取り出す @n
+			・common/time.c の get_wday、get_mon
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "stub.hpp"
+
+namespace stub {
+
+	std::string& sci_out() { static std::string s; return s; }
+
+	std::string& sci_in() { static std::string s; return s; }
+}
+
+extern "C" {
+
+	void sci_putch(char ch)
+	{
+		stub::sci_out() += ch;
+	}
+
+
+	void sci_puts(const char* str)
+	{
+		stub::sci_out() += str;
+	}
+
+
+	char sci_getch(void)
+	{
+		auto& s = stub::sci_in();
+		if(s.empty()) return 0;
+		char ch = s[0];
+		s.erase(0, 1);
+		return ch;
+	}
+
+
+	uint16_t sci_length(void)
+	{
+		return stub::sci_in().size();
+	}
+
+
+	static const char* wday_[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+	static const char* mon_[] = {
+		"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+	};
+
+	const char* get_wday(uint8_t idx)
+	{
+		if(idx >= 7) return "---";
+		return wday_[idx];
+	}
+
+
+	const char* get_mon(uint8_t idx)
+	{
+		if(idx >= 12) return "---";
+		return mon_[idx];
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ホスト用、デバイス層のスタブ（ヘッダー）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <string>
+
+extern "C" {
+	void sci_putch(char ch);
+	void sci_puts(const char* str);
+	char sci_getch(void);
+	uint16_t sci_length(void);
+}
+
+namespace stub {
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  sci_putch、sci_puts の出力先
+		@return 出力文字列の参照
+	*/
+	//-----------------------------------------------------------------//
+	std::string& sci_out();
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  sci_getch の入力元
+		@return 入力文字列の参照
+	*/
+	//-----------------------------------------------------------------//
+	std::string& sci_in();
+}
@@ -0,0 +1,146 @@
+//=====================================================================//
+/*!	@file
+	@brief	basic_arith のテスト @n
+			・NVAL は double のラッパー、シンボルは「X」「Y」、関数は「sqrt」「neg」
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include <cstdlib>
+#include "common/basic_arith.hpp"
+
+namespace {
+
+	struct nval {
+		double	v;
+		nval(double x = 0.0) : v(x) { }
+		void assign(const char* s) { v = std::strtod(s, nullptr); }
+		void pow(const nval& n) { v = std::pow(v, n.v); }
+		nval operator - () const { return nval(-v); }
+		nval& operator += (const nval& n) { v += n.v; return *this; }
+		nval& operator -= (const nval& n) { v -= n.v; return *this; }
+		nval& operator *= (const nval& n) { v *= n.v; return *this; }
+		nval& operator /= (const nval& n) { v /= n.v; return *this; }
+		bool operator == (int n) const { return v == static_cast<double>(n); }
+	};
+
+	struct symbol {
+		enum class NAME : uint8_t { NONE, X = 0x80, Y };
+		double	x = 3.0;
+		double	y = -0.5;
+
+		const char* get_code(const char* text, NAME& name) const
+		{
+			if(*text == 'X') { name = NAME::X; return text + 1; }
+			if(*text == 'Y') { name = NAME::Y; return text + 1; }
+			name = NAME::NONE;
+			return text;
+		}
+
+		bool operator() (NAME name, nval& out)
+		{
+			if(name == NAME::X) { out = x; return true; }
+			if(name == NAME::Y) { out = y; return true; }
+			return false;
+		}
+	};
+
+	struct func {
+		enum class NAME : uint8_t { NONE, SQRT = 0xc0, NEG };
+
+		const char* get_code(const char* text, NAME& name) const
+		{
+			if(std::strncmp(text, "sqrt", 4) == 0) { name = NAME::SQRT; return text + 4; }
+			if(std::strncmp(text, "neg", 3) == 0) { name = NAME::NEG; return text + 3; }
+			name = NAME::NONE;
+			return text;
+		}
+
+		bool operator() (NAME name, const nval& in, nval& out)
+		{
+			if(name == NAME::SQRT) {
+				if(in.v < 0.0) return false;
+				out = std::sqrt(in.v);
+				return true;
+			} else if(name == NAME::NEG) {
+				out = -in.v;
+				return true;
+			}
+			return false;
+		}
+	};
+
+	typedef utils::basic_arith<nval, symbol, func> ARITH;
+
+	symbol	symbol_;
+	func	func_;
+
+	bool calc_(const char* text, double& ans)
+	{
+		ARITH arith(symbol_, func_);
+		if(!arith.analize(text)) return false;
+		ans = arith().v;
+		return true;
+	}
+}
+
+UTEST(basic_arith, operators)
+{
+	double a = 0.0;
+	UTEST_TRUE(calc_("1+2*3", a));
+	UTEST_NEAR(a, 7.0, 1e-12);
+	UTEST_TRUE(calc_("(1+2)*3", a));
+	UTEST_NEAR(a, 9.0, 1e-12);
+	UTEST_TRUE(calc_("10-4-3", a));
+	UTEST_NEAR(a, 3.0, 1e-12);
+	UTEST_TRUE(calc_("8/4/2", a));
+	UTEST_NEAR(a, 1.0, 1e-12);
+	UTEST_TRUE(calc_("2^10", a));
+	UTEST_NEAR(a, 1024.0, 1e-12);
+	UTEST_TRUE(calc_("-2*-3", a));
+	UTEST_NEAR(a, 6.0, 1e-12);
+	UTEST_TRUE(calc_("1.5e3+0.25", a));
+	UTEST_NEAR(a, 1500.25, 1e-12);
+}
+
+UTEST(basic_arith, symbol_func)
+{
+	double a = 0.0;
+	UTEST_TRUE(calc_("X*2", a));
+	UTEST_NEAR(a, 6.0, 1e-12);
+	UTEST_TRUE(calc_("-Y", a));
+	UTEST_NEAR(a, 0.5, 1e-12);
+	UTEST_TRUE(calc_("sqrt(16)+neg(X)", a));
+	UTEST_NEAR(a, 1.0, 1e-12);
+	UTEST_TRUE(calc_("sqrt((X+1)*4)", a));
+	UTEST_NEAR(a, 4.0, 1e-12);
+}
+
+UTEST(basic_arith, error)
+{
+	ARITH arith(symbol_, func_);
+	UTEST_FALSE(arith.analize("1/0"));
+	UTEST_TRUE(arith.get_error().get(ARITH::error::zero_divide));
+	UTEST_FALSE(arith.analize("(1+2"));
+	UTEST_FALSE(arith.analize("1+Z"));
+	UTEST_TRUE(arith.get_error().get(ARITH::error::symbol_fatal));
+	UTEST_FALSE(arith.analize("sqrt(-1)"));
+	UTEST_TRUE(arith.get_error().get(ARITH::error::func_fatal));
+	UTEST_FALSE(arith.analize(""));
+	UTEST_FALSE(arith.analize("((((((((((1))))))))))"));
+	UTEST_TRUE(arith.get_error().get(ARITH::error::nest_fatal));
+}
+
+UBENCH(basic_arith, analize)
+{
+	ARITH arith(symbol_, func_);
+	while(state.keep_running()) {
+		arith.analize("(1.25+X)*sqrt(16)-2^3/Y");
+		auto v = arith().v;
+		utest::do_not_optimize(v);
+	}
+	state.set_items_processed(state.iterations());
+}
@@ -0,0 +1,282 @@
+//=====================================================================//
+/*!	@file
+	@brief	command、command_map のテスト @n
+			・乱数の行（空白、バックスラッシュを含む）を service() で入力し、@n
+			　get_words、get_word、cmp_word を str:: の関数と比べる @n
+			　（無いワードの get_word、cmp_word の違いは、ドキュメントの通り）@n
+			・行末のバックスラッシュ（str:: が終端の先を読んでいた）@n
+			・command_map の整列、unique()、find()、find_word（エスケープされた単語）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "stub.hpp"
+#include "common/command.hpp"
+#include <random>
+#include <vector>
+#include <algorithm>
+
+namespace {
+
+	// 行を入力して、確定させる
+	template <class CMD>
+	bool enter_(CMD& cmd, const std::string& line)
+	{
+		stub::sci_in() = line + '\r';
+		bool ok = cmd.service();
+		stub::sci_out().clear();
+		return ok;
+	}
+
+
+	// 行末が単語の外（最後のエスケープされていない文字が空白、又は、無い）
+	// 連続したバックスラッシュは、一つと同じ（その次の文字をエスケープする）
+	bool tail_space_(const std::string& line)
+	{
+		char bc = ' ';
+		for(uint32_t i = 0; i < line.size(); ++i) {
+			if(line[i] == '\\') {  // 次の文字は単語の区切りにならない
+				while((i + 1) < line.size() && line[i + 1] == '\\') ++i;
+				++i;
+			} else {
+				bc = line[i];
+			}
+		}
+		return bc == ' ';
+	}
+
+
+	struct fuzz_t {
+		uint32_t	ng = 0;
+		uint32_t	doc = 0;	///< ドキュメントにある違い
+	};
+
+
+	template <class CMD>
+	void compare_(const CMD& cmd, const char* line, std::mt19937& rnd, fuzz_t& fz)
+	{
+		auto words = utils::str::get_words(line);
+		if(cmd.get_words() != words) {
+			++fz.ng;
+			return;
+		}
+		for(uint32_t argc = 0; argc <= (words + 1); ++argc) {
+			char a[64];
+			char b[64];
+			uint32_t len = (rnd() & 1) ? sizeof(a) : (1 + rnd() % 6);  // 切り詰めも比べる
+			std::memset(a, '#', sizeof(a));
+			std::memset(b, '#', sizeof(b));
+			bool ra = cmd.get_word(argc, a, len);
+			bool rb = utils::str::get_word(line, argc, b, len);
+			if(ra != rb || std::strcmp(a, b) != 0) {
+				if(!ra && rb && b[0] == 0 && a[0] == 0 && argc == words && tail_space_(line)) {
+					++fz.doc;
+				} else {
+					++fz.ng;
+				}
+			}
+
+			// 単語そのもの、前後が違うキー、空のキー
+			char key[64];
+			utils::str::get_word(line, argc, key, sizeof(key));
+			std::string k = key;
+			const std::string keys[] = { k, k + "x", k.empty() ? "x" : k.substr(0, k.size() - 1), "" };
+			for(const auto& s : keys) {
+				bool ca = cmd.cmp_word(argc, s.c_str());
+				bool cb = utils::str::cmp_word(line, argc, s.c_str());
+				if(ca != cb) {
+					if(!ca && cb && s.empty() && argc >= words) {
+						++fz.doc;
+					} else {
+						++fz.ng;
+					}
+				}
+			}
+		}
+	}
+
+
+	template <uint16_t WORDN>
+	fuzz_t fuzz_(uint32_t seed, uint32_t loop)
+	{
+		static const char chars[] = "ab  \\\\ x";
+		utils::command<64, WORDN> cmd;
+		std::mt19937 rnd(seed);
+		fuzz_t fz;
+		for(uint32_t n = 0; n < loop; ++n) {
+			std::string line;
+			uint32_t len = rnd() % 40;
+			for(uint32_t i = 0; i < len; ++i) line += chars[rnd() % (sizeof(chars) - 1)];
+			if(!enter_(cmd, line)) {
+				++fz.ng;
+				continue;
+			}
+			if(line != cmd.get_command()) {
+				++fz.ng;
+				continue;
+			}
+			compare_(cmd, line.c_str(), rnd, fz);
+		}
+		return fz;
+	}
+
+
+	enum class CMD_ID { LS, PWD, CD, DIR, A_B, FREE, WRITE, WR };
+
+	static constexpr auto map_ = utils::make_command_map<CMD_ID>({
+		{ "pwd", CMD_ID::PWD }, { "ls", CMD_ID::LS }, { "write", CMD_ID::WRITE },
+		{ "cd", CMD_ID::CD }, { "dir", CMD_ID::DIR }, { "a b", CMD_ID::A_B },
+		{ "free", CMD_ID::FREE }, { "wr", CMD_ID::WR } });
+	static_assert(map_.unique(), "command name duplicated");
+	static_assert(map_.size() == 8, "command map size");
+
+	static constexpr auto dup_ = utils::make_command_map<CMD_ID>({
+		{ "ls", CMD_ID::LS }, { "cd", CMD_ID::CD }, { "ls", CMD_ID::DIR } });
+	static_assert(!dup_.unique(), "duplicated name is not found");
+}
+
+UTEST(command, fuzz_str)
+{
+	// 300k 行（記録する単語数を越える単語も比べる）
+	auto a = fuzz_<16>(1, 150000);
+	auto b = fuzz_<3>(2, 150000);
+	UTEST_EQ(a.ng, 0u);
+	UTEST_EQ(b.ng, 0u);
+	UTEST_TRUE(a.doc > 0);
+}
+
+UTEST(command, trailing_space)
+{
+	// ドキュメントにある違い：行末の空白の後の単語は、str:: では空の単語
+	utils::command<64> cmd;
+	UTEST_TRUE(enter_(cmd, "ls -l "));
+	UTEST_EQ(cmd.get_words(), 2u);
+	char a[16];
+	char b[16];
+	UTEST_FALSE(cmd.get_word(2, a, sizeof(a)));
+	UTEST_STR(a, "");
+	UTEST_TRUE(utils::str::get_word(cmd.get_command(), 2, b, sizeof(b)));
+	UTEST_STR(b, "");
+	UTEST_FALSE(cmd.cmp_word(2, ""));
+	UTEST_TRUE(utils::str::cmp_word(cmd.get_command(), 2, ""));
+	UTEST_FALSE(cmd.cmp_word(3, ""));
+	UTEST_TRUE(utils::str::cmp_word(cmd.get_command(), 3, ""));
+
+	// エスケープされた空白は、単語の一部
+	UTEST_TRUE(enter_(cmd, "ls a\\ "));
+	UTEST_EQ(cmd.get_words(), 2u);
+	UTEST_TRUE(cmd.get_word(1, a, sizeof(a)));
+	UTEST_STR(a, "a ");
+	UTEST_FALSE(cmd.get_word(2, a, sizeof(a)));
+	UTEST_FALSE(utils::str::get_word(cmd.get_command(), 2, b, sizeof(b)));
+
+	// 行末のバックスラッシュ（エスケープする文字が無い）は、単語に含めない
+	UTEST_TRUE(enter_(cmd, "ls ab\\"));
+	UTEST_EQ(cmd.get_words(), 2u);
+	UTEST_TRUE(cmd.get_word(1, a, sizeof(a)));
+	UTEST_STR(a, "ab");
+	UTEST_TRUE(utils::str::get_word(cmd.get_command(), 1, b, sizeof(b)));
+	UTEST_STR(b, "ab");
+	UTEST_TRUE(cmd.cmp_word(1, "ab"));
+	UTEST_TRUE(utils::str::cmp_word(cmd.get_command(), 1, "ab"));
+	UTEST_TRUE(enter_(cmd, "ls ab\\\\\\"));
+	UTEST_TRUE(cmd.cmp_word(1, "ab"));
+	UTEST_TRUE(utils::str::cmp_word(cmd.get_command(), 1, "ab"));
+	UTEST_TRUE(enter_(cmd, "ls \\"));
+	UTEST_EQ(cmd.get_words(), 1u);
+	UTEST_EQ(utils::str::get_words(cmd.get_command()), 1u);
+}
+
+UTEST(command_map, sort_unique)
+{
+	for(uint32_t i = 1; i < map_.size(); ++i) {
+		UTEST_TRUE(std::strcmp(map_[i - 1].key, map_[i].key) < 0);
+	}
+	UTEST_STR(map_[0].key, "a b");
+	UTEST_STR(map_[7].key, "write");
+	UTEST_TRUE(map_.unique());
+	UTEST_FALSE(dup_.unique());
+}
+
+UTEST(command_map, find)
+{
+	CMD_ID id = CMD_ID::LS;
+	for(uint32_t i = 0; i < map_.size(); ++i) {
+		UTEST_TRUE(map_.find(map_[i].key, id));
+		UTEST_TRUE(id == map_[i].id);
+	}
+	static const char* none[] = { "", "l", "lss", "a", "a b ", "w", "wri", "writes", "zz", "A b" };
+	for(auto s : none) {
+		UTEST_FALSE(map_.find(s, id));
+	}
+	// NUL 終端されていない単語
+	UTEST_TRUE(map_.find("wrong", 2, id));
+	UTEST_TRUE(id == CMD_ID::WR);
+	UTEST_TRUE(map_.find("write", 5, id));
+	UTEST_TRUE(id == CMD_ID::WRITE);
+	UTEST_FALSE(map_.find("write", 4, id));
+	// バックスラッシュは除いて比べる
+	UTEST_TRUE(map_.find("l\\s", 3, id));
+	UTEST_TRUE(id == CMD_ID::LS);
+	UTEST_TRUE(map_.find("a\\ b", 4, id));
+	UTEST_TRUE(id == CMD_ID::A_B);
+}
+
+UTEST(command_map, find_word)
+{
+	utils::command<64, 4> cmd;
+	UTEST_TRUE(enter_(cmd, "  l\\s  a\\ b pw\\d\\ x  dir"));
+	UTEST_EQ(cmd.get_words(), 4u);
+	CMD_ID id = CMD_ID::LS;
+	UTEST_TRUE(cmd.find_word(0, map_, id));
+	UTEST_TRUE(id == CMD_ID::LS);
+	UTEST_TRUE(cmd.find_word(1, map_, id));
+	UTEST_TRUE(id == CMD_ID::A_B);
+	UTEST_FALSE(cmd.find_word(2, map_, id));  // "pwd x"
+	UTEST_TRUE(cmd.find_word(3, map_, id));
+	UTEST_TRUE(id == CMD_ID::DIR);
+	UTEST_FALSE(cmd.find_word(4, map_, id));
+
+	// 位置を記録していない単語（WORDN 以降）は、行から探す
+	UTEST_TRUE(enter_(cmd, "x x x x free w\\r"));
+	UTEST_EQ(cmd.get_words(), 6u);
+	UTEST_TRUE(cmd.find_word(4, map_, id));
+	UTEST_TRUE(id == CMD_ID::FREE);
+	UTEST_TRUE(cmd.find_word(5, map_, id));
+	UTEST_TRUE(id == CMD_ID::WR);
+	UTEST_FALSE(cmd.find_word(6, map_, id));
+}
+
+UTEST(command_map, random_keys)
+{
+	// 実行時に作った表を、線形探索と比べる
+	static const uint32_t N = 37;
+	std::mt19937 rnd(7);
+	std::vector<std::string> names;
+	while(names.size() < N) {
+		std::string s;
+		uint32_t len = 1 + rnd() % 5;
+		for(uint32_t i = 0; i < len; ++i) s += 'a' + rnd() % 4;
+		if(std::find(names.begin(), names.end(), s) == names.end()) names.push_back(s);
+	}
+	utils::command_key<uint32_t> keys[N];
+	for(uint32_t i = 0; i < N; ++i) keys[i] = { names[i].c_str(), i };
+	auto map = utils::make_command_map<uint32_t>(keys);
+	UTEST_TRUE(map.unique());
+
+	uint32_t ng = 0;
+	for(uint32_t n = 0; n < 20000; ++n) {
+		std::string s;
+		uint32_t len = rnd() % 6;
+		for(uint32_t i = 0; i < len; ++i) s += 'a' + rnd() % 4;
+		auto it = std::find(names.begin(), names.end(), s);
+		uint32_t id = N;
+		bool ok = map.find(s.c_str(), id);
+		if(ok != (it != names.end())) ++ng;
+		else if(ok && id != static_cast<uint32_t>(it - names.begin())) ++ng;
+	}
+	UTEST_EQ(ng, 0u);
+}
@@ -0,0 +1,180 @@
+//=====================================================================//
+/*!	@file
+	@brief	dirty_rect、render の更新領域（部分転送の flip）のテスト
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "common/format.hpp"
+#include "glcdc_stub.hpp"
+#include "graphics/graphics.hpp"
+
+namespace {
+
+	static constexpr int16_t W = 200;
+	static constexpr int16_t H = 120;
+	typedef stub::glcdc<W, H> GLC;
+	typedef graphics::render<GLC> RENDER;
+
+	graphics::afont_null afont_;
+	graphics::kfont_null kfont_;
+	graphics::font_null font_(afont_, kfont_);
+
+	uint32_t rand_ = 31;
+
+	uint32_t rand32_()
+	{
+		rand_ ^= rand_ << 13;
+		rand_ ^= rand_ >> 17;
+		rand_ ^= rand_ << 5;
+		return rand_;
+	}
+
+	int16_t rand_range_(int32_t min, int32_t max)
+	{
+		return min + static_cast<int32_t>(rand32_() % static_cast<uint32_t>(max - min));
+	}
+
+	void draw_random_(RENDER& rdr)
+	{
+		rdr.set_fore_color(graphics::share_color(rand32_() & 255, rand32_() & 255, rand32_() & 255));
+		vtx::spos p(rand_range_(-20, W), rand_range_(-20, H));
+		switch(rand32_() % 6) {
+		case 0:
+			rdr.fill_box(vtx::srect(p, vtx::spos(rand_range_(1, 60), rand_range_(1, 40))));
+			break;
+		case 1:
+			rdr.line(p, vtx::spos(rand_range_(-20, W + 20), rand_range_(-20, H + 20)));
+			break;
+		case 2:
+			rdr.fill_circle_aa(p, rand_range_(1, 30));
+			break;
+		case 3:
+			rdr.triangle_d(vtx::spos(p.x * 16, p.y * 16),
+				vtx::spos(rand_range_(-20, W) * 16, rand_range_(-20, H) * 16),
+				vtx::spos(rand_range_(-20, W) * 16, rand_range_(-20, H) * 16));
+			break;
+		case 4:
+			rdr.plot(p, rand32_());
+			break;
+		case 5:
+			rdr.line_aa(p, vtx::spos(rand_range_(-20, W + 20), rand_range_(-20, H + 20)));
+			break;
+		}
+	}
+}
+
+UTEST(dirty_rect, merge)
+{
+	graphics::dirty_rect<4> d;
+	d.add(0, 0, 10, 10);
+	d.add(5, 5, 15, 15);  // 重なるので統合
+	UTEST_EQ(d.size(), 1u);
+	UTEST_EQ(d.get_area(), 15u * 15u);
+	UTEST_EQ(d.get_pixels(), 200u);
+	d.add(2, 2, 4, 4);  // 含まれる
+	UTEST_EQ(d.size(), 1u);
+	d.add(100, 0, 110, 10);
+	d.add(0, 100, 10, 110);
+	d.add(100, 100, 110, 110);
+	UTEST_EQ(d.size(), 4u);
+	d.add(50, 50, 51, 51);  // 一杯なので、どれかと統合
+	UTEST_EQ(d.size(), 4u);
+	// 矩形は重ならない
+	for(uint32_t i = 0; i < d.size(); ++i) {
+		for(uint32_t j = i + 1; j < d.size(); ++j) {
+			UTEST_FALSE(d.get(i).is_overlap(d.get(j)));
+		}
+	}
+	d.clear();
+	UTEST_TRUE(d.empty());
+	UTEST_EQ(d.get_pixels(), 0u);
+}
+
+UTEST(render, dirty_flip_keeps_buffers_equal)
+{
+	// 描画の間に sync_frame を何度呼んでも、flip の後の描画バッファは、表示中と同じ
+	static GLC glc;
+	glc.enable_double_buffer();
+	RENDER rdr(glc, font_);
+	rdr.enable_dirty();
+	static uint16_t prev[W * H];
+	uint32_t ng_cover = 0;
+	uint32_t ng_copy = 0;
+	for(uint32_t f = 0; f < 2000; ++f) {
+		auto n = rand32_() % 4;
+		for(uint32_t i = 0; i <= n; ++i) {
+			rdr.sync_frame(false);
+			std::memcpy(prev, glc.get_fbp(), sizeof(prev));
+			if((rand32_() & 3) == 0) {
+				int16_t x = rand_range_(0, W / 2);
+				int16_t y = rand_range_(0, H / 2);
+				rdr.set_clip(vtx::srect(x, y, rand_range_(1, W - x), rand_range_(1, H - y)));
+			} else {
+				rdr.set_clip(vtx::srect(0, 0, W, H));
+			}
+			draw_random_(rdr);
+			// 変化した画素は、全て更新領域に含まれる
+			auto fb = static_cast<const uint16_t*>(glc.get_fbp());
+			const auto& d = rdr.get_dirty();
+			for(int16_t y = 0; y < H; ++y) {
+				for(int16_t x = 0; x < W; ++x) {
+					if(fb[y * W + x] == prev[y * W + x]) continue;
+					bool in = false;
+					for(uint32_t j = 0; j < d.size(); ++j) {
+						if(d.get(j).is_focus(vtx::spos(x, y))) { in = true; break; }
+					}
+					if(!in) ++ng_cover;
+				}
+			}
+		}
+		rdr.flip();
+		if(std::memcmp(glc.get_fbp(), glc.get_disp(), sizeof(uint16_t) * W * H) != 0) ++ng_copy;
+		UTEST_TRUE(rdr.get_dirty().empty());
+	}
+	UTEST_EQ(ng_cover, 0u);
+	UTEST_EQ(ng_copy, 0u);
+}
+
+UTEST(render, dirty_frame_stats)
+{
+	static GLC glc;
+	glc.enable_double_buffer();
+	RENDER rdr(glc, font_);
+	rdr.enable_dirty();
+	rdr.flip();  // 最初は全画面を転送
+	UTEST_EQ(rdr.get_copy_pixels(), static_cast<uint32_t>(W * H));
+	// sync_frame -> 描画 -> flip の順でも、集計は残る
+	rdr.sync_frame(false);
+	rdr.fill_box(vtx::srect(10, 10, 20, 5));
+	rdr.sync_frame(false);
+	rdr.fill_box(vtx::srect(10, 10, 20, 5));
+	rdr.flip();
+	UTEST_EQ(rdr.get_frame_pixels(), 200u);
+	UTEST_EQ(rdr.get_frame_area(), 100u);
+	UTEST_EQ(rdr.get_copy_pixels(), 100u);
+
+	// シングルバッファでは、sync_frame で集計してクリア
+	static GLC sgl;
+	RENDER srd(sgl, font_);
+	srd.enable_dirty();
+	srd.fill_box(vtx::srect(0, 0, 4, 4));
+	srd.sync_frame(false);
+	UTEST_EQ(srd.get_frame_pixels(), 16u);
+	UTEST_TRUE(srd.get_dirty().empty());
+}
+
+UBENCH(dirty_rect, add_random)
+{
+	graphics::dirty_rect<16> d;
+	while(state.keep_running()) {
+		int16_t x = rand32_() % 460;
+		int16_t y = rand32_() % 260;
+		d.add(x, y, x + 1 + (rand32_() & 15), y + 1 + (rand32_() & 15));
+		if(d.get_pixels() > 100000) d.clear();
+	}
+	state.set_items_processed(state.iterations());
+}
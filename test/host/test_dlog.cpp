@@ -0,0 +1,298 @@
+//=====================================================================//
+/*!	@file
+	@brief	dlog（遅延バイナリ・ログ）のテスト @n
+			・dlog_format で積んだレコードを、dlogdec の解析クラス（dlog_dec）で @n
+			　文字列に戻し、同じ引数の sformat と比べる @n
+			・文字列の STR_MAX、レコードの RECORD_MAX での切り詰め @n
+			・リング・バッファの折り返し、溢れ、同期外れからの復帰
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "rxprog/dlogdec/dlog_dec.hpp"
+#include <random>
+
+namespace {
+
+	uint32_t tick_ = 0;
+
+	struct tick_t {
+		uint32_t operator() () const noexcept { return tick_++; }
+	};
+
+	typedef utils::dlog_buffer<256, tick_t> DLOG;
+	typedef utils::dlog_format<DLOG> DFORM;
+
+
+	// 書式文字列の ID は、ホストのアドレスの下位３２ビット
+	struct forms {
+		std::vector<const char*>	list;
+
+		bool operator() (uint32_t id, std::string& form) const {
+			for(auto f : list) {
+				if(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(f)) == id) {
+					form = f;
+					return true;
+				}
+			}
+			return false;
+		}
+	};
+
+
+	struct sink {
+		std::vector<std::string>	text;
+		std::vector<uint32_t>		tick;
+
+		utils::dlog_dec::out_func func() {
+			return [this](uint32_t t, const std::string& s) {
+				tick.push_back(t);
+				text.push_back(s);
+			};
+		}
+	};
+
+
+	// バッファの全てを、chunk バイト毎に解析クラスに渡す
+	void drain_(DLOG& log, utils::dlog_dec& dec, sink& out, uint32_t chunk)
+	{
+		uint8_t tmp[256];
+		uint32_t n;
+		while((n = log.read(tmp, chunk)) > 0) {
+			dec.put(tmp, n, false, out.func());
+		}
+		dec.put(tmp, 0, true, out.func());
+	}
+
+
+	// 解析クラスが渡す型で、sformat に通す
+	template <typename... ARGS>
+	std::string ref_(const char* form, ARGS... args)
+	{
+		char tmp[1024] = { };
+		(utils::sformat(form, tmp, sizeof(tmp)) % ... % args);
+		return tmp;
+	}
+
+
+	uint32_t ptr_(const void* p)
+	{
+		return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(p));
+	}
+}
+
+UTEST(dlog, args)
+{
+	static const char* f_int = "int: %d, %5d, %-4d|, %+d\n";
+	static const char* f_uint = "uint: %u %o %b %08X %c\n";
+	static const char* f_float = "float: %f %.2f %e %g %7.3f\n";
+	static const char* f_ptr = "ptr: %p %p\n";
+	static const char* f_str = "str: %s [%8s] [%-5s] %s\n";
+	static const char* f_mix = "%s=%d (%5.1f%%) @%p %x\n";
+	forms fs;
+	fs.list = { f_int, f_uint, f_float, f_ptr, f_str, f_mix };
+
+	DLOG log;
+	tick_ = 100;
+	int x = 0;
+	char name[] = "char*";
+	DFORM(log, f_int) % -12 % 345 % static_cast<int8_t>(-3) % static_cast<int16_t>(7);
+	DFORM(log, f_uint) % 4000000000u % static_cast<uint16_t>(8) % static_cast<uint8_t>(5) % 0xDEADu % 'A';
+	DFORM(log, f_float) % 1.5f % -3.25f % 1e-3f % 123.0 % 2.5;
+	DFORM(log, f_ptr) % &x % static_cast<const int*>(nullptr);
+	DFORM(log, f_str) % "abc" % std::string("de") % name % "";
+	DFORM(log, f_mix) % "v" % -1 % 99.5f % &x % true;
+	UTEST_EQ(log.get_lost(), 0u);
+
+	std::vector<std::string> ref;
+	ref.push_back(ref_(f_int, -12, 345, -3, 7));
+	ref.push_back(ref_(f_uint, 4000000000u, 8u, 5u, 0xDEADu, 'A'));
+	ref.push_back(ref_(f_float, 1.5f, -3.25f, 1e-3f, 123.0, 2.5));
+	ref.push_back(ref_("ptr: %08x %08x\n", ptr_(&x), 0u));
+	ref.push_back(ref_(f_str, "abc", "de", "char*", ""));
+	ref.push_back(ref_("%s=%d (%5.1f%%) @%08x %x\n", "v", -1, 99.5f, ptr_(&x), 1u));
+
+	utils::dlog_dec dec(fs);
+	sink out;
+	drain_(log, dec, out, 256);
+	UTEST_EQ(out.text.size(), ref.size());
+	for(uint32_t i = 0; i < ref.size() && i < out.text.size(); ++i) {
+		UTEST_STR(out.text[i].c_str(), ref[i].c_str());
+		UTEST_EQ(out.tick[i], 100 + i);
+	}
+	UTEST_EQ(dec.get_stat().record, 6u);
+	UTEST_EQ(dec.get_stat().skip, 0u);
+
+	// 書式の無い ID
+	fs.list.clear();
+	utils::dlog_dec dec2(fs);
+	DFORM(log, f_int) % 1;
+	sink out2;
+	drain_(log, dec2, out2, 256);
+	UTEST_EQ(out2.text.size(), 1u);
+	UTEST_EQ(dec2.get_stat().unknown, 1u);
+}
+
+UTEST(dlog, truncate)
+{
+	static const char* f_s = "[%s]\n";
+	static const char* f_d = "%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n";
+	static const char* f_ds = "%d,%d,%d,%d,%d,%d,%d,%d,%d:%s:%d\n";
+	forms fs;
+	fs.list = { f_s, f_d, f_ds };
+
+	DLOG log;
+	std::vector<std::string> ref;
+	// 文字列は STR_MAX まで
+	static const char* s30 = "abcdefghijklmnopqrstuvwxyz0123";
+	static const char* s24 = "abcdefghijklmnopqrstuvwx";
+	{
+		DFORM f(log, f_s);
+		f % s30;
+		UTEST_TRUE(f.status());
+	}
+	ref.push_back(ref_(f_s, s24));
+	DFORM(log, f_s) % s24;
+	ref.push_back(ref_(f_s, s24));
+	DFORM(log, f_s) % std::string(s30);
+	ref.push_back(ref_(f_s, s24));
+
+	// レコードは RECORD_MAX まで（整数は１０個）、溢れた引数は捨てる
+	{
+		DFORM f(log, f_d);
+		for(int i = 0; i < 12; ++i) f % (i * 11);
+		UTEST_EQ(static_cast<int>(f.get_error()), static_cast<int>(utils::base_format::error::over));
+	}
+	ref.push_back(ref_(f_d, 0, 11, 22, 33, 44, 55, 66, 77, 88, 99));
+
+	// 入らない文字列の後は、入る引数も積まない
+	{
+		DFORM f(log, f_ds);
+		for(int i = 0; i < 9; ++i) f % i;
+		f % "0123456789" % 5;
+		UTEST_FALSE(f.status());
+	}
+	ref.push_back(ref_(f_ds, 0, 1, 2, 3, 4, 5, 6, 7, 8));
+
+	// 無効な文字列も、それまでの引数で出力する
+	{
+		DFORM f(log, f_ds);
+		f % 1 % static_cast<const char*>(nullptr);
+		UTEST_EQ(static_cast<int>(f.get_error()), static_cast<int>(utils::base_format::error::null));
+	}
+	ref.push_back(ref_(f_ds, 1));
+
+	utils::dlog_dec dec(fs);
+	sink out;
+	drain_(log, dec, out, 256);
+	UTEST_EQ(out.text.size(), ref.size());
+	for(uint32_t i = 0; i < ref.size() && i < out.text.size(); ++i) {
+		UTEST_STR(out.text[i].c_str(), ref[i].c_str());
+	}
+	UTEST_EQ(dec.get_stat().skip, 0u);
+}
+
+UTEST(dlog, ring_wrap)
+{
+	// 小さなバッファに、ばらばらの長さで書き込み、ばらばらの長さで読み出す
+	static const char* f_a = "a:%d %u\n";
+	static const char* f_b = "b:%s|%5.2f\n";
+	static const char* f_c = "c:%p %s %d %d %d %d %d\n";
+	forms fs;
+	fs.list = { f_a, f_b, f_c };
+
+	typedef utils::dlog_buffer<128, tick_t> SMALL;
+	SMALL log;
+	utils::dlog_dec dec(fs);
+	sink out;
+	std::vector<std::string> ref;
+	std::vector<uint32_t> ticks;
+	std::mt19937 rnd(321);
+	static const char str[] = "0123456789ABCDEFGHIJKLMNOPQRSTUV";
+	static const int ptr[8] = { };  // char* は文字列として積むので、int* を使う
+	tick_ = 0;
+	uint32_t bytes = 0;
+	for(uint32_t n = 0; n < 3000; ++n) {
+		auto lost = log.get_lost();
+		auto t = tick_;
+		int32_t iv = rnd();
+		uint32_t uv = rnd();
+		std::string s(str, rnd() % 32);
+		std::string s24 = s.substr(0, utils::dlog_base::STR_MAX);
+		float fv = static_cast<int32_t>(rnd() % 20000 - 10000) / 16.0f;
+		std::string r;
+		switch(n % 3) {
+		case 0:
+			utils::dlog_format<SMALL>(log, f_a) % iv % uv;
+			r = ref_(f_a, iv, uv);
+			break;
+		case 1:
+			utils::dlog_format<SMALL>(log, f_b) % s % fv;
+			r = ref_(f_b, s24.c_str(), fv);
+			break;
+		case 2:
+			utils::dlog_format<SMALL>(log, f_c) % &ptr[n & 7] % s.substr(0, 8) % 1 % 2 % 3 % 4 % iv;
+			r = ref_("c:%08x %s %d %d %d %d %d\n", ptr_(&ptr[n & 7]), s.substr(0, 8).c_str(), 1, 2, 3, 4, iv);
+			break;
+		}
+		if(log.get_lost() == lost) {
+			ref.push_back(r);
+			ticks.push_back(t);
+		}
+		uint8_t tmp[64];
+		auto len = log.read(tmp, rnd() % 48);
+		bytes += len;
+		dec.put(tmp, len, false, out.func());
+	}
+	uint8_t tmp[128];
+	auto len = log.read(tmp, sizeof(tmp));
+	bytes += len;
+	dec.put(tmp, len, true, out.func());
+
+	UTEST_TRUE(bytes > 128 * 100);  // 何度も折り返す
+	UTEST_TRUE(log.get_lost() > 0);  // 溢れたレコードは、丸ごと捨てる
+	UTEST_EQ(out.text.size(), ref.size());
+	uint32_t ng = 0;
+	for(uint32_t i = 0; i < ref.size() && i < out.text.size(); ++i) {
+		if(out.text[i] != ref[i] || out.tick[i] != ticks[i]) ++ng;
+	}
+	UTEST_EQ(ng, 0u);
+	UTEST_EQ(dec.get_stat().record, ref.size());
+	UTEST_EQ(dec.get_stat().skip, 0u);
+}
+
+UTEST(dlog, resync)
+{
+	static const char* f_a = "a:%d\n";
+	forms fs;
+	fs.list = { f_a };
+
+	DLOG log;
+	for(int i = 0; i < 3; ++i) DFORM(log, f_a) % i;
+	uint8_t rec[256];
+	auto n = log.read(rec, sizeof(rec));
+	uint32_t len = n / 3;
+
+	// 先頭のゴミ（偽の SYNC を含む）、２番目のレコードの引数を壊す
+	std::vector<uint8_t> stream = { 0x00, utils::dlog_base::SYNC, 0x08, 0x12, utils::dlog_base::SYNC };
+	stream.insert(stream.end(), rec, rec + n);
+	stream[5 + len + 12] ^= 0x40;
+
+	utils::dlog_dec dec(fs);
+	sink out;
+	for(auto b : stream) {
+		dec.put(&b, 1, false, out.func());
+	}
+	dec.put(nullptr, 0, true, out.func());
+	UTEST_EQ(out.text.size(), 2u);
+	if(out.text.size() == 2) {
+		UTEST_STR(out.text[0].c_str(), "a:0\n");
+		UTEST_STR(out.text[1].c_str(), "a:2\n");
+	}
+	// 偽の SYNC と、壊したレコード
+	UTEST_TRUE(dec.get_stat().sum_error >= 2);
+	UTEST_TRUE(dec.get_stat().skip >= 5 + len);
+}
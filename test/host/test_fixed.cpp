@@ -0,0 +1,175 @@
+//=====================================================================//
+/*!	@file
+	@brief	fixed_fifo、fixed_stack、fixed_string のテスト
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "common/fixed_fifo.hpp"
+#include "common/fixed_stack.hpp"
+#include "common/fixed_string.hpp"
+
+UTEST(fixed_fifo, put_get)
+{
+	utils::fixed_fifo<uint8_t, 8> f;
+	UTEST_EQ(f.size(), 8u);
+	UTEST_EQ(f.length(), 0u);
+	for(uint8_t i = 0; i < 7; ++i) {
+		f.put(i);
+	}
+	UTEST_EQ(f.length(), 7u);
+	for(uint8_t i = 0; i < 7; ++i) {
+		UTEST_EQ(f.get(), i);
+	}
+	UTEST_EQ(f.length(), 0u);
+}
+
+UTEST(fixed_fifo, wrap_around)
+{
+	utils::fixed_fifo<uint16_t, 5> f;
+	uint16_t put = 0;
+	uint16_t get = 0;
+	for(int n = 0; n < 100; ++n) {
+		for(int i = 0; i < (n % 4) + 1; ++i) f.put(put++);
+		UTEST_EQ(f.length(), static_cast<uint32_t>(put - get));
+		while(f.length() > 0) {
+			UTEST_EQ(f.get(), get);
+			++get;
+		}
+	}
+}
+
+UTEST(fixed_fifo, at_go)
+{
+	utils::fixed_fifo<int, 4> f;
+	f.put_at() = 10;
+	f.put_at(1) = 11;
+	f.put_go();
+	f.put_go();
+	UTEST_EQ(f.length(), 2u);
+	UTEST_EQ(f.get_at(), 10);
+	UTEST_EQ(f.get_at(1), 11);
+	f.get_go();
+	UTEST_EQ(f.get(), 11);
+	f.put(1);
+	f.clear();
+	UTEST_EQ(f.length(), 0u);
+}
+
+UBENCH(fixed_fifo, put_get_256)
+{
+	utils::fixed_fifo<uint8_t, 512> f;
+	while(state.keep_running()) {
+		for(uint32_t i = 0; i < 256; ++i) f.put(i);
+		uint32_t sum = 0;
+		for(uint32_t i = 0; i < 256; ++i) sum += f.get();
+		utest::do_not_optimize(sum);
+	}
+	state.set_bytes_processed(state.iterations() * 256);
+}
+
+
+UTEST(fixed_stack, push_pop)
+{
+	utils::fixed_stack<int, 3> s;
+	UTEST_TRUE(s.empty());
+	UTEST_EQ(s.capacity(), 3u);
+	UTEST_TRUE(s.push(1));
+	UTEST_TRUE(s.push(2));
+	UTEST_TRUE(s.push(3));
+	UTEST_FALSE(s.push(4));
+	UTEST_EQ(s.size(), 3u);
+	UTEST_EQ(s.top(), 1);
+	UTEST_EQ(s.pop(), 3);
+	UTEST_EQ(s.pop(), 2);
+	UTEST_EQ(s.pop(), 1);
+	UTEST_TRUE(s.empty());
+	UTEST_EQ(s.pop(), 0);  // 空の場合は初期値
+}
+
+UBENCH(fixed_stack, push_pop_64)
+{
+	utils::fixed_stack<uint32_t, 64> s;
+	while(state.keep_running()) {
+		for(uint32_t i = 0; i < 64; ++i) s.push(i);
+		uint32_t sum = 0;
+		while(!s.empty()) sum += s.pop();
+		utest::do_not_optimize(sum);
+	}
+	state.set_items_processed(state.iterations() * 64);
+}
+
+
+UTEST(fixed_string, assign_append)
+{
+	utils::fixed_string<8> s;
+	UTEST_TRUE(s.empty());
+	s = "abc";
+	UTEST_EQ(s.size(), 3u);
+	UTEST_STR(s.c_str(), "abc");
+	s += 'd';
+	s += "ef";
+	UTEST_STR(s.c_str(), "abcdef");
+	s += "ghijk";  // 容量で切れる
+	UTEST_EQ(s.size(), 8u);
+	UTEST_STR(s.c_str(), "abcdefgh");
+	s += 'x';
+	UTEST_EQ(s.size(), 8u);
+	s.pop_back();
+	UTEST_STR(s.c_str(), "abcdefg");
+	UTEST_EQ(s.back(), 'g');
+	UTEST_EQ(s[0], 'a');
+	UTEST_EQ(s[100], 0);
+	s.clear();
+	UTEST_TRUE(s.empty());
+	UTEST_STR(s.c_str(), "");
+}
+
+UTEST(fixed_string, compare)
+{
+	utils::fixed_string<16> a("apple");
+	utils::fixed_string<16> b("banana");
+	UTEST_TRUE(a < b);
+	UTEST_TRUE(b > a);
+	UTEST_TRUE(a != b);
+	UTEST_TRUE(a <= a);
+	b = a;
+	UTEST_TRUE(a == b);
+	utils::fixed_string<16> c("cherry");
+	c.swap(a);
+	UTEST_STR(a.c_str(), "cherry");
+	UTEST_STR(c.c_str(), "apple");
+	UTEST_EQ(a.size(), 6u);
+}
+
+UTEST(fixed_string, long_init)
+{
+	utils::fixed_string<4> s("0123456789");
+	UTEST_EQ(s.size(), 4u);
+	UTEST_STR(s.c_str(), "0123");
+}
+
+UBENCH(fixed_string, append_char_64)
+{
+	utils::fixed_string<64> s;
+	while(state.keep_running()) {
+		s.clear();
+		for(uint32_t i = 0; i < 64; ++i) s += static_cast<char>('a' + (i & 15));
+		utest::do_not_optimize(s);
+	}
+	state.set_bytes_processed(state.iterations() * 64);
+}
+
+UBENCH(fixed_string, append_str)
+{
+	utils::fixed_string<256> s;
+	while(state.keep_running()) {
+		s.clear();
+		for(uint32_t i = 0; i < 16; ++i) s += "0123456789abcdef";
+		utest::do_not_optimize(s);
+	}
+	state.set_bytes_processed(state.iterations() * 256);
+}
@@ -0,0 +1,150 @@
+//=====================================================================//
+/*!	@file
+	@brief	fixed_block のテスト @n
+			・乱数で alloc、erase、lock/unlock を繰り返し、参照モデル（bool の配列）と比べる @n
+			・size()、is_alloc()、is_lock()、next_alloc()、next_active() を、@n
+			　ワード境界（32 の倍数）をまたぐ全ての位置で調べる
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "common/fixed_block.hpp"
+#include <random>
+
+namespace {
+
+	// 参照モデル
+	template <uint32_t SIZE>
+	struct model {
+		bool		alloc[SIZE];
+		bool		lock[SIZE];
+		uint32_t	idx;
+
+		model() : alloc{ }, lock{ }, idx(0) { }
+
+		uint32_t size() const {
+			uint32_t n = 0;
+			for(uint32_t i = 0; i < SIZE; ++i) if(alloc[i]) ++n;
+			return n;
+		}
+
+		// 前回確保した位置の次から探し、無ければ先頭から
+		uint32_t get() {
+			uint32_t i = idx;
+			while(i < SIZE && alloc[i]) ++i;
+			if(i >= SIZE) {
+				i = 0;
+				while(i < SIZE && alloc[i]) ++i;
+				if(i >= SIZE) return SIZE;
+			}
+			alloc[i] = true;
+			lock[i] = true;
+			idx = i + 1;
+			if(idx >= SIZE) idx = 0;
+			return i;
+		}
+
+		uint32_t next(uint32_t org, bool active) const {
+			for(uint32_t i = org; i < SIZE; ++i) {
+				if(alloc[i] && (!active || !lock[i])) return i;
+			}
+			return SIZE;
+		}
+	};
+
+
+	template <uint32_t SIZE>
+	uint32_t run_(uint32_t seed, uint32_t loop)
+	{
+		utils::fixed_block<int, SIZE> blk;
+		model<SIZE> ref;
+		std::mt19937 rnd(seed);
+		uint32_t ng = 0;
+		for(uint32_t n = 0; n < loop; ++n) {
+			uint32_t idx = rnd() % (SIZE + 2);  // 範囲外も与える
+			switch(rnd() % 4) {
+			case 0:
+			case 1:
+				if(blk.alloc() != ref.get()) ++ng;
+				break;
+			case 2:
+				{
+					bool ok = idx < SIZE && ref.alloc[idx];
+					if(blk.erase(idx) != ok) ++ng;
+					if(ok) ref.alloc[idx] = false;
+				}
+				break;
+			case 3:
+				{
+					bool ok = idx < SIZE && ref.alloc[idx];
+					bool lk = (rnd() & 1) != 0;
+					if(blk.lock(idx, lk) != ok) ++ng;
+					if(ok) ref.lock[idx] = lk;
+				}
+				break;
+			}
+			if(blk.size() != ref.size()) ++ng;
+			if(blk.empty() != (ref.size() == 0)) ++ng;
+			for(uint32_t i = 0; i <= SIZE; ++i) {
+				if(blk.is_alloc(i) != (i < SIZE && ref.alloc[i])) ++ng;
+				if(blk.is_lock(i) != (i < SIZE && ref.alloc[i] && ref.lock[i])) ++ng;
+				if(blk.next_alloc(i) != ref.next(i, false)) ++ng;
+				if(blk.next_active(i) != ref.next(i, true)) ++ng;
+			}
+		}
+		return ng;
+	}
+
+
+	template <uint32_t SIZE>
+	bool full_()
+	{
+		utils::fixed_block<int, SIZE> blk;
+		for(uint32_t i = 0; i < SIZE; ++i) {
+			if(blk.alloc() != i) return false;
+		}
+		// 範囲外のビット（最後のワードの余り）を確保しない
+		return blk.alloc() == SIZE && blk.size() == SIZE;
+	}
+}
+
+UTEST(fixed_block, model)
+{
+	UTEST_EQ(run_<1>(1, 2000), 0u);
+	UTEST_EQ(run_<5>(2, 5000), 0u);
+	UTEST_EQ(run_<32>(3, 10000), 0u);
+	UTEST_EQ(run_<33>(4, 10000), 0u);
+	UTEST_EQ(run_<200>(5, 10000), 0u);
+}
+
+UTEST(fixed_block, full)
+{
+	UTEST_TRUE(full_<1>());
+	UTEST_TRUE(full_<5>());
+	UTEST_TRUE(full_<31>());
+	UTEST_TRUE(full_<32>());
+	UTEST_TRUE(full_<33>());
+	UTEST_TRUE(full_<200>());
+}
+
+UTEST(fixed_block, reuse_order)
+{
+	// 直前に解放した番号は、すぐには使わない
+	utils::fixed_block<int, 40> blk;
+	for(uint32_t i = 0; i < 35; ++i) blk.alloc();
+	UTEST_TRUE(blk.erase(3));
+	UTEST_EQ(blk.alloc(), 35u);
+	UTEST_TRUE(blk.erase(35));
+	for(uint32_t i = 36; i < 40; ++i) UTEST_EQ(blk.alloc(), i);
+	UTEST_EQ(blk.alloc(), 3u);
+	UTEST_EQ(blk.alloc(), 35u);
+	UTEST_EQ(blk.alloc(), 40u);
+	// 確保した直後はロックされ、next_active に現れない
+	UTEST_EQ(blk.next_active(0), 40u);
+	blk.unlock(33);
+	UTEST_EQ(blk.next_active(0), 33u);
+	UTEST_EQ(blk.next_alloc(34), 34u);
+}
@@ -0,0 +1,208 @@
+//=====================================================================//
+/*!	@file
+	@brief	fixed_pool、fixed_memory、fixed_arena のテスト @n
+			・ベンチマークはホストの malloc/free と比べる（RX の newlib の malloc は @n
+			　実機でしか計れないので、ここでは glibc と比べる）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "common/fixed_memory.hpp"
+#include <cstdlib>
+
+namespace {
+
+	uint32_t rand_ = 12345;
+
+	uint32_t rand32_()
+	{
+		rand_ ^= rand_ << 13;
+		rand_ ^= rand_ >> 17;
+		rand_ ^= rand_ << 5;
+		return rand_;
+	}
+
+	// 確保、解放をランダムに繰り返す時のサイズ（8 ～ 256 バイト）
+	uint32_t rand_size_() { return 8 + (rand32_() % 249); }
+}
+
+UTEST(fixed_pool, alloc_free)
+{
+	utils::fixed_pool<24, 4> p;
+	void* a[5];
+	for(uint32_t i = 0; i < 4; ++i) {
+		a[i] = p.alloc();
+		UTEST_TRUE(a[i] != nullptr);
+		UTEST_TRUE(p.owns(a[i]));
+		UTEST_EQ(reinterpret_cast<uintptr_t>(a[i]) & 7, 0u);
+	}
+	a[4] = p.alloc();
+	UTEST_TRUE(a[4] == nullptr);
+	UTEST_EQ(p.get_fail(), 1u);
+	UTEST_EQ(p.used(), 4u);
+	UTEST_TRUE(p.free(a[2]));
+	UTEST_TRUE(p.alloc() == a[2]);  // 解放したブロックから使う
+	uint64_t x[2];
+	UTEST_FALSE(p.free(x));
+	for(uint32_t i = 0; i < 4; ++i) p.free(a[i]);
+	UTEST_EQ(p.used(), 0u);
+	UTEST_EQ(p.peak(), 4u);
+}
+
+UTEST(fixed_memory, size_class)
+{
+	utils::fixed_memory<4096, 16> m;  // ページ 256 バイト
+	auto a = m.alloc(1);
+	auto b = m.alloc(9);
+	auto c = m.alloc(256);
+	UTEST_TRUE(a != nullptr && b != nullptr && c != nullptr);
+	UTEST_EQ(m.get_used(8), 1u);
+	UTEST_EQ(m.get_used(16), 1u);
+	UTEST_EQ(m.get_used(256), 1u);
+	UTEST_EQ(m.used(), 8u + 16u + 256u);
+	UTEST_EQ(m.get_page(), 3u);
+	UTEST_TRUE(m.alloc(257) == nullptr);
+	UTEST_TRUE(m.alloc(0) == nullptr);
+	UTEST_EQ(m.get_fail(), 2u);
+	UTEST_TRUE(m.free(b));
+	UTEST_TRUE(m.alloc(16) == b);
+	UTEST_TRUE(m.free(nullptr));
+	uint64_t x[2];
+	UTEST_FALSE(m.free(x));
+}
+
+UTEST(fixed_memory, exhaust)
+{
+	utils::fixed_memory<1024, 4> m;
+	uint32_t n = 0;
+	while(m.alloc(64) != nullptr) ++n;
+	UTEST_EQ(n, 16u);
+	UTEST_EQ(m.get_page(), 4u);
+	UTEST_TRUE(m.alloc(8) == nullptr);  // 空きページが無い
+	m.clear();
+	UTEST_EQ(m.used(), 0u);
+	UTEST_EQ(m.peak(), 1024u);
+	UTEST_TRUE(m.alloc(8) != nullptr);
+}
+
+UTEST(fixed_memory, random_no_overlap)
+{
+	// 確保した領域に印を書き、解放する時に壊れていないか調べる
+	static utils::fixed_memory<65536, 64> m;
+	m.clear();
+	struct ent_t { uint8_t* p; uint32_t len; uint8_t mark; };
+	ent_t ent[128] = { };
+	uint32_t ng = 0;
+	uint32_t fail = 0;
+	for(uint32_t i = 0; i < 200000; ++i) {
+		auto& e = ent[rand32_() % 128];
+		if(e.p != nullptr) {
+			for(uint32_t j = 0; j < e.len; ++j) {
+				if(e.p[j] != e.mark) { ++ng; break; }
+			}
+			m.free(e.p);
+			e.p = nullptr;
+		} else {
+			e.len = rand_size_();
+			e.p = static_cast<uint8_t*>(m.alloc(e.len));
+			if(e.p == nullptr) { ++fail; continue; }
+			e.mark = i;
+			std::memset(e.p, e.mark, e.len);
+		}
+	}
+	UTEST_EQ(ng, 0u);
+	UTEST_EQ(fail, 0u);  // 128 個 x 最大 256 バイトは、断片化しても収まる
+	for(auto& e : ent) m.free(e.p);
+	UTEST_EQ(m.used(), 0u);
+}
+
+UTEST(fixed_arena, mark_reset)
+{
+	utils::fixed_arena<64> a;
+	auto p0 = a.alloc(3, 1);
+	UTEST_TRUE(p0 != nullptr);
+	auto mk = a.mark();
+	auto p1 = a.alloc(8, 8);
+	UTEST_EQ(reinterpret_cast<uintptr_t>(p1) & 7, 0u);
+	UTEST_EQ(a.used(), 16u);
+	UTEST_TRUE(a.alloc(49) == nullptr);
+	UTEST_EQ(a.get_fail(), 1u);
+	a.reset(mk);
+	UTEST_EQ(a.used(), 3u);
+	UTEST_TRUE(a.alloc(60, 1) != nullptr);
+	UTEST_EQ(a.peak(), 63u);
+	a.reset();
+	UTEST_EQ(a.used(), 0u);
+}
+
+namespace {
+
+	template <class ALLOC, class FREE>
+	void random_mix_(utest::state& state, ALLOC al, FREE fr)
+	{
+		void* ent[128] = { };
+		rand_ = 12345;
+		while(state.keep_running()) {
+			auto& p = ent[rand32_() & 127];
+			if(p != nullptr) {
+				fr(p);
+				p = nullptr;
+			} else {
+				p = al(rand_size_());
+			}
+		}
+		for(auto p : ent) if(p != nullptr) fr(p);
+		state.set_items_processed(state.iterations());
+	}
+}
+
+UBENCH(fixed_memory, random_mix)
+{
+	static utils::fixed_memory<65536, 64> m;
+	m.clear();
+	random_mix_(state, [](uint32_t n) { return m.alloc(n); }, [](void* p) { m.free(p); });
+}
+
+UBENCH(malloc, random_mix)
+{
+	random_mix_(state, [](uint32_t n) { return std::malloc(n); }, [](void* p) { std::free(p); });
+}
+
+UBENCH(fixed_pool, alloc_free_64)
+{
+	static utils::fixed_pool<64, 256> pool;
+	void* t[64];
+	while(state.keep_running()) {
+		for(uint32_t i = 0; i < 64; ++i) t[i] = pool.alloc();
+		utest::do_not_optimize(t);
+		for(uint32_t i = 0; i < 64; ++i) pool.free(t[i]);
+	}
+	state.set_items_processed(state.iterations() * 64);
+}
+
+UBENCH(malloc, alloc_free_64)
+{
+	void* t[64];
+	while(state.keep_running()) {
+		for(uint32_t i = 0; i < 64; ++i) t[i] = std::malloc(64);
+		utest::do_not_optimize(t);
+		for(uint32_t i = 0; i < 64; ++i) std::free(t[i]);
+	}
+	state.set_items_processed(state.iterations() * 64);
+}
+
+UBENCH(fixed_arena, frame_64)
+{
+	static utils::fixed_arena<8192> a;
+	void* t[64];
+	while(state.keep_running()) {
+		auto mk = a.mark();
+		for(uint32_t i = 0; i < 64; ++i) t[i] = a.alloc(64);
+		utest::do_not_optimize(t);
+		a.reset(mk);
+	}
+	state.set_items_processed(state.iterations() * 64);
+}
@@ -0,0 +1,265 @@
+//=====================================================================//
+/*!	@file
+	@brief	format（sformat）のテスト @n
+			・glibc の snprintf と同じ文字列になるか比べる @n
+			・line_chaout の行単位の出力、memory_chaout の切り詰め
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "common/format.hpp"
+#include <vector>
+#include <string>
+
+namespace {
+
+	template <typename T>
+	bool same_(const char* form, T val)
+	{
+		char a[128];
+		char b[128];
+		(utils::sformat(form, a, sizeof(a)) % val).status();
+		std::snprintf(b, sizeof(b), form, val);
+		if(std::strcmp(a, b) == 0) return true;
+		std::printf("  \"%s\": \"%s\" vs printf \"%s\"\n", form, a, b);
+		return false;
+	}
+}
+
+UTEST(format, integer)
+{
+	static const int32_t vals[] = { 0, 1, -1, 9, 10, 99, 100, -100, 12345, -65536,
+		2147483647, -2147483647 };
+	static const char* forms[] = { "%d", "%5d", "%-5d|", "%05d", "%+d", "%x", "%X", "%08x", "%o" };
+	for(auto f : forms) {
+		for(auto v : vals) {
+			if(f[1] == 'x' || f[1] == 'X' || f[1] == 'o' || (f[1] == '0' && f[3] == 'x')) {
+				UTEST_TRUE(same_(f, static_cast<uint32_t>(v)));
+			} else {
+				UTEST_TRUE(same_(f, v));
+			}
+		}
+	}
+}
+
+UTEST(format, unsigned_max)
+{
+	UTEST_TRUE(same_("%u", 4294967295u));
+	UTEST_TRUE(same_("%x", 0xdeadbeefu));
+}
+
+UTEST(format, string_char)
+{
+	UTEST_TRUE(same_("%s", "hello"));
+	UTEST_TRUE(same_("[%10s]", "abc"));
+	UTEST_TRUE(same_("[%-10s]", "abc"));
+	UTEST_TRUE(same_("%c", 'A'));
+	char buf[32];
+	utils::sformat("%s-%d-%c", buf, sizeof(buf)) % "x" % 12 % 'z';
+	UTEST_STR(buf, "x-12-z");
+}
+
+UTEST(format, binary)
+{
+	char buf[40];
+	utils::sformat("%b", buf, sizeof(buf)) % static_cast<uint32_t>(10);
+	UTEST_STR(buf, "1010");
+	utils::sformat("%08b", buf, sizeof(buf)) % static_cast<uint32_t>(5);
+	UTEST_STR(buf, "00000101");
+}
+
+UTEST(format, float_fixed)
+{
+	static const float vals[] = { 0.0f, 1.0f, -1.5f, 3.14159f, 0.1f, 123456.789f, 1e-3f };
+	for(auto v : vals) {
+		UTEST_TRUE(same_("%f", v));
+		UTEST_TRUE(same_("%.3f", v));
+		UTEST_TRUE(same_("%10.2f", v));
+	}
+	UTEST_TRUE(same_("%f", 2.718281828459045));
+	UTEST_TRUE(same_("%.10f", 2.718281828459045));
+}
+
+UTEST(format, float_exp)
+{
+	static const double vals[] = { 1.0, -2.5e-10, 6.02214076e23, 1.0 / 3.0, 1e300 };
+	for(auto v : vals) {
+		UTEST_TRUE(same_("%e", v));
+		UTEST_TRUE(same_("%.3e", v));
+		UTEST_TRUE(same_("%g", v));
+	}
+}
+
+UTEST(format, error)
+{
+	char buf[16];
+	auto f = utils::sformat("%d", buf, sizeof(buf)) % "str";
+	UTEST_FALSE(f.status());
+	UTEST_EQ(static_cast<int>(f.get_error()), static_cast<int>(utils::base_format::error::unknown));
+
+	// バッファより長い出力は切り詰める
+	utils::sformat("%s", buf, sizeof(buf)) % "0123456789abcdefghij";
+	UTEST_EQ(std::strlen(buf), sizeof(buf) - 1);
+}
+
+UTEST(format, append)
+{
+	char buf[32];
+	utils::sformat("a=%d", buf, sizeof(buf)) % 1;
+	utils::sformat(", b=%d", buf, sizeof(buf), true) % 2;
+	UTEST_STR(buf, "a=1, b=2");
+}
+
+UTEST(format, instance_chaout)
+{
+	char a[32];
+	char b[32];
+	utils::memory_chaout ca(a, sizeof(a));
+	utils::memory_chaout cb(b, sizeof(b));
+	utils::sformat(ca, "%d") % 123;
+	utils::sformat(cb, "%s") % "xyz";
+	UTEST_STR(a, "123");
+	UTEST_STR(b, "xyz");
+}
+
+namespace {
+
+	// line_chaout から渡された行を貯めるターミネーター
+	struct lines_term {
+		std::vector<std::string>	lines;
+
+		void operator() (const char* s, uint16_t l) { lines.emplace_back(s, l); }
+	};
+}
+
+UTEST(format, line_chaout_newline)
+{
+	typedef utils::line_chaout<32, lines_term> LINE;
+	LINE out;
+	utils::basic_format<LINE>(out, "ab%d\ncd%s") % 1 % "ef";
+	// 改行までを１行として渡し、残りは溜めておく
+	UTEST_EQ(out.at_term().lines.size(), 1u);
+	UTEST_STR(out.at_term().lines[0].c_str(), "ab1\n");
+	out('\n');
+	UTEST_EQ(out.at_term().lines.size(), 2u);
+	UTEST_STR(out.at_term().lines[1].c_str(), "cdef\n");
+	UTEST_EQ(out.size(), 9u);
+}
+
+UTEST(format, line_chaout_full)
+{
+	// 改行が無くても、BFN 文字で渡す
+	typedef utils::line_chaout<8, lines_term> LINE;
+	LINE out;
+	utils::basic_format<LINE>(out, "%s") % "abcdefghijklmnopqrst";
+	UTEST_EQ(out.at_term().lines.size(), 2u);
+	UTEST_STR(out.at_term().lines[0].c_str(), "abcdefgh");
+	UTEST_STR(out.at_term().lines[1].c_str(), "ijklmnop");
+	out.write("uvwx\ny", 6);
+	UTEST_EQ(out.at_term().lines.size(), 4u);
+	UTEST_STR(out.at_term().lines[2].c_str(), "qrstuvwx");
+	UTEST_STR(out.at_term().lines[3].c_str(), "\n");
+	for(int i = 0; i < 7; ++i) out('z');
+	UTEST_EQ(out.at_term().lines.size(), 5u);
+	UTEST_STR(out.at_term().lines[4].c_str(), "yzzzzzzz");
+	out.flush();  // 空なら何もしない
+	UTEST_EQ(out.at_term().lines.size(), 5u);
+}
+
+UTEST(format, shared_chaout)
+{
+	// 二つの basic_format が、一つの出力ファンクタを共有し、交互に引数を受け取る
+	// （書式の位置は、それぞれのインスタンスが持つ）
+	typedef utils::line_chaout<64, lines_term> LINE;
+	LINE out;
+	utils::basic_format<LINE> a(out, "%d,%d ");
+	utils::basic_format<LINE> b(out, "%s/%s\n");
+	a % 1;
+	b % "p";
+	a % 2;
+	UTEST_EQ(out.at_term().lines.size(), 0u);
+	b % "q";
+	UTEST_EQ(out.at_term().lines.size(), 1u);
+	UTEST_STR(out.at_term().lines[0].c_str(), "1,p/2 q\n");
+	UTEST_EQ(a.size(), b.size());
+	UTEST_EQ(static_cast<int>(a.get_error()), static_cast<int>(utils::base_format::error::none));
+	UTEST_EQ(static_cast<int>(b.get_error()), static_cast<int>(utils::base_format::error::none));
+}
+
+UTEST(format, memory_chaout_limit)
+{
+	// limit は終端を含むサイズ、溢れた分は捨てる
+	char buf[16];
+	std::memset(buf, '#', sizeof(buf));
+	utils::memory_chaout m(buf, 8);
+	utils::sformat(m, "%s") % "0123456789";
+	UTEST_STR(buf, "0123456");
+	UTEST_EQ(m.size(), 7u);
+	UTEST_EQ(buf[8], '#');
+	m('x');
+	m.write("yz", 2);
+	UTEST_STR(buf, "0123456");
+
+	m.clear();
+	utils::sformat(m, "%c%c") % 'a' % 'b';
+	UTEST_STR(buf, "ab");
+
+	// 終端だけのバッファは使えない
+	char one[1] = { '#' };
+	utils::memory_chaout n(one, sizeof(one));
+	n('a');
+	n.write("b", 1);
+	UTEST_EQ(one[0], '#');
+	UTEST_EQ(n.size(), 0u);
+}
+
+UBENCH(format, sformat_int)
+{
+	char buf[64];
+	int32_t v = 0;
+	while(state.keep_running()) {
+		utils::sformat("%d, %08X", buf, sizeof(buf)) % v % static_cast<uint32_t>(v);
+		utest::do_not_optimize(buf);
+		v += 12345;
+	}
+	state.set_items_processed(state.iterations());
+}
+
+UBENCH(format, snprintf_int)
+{
+	char buf[64];
+	int32_t v = 0;
+	while(state.keep_running()) {
+		std::snprintf(buf, sizeof(buf), "%d, %08X", v, static_cast<uint32_t>(v));
+		utest::do_not_optimize(buf);
+		v += 12345;
+	}
+	state.set_items_processed(state.iterations());
+}
+
+UBENCH(format, sformat_float)
+{
+	char buf[64];
+	float v = 0.0f;
+	while(state.keep_running()) {
+		utils::sformat("%7.3f", buf, sizeof(buf)) % v;
+		utest::do_not_optimize(buf);
+		v += 0.731f;
+	}
+	state.set_items_processed(state.iterations());
+}
+
+UBENCH(format, snprintf_float)
+{
+	char buf[64];
+	float v = 0.0f;
+	while(state.keep_running()) {
+		std::snprintf(buf, sizeof(buf), "%7.3f", v);
+		utest::do_not_optimize(buf);
+		v += 0.731f;
+	}
+	state.set_items_processed(state.iterations());
+}
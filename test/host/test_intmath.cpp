@@ -0,0 +1,140 @@
+//=====================================================================//
+/*!	@file
+	@brief	intmath のテスト
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "common/intmath.hpp"
+
+UTEST(intmath, sqrt16_all)
+{
+	uint32_t ng = 0;
+	for(uint32_t i = 0; i < 65536; ++i) {
+		auto r = intmath::sqrt16(i);
+		uint32_t v = r.val;
+		if(v * v > i || (v + 1) * (v + 1) <= i) ++ng;
+		if(v * v + r.mod != i) ++ng;
+	}
+	UTEST_EQ(ng, 0u);
+}
+
+UTEST(intmath, sqrt32)
+{
+	uint32_t ng = 0;
+	auto test = [&](uint32_t i) {
+		auto r = intmath::sqrt32(i);
+		uint64_t v = r.val;
+		if(v * v > i || (v + 1) * (v + 1) <= i) ++ng;
+		if(v * v + r.mod != i) ++ng;
+	};
+	for(uint32_t i = 0; i < 1000000; ++i) test(i);
+	for(uint32_t i = 0; i < 65536; ++i) {
+		test(i * i);
+		test(i * i - 1);
+		test(i * 65537u);
+	}
+	test(0xffffffff);
+	UTEST_EQ(ng, 0u);
+}
+
+UTEST(intmath, sqrt64)
+{
+	uint32_t ng = 0;
+	auto test = [&](uint64_t i) {
+		auto r = intmath::sqrt64(i);
+		unsigned __int128 v = r.val;
+		if(v * v > i || (v + 1) * (v + 1) <= i) ++ng;
+		if(r.val * r.val + r.mod != i) ++ng;
+	};
+	for(uint64_t i = 0; i < 100000; ++i) test(i);
+	intmath::mrand rnd;
+	rnd.seed(1, 2, 3);
+	for(uint32_t i = 0; i < 100000; ++i) {
+		uint64_t a = rnd.rand32();
+		uint64_t v = (a << 32) | rnd.rand32();
+		test(v);
+		test(a * a);
+		test(a * a - 1);
+		// 32 ビット・レンジは sqrt32 と一致
+		if(intmath::sqrt64(a).val != intmath::sqrt32(a).val) ++ng;
+	}
+	test(0xffffffffffffffffULL);
+	UTEST_EQ(ng, 0u);
+}
+
+UTEST(intmath, mrand)
+{
+	intmath::mrand a;
+	intmath::mrand b;
+	a.seed(1, 2, 3);
+	b.seed(1, 2, 3);
+	uint32_t same = 0;
+	uint32_t prev = 0;
+	uint32_t repeat = 0;
+	for(int i = 0; i < 1000; ++i) {
+		auto x = a.rand32();
+		if(x == b.rand32()) ++same;
+		if(x == prev) ++repeat;
+		prev = x;
+	}
+	UTEST_EQ(same, 1000u);
+	UTEST_EQ(repeat, 0u);
+}
+
+UTEST(intmath, sin_cos)
+{
+	static intmath::sin_cos<10, 16384> sc;
+	int32_t max_err = 0;
+	for(uint32_t a = 0; a < 65536; a += 7) {
+		int16_t s;
+		int16_t c;
+		sc.get(a, s, c);
+		double rad = static_cast<double>(a) * 2.0 * 3.14159265358979 / 65536.0;
+		int32_t es = std::abs(s - static_cast<int32_t>(std::lround(std::sin(rad) * 16384.0)));
+		int32_t ec = std::abs(c - static_cast<int32_t>(std::lround(std::cos(rad) * 16384.0)));
+		if(es > max_err) max_err = es;
+		if(ec > max_err) max_err = ec;
+	}
+	// 1/4 周期 1024 分割の量子化誤差（2π/4096 * 16384 ≒ 25）以内
+	UTEST_TRUE(max_err <= 26);
+	UTEST_EQ(sc[0], 0);
+	UTEST_TRUE(std::abs(sc[1024] - 16384) <= 2);
+	UTEST_EQ(sc[1025], 0);  // 範囲外
+}
+
+UBENCH(intmath, sqrt32)
+{
+	uint32_t i = 12345;
+	while(state.keep_running()) {
+		auto r = intmath::sqrt32(i);
+		utest::do_not_optimize(r);
+		i += 0x9e3779b9;
+	}
+	state.set_items_processed(state.iterations());
+}
+
+UBENCH(intmath, std_sqrt)
+{
+	uint32_t i = 12345;
+	while(state.keep_running()) {
+		auto r = static_cast<uint32_t>(std::sqrt(static_cast<double>(i)));
+		utest::do_not_optimize(r);
+		i += 0x9e3779b9;
+	}
+	state.set_items_processed(state.iterations());
+}
+
+UBENCH(intmath, rand32)
+{
+	intmath::mrand r;
+	r.seed(1, 2, 3);
+	while(state.keep_running()) {
+		auto v = r.rand32();
+		utest::do_not_optimize(v);
+	}
+	state.set_items_processed(state.iterations());
+}
@@ -0,0 +1,236 @@
+//=====================================================================//
+/*!	@file
+	@brief	real_conv、format（%f、%e、%g）のテスト @n
+			・乱数のビット列から作った float、double を、glibc の snprintf と比べる @n
+			・環境変数 REAL_CONV_COUNT で、型毎の値の数を変えられる（標準 100000）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "common/format.hpp"
+#include "common/real_conv.hpp"
+#include <cstdlib>
+
+namespace {
+
+	uint64_t rand_ = 0x9e3779b97f4a7c15ULL;
+
+	uint64_t rand64_()
+	{
+		rand_ ^= rand_ << 13;
+		rand_ ^= rand_ >> 7;
+		rand_ ^= rand_ << 17;
+		return rand_;
+	}
+
+	uint32_t count_()
+	{
+		auto p = std::getenv("REAL_CONV_COUNT");
+		if(p != nullptr) return std::strtoul(p, nullptr, 10);
+		return 100000;
+	}
+
+	template <typename T>
+	T rand_real_()
+	{
+		T v;
+		if(sizeof(T) == 4) {
+			uint32_t b = rand64_();
+			std::memcpy(&v, &b, 4);
+		} else {
+			uint64_t b = rand64_();
+			std::memcpy(&v, &b, 8);
+		}
+		return v;
+	}
+
+	template <typename T>
+	uint32_t compare_(const char* conv, int prec, T v)
+	{
+		char form[16];
+		std::snprintf(form, sizeof(form), "%%.%d%s", prec, conv);
+		char a[512];
+		char b[512];
+		utils::sformat(form, a, sizeof(a)) % v;
+		std::snprintf(b, sizeof(b), form, static_cast<double>(v));
+		if(std::strcmp(a, b) == 0) return 0;
+		std::printf("  \"%s\" (%a): \"%s\" vs printf \"%s\"\n", form, static_cast<double>(v), a, b);
+		return 1;
+	}
+
+	template <typename T>
+	uint32_t random_fixed_(uint32_t num)
+	{
+		uint32_t ng = 0;
+		for(uint32_t i = 0; i < num && ng < 10; ++i) {
+			auto v = rand_real_<T>();
+			if(std::isnan(v)) continue;  // nan の符号、表記は printf と揃えない
+			ng += compare_("e", rand64_() % 18, v);
+			ng += compare_("g", rand64_() % 18 + 1, v);
+			if(std::abs(v) < static_cast<T>(1e30)) {
+				ng += compare_("f", rand64_() % 18, v);
+			}
+		}
+		return ng;
+	}
+
+	// 最短桁の検査、読み戻しで同じ値になり、snprintf で探した最短と同じ桁数か
+	template <typename T>
+	uint32_t shortest_(T v)
+	{
+		utils::real_conv<T> c(v);
+		uint8_t dig[utils::real_conv<T>::LAYOUT::SHORTEST + 1];
+		int32_t k;
+		auto n = c.shortest(dig, k);
+		char s[64];
+		uint32_t pos = 0;
+		if(c.sign()) s[pos++] = '-';
+		s[pos++] = '0';
+		s[pos++] = '.';
+		for(uint32_t i = 0; i < n; ++i) s[pos++] = '0' + dig[i];
+		std::snprintf(&s[pos], sizeof(s) - pos, "e%d", k);
+		T r;
+		if(sizeof(T) == 4) r = std::strtof(s, nullptr);
+		else r = std::strtod(s, nullptr);
+		if(std::memcmp(&r, &v, sizeof(T)) != 0) {
+			std::printf("  shortest(%a): \"%s\" does not round-trip\n", static_cast<double>(v), s);
+			return 1;
+		}
+		uint32_t ref = 1;
+		for(; ref < 17; ++ref) {
+			char t[64];
+			std::snprintf(t, sizeof(t), "%.*e", ref - 1, static_cast<double>(v));
+			T u;
+			if(sizeof(T) == 4) u = std::strtof(t, nullptr);
+			else u = std::strtod(t, nullptr);
+			if(u == v) break;
+		}
+		if(n > ref) {
+			std::printf("  shortest(%a): \"%s\" %u digits, %u is enough\n",
+				static_cast<double>(v), s, n, ref);
+			return 1;
+		}
+		return 0;
+	}
+
+	template <typename T>
+	uint32_t random_shortest_(uint32_t num)
+	{
+		uint32_t ng = 0;
+		for(uint32_t i = 0; i < num && ng < 10; ++i) {
+			auto v = rand_real_<T>();
+			if(!std::isfinite(v) || v == 0) continue;
+			ng += shortest_(v);
+		}
+		return ng;
+	}
+}
+
+UTEST(real_conv, special)
+{
+	char buf[32];
+	utils::sformat("%f", buf, sizeof(buf)) % (1.0 / 0.0);
+	UTEST_STR(buf, "inf");
+	utils::sformat("%e", buf, sizeof(buf)) % (-1.0 / 0.0);
+	UTEST_STR(buf, "-inf");
+	utils::sformat("%.0f", buf, sizeof(buf)) % 0.5;  // 最近接偶数
+	UTEST_STR(buf, "0");
+	utils::sformat("%.0f", buf, sizeof(buf)) % 1.5;
+	UTEST_STR(buf, "2");
+	utils::sformat("%.1f", buf, sizeof(buf)) % 0.25;
+	UTEST_STR(buf, "0.2");
+	utils::sformat("%e", buf, sizeof(buf)) % 4.9406564584124654e-324;  // 最小の非正規化数
+	UTEST_STR(buf, "4.940656e-324");
+}
+
+UTEST(real_conv, random_float)
+{
+	UTEST_EQ(random_fixed_<float>(count_()), 0u);
+}
+
+UTEST(real_conv, random_double)
+{
+	UTEST_EQ(random_fixed_<double>(count_()), 0u);
+}
+
+UTEST(real_conv, shortest_float)
+{
+	UTEST_EQ(random_shortest_<float>(count_()), 0u);
+}
+
+UTEST(real_conv, shortest_double)
+{
+	UTEST_EQ(random_shortest_<double>(count_()), 0u);
+	UTEST_EQ(shortest_(0.1), 0u);
+	UTEST_EQ(shortest_(5e-324), 0u);
+	UTEST_EQ(shortest_(1.7976931348623157e308), 0u);
+}
+
+namespace {
+
+	template <typename T>
+	void fill_(T* v, uint32_t n)
+	{
+		for(uint32_t i = 0; i < n; ++i) {
+			T t;
+			do { t = rand_real_<T>(); } while(!std::isfinite(t) || std::abs(t) > static_cast<T>(1e30));
+			v[i] = t;
+		}
+	}
+}
+
+UBENCH(real_conv, sformat_double_e)
+{
+	double v[256];
+	fill_(v, 256);
+	char buf[64];
+	uint32_t i = 0;
+	while(state.keep_running()) {
+		utils::sformat("%.16e", buf, sizeof(buf)) % v[i++ & 255];
+		utest::do_not_optimize(buf);
+	}
+	state.set_items_processed(state.iterations());
+}
+
+UBENCH(real_conv, snprintf_double_e)
+{
+	double v[256];
+	fill_(v, 256);
+	char buf[64];
+	uint32_t i = 0;
+	while(state.keep_running()) {
+		std::snprintf(buf, sizeof(buf), "%.16e", v[i++ & 255]);
+		utest::do_not_optimize(buf);
+	}
+	state.set_items_processed(state.iterations());
+}
+
+UBENCH(real_conv, sformat_float_f)
+{
+	float v[256];
+	for(uint32_t i = 0; i < 256; ++i) v[i] = static_cast<float>(rand64_() % 2000000) * 0.001f - 1000.0f;
+	char buf[64];
+	uint32_t i = 0;
+	while(state.keep_running()) {
+		utils::sformat("%.3f", buf, sizeof(buf)) % v[i++ & 255];
+		utest::do_not_optimize(buf);
+	}
+	state.set_items_processed(state.iterations());
+}
+
+UBENCH(real_conv, shortest_double)
+{
+	double v[256];
+	fill_(v, 256);
+	uint8_t dig[32];
+	uint32_t i = 0;
+	while(state.keep_running()) {
+		utils::real_conv<double> c(v[i++ & 255]);
+		int32_t k;
+		utest::do_not_optimize(c.shortest(dig, k));
+	}
+	state.set_items_processed(state.iterations());
+}
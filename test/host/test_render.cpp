@@ -0,0 +1,250 @@
+//=====================================================================//
+/*!	@file
+	@brief	graphics::render（塗りつぶし、ビットマップ、移動、スクロール）のテスト @n
+			・ランダムな位置、クリップで、画素毎の参照結果と比べる @n
+			・ベンチマークは、画素数（items/s = pixels/s）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "common/format.hpp"
+#include "glcdc_stub.hpp"
+#include "graphics/graphics.hpp"
+
+namespace {
+
+	static constexpr int16_t W = 480;
+	static constexpr int16_t H = 272;
+	typedef stub::glcdc<W, H> GLC;
+	typedef graphics::render<GLC> RENDER;
+
+	GLC glc_;
+	graphics::afont_null afont_;
+	graphics::kfont_null kfont_;
+	graphics::font_null font_(afont_, kfont_);
+
+	uint32_t rand_ = 99;
+
+	uint32_t rand32_()
+	{
+		rand_ ^= rand_ << 13;
+		rand_ ^= rand_ >> 17;
+		rand_ ^= rand_ << 5;
+		return rand_;
+	}
+
+	int16_t rand_range_(int32_t min, int32_t max)
+	{
+		return min + static_cast<int32_t>(rand32_() % static_cast<uint32_t>(max - min));
+	}
+
+	uint16_t* fb_() { return static_cast<uint16_t*>(glc_.get_fbp()); }
+
+	void fill_random_(uint16_t* p)
+	{
+		for(uint32_t i = 0; i < W * H; ++i) p[i] = rand32_();
+	}
+
+	vtx::srect rand_clip_()
+	{
+		int16_t x = rand_range_(0, W / 2);
+		int16_t y = rand_range_(0, H / 2);
+		return vtx::srect(x, y, rand_range_(1, W - x), rand_range_(1, H - y));
+	}
+}
+
+UTEST(render, fill_box_vs_plot)
+{
+	static uint16_t ref[W * H];
+	RENDER rdr(glc_, font_);
+	uint32_t ng = 0;
+	for(uint32_t n = 0; n < 2000 && ng == 0; ++n) {
+		fill_random_(fb_());
+		std::memcpy(ref, fb_(), sizeof(ref));
+		auto clip = rand_clip_();
+		rdr.set_clip(clip);
+		graphics::share_color c(rand32_() & 255, rand32_() & 255, rand32_() & 255);
+		rdr.set_fore_color(c);
+		vtx::srect r(rand_range_(-50, W), rand_range_(-50, H), rand_range_(-10, 300), rand_range_(-10, 200));
+		rdr.fill_box(r);
+		for(int32_t y = r.org.y; y < r.end_y(); ++y) {
+			for(int32_t x = r.org.x; x < r.end_x(); ++x) {
+				if(clip.is_focus(vtx::spos(x, y))) ref[y * W + x] = c.rgb565;
+			}
+		}
+		if(std::memcmp(ref, fb_(), sizeof(ref)) != 0) ++ng;
+	}
+	UTEST_EQ(ng, 0u);
+}
+
+UTEST(render, line_v_clip)
+{
+	RENDER rdr(glc_, font_);
+	rdr.clear(graphics::def_color::Black);
+	rdr.set_clip(vtx::srect(10, 20, 30, 40));
+	rdr.set_fore_color(graphics::def_color::White);
+	rdr.line_v(15, 0, H);
+	rdr.line_v(5, 0, H);  // クリップの外
+	uint32_t num = 0;
+	for(int32_t y = 0; y < H; ++y) {
+		for(int32_t x = 0; x < W; ++x) {
+			if(fb_()[y * W + x] != 0) {
+				++num;
+				UTEST_EQ(x, 15);
+			}
+		}
+	}
+	UTEST_EQ(num, 40u);
+}
+
+UTEST(render, draw_bitmap_vs_reference)
+{
+	static uint16_t ref[W * H];
+	static uint8_t img[64 * 64 / 8 + 1];
+	RENDER rdr(glc_, font_);
+	uint32_t ng = 0;
+	for(uint32_t n = 0; n < 5000 && ng == 0; ++n) {
+		fill_random_(fb_());
+		std::memcpy(ref, fb_(), sizeof(ref));
+		vtx::spos ssz(rand_range_(1, 64), rand_range_(1, 64));
+		for(auto& b : img) {
+			b = rand32_();
+			if((rand32_() & 3) == 0) b = 0xff;  // 全て１のバイトの経路
+		}
+		auto clip = rand_clip_();
+		rdr.set_clip(clip);
+		graphics::share_color fc(rand32_() & 255, rand32_() & 255, rand32_() & 255);
+		graphics::share_color bc(rand32_() & 255, rand32_() & 255, rand32_() & 255);
+		rdr.set_fore_color(fc);
+		rdr.set_back_color(bc);
+		vtx::spos pos(rand_range_(-40, W), rand_range_(-40, H));
+		bool back = (rand32_() & 1) != 0;
+		rdr.draw_bitmap(pos, img, ssz, back);
+		for(int32_t j = 0; j < ssz.y; ++j) {
+			for(int32_t i = 0; i < ssz.x; ++i) {
+				vtx::spos p(pos.x + i, pos.y + j);
+				if(!clip.is_focus(p)) continue;
+				uint32_t bit = j * ssz.x + i;
+				bool on = (img[bit >> 3] >> (bit & 7)) & 1;
+				if(on) ref[p.y * W + p.x] = fc.rgb565;
+				else if(back) ref[p.y * W + p.x] = bc.rgb565;
+			}
+		}
+		if(std::memcmp(ref, fb_(), sizeof(ref)) != 0) {
+			std::printf("  pos %d,%d size %d,%d back %d\n", pos.x, pos.y, ssz.x, ssz.y, back);
+			++ng;
+		}
+	}
+	UTEST_EQ(ng, 0u);
+}
+
+UTEST(render, move_overlap)
+{
+	static uint16_t ref[W * H];
+	static uint16_t org[W * H];
+	RENDER rdr(glc_, font_);
+	uint32_t ng = 0;
+	for(uint32_t n = 0; n < 500 && ng == 0; ++n) {
+		fill_random_(fb_());
+		std::memcpy(org, fb_(), sizeof(org));
+		std::memcpy(ref, fb_(), sizeof(ref));
+		vtx::srect src(rand_range_(0, W / 2), rand_range_(0, H / 2), rand_range_(1, W / 2), rand_range_(1, H / 2));
+		// 重なる移動（上下左右）
+		vtx::spos dst(src.org.x + rand_range_(-src.org.x, W / 2 - src.org.x + 1),
+			src.org.y + rand_range_(-src.org.y, H / 2 - src.org.y + 1));
+		rdr.move(src, dst);
+		for(int32_t y = 0; y < src.size.y; ++y) {
+			for(int32_t x = 0; x < src.size.x; ++x) {
+				ref[(dst.y + y) * W + dst.x + x] = org[(src.org.y + y) * W + src.org.x + x];
+			}
+		}
+		if(std::memcmp(ref, fb_(), sizeof(ref)) != 0) ++ng;
+	}
+	UTEST_EQ(ng, 0u);
+}
+
+UTEST(render, scroll)
+{
+	static uint16_t org[W * H];
+	RENDER rdr(glc_, font_);
+	fill_random_(fb_());
+	std::memcpy(org, fb_(), sizeof(org));
+	rdr.scroll(16);
+	UTEST_EQ(std::memcmp(fb_(), &org[W * 16], sizeof(uint16_t) * W * (H - 16)), 0);
+	std::memcpy(fb_(), org, sizeof(org));
+	rdr.scroll(-16);
+	UTEST_EQ(std::memcmp(&fb_()[W * 16], org, sizeof(uint16_t) * W * (H - 16)), 0);
+}
+
+UBENCH(render, fill_box_400x200)
+{
+	RENDER rdr(glc_, font_);
+	while(state.keep_running()) {
+		rdr.fill_box(vtx::srect(41, 30, 400, 200));
+		utest::clobber_memory();
+	}
+	state.set_items_processed(state.iterations() * 400 * 200);
+}
+
+namespace {
+
+	void bench_bitmap_(utest::state& state, int16_t w, int16_t h, bool back)
+	{
+		RENDER rdr(glc_, font_);
+		static uint8_t img[16 * 16];
+		for(auto& b : img) b = rand32_();
+		int16_t x = 0;
+		int16_t y = 0;
+		while(state.keep_running()) {
+			rdr.draw_bitmap(vtx::spos(x, y), img, vtx::spos(w, h), back);
+			x += w;
+			if(x > (W - w)) {
+				x = 0;
+				y += h;
+				if(y > (H - h)) y = 0;
+			}
+		}
+		utest::do_not_optimize(fb_()[0]);
+		state.set_items_processed(state.iterations() * w * h);
+	}
+}
+
+UBENCH(render, draw_bitmap_8x16_opaque)
+{
+	bench_bitmap_(state, 8, 16, true);
+}
+
+UBENCH(render, draw_bitmap_8x16_trans)
+{
+	bench_bitmap_(state, 8, 16, false);
+}
+
+UBENCH(render, draw_bitmap_6x12_opaque)
+{
+	bench_bitmap_(state, 6, 12, true);
+}
+
+UBENCH(render, move_400x200)
+{
+	RENDER rdr(glc_, font_);
+	int16_t d = 1;
+	while(state.keep_running()) {
+		rdr.move(vtx::srect(40, 36, 400, 200), vtx::spos(40 + d, 36 + d));
+		d = -d;
+		utest::clobber_memory();
+	}
+	state.set_items_processed(state.iterations() * 400 * 200);
+}
+
+UBENCH(render, scroll_16)
+{
+	RENDER rdr(glc_, font_);
+	while(state.keep_running()) {
+		rdr.scroll(16);
+		utest::clobber_memory();
+	}
+	state.set_items_processed(state.iterations() * W * (H - 16));
+}
@@ -0,0 +1,289 @@
+//=====================================================================//
+/*!	@file
+	@brief	graphics::render のアンチエイリアス描画（line_aa、circle_aa、round_box_aa）のテスト @n
+			・小さい図形は、期待画像（カバレッジを文字にした物）と比べる @n
+			・大きい半径（32 ビットを超える２乗）は、浮動小数点の参照と比べる @n
+			・ベンチマークは、図形数（items/s）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "common/format.hpp"
+#include "glcdc_stub.hpp"
+#include "graphics/graphics.hpp"
+
+namespace {
+
+	static constexpr int16_t W = 480;
+	static constexpr int16_t H = 272;
+	typedef stub::glcdc<W, H> GLC;
+	typedef graphics::render<GLC> RENDER;
+
+	GLC glc_;
+	graphics::afont_null afont_;
+	graphics::kfont_null kfont_;
+	graphics::font_null font_(afont_, kfont_);
+
+	uint16_t* fb_() { return static_cast<uint16_t*>(glc_.get_fbp()); }
+
+	void setup_(RENDER& rdr)
+	{
+		rdr.set_clip(vtx::srect(0, 0, W, H));
+		rdr.clear(graphics::def_color::Black);
+		rdr.set_fore_color(graphics::def_color::White);
+	}
+
+	// 白を黒に描いた画素の、カバレッジ（緑、0 to 63）
+	int32_t cov_(int16_t x, int16_t y)
+	{
+		return (fb_()[y * W + x] >> 5) & 63;
+	}
+
+	// 左上 (0, 0) から w x h の範囲を、カバレッジを文字にして返す @n
+	// ' ': 無し、'#': 全て、'1' to '9': 途中
+	std::string dump_(int16_t w, int16_t h)
+	{
+		std::string s;
+		for(int16_t y = 0; y < h; ++y) {
+			for(int16_t x = 0; x < w; ++x) {
+				auto c = cov_(x, y);
+				if(c == 0) s += ' ';
+				else if(c == 63) s += '#';
+				else s += static_cast<char>('1' + std::min<int32_t>(c * 9 / 63, 8));
+			}
+			s += '\n';
+		}
+		return s;
+	}
+
+	// 中心 (cx, cy) に対して、上下左右が対称な事を検査
+	uint32_t symmetry_ng_(int16_t cx, int16_t cy, int16_t rad)
+	{
+		uint32_t ng = 0;
+		for(int16_t y = cy - rad - 1; y <= cy + rad + 1; ++y) {
+			for(int16_t x = cx - rad - 1; x <= cx + rad + 1; ++x) {
+				auto c = cov_(x, y);
+				if(c != cov_(cx * 2 - x, y)) ++ng;
+				if(c != cov_(x, cy * 2 - y)) ++ng;
+				if(c != cov_(cx + (y - cy), cy + (x - cx))) ++ng;
+			}
+		}
+		return ng;
+	}
+
+	// 参照のカバレッジ（0 to 63）、円の中心は画素の中心
+	int32_t ref_cov_(double d, double rad, bool fill)
+	{
+		double c;
+		if(fill) c = rad + 1.0 - d;
+		else c = 1.0 - std::abs(d - rad);
+		if(c <= 0.0) return 0;
+		if(c >= 1.0) return 63;
+		return static_cast<int32_t>(c * 255.0) >> 2;
+	}
+
+	// 画面全体を参照と比べ、誤差（緑、0 to 63）が tol を超えた画素数
+	uint32_t ref_ng_(int16_t cx, int16_t cy, double rad, bool fill, int32_t tol)
+	{
+		uint32_t ng = 0;
+		for(int16_t y = 0; y < H; ++y) {
+			for(int16_t x = 0; x < W; ++x) {
+				double d = std::hypot(static_cast<double>(x - cx), static_cast<double>(y - cy));
+				auto e = ref_cov_(d, rad, fill) - cov_(x, y);
+				if(e < -tol || e > tol) ++ng;
+			}
+		}
+		return ng;
+	}
+}
+
+UTEST(render_aa, fill_circle_golden)
+{
+	RENDER rdr(glc_, font_);
+	setup_(rdr);
+	rdr.fill_circle_aa(vtx::spos(5, 5), 4);
+	UTEST_STR(dump_(11, 11).c_str(),
+		"           \n"
+		"   59#95   \n"
+		"  8#####8  \n"
+		" 5#######5 \n"
+		" 9#######9 \n"
+		" ######### \n"
+		" 9#######9 \n"
+		" 5#######5 \n"
+		"  8#####8  \n"
+		"   59#95   \n"
+		"           \n");
+}
+
+UTEST(render_aa, circle_golden)
+{
+	RENDER rdr(glc_, font_);
+	setup_(rdr);
+	rdr.circle_aa(vtx::spos(5, 5), 4);
+	UTEST_STR(dump_(11, 11).c_str(),
+		"           \n"
+		"   59#95   \n"
+		"  862 268  \n"
+		" 56     65 \n"
+		" 92     29 \n"
+		" #       # \n"
+		" 92     29 \n"
+		" 56     65 \n"
+		"  862 268  \n"
+		"   59#95   \n"
+		"           \n");
+}
+
+UTEST(render_aa, round_box_golden)
+{
+	RENDER rdr(glc_, font_);
+	setup_(rdr);
+	rdr.round_box_aa(vtx::srect(1, 1, 12, 8), 3);
+	UTEST_STR(dump_(14, 10).c_str(),
+		"              \n"
+		"  69######96  \n"
+		" 6##########6 \n"
+		" 9##########9 \n"
+		" ############ \n"
+		" ############ \n"
+		" 9##########9 \n"
+		" 6##########6 \n"
+		"  69######96  \n"
+		"              \n");
+}
+
+UTEST(render_aa, round_frame_golden)
+{
+	RENDER rdr(glc_, font_);
+	setup_(rdr);
+	rdr.round_frame_aa(vtx::srect(1, 1, 12, 8), 3);
+	UTEST_STR(dump_(14, 10).c_str(),
+		"              \n"
+		"  69######96  \n"
+		" 661      166 \n"
+		" 91        19 \n"
+		" #          # \n"
+		" #          # \n"
+		" 91        19 \n"
+		" 661      166 \n"
+		"  69######96  \n"
+		"              \n");
+}
+
+UTEST(render_aa, line_golden)
+{
+	RENDER rdr(glc_, font_);
+	setup_(rdr);
+	// 小数４ビット、(1.5, 1.5) から (12.5, 5.5)
+	rdr.line_aa(vtx::spos(1 * 16 + 8, 1 * 16 + 8), vtx::spos(12 * 16 + 8, 5 * 16 + 8));
+	UTEST_STR(dump_(14, 8).c_str(),
+		"              \n"
+		" 563          \n"
+		"  47952       \n"
+		"    158851    \n"
+		"       25974  \n"
+		"          365 \n"
+		"              \n"
+		"              \n");
+}
+
+UTEST(render_aa, circle_symmetry)
+{
+	RENDER rdr(glc_, font_);
+	uint32_t ng = 0;
+	for(int16_t rad = 0; rad < 100; ++rad) {
+		setup_(rdr);
+		rdr.fill_circle_aa(vtx::spos(W / 2, H / 2), rad);
+		ng += symmetry_ng_(W / 2, H / 2, rad);
+		setup_(rdr);
+		rdr.circle_aa(vtx::spos(W / 2, H / 2), rad);
+		ng += symmetry_ng_(W / 2, H / 2, rad);
+	}
+	UTEST_EQ(ng, 0u);
+}
+
+UTEST(render_aa, circle_vs_ref)
+{
+	// 輪郭の近似（1/16 画素）と RGB565 の丸めを許す
+	RENDER rdr(glc_, font_);
+	uint32_t ng = 0;
+	for(int16_t rad : { 3, 8, 20, 60, 130 }) {
+		setup_(rdr);
+		rdr.fill_circle_aa(vtx::spos(W / 2, H / 2), rad);
+		ng += ref_ng_(W / 2, H / 2, rad, true, 5);
+		setup_(rdr);
+		rdr.circle_aa(vtx::spos(W / 2, H / 2), rad);
+		ng += ref_ng_(W / 2, H / 2, rad, false, 5);
+	}
+	UTEST_EQ(ng, 0u);
+}
+
+UTEST(render_aa, large_radius)
+{
+	// 半径が約 720 画素を超えると、１／６４画素単位の２乗が 32 ビットを超える
+	RENDER rdr(glc_, font_);
+	uint32_t ng = 0;
+	for(int16_t rad : { 800, 3000, 20000, 32000 }) {
+		// 円の下端が、画面の中ほどを横切る位置
+		vtx::spos cen(W / 2, H / 2 - rad);
+		setup_(rdr);
+		rdr.fill_circle_aa(cen, rad);
+		ng += ref_ng_(cen.x, cen.y, rad, true, 5);
+		setup_(rdr);
+		rdr.circle_aa(cen, rad);
+		ng += ref_ng_(cen.x, cen.y, rad, false, 5);
+	}
+	// 画面を覆う大きな角丸の箱は、全て塗られる
+	setup_(rdr);
+	rdr.round_box_aa(vtx::srect(-2000, -2000, 4480, 4272), 2000);
+	for(int16_t y = 0; y < H; ++y) {
+		for(int16_t x = 0; x < W; ++x) {
+			if(cov_(x, y) != 63) ++ng;
+		}
+	}
+	UTEST_EQ(ng, 0u);
+}
+
+UBENCH(render_aa, fill_circle_r20)
+{
+	RENDER rdr(glc_, font_);
+	setup_(rdr);
+	uint64_t n = 0;
+	while(state.keep_running()) {
+		rdr.fill_circle_aa(vtx::spos(20 + (n % 400), 30 + (n % 200)), 20);
+		++n;
+	}
+	utest::do_not_optimize(fb_()[0]);
+	state.set_items_processed(n);
+}
+
+UBENCH(render_aa, circle_r100)
+{
+	RENDER rdr(glc_, font_);
+	setup_(rdr);
+	uint64_t n = 0;
+	while(state.keep_running()) {
+		rdr.circle_aa(vtx::spos(W / 2, H / 2), 100 + (n % 30));
+		++n;
+	}
+	utest::do_not_optimize(fb_()[0]);
+	state.set_items_processed(n);
+}
+
+UBENCH(render_aa, line)
+{
+	RENDER rdr(glc_, font_);
+	setup_(rdr);
+	uint64_t n = 0;
+	while(state.keep_running()) {
+		int16_t a = n % 256;
+		rdr.line_aa(vtx::spos(16, a * 16), vtx::spos((W - 1) * 16, (H - 1 - a) * 16));
+		++n;
+	}
+	utest::do_not_optimize(fb_()[0]);
+	state.set_items_processed(n);
+}
@@ -0,0 +1,241 @@
+//=====================================================================//
+/*!	@file
+	@brief	img::resampler（分離型リサンプラー）のテスト @n
+			・一様な画像は、拡大、縮小、途中で切れた入力でも一様のまま @n
+			・下から上の順（BMP）で与えても、同じ結果 @n
+			・ベンチマークは、出力画素数（items/s = pixels/s）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "graphics/scaling.hpp"
+
+namespace {
+
+	static constexpr int16_t DW = 320;
+	static constexpr int16_t DH = 320;
+
+	// 出力を RGBA で貯める描画ファンクタ
+	struct canvas {
+		uint8_t		pix[DH][DW][4];
+		uint32_t	count;
+		uint32_t	outside;
+
+		canvas() : pix{ }, count(0), outside(0) { }
+
+		void clear()
+		{
+			std::memset(pix, 0, sizeof(pix));
+			count = 0;
+			outside = 0;
+		}
+
+		void operator() (int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+		{
+			if(x < 0 || x >= DW || y < 0 || y >= DH) {
+				++outside;
+				return;
+			}
+			auto p = pix[y][x];
+			p[0] = r;
+			p[1] = g;
+			p[2] = b;
+			p[3] = a;
+			++count;
+		}
+	};
+
+	typedef img::resampler<canvas> RESAMPLER;
+	typedef RESAMPLER::FILTER FILTER;
+
+	canvas canvas_;
+	RESAMPLER resampler_(canvas_);
+
+	static constexpr FILTER filters_[] = { FILTER::BOX, FILTER::BILINEAR, FILTER::LANCZOS3 };
+
+	// 一様な画像を、rows ラインだけ与える
+	void feed_flat_(int16_t sw, int16_t rows, uint8_t v)
+	{
+		for(int16_t y = 0; y < rows; ++y) {
+			for(int16_t x = 0; x < sw; ++x) {
+				resampler_(x, y, v, v, v, 255);
+			}
+		}
+	}
+
+	// 出力範囲の、値が v でない画素数
+	uint32_t count_ng_(const vtx::spos& dst, uint8_t v)
+	{
+		uint32_t ng = 0;
+		for(int16_t y = 0; y < dst.y; ++y) {
+			for(int16_t x = 0; x < dst.x; ++x) {
+				auto p = canvas_.pix[y][x];
+				if(p[0] != v || p[1] != v || p[2] != v || p[3] != 255) ++ng;
+			}
+		}
+		return ng;
+	}
+
+	uint8_t pattern_(int16_t x, int16_t y, int16_t c)
+	{
+		return static_cast<uint8_t>((x * 7 + y * 13 + c * 50) ^ (x * y));
+	}
+}
+
+UTEST(resampler, flat_up_down)
+{
+	static const vtx::spos sizes[][2] = {
+		{ { 10, 10 }, { 40, 40 } },
+		{ { 40, 40 }, { 10, 10 } },
+		{ { 64, 48 }, { 100, 75 } },
+		{ { 300, 200 }, { 120, 90 } },
+		{ { 7, 300 }, { 300, 5 } },
+		{ { 1, 1 }, { 16, 16 } },
+	};
+	uint32_t ng = 0;
+	for(auto f : filters_) {
+		for(const auto& s : sizes) {
+			canvas_.clear();
+			if(!UTEST_TRUE(resampler_.start(s[0], s[1], f))) continue;
+			feed_flat_(s[0].x, s[0].y, 100);
+			resampler_.flush();
+			ng += count_ng_(s[1], 100);
+			UTEST_EQ(canvas_.count, static_cast<uint32_t>(s[1].x * s[1].y));
+			UTEST_EQ(canvas_.outside, 0u);
+		}
+	}
+	UTEST_EQ(ng, 0u);
+}
+
+UTEST(resampler, truncated_input)
+{
+	// 途中で切れた入力では、足りないラインは最後のラインの複製になる
+	static const vtx::spos sizes[][2] = {
+		{ { 10, 10 }, { 40, 40 } },
+		{ { 40, 40 }, { 10, 10 } },
+		{ { 100, 100 }, { 100, 100 } },
+		{ { 33, 64 }, { 200, 300 } },
+	};
+	uint32_t ng = 0;
+	for(auto f : filters_) {
+		for(const auto& s : sizes) {
+			for(int rows : { 1, 5, 16, s[0].y - 1 }) {
+				canvas_.clear();
+				if(!UTEST_TRUE(resampler_.start(s[0], s[1], f))) continue;
+				feed_flat_(s[0].x, static_cast<int16_t>(rows), 100);
+				resampler_.flush();
+				ng += count_ng_(s[1], 100);
+				UTEST_EQ(resampler_.get_output_lines(), s[1].y);
+			}
+		}
+	}
+	UTEST_EQ(ng, 0u);
+}
+
+UTEST(resampler, bottom_up)
+{
+	// BMP の様に、最終ラインから与えても同じ画像
+	static uint8_t ref[DH][DW][4];
+	vtx::spos src(50, 37);
+	vtx::spos dst(123, 29);
+	uint32_t ng = 0;
+	for(auto f : filters_) {
+		canvas_.clear();
+		resampler_.start(src, dst, f);
+		for(int16_t y = 0; y < src.y; ++y) {
+			for(int16_t x = 0; x < src.x; ++x) {
+				resampler_(x, y, pattern_(x, y, 0), pattern_(x, y, 1), pattern_(x, y, 2), 255);
+			}
+		}
+		resampler_.flush();
+		std::memcpy(ref, canvas_.pix, sizeof(ref));
+
+		canvas_.clear();
+		resampler_.start(src, dst, f);
+		for(int16_t y = src.y - 1; y >= 0; --y) {
+			for(int16_t x = 0; x < src.x; ++x) {
+				resampler_(x, y, pattern_(x, y, 0), pattern_(x, y, 1), pattern_(x, y, 2), 255);
+			}
+		}
+		resampler_.flush();
+		if(std::memcmp(ref, canvas_.pix, sizeof(ref)) != 0) ++ng;
+	}
+	UTEST_EQ(ng, 0u);
+}
+
+UTEST(resampler, box_half)
+{
+	// 面積平均で 1/2 は、2x2 の平均（丸め誤差 1 まで）
+	vtx::spos src(64, 64);
+	vtx::spos dst(32, 32);
+	canvas_.clear();
+	resampler_.start(src, dst, FILTER::BOX);
+	for(int16_t y = 0; y < src.y; ++y) {
+		for(int16_t x = 0; x < src.x; ++x) {
+			resampler_(x, y, pattern_(x, y, 0), pattern_(x, y, 1), pattern_(x, y, 2), 255);
+		}
+	}
+	resampler_.flush();
+	uint32_t ng = 0;
+	for(int16_t y = 0; y < dst.y; ++y) {
+		for(int16_t x = 0; x < dst.x; ++x) {
+			for(int16_t c = 0; c < 3; ++c) {
+				int32_t sum = pattern_(x * 2, y * 2, c) + pattern_(x * 2 + 1, y * 2, c)
+					+ pattern_(x * 2, y * 2 + 1, c) + pattern_(x * 2 + 1, y * 2 + 1, c);
+				int32_t e = (sum + 2) / 4 - canvas_.pix[y][x][c];
+				if(e < -1 || e > 1) ++ng;
+			}
+		}
+	}
+	UTEST_EQ(ng, 0u);
+}
+
+UTEST(resampler, reject)
+{
+	UTEST_FALSE(resampler_.start(vtx::spos(0, 10), vtx::spos(10, 10)));
+	UTEST_FALSE(resampler_.start(vtx::spos(641, 10), vtx::spos(10, 10)));
+	UTEST_FALSE(resampler_.start(vtx::spos(10, 10), vtx::spos(321, 10)));
+	// start に失敗した後は、画素を無視する
+	canvas_.clear();
+	resampler_(0, 0, 1, 2, 3, 4);
+	resampler_.flush();
+	UTEST_EQ(canvas_.count, 0u);
+}
+
+namespace {
+
+	void bench_(utest::state& state, const vtx::spos& src, const vtx::spos& dst, FILTER f)
+	{
+		uint64_t n = 0;
+		while(state.keep_running()) {
+			resampler_.start(src, dst, f);
+			for(int16_t y = 0; y < src.y; ++y) {
+				for(int16_t x = 0; x < src.x; ++x) {
+					resampler_(x, y, x, y, x ^ y, 255);
+				}
+			}
+			resampler_.flush();
+			n += dst.x * dst.y;
+		}
+		utest::do_not_optimize(canvas_.pix[0][0][0]);
+		state.set_items_processed(n);
+	}
+}
+
+UBENCH(resampler, down_640x480_160x120_lanczos3)
+{
+	bench_(state, vtx::spos(640, 480), vtx::spos(160, 120), FILTER::LANCZOS3);
+}
+
+UBENCH(resampler, down_640x480_160x120_box)
+{
+	bench_(state, vtx::spos(640, 480), vtx::spos(160, 120), FILTER::BOX);
+}
+
+UBENCH(resampler, up_80x60_320x240_bilinear)
+{
+	bench_(state, vtx::spos(80, 60), vtx::spos(320, 240), FILTER::BILINEAR);
+}
@@ -0,0 +1,202 @@
+//=====================================================================//
+/*!	@file
+	@brief	UTF-8、UTF-16、SJIS (CP932) 変換のテスト @n
+			・sjis_utf16_tbl.hpp の表を、ff14 の ff_oem2uni と比べる
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "common/string_utils.hpp"
+
+namespace {
+
+	// ASCII、かな、漢字が混ざった、ファイル名、タグのような文字列
+	static const char* text_u8_ =
+		"01 - \xe5\xa4\x9c\xe3\x81\xab\xe9\xa7\x86\xe3\x81\x91\xe3\x82\x8b (Album Version).mp3 / "
+		"\xe3\x82\xa2\xe3\x83\xbc\xe3\x83\x86\xe3\x82\xa3\xe3\x82\xb9\xe3\x83\x88 \xef\xbd\xb1\xef\xbd\xb2 "
+		"track 2021 \xe6\x9d\xb1\xe4\xba\xac\xe9\x83\xbd ";
+
+	uint32_t make_text_(char* dst, uint32_t size)
+	{
+		auto l = std::strlen(text_u8_);
+		uint32_t n = 0;
+		while((n + l) < size) {
+			std::memcpy(&dst[n], text_u8_, l);
+			n += l;
+		}
+		dst[n] = 0;
+		return n;
+	}
+}
+
+UTEST(sjis, table_vs_ff)
+{
+	// ff にあるコードは、表でも同じ（表には、ff に無い NEC 選定 IBM 拡張の重複もある）
+	uint32_t ng = 0;
+	uint32_t num = 0;
+	for(uint32_t code = 0x8100; code <= 0xeeff; ++code) {
+		if(!utils::sjis::is_trail(code & 0xff)) continue;
+		auto t = utils::sjis::to_utf16(code);
+		auto f = ff_oem2uni(code, 932);
+		if(f != 0 && t != f) {
+			if(ng < 10) std::printf("  SJIS %04X: table %04X, ff %04X\n", code, t, f);
+			++ng;
+		}
+		if(f != 0) ++num;
+	}
+	UTEST_EQ(ng, 0u);
+	UTEST_TRUE(num > 6900);
+	UTEST_EQ(utils::sjis::to_utf16(0x41), 0x41);
+	UTEST_EQ(utils::sjis::to_utf16(0xb1), 0xff71);  // 半角カナ
+}
+
+UTEST(sjis, round_trip_all)
+{
+	// 定義されている２バイト文字は全て、SJIS -> UTF-8 -> SJIS で戻る
+	uint32_t ng = 0;
+	for(uint32_t code = 0x8100; code <= 0xfcff; ++code) {
+		if(!utils::sjis::is_trail(code & 0xff)) continue;
+		if(ff_oem2uni(code, 932) == 0) continue;
+		// CP932 には、同じ UTF-16 に対応する重複コード（NEC 選定 IBM 拡張など）があり、戻らない
+		auto u = ff_oem2uni(code, 932);
+		if(ff_uni2oem(u, 932) != code) continue;
+		char src[3] = { static_cast<char>(code >> 8), static_cast<char>(code & 0xff), 0 };
+		char u8[8];
+		char back[4];
+		if(!utils::str::oemc_to_utf8(src, u8, sizeof(u8))
+			|| !utils::str::utf8_to_oemc(u8, back, sizeof(back)) || std::strcmp(src, back) != 0) {
+			if(ng < 10) std::printf("  SJIS %04X does not round-trip\n", code);
+			++ng;
+		}
+	}
+	UTEST_EQ(ng, 0u);
+}
+
+UTEST(sjis, invalid)
+{
+	char dst[16];
+	UTEST_FALSE(utils::str::oemc_to_utf8("\x82", dst, sizeof(dst)));  // 下位バイトが無い
+	UTEST_EQ(dst[0], 0);
+	UTEST_FALSE(utils::str::oemc_to_utf8("\x82\x20", dst, sizeof(dst)));
+	UTEST_FALSE(utils::str::oemc_to_utf8("\x85\x40", dst, sizeof(dst)));  // 未定義
+	UTEST_TRUE(utils::str::oemc_to_utf8("\xfa\x40", dst, sizeof(dst)));  // 表に無い 0xfa 以降は ff で引く
+	UTEST_STR(dst, "\xe2\x85\xb0");
+	UTEST_TRUE(utils::str::oemc_to_utf8("a\xb1", dst, sizeof(dst)));  // 半角カナ
+	UTEST_STR(dst, "a\xef\xbd\xb1");
+	UTEST_FALSE(utils::str::oemc_to_utf8("\x82\xa0", dst, 3));  // あ（3 バイト）+ NUL は入らない
+	UTEST_EQ(dst[0], 0);
+	UTEST_FALSE(utils::str::utf8_to_oemc("\xed\xa0\x80", dst, sizeof(dst)));  // サロゲート
+	UTEST_FALSE(utils::str::utf8_to_oemc("\xf4\x90\x80\x80", dst, sizeof(dst)));  // 0x10FFFF 超え
+	UTEST_FALSE(utils::str::utf8_to_oemc("\xe0\x80\x80", dst, sizeof(dst)));  // 冗長な表現
+	UTEST_TRUE(utils::str::utf8_to_oemc("\xef\xbd\xb1", dst, sizeof(dst)));
+	UTEST_STR(dst, "\xb1");
+}
+
+UTEST(sjis, utf16_random_round_trip)
+{
+	uint32_t r = 1;
+	uint32_t ng = 0;
+	for(uint32_t n = 0; n < 20000; ++n) {
+		uint16_t src[33];
+		uint32_t i = 0;
+		while(i < 31) {
+			r = r * 1664525 + 1013904223;
+			uint32_t c = (r >> 8) % 0x110000;
+			if(c == 0 || (0xd800 <= c && c <= 0xdfff)) continue;
+			if(c >= 0x10000) {
+				c -= 0x10000;
+				src[i++] = 0xd800 | (c >> 10);
+				src[i++] = 0xdc00 | (c & 0x3ff);
+			} else {
+				src[i++] = c;
+			}
+		}
+		src[i] = 0;
+		char u8[33 * 4];
+		uint16_t back[34];
+		if(!utils::str::utf16_to_utf8(src, u8, sizeof(u8))
+			|| !utils::str::utf8_to_utf16(u8, back, sizeof(back))
+			|| std::memcmp(src, back, (i + 1) * 2) != 0) ++ng;
+	}
+	UTEST_EQ(ng, 0u);
+}
+
+UBENCH(sjis, oemc_to_utf8_4k)
+{
+	static char u8[4096];
+	static char sj[4096];
+	static char out[8192];
+	make_text_(u8, sizeof(u8));
+	utils::str::utf8_to_oemc(u8, sj, sizeof(sj));
+	auto len = std::strlen(sj);
+	while(state.keep_running()) {
+		utils::str::oemc_to_utf8(sj, out, sizeof(out));
+		utest::do_not_optimize(out);
+	}
+	state.set_bytes_processed(state.iterations() * len);
+}
+
+UBENCH(sjis, utf8_to_oemc_4k)
+{
+	static char u8[4096];
+	static char out[4096];
+	auto len = make_text_(u8, sizeof(u8));
+	while(state.keep_running()) {
+		utils::str::utf8_to_oemc(u8, out, sizeof(out));
+		utest::do_not_optimize(out);
+	}
+	state.set_bytes_processed(state.iterations() * len);
+}
+
+UBENCH(sjis, utf8_to_utf16_mixed_4k)
+{
+	static char u8[4096];
+	static uint16_t out[4096];
+	auto len = make_text_(u8, sizeof(u8));
+	while(state.keep_running()) {
+		utils::str::utf8_to_utf16(u8, out, sizeof(out));
+		utest::do_not_optimize(out);
+	}
+	state.set_bytes_processed(state.iterations() * len);
+}
+
+UBENCH(sjis, utf16_to_utf8_mixed_4k)
+{
+	static char u8[4096];
+	static uint16_t u16[4096];
+	static char out[4096];
+	auto len = make_text_(u8, sizeof(u8));
+	utils::str::utf8_to_utf16(u8, u16, sizeof(u16));
+	while(state.keep_running()) {
+		utils::str::utf16_to_utf8(u16, out, sizeof(out));
+		utest::do_not_optimize(out);
+	}
+	state.set_bytes_processed(state.iterations() * len);
+}
+
+UBENCH(sjis, to_utf16_table)
+{
+	uint32_t code = 0x889f;
+	uint32_t sum = 0;
+	while(state.keep_running()) {
+		sum += utils::sjis::to_utf16(code);
+		code = code >= 0x9ffc ? 0x889f : code + 1;
+	}
+	utest::do_not_optimize(sum);
+	state.set_items_processed(state.iterations());
+}
+
+UBENCH(sjis, ff_oem2uni)
+{
+	uint32_t code = 0x889f;
+	uint32_t sum = 0;
+	while(state.keep_running()) {
+		sum += ff_oem2uni(code, 932);
+		code = code >= 0x9ffc ? 0x889f : code + 1;
+	}
+	utest::do_not_optimize(sum);
+	state.set_items_processed(state.iterations());
+}
@@ -0,0 +1,250 @@
+//=====================================================================//
+/*!	@file
+	@brief	sparse_image（rxprog）のテスト @n
+			・重なる、隣接するエクステントと領域を、一つにまとめる事 @n
+			・アドレス空間の終わりで、切り詰める事 @n
+			・乱数で書き込み、参照モデル（フラットな配列）と比べる
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "rxprog/sparse_image.hpp"
+#include <random>
+
+namespace {
+
+	typedef utils::sparse_image IMAGE;
+	static const uint32_t PAGE = IMAGE::PAGE_SIZE;
+
+	// 同じエクステントなら、ページは連続している
+	bool joined_(const IMAGE& img, uint32_t a, uint32_t b)
+	{
+		auto pa = img.get_page(a);
+		auto pb = img.get_page(b);
+		return pa != nullptr && pb != nullptr && (pa + (b - a)) == pb;
+	}
+
+
+	bool area_(const IMAGE& img, uint32_t idx, uint32_t min, uint32_t max)
+	{
+		const auto& as = img.get_areas();
+		if(idx >= as.size()) return false;
+		if(as[idx].min_ == min && as[idx].max_ == max) return true;
+		std::printf("  area[%u]: %08X-%08X (expect %08X-%08X)\n", idx, as[idx].min_, as[idx].max_, min, max);
+		return false;
+	}
+
+
+	void fill_(uint8_t* dst, uint32_t len, uint8_t v)
+	{
+		for(uint32_t i = 0; i < len; ++i) dst[i] = v + i;
+	}
+}
+
+UTEST(sparse_image, write)
+{
+	IMAGE img;
+	UTEST_TRUE(img.empty());
+	uint8_t buf[16];
+	fill_(buf, sizeof(buf), 0x10);
+	img.write(0x1005, buf, 0);
+	UTEST_TRUE(img.empty());
+
+	img.write(0x1005, buf, 10);
+	UTEST_EQ(img.get_page_num(), 1u);
+	auto p = img.get_page(0x10FF);
+	UTEST_TRUE(p != nullptr);
+	UTEST_TRUE(p == img.get_page(0x1000));
+	UTEST_EQ(p[4], 0xFF);
+	UTEST_EQ(p[5], 0x10);
+	UTEST_EQ(p[14], 0x19);
+	UTEST_EQ(p[15], 0xFF);
+	UTEST_TRUE(img.get_page(0x0F00) == nullptr);
+	UTEST_TRUE(img.get_page(0x1100) == nullptr);
+	UTEST_EQ(img.get_areas().size(), 1u);
+	UTEST_TRUE(area_(img, 0, 0x1005, 0x100E));
+
+	// ページをまたぐ書き込み
+	img.write(0x10FC, buf, 8);
+	UTEST_EQ(img.get_page_num(), 2u);
+	UTEST_TRUE(joined_(img, 0x1000, 0x1100));
+	UTEST_EQ(img.get_page(0x1100)[3], 0x17);
+	UTEST_EQ(img.get_areas().size(), 2u);
+	UTEST_TRUE(area_(img, 1, 0x10FC, 0x1103));
+
+	img.clear();
+	UTEST_TRUE(img.empty());
+	UTEST_EQ(img.get_areas().size(), 0u);
+}
+
+UTEST(sparse_image, adjacent)
+{
+	IMAGE img;
+	uint8_t buf[PAGE * 2];
+	fill_(buf, sizeof(buf), 0);
+
+	// 隣接する領域は一つにまとめる（書き込み順によらない）
+	img.write(0x2004, buf, 4);
+	img.write(0x2000, buf, 4);
+	img.write(0x2008, buf, 4);
+	UTEST_EQ(img.get_areas().size(), 1u);
+	UTEST_TRUE(area_(img, 0, 0x2000, 0x200B));
+
+	// 後ろのページに隣接（直前のエクステントを延ばす）
+	img.write(0x2100, buf, PAGE);
+	UTEST_TRUE(joined_(img, 0x2000, 0x2100));
+	UTEST_TRUE(area_(img, 0, 0x2000, 0x200B));
+	UTEST_TRUE(area_(img, 1, 0x2100, 0x21FF));
+
+	// 前のページに隣接
+	img.write(0x1F00, buf, PAGE);
+	UTEST_EQ(img.get_page_num(), 3u);
+	UTEST_TRUE(joined_(img, 0x1F00, 0x2100));
+	UTEST_EQ(img.get_areas().size(), 2u);
+	UTEST_TRUE(area_(img, 0, 0x1F00, 0x200B));
+
+	// 間が空いたエクステントを、間のページで一つにする
+	img.write(0x2300, buf, PAGE);
+	UTEST_TRUE(img.get_page(0x2200) == nullptr);
+	UTEST_FALSE(joined_(img, 0x2100, 0x2300));
+	img.write(0x2250, buf, 1);
+	UTEST_EQ(img.get_page_num(), 5u);
+	UTEST_TRUE(joined_(img, 0x1F00, 0x2300));
+	UTEST_EQ(img.get_page(0x2300)[0], 0x00);
+	UTEST_EQ(img.get_page(0x2300)[255], 0xFF);
+	UTEST_EQ(img.get_areas().size(), 4u);
+	UTEST_TRUE(area_(img, 2, 0x2250, 0x2250));
+	UTEST_TRUE(area_(img, 3, 0x2300, 0x23FF));
+}
+
+UTEST(sparse_image, overlap)
+{
+	IMAGE img;
+	uint8_t a[PAGE];
+	uint8_t b[PAGE * 4];
+	fill_(a, sizeof(a), 0x40);
+	fill_(b, sizeof(b), 0x80);
+
+	img.write(0x3000, a, PAGE);
+	img.write(0x3400, a, PAGE);
+	img.write(0x3800, a, PAGE);
+	UTEST_EQ(img.get_page_num(), 3u);
+	UTEST_EQ(img.get_areas().size(), 3u);
+
+	// 二つのエクステントにかかる書き込み（前と後ろのデータは残る）
+	img.write(0x3080, b, 0x400);
+	UTEST_EQ(img.get_page_num(), 6u);
+	UTEST_TRUE(joined_(img, 0x3000, 0x3400));
+	UTEST_FALSE(joined_(img, 0x3400, 0x3800));
+	auto p = img.get_page(0x3000);
+	UTEST_EQ(p[0x7F], static_cast<uint8_t>(0x40 + 0x7F));
+	UTEST_EQ(p[0x80], 0x80);
+	UTEST_EQ(p[0x47F], static_cast<uint8_t>(0x80 + 0x3FF));
+	UTEST_EQ(p[0x480], static_cast<uint8_t>(0x40 + 0x80));
+	UTEST_EQ(img.get_areas().size(), 2u);
+	UTEST_TRUE(area_(img, 0, 0x3000, 0x34FF));
+	UTEST_TRUE(area_(img, 1, 0x3800, 0x38FF));
+
+	// 全てを覆う書き込み（前に戻った位置から）
+	img.write(0x2F00, b, PAGE * 4);
+	img.write(0x3400, b, PAGE * 4);
+	UTEST_EQ(img.get_page_num(), 10u);
+	UTEST_TRUE(joined_(img, 0x2F00, 0x3800));
+	UTEST_EQ(img.get_areas().size(), 1u);
+	UTEST_TRUE(area_(img, 0, 0x2F00, 0x38FF));
+	UTEST_EQ(img.get_page(0x3800)[0], 0x40);
+}
+
+UTEST(sparse_image, address_end)
+{
+	IMAGE img;
+	uint8_t buf[64];
+	fill_(buf, sizeof(buf), 1);
+
+	// アドレス空間を越える分は捨てる
+	img.write(0xFFFFFFF0, buf, 32);
+	UTEST_EQ(img.get_page_num(), 1u);
+	auto p = img.get_page(0xFFFFFFFF);
+	UTEST_TRUE(p != nullptr);
+	UTEST_EQ(p[0xEF], 0xFF);
+	UTEST_EQ(p[0xF0], 1);
+	UTEST_EQ(p[0xFF], 16);
+	UTEST_EQ(img.get_areas().size(), 1u);
+	UTEST_TRUE(area_(img, 0, 0xFFFFFFF0, 0xFFFFFFFF));
+
+	// 最後のページの前に隣接
+	img.write(0xFFFFFEC0, buf, 64);
+	UTEST_TRUE(joined_(img, 0xFFFFFE00, 0xFFFFFF00));
+	UTEST_EQ(img.get_areas().size(), 2u);
+	img.write(0xFFFFFF00, buf, 64);
+	img.write(0xFFFFFF40, buf, 64);
+	img.write(0xFFFFFF80, buf, 64);
+	img.write(0xFFFFFFC0, buf, 64);
+	UTEST_EQ(img.get_page_num(), 2u);
+	UTEST_EQ(img.get_areas().size(), 1u);
+	UTEST_TRUE(area_(img, 0, 0xFFFFFEC0, 0xFFFFFFFF));
+
+	// 先頭
+	img.write(0x00000000, buf, 1);
+	UTEST_EQ(img.get_areas().size(), 2u);
+	UTEST_TRUE(area_(img, 0, 0, 0));
+	UTEST_EQ(img.get_page(0x00)[0], 1);
+}
+
+UTEST(sparse_image, model)
+{
+	// 64K の窓に、乱数の位置、長さ、順番で書き込む
+	static const uint32_t ORG = 0xFFFF0000;
+	static const uint32_t SIZE = 0x10000;
+	std::vector<int16_t> ref(SIZE, -1);
+	std::mt19937 rnd(12345);
+	uint8_t buf[1024];
+	uint32_t ng = 0;
+	for(uint32_t loop = 0; loop < 20; ++loop) {
+		IMAGE img;
+		std::fill(ref.begin(), ref.end(), -1);
+		for(uint32_t n = 0; n < 200; ++n) {
+			uint32_t ofs = rnd() % SIZE;
+			uint32_t len = 1 + rnd() % ((n & 3) == 0 ? sizeof(buf) : 40);
+			for(uint32_t i = 0; i < len; ++i) buf[i] = rnd();
+			img.write(ORG + ofs, buf, len);
+			for(uint32_t i = 0; i < len && (ofs + i) < SIZE; ++i) ref[ofs + i] = buf[i];
+		}
+
+		uint32_t pages = 0;
+		for(uint32_t pg = 0; pg < SIZE; pg += PAGE) {
+			bool use = false;
+			for(uint32_t i = 0; i < PAGE; ++i) if(ref[pg + i] >= 0) use = true;
+			auto p = img.get_page(ORG + pg);
+			if(use != (p != nullptr)) { ++ng; continue; }
+			if(!use) continue;
+			++pages;
+			for(uint32_t i = 0; i < PAGE; ++i) {
+				int16_t v = ref[pg + i] < 0 ? 0xFF : ref[pg + i];
+				if(p[i] != v) ++ng;
+			}
+			// 隣接するページは、同じエクステント
+			if(pg > 0 && img.get_page(ORG + pg - PAGE) != nullptr && !joined_(img, ORG + pg - PAGE, ORG + pg)) ++ng;
+		}
+		if(img.get_page_num() != pages) ++ng;
+
+		// 書き込まれたバイトの連続した範囲
+		IMAGE::areas as;
+		for(uint32_t i = 0; i < SIZE; ++i) {
+			if(ref[i] < 0) continue;
+			if(!as.empty() && (as.back().max_ + 1) == (ORG + i)) as.back().max_ = ORG + i;
+			else as.emplace_back(ORG + i, ORG + i);
+		}
+		const auto& ia = img.get_areas();
+		if(ia.size() != as.size()) ++ng;
+		else {
+			for(uint32_t i = 0; i < as.size(); ++i) {
+				if(ia[i].min_ != as[i].min_ || ia[i].max_ != as[i].max_) ++ng;
+			}
+		}
+	}
+	UTEST_EQ(ng, 0u);
+}
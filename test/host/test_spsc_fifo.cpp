@@ -0,0 +1,160 @@
+//=====================================================================//
+/*!	@file
+	@brief	spsc_fifo のテスト @n
+			・書き込み、読み出しを別スレッドにして、順番と値が崩れないか調べる @n
+			　（spsc_fifo はコンパイラー・バリアだけなので、ストアの順番が保たれる @n
+			　　x86 などのホストと、RX の割り込み／タスク間で有効）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "common/spsc_fifo.hpp"
+#include "common/fixed_fifo.hpp"
+#include <thread>
+
+UTEST(spsc_fifo, put_get)
+{
+	utils::spsc_fifo<uint8_t, 8> f;
+	UTEST_EQ(f.size(), 8u);
+	for(uint8_t i = 0; i < 8; ++i) f.put(i);  // SIZE 個全て使える
+	UTEST_EQ(f.length(), 8u);
+	UTEST_EQ(f.space(), 0u);
+	for(uint8_t i = 0; i < 8; ++i) UTEST_EQ(f.get(), i);
+	UTEST_EQ(f.length(), 0u);
+}
+
+UTEST(spsc_fifo, span)
+{
+	utils::spsc_fifo<uint16_t, 16> f;
+	for(uint16_t i = 0; i < 12; ++i) f.put(i);
+	for(uint16_t i = 0; i < 12; ++i) f.get();
+	// put 位置は 12、終端までの 4 個が連続領域
+	auto ws = f.write_span();
+	UTEST_EQ(ws.len, 4u);
+	for(uint32_t i = 0; i < ws.len; ++i) ws.ptr[i] = 100 + i;
+	f.put_go(ws.len);
+	ws = f.write_span();
+	UTEST_EQ(ws.len, 12u);
+	uint16_t src[6] = { 104, 105, 106, 107, 108, 109 };
+	UTEST_EQ(f.write(src, 6), 6u);
+	auto rs = f.read_span();
+	UTEST_EQ(rs.len, 4u);
+	UTEST_EQ(rs.ptr[0], 100);
+	uint16_t dst[16];
+	UTEST_EQ(f.read(dst, 16), 10u);
+	for(uint16_t i = 0; i < 10; ++i) UTEST_EQ(dst[i], 100 + i);
+}
+
+UTEST(spsc_fifo, two_thread_stress)
+{
+	static const uint32_t num = 4000000;
+	static utils::spsc_fifo<uint32_t, 64> f;
+	f.clear();
+	std::thread prod([] {
+		uint32_t n = 0;
+		uint32_t buf[23];
+		while(n < num) {
+			if((n & 1) != 0 && f.space() > 0) {  // １つずつ
+				f.put(n++);
+				continue;
+			}
+			// まとめて
+			uint32_t len = (n % 23) + 1;
+			if(len > (num - n)) len = num - n;
+			for(uint32_t i = 0; i < len; ++i) buf[i] = n + i;
+			auto m = f.write(buf, len);
+			if(m == 0) std::this_thread::yield();  // CPU が１つでも進むように
+			n += m;
+		}
+	});
+	uint32_t expect = 0;
+	uint32_t ng = 0;
+	while(expect < num && ng < 10) {
+		if((expect & 3) == 0) {
+			auto sp = f.read_span();
+			for(uint32_t i = 0; i < sp.len; ++i) {
+				if(sp.ptr[i] != expect + i) ++ng;
+			}
+			if(sp.len == 0) std::this_thread::yield();
+			f.get_go(sp.len);
+			expect += sp.len;
+		} else if(f.length() > 0) {
+			if(f.get() != expect) ++ng;
+			++expect;
+		} else {
+			std::this_thread::yield();
+		}
+	}
+	prod.join();
+	UTEST_EQ(ng, 0u);
+	UTEST_EQ(expect, num);
+	UTEST_EQ(f.length(), 0u);
+}
+
+UBENCH(spsc_fifo, put_get_256)
+{
+	utils::spsc_fifo<uint8_t, 512> f;
+	while(state.keep_running()) {
+		for(uint32_t i = 0; i < 256; ++i) f.put(i);
+		uint32_t sum = 0;
+		for(uint32_t i = 0; i < 256; ++i) sum += f.get();
+		utest::do_not_optimize(sum);
+	}
+	state.set_bytes_processed(state.iterations() * 256);
+}
+
+UBENCH(spsc_fifo, write_read_256)
+{
+	utils::spsc_fifo<uint8_t, 512> f;
+	uint8_t src[256];
+	uint8_t dst[256];
+	for(uint32_t i = 0; i < 256; ++i) src[i] = i;
+	while(state.keep_running()) {
+		f.write(src, 256);
+		f.read(dst, 256);
+		utest::do_not_optimize(dst);
+	}
+	state.set_bytes_processed(state.iterations() * 256);
+}
+
+UBENCH(spsc_fifo, two_thread_4k_block)
+{
+	// 別スレッドへ、4096 個ずつ流す（fixed_fifo の比較は put_get_256）
+	static utils::spsc_fifo<uint32_t, 1024> f;
+	f.clear();
+	uint64_t num = state.iterations() * 4096;
+	std::thread prod([num] {
+		uint32_t buf[256];
+		for(uint32_t i = 0; i < 256; ++i) buf[i] = i;
+		uint64_t n = 0;
+		while(n < num) {
+			uint32_t len = (num - n) < 256 ? (num - n) : 256;
+			auto m = f.write(buf, len);
+			if(m == 0) std::this_thread::yield();
+			n += m;
+		}
+	});
+	uint64_t n = 0;
+	uint32_t sum = 0;
+	while(state.keep_running()) {
+		uint32_t m = 0;
+		while(m < 4096) {
+			auto sp = f.read_span();
+			if(sp.len == 0) {
+				std::this_thread::yield();
+				continue;
+			}
+			if(sp.len > (4096 - m)) sp.len = 4096 - m;
+			for(uint32_t i = 0; i < sp.len; ++i) sum += sp.ptr[i];
+			f.get_go(sp.len);
+			m += sp.len;
+		}
+		n += m;
+	}
+	prod.join();
+	utest::do_not_optimize(sum);
+	state.set_bytes_processed(n * sizeof(uint32_t));
+}
@@ -0,0 +1,241 @@
+//=====================================================================//
+/*!	@file
+	@brief	static_format（cformat、csformat、csize_format）のテスト @n
+			・同じ書式、同じ引数で、utils::format（sformat）と１バイトも違わない事 @n
+			・エラー種別、出力サイズも同じ事 @n
+			・ベンチマークは、format、sformat、size_format との比較（items/s = 行数）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "common/static_format.hpp"
+
+namespace {
+
+	// 書式を一度だけ書く（UTILS_FORM と、sformat に渡す文字列）
+#define SAME_(form, ...) same_(UTILS_FORM(form), form, ## __VA_ARGS__)
+
+	template <class FORM, typename... ARGS>
+	bool same_(FORM f, const char* form, ARGS... args)
+	{
+		char a[128] = { };
+		char b[128] = { };
+		// csformat と sformat は、同じ memory_chaout を使うので、順番に行う
+		auto ea = (utils::csformat(f, a, sizeof(a)) % ... % args).get_error();
+		auto eb = (utils::sformat(form, b, sizeof(b)) % ... % args).get_error();
+		if(std::strcmp(a, b) == 0 && ea == eb) return true;
+		std::printf("  \"%s\": \"%s\" (%d) vs sformat \"%s\" (%d)\n", form, a,
+			static_cast<int>(ea), b, static_cast<int>(eb));
+		return false;
+	}
+
+	// 出力サイズ（csize_format、size_format は、同じ size_chaout を使う）
+	template <class FORM, typename... ARGS>
+	bool same_size_(FORM f, const char* form, ARGS... args)
+	{
+		auto& out = utils::size_format::chaout();
+		out.clear();
+		(utils::csize_format(f) % ... % args);
+		auto a = out.size();
+		out.clear();
+		(utils::size_format(form) % ... % args);
+		auto b = out.size();
+		if(a == b) return true;
+		std::printf("  \"%s\": size %u vs size_format %u\n", form, a, b);
+		return false;
+	}
+
+	static const int32_t ivals_[] = { 0, 1, -1, 9, 10, 99, -100, 12345, -65536,
+		2147483647, -2147483647 };
+}
+
+UTEST(static_format, integer)
+{
+	for(auto v : ivals_) {
+		auto u = static_cast<uint32_t>(v);
+		UTEST_TRUE(SAME_("%d", v));
+		UTEST_TRUE(SAME_("%i", v));
+		UTEST_TRUE(SAME_("%5d", v));
+		UTEST_TRUE(SAME_("%-5d|", v));
+		UTEST_TRUE(SAME_("%05d", v));
+		UTEST_TRUE(SAME_("%+d", v));
+		UTEST_TRUE(SAME_("%+6d", v));
+		UTEST_TRUE(SAME_("%u", u));
+		UTEST_TRUE(SAME_("%x", u));
+		UTEST_TRUE(SAME_("%X", u));
+		UTEST_TRUE(SAME_("%08X", u));
+		UTEST_TRUE(SAME_("%-10x|", u));
+		UTEST_TRUE(SAME_("%o", u));
+		UTEST_TRUE(SAME_("%b", u));
+		UTEST_TRUE(SAME_("%040b", u));
+	}
+	UTEST_TRUE(SAME_("%d", static_cast<int8_t>(-5)));
+	UTEST_TRUE(SAME_("%u", static_cast<uint16_t>(65535)));
+	UTEST_TRUE(SAME_("%X", static_cast<int16_t>(-1)));
+}
+
+UTEST(static_format, string_char)
+{
+	UTEST_TRUE(SAME_("%s", "hello"));
+	UTEST_TRUE(SAME_("[%10s]", "abc"));
+	UTEST_TRUE(SAME_("[%-10s]", "abc"));
+	UTEST_TRUE(SAME_("[%010s]", "abc"));
+	UTEST_TRUE(SAME_("%s", std::string("std::string")));
+	UTEST_TRUE(SAME_("%s", static_cast<const char*>(nullptr)));
+	UTEST_TRUE(SAME_("%c", 'A'));
+	UTEST_TRUE(SAME_("[%3c]", 'z'));
+	UTEST_TRUE(SAME_("%c", 300));
+	UTEST_TRUE(SAME_("100%%"));
+	UTEST_TRUE(SAME_("%%%d%%", 7));
+	UTEST_TRUE(SAME_("literal only"));
+}
+
+UTEST(static_format, pointer)
+{
+	int x = 0;
+	UTEST_TRUE(SAME_("%p", &x));
+	UTEST_TRUE(SAME_("%p", static_cast<const void*>(nullptr)));
+}
+
+UTEST(static_format, float_fixed)
+{
+	static const float vals[] = { 0.0f, 1.0f, -1.5f, 3.14159f, 0.1f, 123456.789f, 1e-3f };
+	for(auto v : vals) {
+		UTEST_TRUE(SAME_("%f", v));
+		UTEST_TRUE(SAME_("%.3f", v));
+		UTEST_TRUE(SAME_("%10.2f|", v));
+		UTEST_TRUE(SAME_("%e", v));
+		UTEST_TRUE(SAME_("%g", v));
+	}
+	UTEST_TRUE(SAME_("%.10f", 2.718281828459045));
+	// 固定小数点（小数部のビット数を「:」の後に指定）
+	static const int32_t fvals[] = { 0, 0x100, 0x180, 0x1234, 0x7fff, 3 };
+	for(auto v : fvals) {
+		UTEST_TRUE(SAME_("%:8y", v));
+		UTEST_TRUE(SAME_("%5.2:8y", v));
+		UTEST_TRUE(SAME_("%3.4:12y", v));
+	}
+}
+
+UTEST(static_format, mixed)
+{
+	UTEST_TRUE(SAME_("%d: %s, %08X\n", 123, "abc", 0xdeadbeefu));
+	UTEST_TRUE(SAME_("(%d,%d) %c%c %5.1f%%", -3, 4, 'o', 'k', 99.5f));
+	UTEST_TRUE(SAME_("  %-6s|%6s|%06d|%x", "ab", "cd", -42, 255u));
+}
+
+UTEST(static_format, truncate_append)
+{
+	char a[8];
+	char b[8];
+	utils::csformat(UTILS_FORM("%s-%d"), a, sizeof(a)) % "abcdef" % 123;
+	utils::sformat("%s-%d", b, sizeof(b)) % "abcdef" % 123;
+	UTEST_STR(a, b);
+
+	char c[32];
+	utils::csformat(UTILS_FORM("a=%d"), c, sizeof(c)) % 1;
+	utils::csformat(UTILS_FORM(", b=%d"), c, sizeof(c), true) % 2;
+	UTEST_STR(c, "a=1, b=2");
+}
+
+UTEST(static_format, size)
+{
+	UTEST_TRUE(same_size_(UTILS_FORM("%d: %s, %08X\n"), "%d: %s, %08X\n", -123, "abc", 0x55u));
+	UTEST_TRUE(same_size_(UTILS_FORM("%10.3f|%-8s|"), "%10.3f|%-8s|", 1.25f, "x"));
+	UTEST_TRUE(same_size_(UTILS_FORM("%b"), "%b", 0x12345u));
+}
+
+UTEST(static_format, instance_chaout)
+{
+	// インスタンス毎の出力ファンクタ
+	char a[32];
+	char b[32];
+	utils::memory_chaout ca(a, sizeof(a));
+	utils::memory_chaout cb(b, sizeof(b));
+	utils::cformat(ca, UTILS_FORM("%d/%s")) % 123 % "x";
+	utils::sformat(cb, "%d/%s") % 123 % "x";
+	UTEST_STR(a, b);
+	UTEST_EQ(ca.size(), cb.size());
+}
+
+namespace {
+
+	typedef utils::line_chaout<256, utils::null_term> LINE;
+
+	static const char* str_[] = { "abc", "defgh", "i", "jklmnopq" };
+}
+
+// format と同じ、行バッファの出力（ターミネーターは捨てる）
+UBENCH(static_format, cformat_line)
+{
+	LINE out;
+	int32_t v = 0;
+	while(state.keep_running()) {
+		utils::cformat(out, UTILS_FORM("%d: %s, %08X\n")) % v % str_[v & 3] % static_cast<uint32_t>(v);
+		v += 12345;
+	}
+	utest::do_not_optimize(out.size());
+	state.set_items_processed(state.iterations());
+}
+
+UBENCH(static_format, format_line)
+{
+	LINE out;
+	int32_t v = 0;
+	while(state.keep_running()) {
+		utils::basic_format<LINE>(out, "%d: %s, %08X\n") % v % str_[v & 3] % static_cast<uint32_t>(v);
+		v += 12345;
+	}
+	utest::do_not_optimize(out.size());
+	state.set_items_processed(state.iterations());
+}
+
+UBENCH(static_format, csformat)
+{
+	char buf[64];
+	int32_t v = 0;
+	while(state.keep_running()) {
+		utils::csformat(UTILS_FORM("%d: %s, %08X\n"), buf, sizeof(buf))
+			% v % str_[v & 3] % static_cast<uint32_t>(v);
+		utest::do_not_optimize(buf);
+		v += 12345;
+	}
+	state.set_items_processed(state.iterations());
+}
+
+UBENCH(static_format, sformat)
+{
+	char buf[64];
+	int32_t v = 0;
+	while(state.keep_running()) {
+		utils::sformat("%d: %s, %08X\n", buf, sizeof(buf)) % v % str_[v & 3] % static_cast<uint32_t>(v);
+		utest::do_not_optimize(buf);
+		v += 12345;
+	}
+	state.set_items_processed(state.iterations());
+}
+
+UBENCH(static_format, csize_format)
+{
+	int32_t v = 0;
+	while(state.keep_running()) {
+		utils::csize_format(UTILS_FORM("%d: %s, %08X\n")) % v % str_[v & 3] % static_cast<uint32_t>(v);
+		v += 12345;
+	}
+	utest::do_not_optimize(utils::size_format::chaout().size());
+	state.set_items_processed(state.iterations());
+}
+
+UBENCH(static_format, size_format)
+{
+	int32_t v = 0;
+	while(state.keep_running()) {
+		utils::size_format("%d: %s, %08X\n") % v % str_[v & 3] % static_cast<uint32_t>(v);
+		v += 12345;
+	}
+	utest::do_not_optimize(utils::size_format::chaout().size());
+	state.set_items_processed(state.iterations());
+}
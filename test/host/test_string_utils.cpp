@@ -0,0 +1,135 @@
+//=====================================================================//
+/*!	@file
+	@brief	string_utils（utils::str）のテスト
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "common/string_utils.hpp"
+
+UTEST(string_utils, strncpy_)
+{
+	char buf[4];
+	utils::str::strncpy_(buf, "ab", sizeof(buf));
+	UTEST_STR(buf, "ab");
+	utils::str::strncpy_(buf, "abcdef", sizeof(buf));
+	UTEST_STR(buf, "abc");
+}
+
+UTEST(string_utils, get_file_base)
+{
+	char buf[32];
+	UTEST_TRUE(utils::str::get_file_base("/sd/music/track01.wav", buf, sizeof(buf)));
+	UTEST_STR(buf, "track01");
+	UTEST_TRUE(utils::str::get_file_base("a.b.c", buf, sizeof(buf)));
+	UTEST_STR(buf, "a.b");
+	UTEST_TRUE(utils::str::get_file_base("/sd/long_name.wav", buf, 5));
+	UTEST_STR(buf, "long");
+	UTEST_FALSE(utils::str::get_file_base("/sd/name", buf, sizeof(buf)));
+}
+
+UTEST(string_utils, words)
+{
+	const char* src = "  ls  -l   /sd\\ card ";
+	UTEST_EQ(utils::str::get_words(src), 3u);
+	char buf[16];
+	UTEST_TRUE(utils::str::get_word(src, 0, buf, sizeof(buf)));
+	UTEST_STR(buf, "ls");
+	UTEST_TRUE(utils::str::get_word(src, 1, buf, sizeof(buf)));
+	UTEST_STR(buf, "-l");
+	UTEST_TRUE(utils::str::get_word(src, 2, buf, sizeof(buf)));
+	UTEST_STR(buf, "/sd card");
+	UTEST_TRUE(utils::str::cmp_word(src, 1, "-l"));
+	UTEST_FALSE(utils::str::cmp_word(src, 1, "-a"));
+	UTEST_EQ(utils::str::get_words("a,b,,c", ','), 3u);
+}
+
+UTEST(string_utils, utf8_utf16)
+{
+	// "aあ𠀋"（BMP 外はサロゲート・ペア）
+	const char* src = "a\xe3\x81\x82\xf0\xa0\x80\x8b";
+	uint16_t u16[8];
+	UTEST_TRUE(utils::str::utf8_to_utf16(src, u16, sizeof(u16)));
+	UTEST_EQ(u16[0], 'a');
+	UTEST_EQ(u16[1], 0x3042);
+	UTEST_EQ(u16[2], 0xd840);
+	UTEST_EQ(u16[3], 0xdc0b);
+	UTEST_EQ(u16[4], 0);
+	char back[16];
+	UTEST_TRUE(utils::str::utf16_to_utf8(u16, back, sizeof(back)));
+	UTEST_STR(back, src);
+
+	// 不正な UTF-8
+	UTEST_FALSE(utils::str::utf8_to_utf16("\xc0\xaf", u16, sizeof(u16)));
+	UTEST_FALSE(utils::str::utf8_to_utf16("\xe3\x81", u16, sizeof(u16)));
+	// 変換先が足りない
+	UTEST_FALSE(utils::str::utf8_to_utf16("abcdefgh", u16, 4 * sizeof(uint16_t)));
+	// 対の無いサロゲート
+	const uint16_t bad[] = { 0xd800, 'a', 0 };
+	UTEST_FALSE(utils::str::utf16_to_utf8(bad, back, sizeof(back)));
+}
+
+UTEST(string_utils, utf8_length)
+{
+	UTEST_EQ(utils::str::utf8_string_length("abc"), 3u);
+	UTEST_EQ(utils::str::utf8_string_length("\xe3\x81\x82\xe3\x81\x84"), 4u);
+}
+
+UTEST(string_utils, url)
+{
+	char buf[64];
+	utils::str::url_encode_to_str("a%20b%2Fc", buf, sizeof(buf));
+	UTEST_STR(buf, "a b/c");
+}
+
+UTEST(string_utils, no_caps)
+{
+	UTEST_EQ(utils::str::strcmp_no_caps("Hello", "hELLO"), 0);
+	UTEST_TRUE(utils::str::strcmp_no_caps("abc", "abd") < 0);
+	UTEST_TRUE(utils::str::scan_ext("/sd/IMAGE.JPG", "bmp,jpg,png"));
+	UTEST_FALSE(utils::str::scan_ext("/sd/image.gif", "bmp,jpg,png"));
+}
+
+UBENCH(string_utils, utf8_to_utf16_ascii_4k)
+{
+	static char src[4096];
+	static uint16_t dst[4096];
+	for(uint32_t i = 0; i < sizeof(src) - 1; ++i) src[i] = 'a' + (i % 26);
+	while(state.keep_running()) {
+		utils::str::utf8_to_utf16(src, dst, sizeof(dst));
+		utest::clobber_memory();
+	}
+	state.set_bytes_processed(state.iterations() * (sizeof(src) - 1));
+}
+
+UBENCH(string_utils, utf8_to_utf16_kana_4k)
+{
+	static char src[4096 + 1];
+	static uint16_t dst[4096];
+	for(uint32_t i = 0; i < 4095 / 3; ++i) {
+		src[i * 3 + 0] = '\xe3';
+		src[i * 3 + 1] = '\x81';
+		src[i * 3 + 2] = static_cast<char>(0x82 + (i % 16));
+	}
+	while(state.keep_running()) {
+		utils::str::utf8_to_utf16(src, dst, sizeof(dst));
+		utest::clobber_memory();
+	}
+	state.set_bytes_processed(state.iterations() * (4095 / 3 * 3));
+}
+
+UBENCH(string_utils, get_word)
+{
+	const char* src = "write 0x1000 0x2000 0x3000 file.bin";
+	char buf[32];
+	while(state.keep_running()) {
+		for(uint32_t i = 0; i < 5; ++i) {
+			utils::str::get_word(src, i, buf, sizeof(buf));
+			utest::do_not_optimize(buf);
+		}
+	}
+	state.set_items_processed(state.iterations() * 5);
+}
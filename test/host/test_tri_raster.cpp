@@ -0,0 +1,255 @@
+//=====================================================================//
+/*!	@file
+	@brief	tri_raster（ソフトウェア三角形ラスタライザー）のテスト @n
+			・タイルの判定を省いた結果が、画素毎のエッジ関数と同じか調べる
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "common/format.hpp"
+#include "glcdc_stub.hpp"
+#include "graphics/graphics.hpp"
+
+namespace {
+
+	static constexpr int16_t W = 160;
+	static constexpr int16_t H = 120;
+	typedef graphics::tri_raster<W> RASTER;
+	typedef RASTER::vertex VTX;
+
+	uint32_t rand_ = 7;
+
+	uint32_t rand32_()
+	{
+		rand_ ^= rand_ << 13;
+		rand_ ^= rand_ >> 17;
+		rand_ ^= rand_ << 5;
+		return rand_;
+	}
+
+	// 画面の少し外まで（小数４ビット）
+	VTX rand_vtx_()
+	{
+		return VTX(static_cast<int32_t>(rand32_() % ((W + 40) * 16)) - 20 * 16,
+			static_cast<int32_t>(rand32_() % ((H + 40) * 16)) - 20 * 16);
+	}
+
+	// 画素の中心が、三角形に含まれるか（左上ルール）
+	bool inside_(const VTX& a, const VTX& b, const VTX& c, int32_t px, int32_t py)
+	{
+		int64_t area = static_cast<int64_t>(b.x - a.x) * (c.y - a.y)
+			- static_cast<int64_t>(b.y - a.y) * (c.x - a.x);
+		const VTX* p[3] = { &a, &b, &c };
+		if(area < 0) std::swap(p[1], p[2]);
+		int32_t x = px * 16 + 8;
+		int32_t y = py * 16 + 8;
+		for(uint32_t i = 0; i < 3; ++i) {
+			const VTX& s = *p[(i + 1) % 3];
+			const VTX& e = *p[(i + 2) % 3];
+			int64_t ea = s.y - e.y;
+			int64_t eb = e.x - s.x;
+			int64_t v = ea * (x - s.x) + eb * (y - s.y);
+			bool top_left = ea > 0 || (ea == 0 && eb > 0);
+			if(v < 0 || (v == 0 && !top_left)) return false;
+		}
+		return true;
+	}
+}
+
+UTEST(tri_raster, coverage_vs_reference)
+{
+	static uint16_t fb[W * H];
+	RASTER ras;
+	ras.set_color(0xffff);
+	vtx::srect clip(0, 0, W, H);
+	uint32_t ng = 0;
+	for(uint32_t n = 0; n < 2000 && ng < 5; ++n) {
+		std::memset(fb, 0, sizeof(fb));
+		auto a = rand_vtx_();
+		auto b = rand_vtx_();
+		auto c = rand_vtx_();
+		ras.draw(fb, clip, a, b, c);
+		for(int32_t y = 0; y < H; ++y) {
+			for(int32_t x = 0; x < W; ++x) {
+				bool in = inside_(a, b, c, x, y);
+				if(in != (fb[y * W + x] != 0)) {
+					std::printf("  (%d,%d) (%d,%d) (%d,%d): pixel %d,%d\n",
+						a.x, a.y, b.x, b.y, c.x, c.y, x, y);
+					++ng;
+					y = H;
+					break;
+				}
+			}
+		}
+	}
+	UTEST_EQ(ng, 0u);
+}
+
+UTEST(tri_raster, shared_edge)
+{
+	// 辺を共有する扇形の三角形は、重ならず、隙間も無い
+	static uint16_t fb[W * H];
+	static uint16_t cnt[W * H];
+	RASTER ras;
+	ras.set_color(1);
+	vtx::srect clip(0, 0, W, H);
+	std::memset(cnt, 0, sizeof(cnt));
+	VTX cen(80 * 16 + 5, 60 * 16 + 3);
+	static const uint32_t num = 37;
+	VTX rim[num];
+	for(uint32_t i = 0; i < num; ++i) {
+		float a = 2.0f * vtx::get_pi<float>() * static_cast<float>(i) / static_cast<float>(num);
+		rim[i] = VTX(cen.x + static_cast<int32_t>(std::cos(a) * 50.0f * 16.0f),
+			cen.y + static_cast<int32_t>(std::sin(a) * 50.0f * 16.0f));
+	}
+	for(uint32_t i = 0; i < num; ++i) {
+		std::memset(fb, 0, sizeof(fb));
+		ras.draw(fb, clip, cen, rim[i], rim[(i + 1) % num]);
+		for(uint32_t j = 0; j < W * H; ++j) cnt[j] += fb[j];
+	}
+	uint32_t over = 0;
+	uint32_t hole = 0;
+	for(int32_t y = 0; y < H; ++y) {
+		for(int32_t x = 0; x < W; ++x) {
+			auto c = cnt[y * W + x];
+			if(c > 1) ++over;
+			// 多角形の内側（どれかの三角形に含まれる）なら、１回だけ
+			bool in = false;
+			for(uint32_t i = 0; i < num; ++i) {
+				if(inside_(cen, rim[i], rim[(i + 1) % num], x, y)) { in = true; break; }
+			}
+			if(in && c == 0) ++hole;
+		}
+	}
+	UTEST_EQ(over, 0u);
+	UTEST_EQ(hole, 0u);
+}
+
+UTEST(tri_raster, clip)
+{
+	static uint16_t fb[W * H];
+	std::memset(fb, 0, sizeof(fb));
+	RASTER ras;
+	ras.set_color(0xffff);
+	vtx::srect clip(10, 20, 30, 40);
+	ras.draw(fb, clip, VTX(-100 * 16, -100 * 16), VTX(400 * 16, 0), VTX(0, 400 * 16));
+	uint32_t in = 0;
+	uint32_t out = 0;
+	for(int32_t y = 0; y < H; ++y) {
+		for(int32_t x = 0; x < W; ++x) {
+			bool c = clip.is_focus(vtx::spos(x, y));
+			if(fb[y * W + x] != 0) {
+				if(c) ++in;
+				else ++out;
+			}
+		}
+	}
+	UTEST_EQ(in, 30u * 40u);
+	UTEST_EQ(out, 0u);
+}
+
+UTEST(tri_raster, gouraud_flat_color)
+{
+	static uint16_t fb[W * H];
+	std::memset(fb, 0, sizeof(fb));
+	RASTER ras;
+	ras.set_shade(RASTER::SHADE::GOURAUD);
+	VTX v[3] = { VTX(10 * 16, 10 * 16), VTX(100 * 16, 20 * 16), VTX(30 * 16, 90 * 16) };
+	for(auto& t : v) { t.r = 255; t.g = 0; t.b = 0; }
+	ras.draw(fb, vtx::srect(0, 0, W, H), v[0], v[1], v[2]);
+	uint32_t ng = 0;
+	uint32_t num = 0;
+	for(auto c : fb) {
+		if(c == 0) continue;
+		++num;
+		if(c != 0xf800) ++ng;
+	}
+	UTEST_TRUE(num > 0);
+	UTEST_EQ(ng, 0u);
+	UTEST_FALSE(ras.draw(fb, vtx::srect(0, 0, W, H), v[0], v[0], v[1]));  // 面積が無い
+}
+
+UTEST(tri_raster, render_quad_d)
+{
+	// render::quad_d の２つの三角形で、矩形がちょうど埋まる
+	typedef stub::glcdc<W, H> GLC;
+	static GLC glc;
+	graphics::afont_null af;
+	graphics::kfont_null kf;
+	graphics::font_null font(af, kf);
+	graphics::render<GLC> rdr(glc, font);
+	rdr.clear(graphics::def_color::Black);
+	rdr.set_fore_color(graphics::def_color::White);
+	rdr.quad_d(vtx::spos(20 * 16, 10 * 16), vtx::spos(70 * 16, 10 * 16),
+		vtx::spos(70 * 16, 40 * 16), vtx::spos(20 * 16, 40 * 16));
+	auto fb = static_cast<const uint16_t*>(glc.get_fbp());
+	uint32_t num = 0;
+	uint32_t ng = 0;
+	for(int32_t y = 0; y < H; ++y) {
+		for(int32_t x = 0; x < W; ++x) {
+			bool on = fb[y * W + x] != 0;
+			if(on) ++num;
+			if(on != (x >= 20 && x < 70 && y >= 10 && y < 40)) ++ng;
+		}
+	}
+	UTEST_EQ(num, 50u * 30u);
+	UTEST_EQ(ng, 0u);
+}
+
+namespace {
+
+	void bench_tri_(utest::state& state, int32_t size, RASTER::SHADE shade, bool texture)
+	{
+		static uint16_t fb[W * H];
+		static uint32_t tex[64 * 64];
+		for(uint32_t i = 0; i < 64 * 64; ++i) tex[i] = rand32_();
+		RASTER ras;
+		ras.set_color(0x07e0);
+		ras.set_shade(shade);
+		ras.set_texture(tex, 64, 64);
+		vtx::srect clip(0, 0, W, H);
+		VTX v[64][3];
+		for(auto& t : v) {
+			int32_t x = rand32_() % ((W - size) * 16);
+			int32_t y = rand32_() % ((H - size) * 16);
+			t[0] = VTX(x, y);
+			t[1] = VTX(x + size * 16, y + (rand32_() % (size * 16)));
+			t[2] = VTX(x + (rand32_() % (size * 16)), y + size * 16);
+			for(auto& p : t) {
+				p.r = rand32_(); p.g = rand32_(); p.b = rand32_();
+				p.u = static_cast<float>(p.x) / (64.0f * 16.0f);
+				p.v = static_cast<float>(p.y) / (64.0f * 16.0f);
+			}
+		}
+		uint32_t i = 0;
+		while(state.keep_running()) {
+			auto& t = v[i++ & 63];
+			ras.draw(fb, clip, t[0], t[1], t[2], texture);
+		}
+		utest::do_not_optimize(fb);
+		state.set_items_processed(state.iterations());
+	}
+}
+
+UBENCH(tri_raster, flat_8px)
+{
+	bench_tri_(state, 8, RASTER::SHADE::FLAT, false);
+}
+
+UBENCH(tri_raster, flat_64px)
+{
+	bench_tri_(state, 64, RASTER::SHADE::FLAT, false);
+}
+
+UBENCH(tri_raster, gouraud_64px)
+{
+	bench_tri_(state, 64, RASTER::SHADE::GOURAUD, false);
+}
+
+UBENCH(tri_raster, texture_64px)
+{
+	bench_tri_(state, 64, RASTER::SHADE::FLAT, true);
+}
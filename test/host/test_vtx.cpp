@@ -0,0 +1,135 @@
+//=====================================================================//
+/*!	@file
+	@brief	vtx、mtx のテスト
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "utest.hpp"
+#include "common/vtx.hpp"
+#include "common/mtx.hpp"
+
+UTEST(vtx, vertex2)
+{
+	vtx::spos a(3, 4);
+	vtx::spos b(1, -2);
+	UTEST_TRUE((a + b) == vtx::spos(4, 2));
+	UTEST_TRUE((a - b) == vtx::spos(2, 6));
+	UTEST_TRUE((a * 2) == vtx::spos(6, 8));
+	UTEST_EQ(a.sqr(), 25);
+	UTEST_EQ(vtx::spos::dot(a, b), -5);
+	UTEST_EQ(vtx::spos::cross(a, b), -10);
+	vtx::fpos f(3.0f, 4.0f);
+	UTEST_NEAR(f.len(), 5.0, 1e-6);
+	UTEST_NEAR(vtx::distance(vtx::fpos(0.0f), f), 5.0, 1e-6);
+}
+
+UTEST(vtx, vertex3)
+{
+	vtx::fvtx x(1.0f, 0.0f, 0.0f);
+	vtx::fvtx y(0.0f, 1.0f, 0.0f);
+	vtx::fvtx z;
+	vtx::cross(x, y, z);
+	UTEST_NEAR(z.x, 0.0, 1e-6);
+	UTEST_NEAR(z.y, 0.0, 1e-6);
+	UTEST_NEAR(z.z, 1.0, 1e-6);
+	UTEST_NEAR(vtx::dot(x, y), 0.0, 1e-6);
+	vtx::fvtx n;
+	UTEST_TRUE(vtx::normalize(vtx::fvtx(2.0f, 0.0f, 0.0f), n));
+	UTEST_NEAR(n.x, 1.0, 1e-6);
+}
+
+UTEST(vtx, rect)
+{
+	vtx::srect r(10, 20, 30, 40);
+	UTEST_EQ(r.end_x(), 40);
+	UTEST_EQ(r.end_y(), 60);
+	UTEST_TRUE(r.is_focus(vtx::spos(10, 20)));
+	UTEST_TRUE(r.is_focus(vtx::spos(39, 59)));
+	UTEST_FALSE(r.is_focus(vtx::spos(40, 59)));
+	UTEST_TRUE(r.is_overlap(vtx::srect(35, 55, 10, 10)));
+	UTEST_FALSE(r.is_overlap(vtx::srect(40, 20, 10, 10)));
+}
+
+UTEST(mtx, identity_mul)
+{
+	mtx::fmat4 a;
+	a.identity();
+	mtx::fmat4 b;
+	for(uint32_t i = 0; i < 16; ++i) b[i] = static_cast<float>(i + 1);
+	auto c = a * b;
+	for(uint32_t i = 0; i < 16; ++i) {
+		UTEST_NEAR(c[i], b[i], 1e-6);
+	}
+}
+
+UTEST(mtx, inverse)
+{
+	mtx::fmat4 m;
+	m.identity();
+	m.scale(vtx::fvtx(2.0f, 4.0f, 0.5f));
+	m.translate(vtx::fvtx(1.0f, -2.0f, 3.0f));
+	m.rotate(30.0f, vtx::fvtx(0.0f, 0.0f, 1.0f));
+	mtx::fmat4 inv;
+	UTEST_TRUE(inv.inverse(m()));
+	auto e = m * inv;
+	for(uint32_t i = 0; i < 16; ++i) {
+		UTEST_NEAR(e[i], (i % 5) == 0 ? 1.0 : 0.0, 1e-5);
+	}
+	// ベクターの変換と逆変換
+	float v[4] = { 1.0f, 2.0f, 3.0f, 1.0f };
+	float t[4];
+	float r[4];
+	mtx::matmul1(t, m(), v);
+	mtx::matmul1(r, inv(), t);
+	for(uint32_t i = 0; i < 4; ++i) {
+		UTEST_NEAR(r[i], v[i], 1e-5);
+	}
+	mtx::fmat4 z;
+	z.zero();
+	mtx::fmat4 zi;
+	UTEST_FALSE(zi.inverse(z()));
+}
+
+UBENCH(mtx, matmul4)
+{
+	mtx::fmat4 a;
+	mtx::fmat4 b;
+	for(uint32_t i = 0; i < 16; ++i) {
+		a[i] = static_cast<float>(i) * 0.1f;
+		b[i] = static_cast<float>(16 - i) * 0.1f;
+	}
+	while(state.keep_running()) {
+		auto c = a * b;
+		utest::do_not_optimize(c);
+	}
+	state.set_items_processed(state.iterations());
+}
+
+UBENCH(mtx, inverse)
+{
+	mtx::fmat4 m;
+	m.identity();
+	m.rotate(30.0f, vtx::fvtx(0.0f, 1.0f, 0.0f));
+	m.translate(vtx::fvtx(1.0f, 2.0f, 3.0f));
+	mtx::fmat4 inv;
+	while(state.keep_running()) {
+		inv.inverse(m());
+		utest::do_not_optimize(inv);
+	}
+	state.set_items_processed(state.iterations());
+}
+
+UBENCH(vtx, fvtx_normalize)
+{
+	vtx::fvtx v(1.0f, 2.0f, 3.0f);
+	vtx::fvtx n;
+	while(state.keep_running()) {
+		vtx::normalize(v, n);
+		utest::do_not_optimize(n);
+		v.x += 0.001f;
+	}
+	state.set_items_processed(state.iterations());
+}
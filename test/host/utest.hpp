@@ -0,0 +1,304 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ホスト用、ユニット・テスト、マイクロ・ベンチマーク @n
+			・UTEST(group, name) でテストを登録する @n
+			・UBENCH(group, name) でベンチマークを登録する @n
+			　（Google Benchmark と同じく、state.keep_running() でループする） @n
+			Ex: @n
+			UTEST(fifo, put_get) { ... UTEST_EQ(f.get(), 1); } @n
+			UBENCH(fifo, put_get) { while(state.keep_running()) { ... } }
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2021 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RX/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <type_traits>
+
+namespace utest {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  ベンチマーク・ステート
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class state {
+		uint64_t	max_;
+		uint64_t	count_;
+		uint64_t	items_;
+		uint64_t	bytes_;
+
+	public:
+		state(uint64_t max) noexcept : max_(max), count_(0), items_(0), bytes_(0) { }
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ループの継続判定
+			@return 規定回数に達していなければ「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool keep_running() noexcept
+		{
+			if(count_ >= max_) return false;
+			++count_;
+			return true;
+		}
+
+		uint64_t iterations() const noexcept { return max_; }
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  処理した要素数を設定（items/s を表示する）
+			@param[in]	n	要素数（全ループの合計）
+		*/
+		//-----------------------------------------------------------------//
+		void set_items_processed(uint64_t n) noexcept { items_ = n; }
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  処理したバイト数を設定（MB/s を表示する）
+			@param[in]	n	バイト数（全ループの合計）
+		*/
+		//-----------------------------------------------------------------//
+		void set_bytes_processed(uint64_t n) noexcept { bytes_ = n; }
+
+		uint64_t get_items() const noexcept { return items_; }
+
+		uint64_t get_bytes() const noexcept { return bytes_; }
+	};
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  値を最適化で消されないようにする
+		@param[in]	v	値
+	*/
+	//-----------------------------------------------------------------//
+	template <typename T>
+	inline void do_not_optimize(const T& v) noexcept
+	{
+		asm volatile("" : : "r,m"(v) : "memory");
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  メモリへの書き込みを、最適化で消されないようにする
+	*/
+	//-----------------------------------------------------------------//
+	inline void clobber_memory() noexcept
+	{
+		asm volatile("" : : : "memory");
+	}
+
+
+	typedef void (*test_func)();
+	typedef void (*bench_func)(state&);
+
+	struct test_t {
+		const char*	group;
+		const char*	name;
+		test_func	func;
+	};
+
+	struct bench_t {
+		const char*	group;
+		const char*	name;
+		bench_func	func;
+	};
+
+	inline std::vector<test_t>& tests() { static std::vector<test_t> t; return t; }
+
+	inline std::vector<bench_t>& benches() { static std::vector<bench_t> t; return t; }
+
+	inline uint32_t& fail_count() { static uint32_t n = 0; return n; }
+
+	struct test_reg {
+		test_reg(const char* g, const char* n, test_func f) { tests().push_back({ g, n, f }); }
+	};
+
+	struct bench_reg {
+		bench_reg(const char* g, const char* n, bench_func f) { benches().push_back({ g, n, f }); }
+	};
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  条件の検査
+		@return 成功なら「true」
+	*/
+	//-----------------------------------------------------------------//
+	inline bool check(bool ok, const char* expr, const char* file, int line) noexcept
+	{
+		if(!ok) {
+			std::printf("  %s:%d: FAILED: %s\n", file, line, expr);
+			++fail_count();
+		}
+		return ok;
+	}
+
+
+	template <typename T>
+	inline std::string to_str_(const T& v)
+	{
+		std::ostringstream os;
+		if constexpr (sizeof(T) == 1 && std::is_integral<T>::value) {
+			os << static_cast<int>(v);
+		} else {
+			os << v;
+		}
+		return os.str();
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  一致の検査（不一致なら、両方の値を表示）
+		@return 成功なら「true」
+	*/
+	//-----------------------------------------------------------------//
+	template <typename A, typename B>
+	inline bool check_eq(const A& a, const B& b, const char* ea, const char* eb,
+		const char* file, int line)
+	{
+		if(a == b) return true;
+		std::printf("  %s:%d: FAILED: %s == %s (%s vs %s)\n", file, line, ea, eb,
+			to_str_(a).c_str(), to_str_(b).c_str());
+		++fail_count();
+		return false;
+	}
+
+
+	inline bool check_str(const char* a, const char* b, const char* ea, const char* eb,
+		const char* file, int line)
+	{
+		if(a != nullptr && b != nullptr && std::strcmp(a, b) == 0) return true;
+		std::printf("  %s:%d: FAILED: %s == %s (\"%s\" vs \"%s\")\n", file, line, ea, eb,
+			a != nullptr ? a : "(null)", b != nullptr ? b : "(null)");
+		++fail_count();
+		return false;
+	}
+
+
+	inline bool check_near(double a, double b, double eps, const char* ea, const char* eb,
+		const char* file, int line)
+	{
+		if(std::abs(a - b) <= eps) return true;
+		std::printf("  %s:%d: FAILED: %s ~= %s (%.9g vs %.9g, eps %g)\n", file, line, ea, eb,
+			a, b, eps);
+		++fail_count();
+		return false;
+	}
+
+
+	inline bool match_(const char* filter, const char* group, const char* name)
+	{
+		if(filter == nullptr) return true;
+		std::string s = group;
+		s += '.';
+		s += name;
+		return s.find(filter) != std::string::npos;
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  テストを全て実行
+		@param[in]	filter	「group.name」に含まれる文字列（nullptr なら全て）
+		@return 失敗したテストの数
+	*/
+	//-----------------------------------------------------------------//
+	inline uint32_t run_tests(const char* filter)
+	{
+		uint32_t num = 0;
+		uint32_t ng = 0;
+		for(const auto& t : tests()) {
+			if(!match_(filter, t.group, t.name)) continue;
+			auto n = fail_count();
+			t.func();
+			++num;
+			if(fail_count() != n) {
+				std::printf("[ NG ] %s.%s\n", t.group, t.name);
+				++ng;
+			} else {
+				std::printf("[ OK ] %s.%s\n", t.group, t.name);
+			}
+		}
+		std::printf("%u tests, %u failed\n", num, ng);
+		return ng;
+	}
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief  ベンチマークを全て実行 @n
+				１回の計測が min_time 秒を超えるまで、回数を増やす
+		@param[in]	filter		「group.name」に含まれる文字列（nullptr なら全て）
+		@param[in]	min_time	最小計測時間（秒）
+	*/
+	//-----------------------------------------------------------------//
+	inline void run_benches(const char* filter, double min_time)
+	{
+		std::printf("%-40s %14s %12s %16s\n", "benchmark", "ns/iter", "iterations", "rate");
+		for(const auto& b : benches()) {
+			if(!match_(filter, b.group, b.name)) continue;
+			uint64_t n = 1;
+			while(1) {
+				state st(n);
+				auto t0 = std::chrono::steady_clock::now();
+				b.func(st);
+				auto t1 = std::chrono::steady_clock::now();
+				double sec = std::chrono::duration<double>(t1 - t0).count();
+				if(sec >= min_time || n >= (1ULL << 40)) {
+					char rate[32] = { 0 };
+					if(st.get_bytes() > 0) {
+						std::snprintf(rate, sizeof(rate), "%.1f MB/s",
+							static_cast<double>(st.get_bytes()) / sec / 1e6);
+					} else if(st.get_items() > 0) {
+						std::snprintf(rate, sizeof(rate), "%.3g items/s",
+							static_cast<double>(st.get_items()) / sec);
+					}
+					std::string name = b.group;
+					name += '.';
+					name += b.name;
+					std::printf("%-40s %14.1f %12llu %16s\n", name.c_str(),
+						sec * 1e9 / static_cast<double>(n), static_cast<unsigned long long>(n), rate);
+					break;
+				}
+				// 目標時間に届くよう回数を増やす（最大 10 倍）
+				double m = sec > 0.0 ? (min_time * 1.4 / sec) : 10.0;
+				if(m > 10.0) m = 10.0;
+				if(m < 2.0) m = 2.0;
+				n = static_cast<uint64_t>(static_cast<double>(n) * m);
+			}
+		}
+	}
+}
+
+#define UTEST_CAT_(a, b) a##b
+#define UTEST_CAT(a, b) UTEST_CAT_(a, b)
+
+#define UTEST(group, name) \
+	static void utest_##group##_##name(); \
+	static utest::test_reg UTEST_CAT(utest_reg_, __LINE__)(#group, #name, utest_##group##_##name); \
+	static void utest_##group##_##name()
+
+#define UBENCH(group, name) \
+	static void ubench_##group##_##name(utest::state& state); \
+	static utest::bench_reg UTEST_CAT(ubench_reg_, __LINE__)(#group, #name, ubench_##group##_##name); \
+	static void ubench_##group##_##name(utest::state& state)
+
+#define UTEST_TRUE(cond) utest::check(static_cast<bool>(cond), #cond, __FILE__, __LINE__)
+#define UTEST_FALSE(cond) utest::check(!static_cast<bool>(cond), "!(" #cond ")", __FILE__, __LINE__)
+#define UTEST_EQ(a, b) utest::check_eq((a), (b), #a, #b, __FILE__, __LINE__)
+#define UTEST_STR(a, b) utest::check_str((a), (b), #a, #b, __FILE__, __LINE__)
+#define UTEST_NEAR(a, b, eps) utest::check_near((a), (b), (eps), #a, #b, __FILE__, __LINE__)